@@ -1,141 +1,159 @@
 #include <algorithm>
 #include <array>
-#include <cassert>
+#include <chrono>
 #include <cstdint>
-#include <memory>
+#include <cstdio>
+#include <fstream>
 #include <vector>
 
 #include "ExeUnpacker.h"
 
 #include "../Utilities/Bytes.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/File.h"
 #include "../Utilities/String.h"
 
 #include "components/vfs/manager.hpp"
 
 namespace
 {
-	// Performance optimization for bit reading (replaces the unnecessary heap 
-	// allocation of std::vector<bool>). Use BitVector::bitsUsed instead of 
-	// BitVector::bits.size().
-	struct BitVector
+	// One entry in a bit table lookup. The index into the lookup table is the next 
+	// "bits" of the bit stream (first bit in the least significant position), so any 
+	// code can be decoded with a single table access instead of walking a tree one 
+	// bit at a time.
+	struct BitTableEntry
 	{
-		std::array<bool, 9> bits;
-		int bitsUsed;
+		int value;
+		int bitCount; // Zero if no code matches.
+		bool special; // Only set for the "011100" case in Duplication1.
 
-		BitVector()
+		BitTableEntry()
 		{
-			std::fill(this->bits.begin(), this->bits.end(), false);
-			this->bitsUsed = 0;
+			this->value = 0;
+			this->bitCount = 0;
+			this->special = false;
 		}
 	};
 
-	// A simple binary tree for retrieving a decoded value, given a vector of bits.
-	class BitTree
+	// Lookup table for a prefix code whose longest code is MaxBits long.
+	template <int MaxBits>
+	class BitTable
 	{
 	private:
-		struct Node
-		{
-			// Only leaves will have non-null values.
-			std::unique_ptr<int> value;
-			std::unique_ptr<Node> left;
-			std::unique_ptr<Node> right;
-		};
-
-		BitTree::Node root;
+		std::array<BitTableEntry, 1 << MaxBits> entries;
 	public:
-		BitTree() { }
-		~BitTree() { }
-
-		// Inserts a node into the tree, overwriting any existing entry.
-		void insert(const std::vector<bool> &bits, int value)
+		// Inserts a code into every slot whose low bits match it.
+		void insert(const std::vector<bool> &bits, int value, bool special)
 		{
-			BitTree::Node *node = &this->root;
+			const int bitCount = static_cast<int>(bits.size());
+			DebugAssert((bitCount > 0) && (bitCount <= MaxBits), 
+				"Invalid bit code length \"" + std::to_string(bitCount) + "\".");
 
-			// Walk the tree, creating new nodes as necessary. Internal nodes have null values.
-			for (size_t i = 0; i < bits.size(); ++i)
+			int code = 0;
+			for (int i = 0; i < bitCount; i++)
 			{
-				const bool bit = bits.at(i);
+				code |= (bits.at(i) ? 1 : 0) << i;
+			}
 
-				// Decide which branch to use.
-				if (bit)
-				{
-					// Right.
-					if (node->right.get() == nullptr)
-					{
-						// Make a new node.
-						node->right = std::unique_ptr<BitTree::Node>(new BitTree::Node());
-					}
-
-					node = node->right.get();
-				}
-				else
-				{
-					// Left.
-					if (node->left.get() == nullptr)
-					{
-						// Make a new node.
-						node->left = std::unique_ptr<BitTree::Node>(new BitTree::Node());
-					}
-
-					node = node->left.get();
-				}
-				
-				// Set the node's value if it's the desired leaf.
-				if (i == (bits.size() - 1))
-				{
-					node->value = std::unique_ptr<int>(new int(value));
-				}
+			const int suffixCount = 1 << (MaxBits - bitCount);
+			for (int i = 0; i < suffixCount; i++)
+			{
+				BitTableEntry &entry = this->entries.at(code | (i << bitCount));
+				entry.value = value;
+				entry.bitCount = bitCount;
+				entry.special = special;
 			}
 		}
 
-		// Returns a pointer to a decoded value in the tree, or null if no entry exists.
-		const int *get(const BitVector &bitVector)
+		// Gets the entry for the next MaxBits of the bit stream.
+		const BitTableEntry &get(uint32_t bits) const
 		{
-			const int *value = nullptr;
-			const BitTree::Node *left = this->root.left.get();
-			const BitTree::Node *right = this->root.right.get();
+			return this->entries[bits & ((1 << MaxBits) - 1)];
+		}
+	};
 
-			// Walk the tree.
-			for (int i = 0; i < bitVector.bitsUsed; i++)
-			{
-				const bool bit = bitVector.bits.at(i);
+	// Reads the PKLITE bit stream. Bit arrays are 16-bit little endian words that 
+	// are interleaved with plain bytes, and the next bit array is fetched as soon as 
+	// the last bit of the current one is consumed.
+	class BitReader
+	{
+	private:
+		const uint8_t *begin;
+		const uint8_t *end;
+		const uint8_t *ptr;
+		uint16_t bitArray;
+		int bitsRead;
 
-				// Decide which branch to use.
-				if (bit)
-				{
-					// Right.
-					assert(right != nullptr);
+		uint16_t peekWord() const
+		{
+			return ((this->ptr + 1) < this->end) ? Bytes::getLE16(this->ptr) : 0;
+		}
+	public:
+		BitReader(const uint8_t *begin, const uint8_t *end)
+		{
+			this->begin = begin;
+			this->end = end;
+			this->ptr = begin;
+			this->bitArray = this->peekWord();
+			this->ptr += 2;
+			this->bitsRead = 0;
+		}
 
-					// Check if it's a leaf.
-					if ((right->left.get() == nullptr) && (right->right.get() == nullptr))
-					{
-						value = right->value.get();
-					}
+		// Number of bits consumed in the current bit array (between 0 and 15).
+		int getBitsRead() const
+		{
+			return this->bitsRead;
+		}
 
-					left = right->left.get();
-					right = right->right.get();
-				}
-				else
-				{
-					// Left.
-					assert(left != nullptr);
+		// Gets the next 16 or more bits without consuming them. Bits beyond the 
+		// current bit array come from the next two bytes in the stream, which is 
+		// where the next bit array will be read from.
+		uint32_t peekBits() const
+		{
+			const uint32_t current = static_cast<uint32_t>(this->bitArray) >> this->bitsRead;
+			const uint32_t next = static_cast<uint32_t>(this->peekWord());
+			return current | (next << (16 - this->bitsRead));
+		}
 
-					// Check if it's a leaf.
-					if ((left->left.get() == nullptr) && (left->right.get() == nullptr))
-					{
-						value = left->value.get();
-					}
+		// Consumes up to 16 bits, fetching the next bit array if necessary.
+		void skipBits(int count)
+		{
+			this->bitsRead += count;
 
-					right = left->right.get();
-					left = left->left.get();
-				}
+			if (this->bitsRead >= 16)
+			{
+				this->bitsRead -= 16;
+				this->bitArray = this->peekWord();
+				this->ptr += 2;
+			}
+		}
+
+		bool getNextBit()
+		{
+			const bool bit = (this->bitArray & (1 << this->bitsRead)) != 0;
+			this->skipBits(1);
+			return bit;
+		}
+
+		uint8_t getNextByte()
+		{
+			if (this->ptr >= this->end)
+			{
+				DebugCrash("Compressed data overrun at offset " + 
+					std::to_string(this->ptr - this->begin) + ".");
 			}
 
-			return value;
+			const uint8_t byte = *this->ptr;
+			this->ptr++;
+			return byte;
 		}
 	};
 
+	// Header for the cached decompressed executable. The compressed file's size and 
+	// hash are stored so a changed or different executable invalidates the cache.
+	const std::string CacheSignature = "OTAEXE01";
+	const int CacheHeaderSize = 8 + 4 + 4 + 4;
+
 	// Bit table from pklite_specification.md, section 4.3.1 "Number of bytes".
 	// The decoded value for a given vector is (index + 2) before index 11, and
 	// (index + 1) after index 11.
@@ -204,12 +222,40 @@ namespace
 		{ false, true, true, true, true, true, false }, // 30
 		{ false, true, true, true, true, true, true } // 31
 	};
+
+	// Longest codes in each bit table.
+	const int Duplication1MaxBits = 9;
+	const int Duplication2MaxBits = 7;
+
+	// FNV-1a hash of a byte buffer, for validating the cached executable.
+	uint32_t getHash(const std::vector<uint8_t> &data)
+	{
+		uint32_t hash = 2166136261u;
+		for (const uint8_t byte : data)
+		{
+			hash ^= byte;
+			hash *= 16777619u;
+		}
+
+		return hash;
+	}
+
+	void writeLE32(std::ofstream &ofs, uint32_t value)
+	{
+		const char bytes[] =
+		{
+			static_cast<char>(value & 0xFF),
+			static_cast<char>((value >> 8) & 0xFF),
+			static_cast<char>((value >> 16) & 0xFF),
+			static_cast<char>((value >> 24) & 0xFF)
+		};
+
+		ofs.write(bytes, sizeof(bytes));
+	}
 }
 
-ExeUnpacker::ExeUnpacker(const std::string &filename)
+ExeUnpacker::ExeUnpacker(const std::string &filename, const std::string &cacheFilename)
 {
-	DebugMention("Unpacking \"" + filename + "\".");
-
 	VFS::IStreamPtr stream = VFS::Manager::get().open(filename);
 	DebugAssert(stream != nullptr, "Could not open \"" + filename + "\".");
 
@@ -220,26 +266,170 @@ ExeUnpacker::ExeUnpacker(const std::string &filename)
 	std::vector<uint8_t> srcData(fileSize);
 	stream->read(reinterpret_cast<char*>(srcData.data()), srcData.size());
 
-	// Generate the bit trees for "duplication mode". Since the Duplication1 table has 
-	// a special case at index 11, split the insertions up for the first bit tree.
-	BitTree bitTree1, bitTree2;
+	// Reading the compressed file is cheap compared to decompressing it, so the cache
+	// is validated against the compressed data every time.
+	const uint32_t srcHash = getHash(srcData);
+	const uint32_t srcSize = static_cast<uint32_t>(srcData.size());
+
+	if (!cacheFilename.empty() && this->readCache(cacheFilename, srcSize, srcHash))
+	{
+		DebugMention("Using cached \"" + filename + "\" from \"" + cacheFilename + "\".");
+		return;
+	}
+
+	DebugMention("Unpacking \"" + filename + "\".");
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	this->unpack(srcData);
+	const auto endTime = std::chrono::high_resolution_clock::now();
+
+	const double elapsedMs = std::chrono::duration<double, std::milli>(
+		endTime - startTime).count();
+	DebugMention("Unpacked \"" + filename + "\" in " + 
+		String::fixedPrecision(elapsedMs, 2) + "ms.");
+
+	if (!cacheFilename.empty())
+	{
+		this->writeCache(cacheFilename, srcSize, srcHash);
+	}
+}
+
+ExeUnpacker::ExeUnpacker(const std::string &filename)
+	: ExeUnpacker(filename, std::string()) { }
+
+ExeUnpacker::ExeUnpacker(const std::vector<uint8_t> &srcData)
+{
+	this->unpack(srcData);
+}
+
+ExeUnpacker::~ExeUnpacker()
+{
+
+}
+
+bool ExeUnpacker::readCache(const std::string &cacheFilename, uint32_t srcSize, 
+	uint32_t srcHash)
+{
+	if (!File::exists(cacheFilename))
+	{
+		return false;
+	}
+
+	std::ifstream ifs(cacheFilename, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!ifs.is_open())
+	{
+		return false;
+	}
+
+	const auto cacheSize = static_cast<size_t>(ifs.tellg());
+	if (cacheSize < CacheHeaderSize)
+	{
+		return false;
+	}
+
+	ifs.seekg(0, std::ios::beg);
+
+	std::array<uint8_t, CacheHeaderSize> header;
+	ifs.read(reinterpret_cast<char*>(header.data()), header.size());
+
+	const std::string signature(reinterpret_cast<const char*>(header.data()), 
+		CacheSignature.size());
+	const uint32_t cachedSrcSize = Bytes::getLE32(header.data() + 8);
+	const uint32_t cachedSrcHash = Bytes::getLE32(header.data() + 12);
+	const uint32_t textSize = Bytes::getLE32(header.data() + 16);
+
+	const bool headerMatches = (signature == CacheSignature) &&
+		(cachedSrcSize == srcSize) && (cachedSrcHash == srcHash) &&
+		(textSize == (cacheSize - CacheHeaderSize));
+
+	if (!headerMatches)
+	{
+		DebugMention("Ignoring stale cache \"" + cacheFilename + "\".");
+		return false;
+	}
+
+	this->text.resize(textSize);
+	ifs.read(&this->text[0], textSize);
+
+	if (!ifs.good())
+	{
+		this->text.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void ExeUnpacker::writeCache(const std::string &cacheFilename, uint32_t srcSize, 
+	uint32_t srcHash) const
+{
+	// Write to a temporary file first so an interrupted write never leaves a 
+	// truncated cache behind.
+	const std::string tempFilename = cacheFilename + ".tmp";
 
-	for (int i = 0; i < 11; ++i)
+	std::ofstream ofs(tempFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!ofs.is_open())
 	{
-		bitTree1.insert(Duplication1.at(i), i + 2);
+		DebugWarning("Could not write cache \"" + cacheFilename + "\".");
+		return;
 	}
 
-	bitTree1.insert(Duplication1.at(11), 13);
+	ofs.write(CacheSignature.data(), CacheSignature.size());
+	writeLE32(ofs, srcSize);
+	writeLE32(ofs, srcHash);
+	writeLE32(ofs, static_cast<uint32_t>(this->text.size()));
+	ofs.write(this->text.data(), this->text.size());
+	ofs.close();
 
-	for (int i = 12; i < Duplication1.size(); ++i)
+	if (!ofs.good())
 	{
-		bitTree1.insert(Duplication1.at(i), i + 1);
+		DebugWarning("Could not write cache \"" + cacheFilename + "\".");
+		std::remove(tempFilename.c_str());
+		return;
 	}
 
-	for (int i = 0; i < Duplication2.size(); ++i)
+	if (!File::replace(tempFilename, cacheFilename))
 	{
-		bitTree2.insert(Duplication2.at(i), i);
+		DebugWarning("Could not rename \"" + tempFilename + "\" to \"" + 
+			cacheFilename + "\".");
+		std::remove(tempFilename.c_str());
 	}
+}
+
+void ExeUnpacker::unpack(const std::vector<uint8_t> &srcData)
+{
+	// Generate the lookup tables for "duplication mode". Since the Duplication1 table has 
+	// a special case at index 11, split the insertions up for the first table.
+	static const BitTable<Duplication1MaxBits> bitTable1 = []()
+	{
+		BitTable<Duplication1MaxBits> table;
+
+		for (int i = 0; i < 11; ++i)
+		{
+			table.insert(Duplication1.at(i), i + 2, false);
+		}
+
+		table.insert(Duplication1.at(11), 13, true);
+
+		for (int i = 12; i < static_cast<int>(Duplication1.size()); ++i)
+		{
+			table.insert(Duplication1.at(i), i + 1, false);
+		}
+
+		return table;
+	}();
+
+	static const BitTable<Duplication2MaxBits> bitTable2 = []()
+	{
+		BitTable<Duplication2MaxBits> table;
+
+		for (int i = 0; i < static_cast<int>(Duplication2.size()); ++i)
+		{
+			table.insert(Duplication2.at(i), i, false);
+		}
+
+		return table;
+	}();
 
 	// Beginning and end of compressed data in the executable.
 	const uint8_t *compressedStart = srcData.data() + 752;
@@ -259,102 +449,42 @@ ExeUnpacker::ExeUnpacker(const std::string &filename)
 	}();
 
 	// Buffer for the decompressed data (also little endian).
-	std::vector<uint8_t> decomp(decompLen);
-	std::fill(decomp.begin(), decomp.end(), 0);
+	this->text = std::string(decompLen, '\0');
+	uint8_t *decomp = reinterpret_cast<uint8_t*>(&this->text[0]);
 
 	// Current position for inserting decompressed data.
 	size_t decompIndex = 0;
 
-	// A 16-bit array of compressed data.
-	uint16_t bitArray = Bytes::getLE16(compressedStart);
-
-	// Offset from start of compressed data (start at 2 because of the bit array).
-	int byteIndex = 2;
-
-	// Number of bits consumed in the current 16-bit array.
-	int bitsRead = 0;
+	// Bit and byte reader over the compressed data. It is bounded by the end of the 
+	// file rather than the 0xFFFF word so it never reads less than before.
+	BitReader reader(compressedStart, srcData.data() + srcData.size());
 
 	// Continually read bit arrays from the compressed data and interpret each bit. 
 	// Break once a compressed byte equals 0xFF in duplication mode.
 	while (true)
 	{
-		// Lambda for getting the next byte from compressed data.
-		auto getNextByte = [compressedStart, &byteIndex]()
-		{
-			const uint8_t byte = compressedStart[byteIndex];
-			byteIndex++;
-
-			return byte;
-		};
-
-		// Lambda for getting the next bit in the theoretical bit stream.
-		auto getNextBit = [&bitArray, &bitsRead, &getNextByte]()
-		{
-			const bool bit = (bitArray & (1 << bitsRead)) != 0;
-			bitsRead++;
-
-			// Advance the bit array if done with the current one.
-			if (bitsRead == 16)
-			{
-				bitsRead = 0;
-
-				// Get two bytes in little endian format.
-				const uint8_t byte1 = getNextByte();
-				const uint8_t byte2 = getNextByte();
-				bitArray = byte1 | (byte2 << 8);
-			}
-
-			return bit;
-		};
-
 		// Decide which mode to use for the current bit.
-		if (getNextBit())
+		if (reader.getNextBit())
 		{
 			// "Duplication" mode.
 			// Calculate which bytes in the decompressed data to duplicate and append.
-			BitVector copyBits;
-			const int *copyPtr = nullptr;
-
-			// Read bits until they match a bit tree leaf.
-			while (copyPtr == nullptr)
+			// Checked with an "if" so the message string isn't built for every code.
+			const BitTableEntry &copyEntry = bitTable1.get(reader.peekBits());
+			if (copyEntry.bitCount == 0)
 			{
-				copyBits.bits.at(copyBits.bitsUsed) = getNextBit();
-				copyBits.bitsUsed++;
-				copyPtr = bitTree1.get(copyBits);
+				DebugCrash("Invalid copy count code.");
 			}
 
+			reader.skipBits(copyEntry.bitCount);
+
 			// Calculate the number of bytes in the decompressed data to copy.
 			uint16_t copyCount = 0;
 
-			// Lambda for comparing a bit vector's equality with the special case.
-			auto matchesSpecialCase = [](const BitVector &bitVector)
-			{
-				const std::vector<bool> &specialCase = Duplication1.at(11);
-				const bool equalSize = bitVector.bitsUsed == specialCase.size();
-
-				if (!equalSize)
-				{
-					return false;
-				}
-				else
-				{
-					for (int i = 0; i < bitVector.bitsUsed; i++)
-					{
-						if (bitVector.bits.at(i) != specialCase.at(i))
-						{
-							return false;
-						}
-					}
-
-					return true;
-				}
-			};
-
 			// Check for the special bit vector case "011100".
-			if (matchesSpecialCase(copyBits))
+			if (copyEntry.special)
 			{
 				// Read a compressed byte.
-				const uint8_t encryptedByte = getNextByte();
+				const uint8_t encryptedByte = reader.getNextByte();
 
 				if (encryptedByte == 0xFE)
 				{
@@ -375,7 +505,7 @@ ExeUnpacker::ExeUnpacker(const std::string &filename)
 			else
 			{
 				// Use the decoded value from the first bit table.
-				copyCount = *copyPtr;
+				copyCount = copyEntry.value;
 			}
 
 			// Calculate the offset in decompressed data. It is a two byte value.
@@ -385,40 +515,47 @@ ExeUnpacker::ExeUnpacker(const std::string &filename)
 			// If the copy count is not 2, decode the most significant byte.
 			if (copyCount != 2)
 			{
-				BitVector offsetBits;
-				const int* offsetPtr = nullptr;
-
-				// Read bits until they match a bit tree leaf.
-				while (offsetPtr == nullptr)
+				const BitTableEntry &offsetEntry = bitTable2.get(reader.peekBits());
+				if (offsetEntry.bitCount == 0)
 				{
-					offsetBits.bits.at(offsetBits.bitsUsed) = getNextBit();
-					offsetBits.bitsUsed++;
-					offsetPtr = bitTree2.get(offsetBits);
+					DebugCrash("Invalid offset code.");
 				}
 
+				reader.skipBits(offsetEntry.bitCount);
+
 				// Use the decoded value from the second bit table.
-				mostSigByte = *offsetPtr;
+				mostSigByte = offsetEntry.value;
 			}
 
 			// Get the least significant byte of the two bytes.
-			const uint8_t leastSigByte = getNextByte();
+			const uint8_t leastSigByte = reader.getNextByte();
 
 			// Combine the two bytes.
 			const uint16_t offset = leastSigByte | (mostSigByte << 8);
 
 			// Finally, duplicate the decompressed data using the calculated offset and size.
-			const size_t duplicateBegin = decompIndex - offset;
-			const size_t duplicateEnd = duplicateBegin + copyCount;
-			for (size_t i = duplicateBegin; i < duplicateEnd; ++i, ++decompIndex)
+			// The ranges may overlap (i.e., run-length style copies), so copy byte by byte.
+			if ((offset > decompIndex) || ((decompIndex + copyCount) > decompLen))
 			{
-				decomp.at(decompIndex) = decomp.at(i);
+				DebugCrash("Invalid duplication (offset " + std::to_string(offset) + 
+					", count " + std::to_string(copyCount) + ", index " + 
+					std::to_string(decompIndex) + ").");
 			}
+
+			const uint8_t *duplicateBegin = decomp + (decompIndex - offset);
+			uint8_t *dst = decomp + decompIndex;
+			for (int i = 0; i < copyCount; i++)
+			{
+				dst[i] = duplicateBegin[i];
+			}
+
+			decompIndex += copyCount;
 		}
 		else
 		{
 			// "Decryption" mode.
 			// Read the next byte from the compressed data.
-			const uint8_t encryptedByte = getNextByte();
+			const uint8_t encryptedByte = reader.getNextByte();
 
 			// Lambda for decrypting an encrypted byte with an XOR operation based on 
 			// the current bit index. "bitsRead" is between 0 and 15. It is 0 if the
@@ -430,23 +567,17 @@ ExeUnpacker::ExeUnpacker(const std::string &filename)
 				return decryptedByte;
 			};
 
-			// Decrypt the byte.
-			const uint8_t decryptedByte = decrypt(encryptedByte, bitsRead);
+			if (decompIndex >= decompLen)
+			{
+				DebugCrash("Decompressed data overrun at index " + 
+					std::to_string(decompIndex) + ".");
+			}
 
 			// Append the decrypted byte onto the decompressed data.
-			decomp.at(decompIndex) = decryptedByte;
+			decomp[decompIndex] = decrypt(encryptedByte, reader.getBitsRead());
 			decompIndex++;
 		}
 	}
-
-	// Convert the vector to a string.
-	this->text.resize(decomp.size());
-	std::copy(decomp.begin(), decomp.end(), this->text.begin());
-}
-
-ExeUnpacker::~ExeUnpacker()
-{
-
 }
 
 const std::string &ExeUnpacker::getText() const
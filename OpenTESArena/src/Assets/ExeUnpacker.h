@@ -1,17 +1,42 @@
 #ifndef EXE_UNPACKER_H
 #define EXE_UNPACKER_H
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 // For decompressing DOS executables compressed with PKLITE.
 
+// Decompression can optionally be skipped by giving a cache file path. The unpacked
+// image is written there the first time, and later runs load it directly as long as
+// the compressed executable hasn't changed.
+
 class ExeUnpacker
 {
 private:
 	std::string text;
+
+	// Attempts to load the decompressed data from a cache file. Returns false if the
+	// cache is missing or was made from a different executable.
+	bool readCache(const std::string &cacheFilename, uint32_t srcSize, uint32_t srcHash);
+
+	// Writes the decompressed data to a cache file, tagged with the compressed 
+	// executable's size and hash.
+	void writeCache(const std::string &cacheFilename, uint32_t srcSize, 
+		uint32_t srcHash) const;
+
+	// Decompresses the given PKLITE executable data into the "text" member.
+	void unpack(const std::vector<uint8_t> &srcData);
 public:
 	// Reads in a compressed EXE file and decompresses it into a "text" member.
 	ExeUnpacker(const std::string &filename);
+
+	// Same as above, but uses the given cache file (if valid) instead of decompressing,
+	// and otherwise writes the decompressed data to it.
+	ExeUnpacker(const std::string &filename, const std::string &cacheFilename);
+
+	// Decompresses PKLITE executable data that has already been read into memory.
+	ExeUnpacker(const std::vector<uint8_t> &srcData);
 	~ExeUnpacker();
 
 	// Gets the decompressed executable file data.
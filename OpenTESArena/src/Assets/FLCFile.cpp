@@ -98,20 +98,20 @@ FLCFile::FLCFile(const std::string &filename)
 	const auto fileSize = stream->tellg();
 	stream->seekg(0, std::ios::beg);
 
-	std::vector<uint8_t> srcData(fileSize);
-	stream->read(reinterpret_cast<char*>(srcData.data()), srcData.size());
+	this->srcData = std::vector<uint8_t>(fileSize);
+	stream->read(reinterpret_cast<char*>(this->srcData.data()), this->srcData.size());
 
 	// Get the header data. Some of it is just miscellaneous (last updated, etc.),
 	// or only used in later versions with the EGI modifications.
 	FLICHeader header;
-	header.size = Bytes::getLE32(srcData.data());
-	header.type = Bytes::getLE16(srcData.data() + 4);
-	header.frames = Bytes::getLE16(srcData.data() + 6);
-	header.width = Bytes::getLE16(srcData.data() + 8);
-	header.height = Bytes::getLE16(srcData.data() + 10);
-	header.depth = Bytes::getLE16(srcData.data() + 12);
-	header.flags = Bytes::getLE16(srcData.data() + 14);
-	header.speed = Bytes::getLE32(srcData.data() + 16);
+	header.size = Bytes::getLE32(this->srcData.data());
+	header.type = Bytes::getLE16(this->srcData.data() + 4);
+	header.frames = Bytes::getLE16(this->srcData.data() + 6);
+	header.width = Bytes::getLE16(this->srcData.data() + 8);
+	header.height = Bytes::getLE16(this->srcData.data() + 10);
+	header.depth = Bytes::getLE16(this->srcData.data() + 12);
+	header.flags = Bytes::getLE16(this->srcData.data() + 14);
+	header.speed = Bytes::getLE32(this->srcData.data() + 16);
 
 	// This class will only support the format used by Arena (0xAF12) for now.
 	DebugAssert(header.type == static_cast<int>(FileType::FLC_TYPE), 
@@ -120,95 +120,66 @@ FLCFile::FLCFile(const std::string &filename)
 	this->frameDuration = static_cast<double>(header.speed) / 1000.0;
 	this->width = header.width;
 	this->height = header.height;
+	this->frameIndices = std::vector<uint8_t>(this->width * this->height);
+	this->paletteARGB.fill(0);
 
-	// Palette which is filled by one of the FLIC color chunks.
-	Palette palette;
+	// The last frame is dropped, since they all seem to loop around to the beginning
+	// at the end.
+	this->frameCount = std::max(this->countFrames() - 1, 0);
+
+	this->rewind();
+}
 
-	// Current state of the frame's palette indices. Completely updated by byte runs
-	// and partially updated by delta frames.
-	std::vector<uint8_t> framePixels(this->width * this->height);
+FLCFile::~FLCFile()
+{
+
+}
+
+int FLCFile::countFrames() const
+{
+	int count = 0;
 
-	// Start decoding frames. The data starts after the header.
-	uint32_t dataOffset = sizeof(FLICHeader);
-	while ((srcData.begin() + dataOffset) < srcData.end())
+	// The data starts after the header.
+	uint32_t offset = sizeof(FLICHeader);
+	while ((this->srcData.begin() + offset) < this->srcData.end())
 	{
-		const uint8_t *framePtr = srcData.data() + dataOffset;
+		const uint8_t *framePtr = this->srcData.data() + offset;
 
 		const FrameHeader frameHeader(Bytes::getLE32(framePtr),
 			Bytes::getLE16(framePtr + 4), Bytes::getLE16(framePtr + 6));
 
 		if (frameHeader.type == FrameType::FRAME_TYPE)
 		{
-			// Check each chunk's type and decode its data if relevant.
 			uint32_t chunkOffset = sizeof(FrameHeader);
 			for (uint16_t i = 0; i < frameHeader.chunkCount; ++i)
 			{
-				// Pointer to the chunk's header.
 				const uint8_t *chunkPtr = framePtr + chunkOffset;
 
 				const ChunkHeader chunkHeader(Bytes::getLE32(chunkPtr),
 					Bytes::getLE16(chunkPtr + 4));
 
-				// The struct alignment of 8 means sizeof(ChunkHeader) wouldn't
-				// be accurate here, so 6 is used instead.
-				const uint8_t *chunkData = chunkPtr + 6;
-
-				// Just concerned with palettes, full frames, and delta frames.
-				if (chunkHeader.type == ChunkType::COLOR_256)
-				{
-					// Palette chunk.
-					this->readPaletteData(chunkData, palette);
-				}
-				else if (chunkHeader.type == ChunkType::FLI_BRUN)
-				{
-					// Full frame chunk.
-					auto frame = this->decodeFullFrame(chunkData, chunkHeader.size,
-						palette, framePixels);
-
-					this->pixels.push_back(std::move(frame));
-				}
-				else if (chunkHeader.type == ChunkType::FLI_SS2)
+				if ((chunkHeader.type == ChunkType::FLI_BRUN) ||
+					(chunkHeader.type == ChunkType::FLI_SS2))
 				{
-					// Delta frame chunk.
-					auto frame = this->decodeDeltaFrame(chunkData, chunkHeader.size,
-						palette, framePixels);
-
-					this->pixels.push_back(std::move(frame));
-				}
-				else
-				{
-					// Ignoring other chunk types for now since they're not needed.
-					/*Debug::mention("FLCFile", "Unrecognized chunk type \"" +
-						std::to_string(static_cast<int>(chunkHeader.type)) + "\".");*/
+					count++;
 				}
 
 				chunkOffset += chunkHeader.size;
 			}
 		}
-		else if (frameHeader.type == FrameType::PREFIX_CHUNK)
-		{
-			// CEL prefix chunk, can be skipped.
-		}
-		else
+		else if (frameHeader.type != FrameType::PREFIX_CHUNK)
 		{
 			DebugCrash("Unrecognized frame type \"" +
 				std::to_string(static_cast<int>(frameHeader.type)) + "\".");
 		}
 
-		dataOffset += frameHeader.size;
+		offset += frameHeader.size;
 	}
 
-	// Pop the last frame off, since they all seem to loop around to the beginning
-	// at the end.
-	this->pixels.pop_back();
-}
-
-FLCFile::~FLCFile()
-{
-
+	return count;
 }
 
-void FLCFile::readPaletteData(const uint8_t *chunkData, Palette &dstPalette)
+void FLCFile::readPaletteData(const uint8_t *chunkData)
 {
 	// The number of elements (i.e., "groups" of pixels) should be one.
 	const uint16_t numberOfElements = Bytes::getLE16(chunkData);
@@ -226,15 +197,21 @@ void FLCFile::readPaletteData(const uint8_t *chunkData, Palette &dstPalette)
 		const uint8_t r = *(ptr + 0);
 		const uint8_t g = *(ptr + 1);
 		const uint8_t b = *(ptr + 2);
-		dstPalette.get()[i] = Color(r, g, b, 255);
+		this->palette.get()[i] = Color(r, g, b, 255);
+	}
+
+	// Keep the ARGB form of the palette so frames don't need to convert each color.
+	for (size_t i = 0; i < this->paletteARGB.size(); ++i)
+	{
+		this->paletteARGB[i] = this->palette.get()[i].toARGB();
 	}
 }
 
-std::unique_ptr<uint32_t[]> FLCFile::decodeFullFrame(const uint8_t *chunkData,
-	int chunkSize, const Palette &palette, std::vector<uint8_t> &initialFrame)
+void FLCFile::decodeFullFrame(const uint8_t *chunkData, int chunkSize)
 {
 	// Decode a fullscreen image chunk. Most likely the first image in the FLIC.
-	std::vector<uint8_t> decomp(this->width * this->height);
+	// It completely overwrites the current frame.
+	uint8_t *decomp = this->frameIndices.data();
 
 	// The chunk data is organized in rows, and each row has packets of compressed
 	// pixels. The number of lines is the height of the FLIC.
@@ -247,6 +224,8 @@ std::unique_ptr<uint32_t[]> FLCFile::decodeFullFrame(const uint8_t *chunkData,
 		// of the line after decoding pixels is used instead.
 		offset++;
 
+		uint8_t *row = decomp + (rowsDone * this->width);
+
 		// Read and process packets until the pixel count for the row is equal to 
 		// the width.
 		int rowPixelsDone = 0;
@@ -260,11 +239,10 @@ std::unique_ptr<uint32_t[]> FLCFile::decodeFullFrame(const uint8_t *chunkData,
 				// The packet contains one pixel that is repeated by the absolute 
 				// value of "type". This is probably used frequently for black pixels.
 				const uint8_t pixel = *(chunkData + offset + 1);
+				const int count = std::min(static_cast<int>(type), 
+					this->width - rowPixelsDone);
 
-				for (int i = 0; i < type; ++i)
-				{
-					decomp.at((rowPixelsDone + i) + (rowsDone * this->width)) = pixel;
-				}
+				std::fill(row + rowPixelsDone, row + rowPixelsDone + count, pixel);
 
 				rowPixelsDone += type;
 				offset += 2;
@@ -273,13 +251,11 @@ std::unique_ptr<uint32_t[]> FLCFile::decodeFullFrame(const uint8_t *chunkData,
 			{
 				// "Type" is a pixel count for how many to copy from the packet 
 				// to the output.
-				const int8_t pixelCount = -type;
+				const int pixelCount = -type;
+				const int count = std::min(pixelCount, this->width - rowPixelsDone);
 
-				for (int i = 0; i < pixelCount; ++i)
-				{
-					const uint8_t pixel = *(chunkData + offset + 1 + i);
-					decomp.at((rowPixelsDone + i) + (rowsDone * this->width)) = pixel;
-				}
+				const uint8_t *src = chunkData + offset + 1;
+				std::copy(src, src + count, row + rowPixelsDone);
 
 				rowPixelsDone += pixelCount;
 				offset += 1 + pixelCount;
@@ -290,26 +266,12 @@ std::unique_ptr<uint32_t[]> FLCFile::decodeFullFrame(const uint8_t *chunkData,
 			}
 		}
 	}
-
-	// Write the decoded frame to the initial (scratch) frame.
-	initialFrame = decomp;
-
-	const uint8_t *decompPixels = decomp.data();
-	std::unique_ptr<uint32_t[]> image(new uint32_t[this->width * this->height]);
-
-	std::transform(decompPixels, decompPixels + decomp.size(), image.get(),
-		[&palette](uint8_t col) -> uint32_t
-	{
-		return palette.get()[col].toARGB();
-	});
-
-	return std::move(image);
 }
 
-std::unique_ptr<uint32_t[]> FLCFile::decodeDeltaFrame(const uint8_t *chunkData,
-	int chunkSize, const Palette &palette, std::vector<uint8_t> &initialFrame)
+void FLCFile::decodeDeltaFrame(const uint8_t *chunkData, int chunkSize)
 {
 	// Decode a delta frame chunk. The majority of FLIC frames are this format.
+	std::vector<uint8_t> &initialFrame = this->frameIndices;
 
 	// The line count is the number of rows with encoded packets.
 	const uint16_t lineCount = Bytes::getLE16(chunkData);
@@ -427,24 +389,11 @@ std::unique_ptr<uint32_t[]> FLCFile::decodeDeltaFrame(const uint8_t *chunkData,
 			}
 		}
 	}
-
-	// Use the modified initial frame as the source instead of a separate
-	// decompressed buffer.
-	const uint8_t *framePixels = initialFrame.data();
-	std::unique_ptr<uint32_t[]> image(new uint32_t[this->width * this->height]);
-
-	std::transform(framePixels, framePixels + initialFrame.size(), image.get(),
-		[&palette](uint8_t col) -> uint32_t
-	{
-		return palette.get()[col].toARGB();
-	});
-
-	return std::move(image);
 }
 
 int FLCFile::getFrameCount() const
 {
-	return static_cast<int>(this->pixels.size());
+	return this->frameCount;
 }
 
 double FLCFile::getFrameDuration() const
@@ -462,7 +411,118 @@ int FLCFile::getHeight() const
 	return this->height;
 }
 
-uint32_t *FLCFile::getPixels(int index) const
+int FLCFile::getFrameIndex() const
+{
+	return this->frameIndex;
+}
+
+const uint8_t *FLCFile::getFrameIndices() const
 {
-	return this->pixels.at(index).get();
+	return this->frameIndices.data();
+}
+
+const Palette &FLCFile::getPalette() const
+{
+	return this->palette;
+}
+
+bool FLCFile::readNextFrame()
+{
+	if ((this->frameIndex + 1) >= this->frameCount)
+	{
+		return false;
+	}
+
+	// Continue from where the last frame left off, stopping right after the next
+	// image chunk so any palette chunk after it applies to later frames only.
+	while ((this->srcData.begin() + this->dataOffset) < this->srcData.end())
+	{
+		const uint8_t *framePtr = this->srcData.data() + this->dataOffset;
+
+		const FrameHeader frameHeader(Bytes::getLE32(framePtr),
+			Bytes::getLE16(framePtr + 4), Bytes::getLE16(framePtr + 6));
+
+		if (frameHeader.type == FrameType::FRAME_TYPE)
+		{
+			// Check each chunk's type and decode its data if relevant.
+			while (this->chunkIndex < frameHeader.chunkCount)
+			{
+				// Pointer to the chunk's header.
+				const uint8_t *chunkPtr = framePtr + this->chunkOffset;
+
+				const ChunkHeader chunkHeader(Bytes::getLE32(chunkPtr),
+					Bytes::getLE16(chunkPtr + 4));
+
+				// The struct alignment of 8 means sizeof(ChunkHeader) wouldn't
+				// be accurate here, so 6 is used instead.
+				const uint8_t *chunkData = chunkPtr + 6;
+
+				this->chunkIndex++;
+				this->chunkOffset += chunkHeader.size;
+
+				// Just concerned with palettes, full frames, and delta frames.
+				if (chunkHeader.type == ChunkType::COLOR_256)
+				{
+					// Palette chunk.
+					this->readPaletteData(chunkData);
+				}
+				else if (chunkHeader.type == ChunkType::FLI_BRUN)
+				{
+					// Full frame chunk.
+					this->decodeFullFrame(chunkData, chunkHeader.size);
+					this->frameIndex++;
+					return true;
+				}
+				else if (chunkHeader.type == ChunkType::FLI_SS2)
+				{
+					// Delta frame chunk.
+					this->decodeDeltaFrame(chunkData, chunkHeader.size);
+					this->frameIndex++;
+					return true;
+				}
+				else
+				{
+					// Ignoring other chunk types for now since they're not needed.
+				}
+			}
+		}
+		else if (frameHeader.type == FrameType::PREFIX_CHUNK)
+		{
+			// CEL prefix chunk, can be skipped.
+		}
+		else
+		{
+			DebugCrash("Unrecognized frame type \"" +
+				std::to_string(static_cast<int>(frameHeader.type)) + "\".");
+		}
+
+		this->dataOffset += frameHeader.size;
+		this->chunkOffset = sizeof(FrameHeader);
+		this->chunkIndex = 0;
+	}
+
+	return false;
+}
+
+void FLCFile::rewind()
+{
+	this->frameIndex = -1;
+	this->dataOffset = sizeof(FLICHeader);
+	this->chunkOffset = sizeof(FrameHeader);
+	this->chunkIndex = 0;
+}
+
+void FLCFile::writePixels(uint32_t *dst, int pitch) const
+{
+	const uint8_t *src = this->frameIndices.data();
+	for (int y = 0; y < this->height; ++y)
+	{
+		const uint8_t *srcRow = src + (y * this->width);
+		uint32_t *dstRow = dst + (y * pitch);
+
+		for (int x = 0; x < this->width; ++x)
+		{
+			dstRow[x] = this->paletteARGB[srcRow[x]];
+		}
+	}
 }
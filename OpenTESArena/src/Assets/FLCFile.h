@@ -1,8 +1,8 @@
 #ifndef FLC_FILE_H
 #define FLC_FILE_H
 
+#include <array>
 #include <cstdint>
-#include <memory>
 #include <string>
 #include <vector>
 
@@ -24,27 +24,49 @@
 // - http://www.compuphase.com/flic.htm
 // - http://www.fileformat.info/format/fli/egff.htm
 
+// Frames are decoded one at a time on demand. Only the current frame's palette indices
+// and the palette are kept, since most frames are deltas of the previous one. Callers
+// that want every frame (i.e., for a texture set) should step through them with 
+// readNextFrame() and convert each one as it comes.
+
 class FLCFile
 {
 private:
-	// One unique_ptr for each frame.
-	std::vector<std::unique_ptr<uint32_t[]>> pixels;
+	std::vector<uint8_t> srcData;
+
+	// Current state of the frame's palette indices. Completely updated by byte runs
+	// and partially updated by delta frames.
+	std::vector<uint8_t> frameIndices;
+
+	// Palette which is filled by one of the FLIC color chunks, and its ARGB colors.
+	Palette palette;
+	std::array<uint32_t, 256> paletteARGB;
+
 	double frameDuration;
 	int width;
 	int height;
+	int frameCount;
+
+	// Index of the most recently decoded frame (-1 if none yet).
+	int frameIndex;
+
+	// Position of the next chunk to decode (the frame record's offset, plus the chunk's
+	// index and offset within that frame).
+	uint32_t dataOffset;
+	uint32_t chunkOffset;
+	int chunkIndex;
 
-	// Reads a palette chunk and writes the results to the given palette reference.
-	void readPaletteData(const uint8_t *chunkData, Palette &dstPalette);
+	// Counts the image chunks in the file without decoding them.
+	int countFrames() const;
 
-	// Decodes a fullscreen FLC chunk by updating the initial frame indices and
-	// returning a complete frame.
-	std::unique_ptr<uint32_t[]> decodeFullFrame(const uint8_t *chunkData, int chunkSize,
-		const Palette &palette, std::vector<uint8_t> &initialFrame);
+	// Reads a palette chunk and writes the results to the palette members.
+	void readPaletteData(const uint8_t *chunkData);
 
-	// Decodes a delta FLC chunk by partially updating the initial frame indices and
-	// returning a complete frame.
-	std::unique_ptr<uint32_t[]> decodeDeltaFrame(const uint8_t *chunkData, int chunkSize,
-		const Palette &palette, std::vector<uint8_t> &initialFrame);
+	// Decodes a fullscreen FLC chunk by overwriting the current frame indices.
+	void decodeFullFrame(const uint8_t *chunkData, int chunkSize);
+
+	// Decodes a delta FLC chunk by partially updating the current frame indices.
+	void decodeDeltaFrame(const uint8_t *chunkData, int chunkSize);
 public:
 	FLCFile(const std::string &filename);
 	~FLCFile();
@@ -61,8 +83,25 @@ public:
 	// Gets the height of each frame in the FLC file.
 	int getHeight() const;
 
-	// Gets the pixel data for a frame in the FLC file.
-	uint32_t *getPixels(int index) const;
+	// Gets the index of the most recently decoded frame, or -1 if none have been
+	// decoded since the start.
+	int getFrameIndex() const;
+
+	// Gets the palette indices of the most recently decoded frame.
+	const uint8_t *getFrameIndices() const;
+
+	// Gets the palette at the most recently decoded frame.
+	const Palette &getPalette() const;
+
+	// Decodes the next frame. Returns false if there are no frames left.
+	bool readNextFrame();
+
+	// Goes back to before the first frame so it can be decoded again.
+	void rewind();
+
+	// Writes the most recently decoded frame as ARGB pixels into the given buffer. The
+	// pitch is in pixels.
+	void writePixels(uint32_t *dst, int pitch) const;
 };
 
 #endif
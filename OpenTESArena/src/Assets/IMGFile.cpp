@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <unordered_map>
 
 #include "IMGFile.h"
@@ -32,7 +33,7 @@ namespace
 	};
 }
 
-IMGFile::IMGFile(const std::string &filename, const Palette *palette)
+IMGFile::IMGFile(const std::string &filename)
 {
 	VFS::IStreamPtr stream = VFS::Manager::get().open(filename);
 	DebugAssert(stream != nullptr, "Could not open \"" + filename + "\".");
@@ -83,36 +84,12 @@ IMGFile::IMGFile(const std::string &filename, const Palette *palette)
 
 	const int headerSize = 12;
 
-	// Try and read the IMG's built-in palette if the given palette is null.
-	Palette builtInPalette;
-	const bool useBuiltInPalette = palette == nullptr;
-
-	if (useBuiltInPalette)
-	{
-		// This code might run even if the IMG doesn't have a palette, because
-		// some IMGs have no header and are not "raw" (like walls, for instance).
-		DebugAssert((flags & 0x0100) != 0, "\"" + filename + 
-			"\" does not have a built-in palette.");
-
-		// Read the palette data and write it to the destination palette.
-		IMGFile::readPalette(srcData.data() + headerSize + len, builtInPalette);
-	}
-
-	// Choose which palette to use.
-	const Palette &paletteRef = useBuiltInPalette ? builtInPalette : (*palette);
-
-	// Lambda for setting IMGFile members and constructing the final image.
-	auto makeImage = [this, &paletteRef](int width, int height, const uint8_t *data)
+	// Lambda for setting IMGFile members and copying the palette indices.
+	auto makeImage = [this](int width, int height, const uint8_t *data)
 	{
 		this->width = width;
 		this->height = height;
-		this->pixels = std::unique_ptr<uint32_t[]>(new uint32_t[width * height]);
-
-		std::transform(data, data + (width * height), this->pixels.get(),
-			[&paletteRef](uint8_t col) -> uint32_t
-		{
-			return paletteRef.get()[col].toARGB();
-		});
+		this->pixels = std::vector<uint8_t>(data, data + (width * height));
 	};
 
 	// Decide how to use the pixel data.
@@ -136,24 +113,22 @@ IMGFile::IMGFile(const std::string &filename, const Palette *palette)
 		}
 		else if ((flags & 0x00FF) == 0x0004)
 		{
-			// Type 4 compression.
-			std::vector<uint8_t> decomp(width * height);
+			// Type 4 compression. Decode straight into the indices.
+			this->width = width;
+			this->height = height;
+			this->pixels = std::vector<uint8_t>(width * height);
 			Compression::decodeType04(srcData.begin() + headerSize,
-				srcData.begin() + headerSize + len, decomp);
-
-			// Create 32-bit image.
-			makeImage(width, height, decomp.data());
+				srcData.begin() + headerSize + len, this->pixels);
 		}
 		else if ((flags & 0x00FF) == 0x0008)
 		{
 			// Type 8 compression. Contains a 2 byte decompressed length after
 			// the header, so skip that (should be equivalent to width * height).
-			std::vector<uint8_t> decomp(width * height);
+			this->width = width;
+			this->height = height;
+			this->pixels = std::vector<uint8_t>(width * height);
 			Compression::decodeType08(srcData.begin() + headerSize + 2,
-				srcData.begin() + headerSize + len, decomp);
-
-			// Create 32-bit image.
-			makeImage(width, height, decomp.data());
+				srcData.begin() + headerSize + len, this->pixels);
 		}
 		else
 		{
@@ -228,7 +203,12 @@ int IMGFile::getHeight() const
 	return this->height;
 }
 
-uint32_t *IMGFile::getPixels() const
+const uint8_t *IMGFile::getPixels() const
+{
+	return this->pixels.data();
+}
+
+std::vector<uint8_t> &IMGFile::getPixels()
 {
-	return this->pixels.get();
+	return this->pixels;
 }
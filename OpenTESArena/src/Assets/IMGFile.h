@@ -2,8 +2,8 @@
 #define IMG_FILE_H
 
 #include <cstdint>
-#include <memory>
 #include <string>
+#include <vector>
 
 #include "../Media/Palette.h"
 
@@ -11,18 +11,21 @@
 // properties, or without a header (either raw or a wall). Some IMGs also have a
 // built-in palette, which they may or may not use eventually.
 
+// The pixels are kept as 8-bit palette indices. The palette is applied later, so
+// one decoded IMG can be shown with any number of palettes.
+
 class IMGFile
 {
 private:
-	std::unique_ptr<uint32_t[]> pixels;
+	std::vector<uint8_t> pixels;
 	int width, height;
 
 	// Reads the palette from an IMG file and writes into the given palette reference.
 	static void readPalette(const uint8_t *paletteData, Palette &dstPalette);
 public:
-	// Loads an IMG from file. Uses the given palette unless it is null, then it 
-	// refers to the IMG's built-in palette instead if it has one.
-	IMGFile(const std::string &filename, const Palette *palette);
+	// Loads an IMG from file. Its built-in palette (if any) can be obtained with 
+	// IMGFile::extractPalette().
+	IMGFile(const std::string &filename);
 	~IMGFile();
 
 	// Extracts the palette from an IMG file and writes it into the given palette
@@ -35,8 +38,11 @@ public:
 	// Gets the height of the IMG in pixels.
 	int getHeight() const;
 
-	// Gets a pointer to the pixel data for the IMG.
-	uint32_t *getPixels() const;
+	// Gets a pointer to the palette indices for the IMG.
+	const uint8_t *getPixels() const;
+
+	// Gets the palette indices so they can be moved out of the IMG.
+	std::vector<uint8_t> &getPixels();
 };
 
 #endif
@@ -46,6 +46,7 @@ const uint8_t MIFFile::LAVA_CHASM = 0xE;
 const double MIFFile::ARENA_UNITS = 128.0;
 
 MIFFile::MIFFile(const std::string &filename)
+	: name(filename)
 {
 	VFS::IStreamPtr stream = VFS::Manager::get().open(filename);
 	DebugAssert(stream != nullptr, "Could not open \"" + filename + "\".");
@@ -89,7 +90,7 @@ MIFFile::MIFFile(const std::string &filename)
 	while (levelOffset < srcData.size())
 	{
 		MIFFile::Level level;
-		std::memset(&level, 0, sizeof(level));
+		level.numf = 0;
 
 		// Begin loading the level data at the current LEVL, and get the offset
 		// to the next LEVL.
@@ -109,6 +110,11 @@ MIFFile::~MIFFile()
 
 }
 
+const std::string &MIFFile::getName() const
+{
+	return this->name;
+}
+
 int MIFFile::getWidth() const
 {
 	return this->width;
@@ -55,6 +55,7 @@ public:
 		static int loadTRIG(MIFFile::Level &level, const uint8_t *tagStart);
 	};
 private:
+	std::string name;
 	int width, depth;
 	int startingLevelIndex;
 	std::vector<Double2> startPoints; // Entrance locations for the level.
@@ -76,6 +77,9 @@ public:
 	// voxel at X coordinate 1).
 	static const double ARENA_UNITS;
 
+	// Gets the filename the map was loaded from.
+	const std::string &getName() const;
+
 	// Gets the dimensions of the map. They are constant for all levels in a map.
 	int getWidth() const;
 	int getDepth() const;
@@ -14,11 +14,14 @@
 #include "components/vfs/manager.hpp"
 
 const std::string TextAssets::AExeKeyValuesMapPath = "data/text/aExeStrings.txt";
+const std::string TextAssets::AExeCacheFilename = "A.EXE.unpacked";
 
 TextAssets::TextAssets()
 {
-	// Decompress A.EXE and place it in a string for later use.
-	const ExeUnpacker floppyExe("A.EXE");
+	// Decompress A.EXE and place it in a string for later use. The unpacked image is 
+	// cached in the options folder so later runs don't need to decompress it again.
+	const ExeUnpacker floppyExe("A.EXE",
+		Platform::getOptionsPath() + TextAssets::AExeCacheFilename);
 	this->aExe = floppyExe.getText();
 
 	// Generate a map of interesting strings from the text of A.EXE.
@@ -19,6 +19,7 @@ class TextAssets
 {
 private:
 	static const std::string AExeKeyValuesMapPath;
+	static const std::string AExeCacheFilename;
 
 	std::string aExe;
 	std::unique_ptr<ExeStrings> aExeStrings;
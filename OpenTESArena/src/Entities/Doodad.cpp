@@ -2,9 +2,8 @@
 
 #include "EntityType.h"
 
-Doodad::Doodad(const Animation &animation, const Double3 &position,
-	EntityManager &entityManager)
-	: Entity(entityManager), animation(animation), position(position) { }
+Doodad::Doodad(EntityManager &entityManager)
+	: Entity(entityManager) { }
 
 Doodad::~Doodad()
 {
@@ -13,8 +12,7 @@ Doodad::~Doodad()
 
 std::unique_ptr<Entity> Doodad::clone(EntityManager &entityManager) const
 {
-	return std::unique_ptr<Doodad>(new Doodad(
-		this->animation, this->position, entityManager));
+	return std::unique_ptr<Doodad>(new Doodad(entityManager));
 }
 
 EntityType Doodad::getEntityType() const
@@ -22,19 +20,7 @@ EntityType Doodad::getEntityType() const
 	return EntityType::Doodad;
 }
 
-const Double3 &Doodad::getPosition() const
-{
-	return this->position;
-}
-
 bool Doodad::facesPlayer() const
 {
 	return true;
 }
-
-void Doodad::tick(Game &game, double dt)
-{
-	// Animate.
-	this->animation.tick(dt);
-	this->textureID = this->animation.getCurrentID();
-}
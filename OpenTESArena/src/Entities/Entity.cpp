@@ -8,8 +8,6 @@
 Entity::Entity(EntityManager &entityManager)
 {
 	this->id = entityManager.nextID();
-	this->textureID = 0;
-	this->flipped = false;
 }
 
 Entity::~Entity()
@@ -21,13 +19,3 @@ int Entity::getID() const
 {
 	return this->id;
 }
-
-int Entity::getTextureID() const
-{
-	return this->textureID;
-}
-
-bool Entity::getFlipped() const
-{
-	return this->flipped;
-}
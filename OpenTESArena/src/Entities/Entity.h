@@ -3,15 +3,16 @@
 
 #include <memory>
 
-#include "../Math/Vector3.h"
-
 // Entities are any non-player objects in the world that aren't part of the 
 // voxel grid. Every entity has a world position and a unique referencing ID. 
 
+// The position, animation, and texture of an entity are stored by the entity manager
+// so all entities can be updated together. Derived entities hold what's specific to
+// their type.
+
 // Not all sprites turn to face the camera (such as doors and portcullises).
 
 class EntityManager;
-class Game;
 
 enum class EntityType;
 
@@ -19,10 +20,6 @@ class Entity
 {
 private:
 	int id;
-protected:
-	// Texture ID and flip state are updated by the derived entity's tick() method.
-	int textureID;
-	bool flipped;
 public:
 	Entity(EntityManager &entityManager);
 	Entity(const Entity&) = delete;
@@ -36,28 +33,10 @@ public:
 	// find which flat is associated with the entity.
 	int getID() const;
 
-	// Gets the texture ID for the current animation frame, to be used by the software 
-	// renderer. This is updated through the tick() method and might also be a function 
-	// of the player's position.
-	int getTextureID() const;
-
-	// Returns whether the entity's texture is currently mirrored across the Y axis. 
-	// This is potentially true for entities whose texture ID depends on their orientation 
-	// to the player.
-	bool getFlipped() const;
-
 	virtual EntityType getEntityType() const = 0;
 
-	// Gets the 3D position of the entity. The semantics of this depends on how it is 
-	// implemented for each entity. For example, the player's position is at their eye, 
-	// while the position of NPCs is at the center of their feet.
-	virtual const Double3 &getPosition() const = 0;
-
 	// Returns whether the entity's 3D flat faces the player (like a sprite).
 	virtual bool facesPlayer() const = 0;
-
-	// Animates the entity's state by delta time.
-	virtual void tick(Game &game, double dt) = 0;
 };
 
 #endif
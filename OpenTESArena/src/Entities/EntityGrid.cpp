@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "EntityGrid.h"
+
+EntityGrid::EntityGrid()
+{
+
+}
+
+EntityGrid::~EntityGrid()
+{
+
+}
+
+Int2 EntityGrid::getCell(const Double3 &position)
+{
+	return Int2(static_cast<int>(std::floor(position.x)),
+		static_cast<int>(std::floor(position.z)));
+}
+
+const std::vector<int> *EntityGrid::getIDs(const Int2 &cell) const
+{
+	const auto cellIter = this->cells.find(cell);
+	return (cellIter != this->cells.end()) ? &cellIter->second : nullptr;
+}
+
+void EntityGrid::add(int id, const Double3 &position)
+{
+	this->cells[EntityGrid::getCell(position)].push_back(id);
+}
+
+void EntityGrid::move(int id, const Double3 &oldPosition, const Double3 &newPosition)
+{
+	const Int2 oldCell = EntityGrid::getCell(oldPosition);
+	const Int2 newCell = EntityGrid::getCell(newPosition);
+	if ((oldCell.x != newCell.x) || (oldCell.y != newCell.y))
+	{
+		this->remove(id, oldPosition);
+		this->add(id, newPosition);
+	}
+}
+
+void EntityGrid::remove(int id, const Double3 &position)
+{
+	const auto cellIter = this->cells.find(EntityGrid::getCell(position));
+	assert(cellIter != this->cells.end());
+
+	std::vector<int> &ids = cellIter->second;
+	const auto idIter = std::find(ids.begin(), ids.end(), id);
+	assert(idIter != ids.end());
+
+	// Order within a cell doesn't matter.
+	*idIter = ids.back();
+	ids.pop_back();
+
+	if (ids.size() == 0)
+	{
+		this->cells.erase(cellIter);
+	}
+}
+
+void EntityGrid::clear()
+{
+	this->cells.clear();
+}
@@ -0,0 +1,44 @@
+#ifndef ENTITY_GRID_H
+#define ENTITY_GRID_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
+
+// An entity grid is a spatial index of entity IDs, bucketed by the voxel column (XZ)
+// each entity's position is in. Only occupied cells are stored, so it doesn't depend
+// on the size of the world. It is updated incrementally as entities are added, moved,
+// and removed, so queries only look at the cells near a point or along a ray instead
+// of every entity.
+
+class EntityGrid
+{
+private:
+	std::unordered_map<Int2, std::vector<int>> cells;
+public:
+	EntityGrid();
+	~EntityGrid();
+
+	// Gets the cell that contains a position.
+	static Int2 getCell(const Double3 &position);
+
+	// Gets the IDs in a cell, or null if the cell is empty.
+	const std::vector<int> *getIDs(const Int2 &cell) const;
+
+	// Adds an ID at a position.
+	void add(int id, const Double3 &position);
+
+	// Moves an ID from its old position to a new one. Nothing happens if both are in
+	// the same cell.
+	void move(int id, const Double3 &oldPosition, const Double3 &newPosition);
+
+	// Removes an ID that was added at the given position.
+	void remove(int id, const Double3 &position);
+
+	// Removes all IDs.
+	void clear();
+};
+
+#endif
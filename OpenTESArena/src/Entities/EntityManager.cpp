@@ -1,13 +1,44 @@
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
 
 #include "EntityManager.h"
 
 #include "Entity.h"
 #include "EntityType.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/JobSystem.h"
+#include "../World/VoxelGrid.h"
 
-EntityManager::EntityManager()
+namespace
 {
+	// One group for each entity type, indexed by the type's value.
+	const int EntityGroupCount = static_cast<int>(EntityType::Transition) + 1;
+
+	// Bits of an ID used by the slot index. The rest (except the sign bit) are the
+	// generation.
+	const int SlotBits = 20;
+	const int SlotMask = (1 << SlotBits) - 1;
+	const int GenerationMask = (1 << (31 - SlotBits)) - 1;
+
+	// Entities per batch when ticking in parallel. Small groups are ticked on the
+	// calling thread alone.
+	const int TickBatchSize = 512;
+}
+
+const int EntityManager::MAX_ENTITIES = 1 << SlotBits;
 
+int EntityManager::EntityGroup::getCount() const
+{
+	return static_cast<int>(this->entities.size());
+}
+
+EntityManager::EntityManager()
+	: groups(EntityGroupCount)
+{
+	this->count = 0;
 }
 
 EntityManager::~EntityManager()
@@ -15,21 +46,72 @@ EntityManager::~EntityManager()
 
 }
 
+int EntityManager::makeID(int slotIndex, int generation)
+{
+	return ((generation & GenerationMask) << SlotBits) | slotIndex;
+}
+
+int EntityManager::getSlotIndex(int id)
+{
+	return id & SlotMask;
+}
+
+int EntityManager::getGeneration(int id)
+{
+	return (id >> SlotBits) & GenerationMask;
+}
+
+const EntityManager::EntitySlot &EntityManager::getSlot(int id) const
+{
+	if (!this->isValid(id))
+	{
+		DebugCrash("No entity with ID " + std::to_string(id) + ".");
+	}
+
+	return this->slots[EntityManager::getSlotIndex(id)];
+}
+
 Entity *EntityManager::at(int id) const
 {
-	const auto entityIter = this->entities.find(id);
-	return (entityIter != this->entities.end()) ?
-		entityIter->second.get() : nullptr;
+	if (this->isValid(id))
+	{
+		const EntitySlot &slot = this->slots[EntityManager::getSlotIndex(id)];
+		return this->groups[slot.groupIndex].entities[slot.index].get();
+	}
+	else
+	{
+		return nullptr;
+	}
+}
+
+bool EntityManager::isValid(int id) const
+{
+	if (id < 0)
+	{
+		return false;
+	}
+
+	const int slotIndex = EntityManager::getSlotIndex(id);
+	if (slotIndex >= static_cast<int>(this->slots.size()))
+	{
+		return false;
+	}
+
+	const EntitySlot &slot = this->slots[slotIndex];
+	return (slot.index >= 0) && (slot.generation == EntityManager::getGeneration(id));
 }
 
 std::vector<Entity*> EntityManager::getAllEntities() const
 {
 	std::vector<Entity*> entityPtrs;
+	entityPtrs.reserve(this->count);
 
-	for (const auto &pair : this->entities)
+	for (const auto &group : this->groups)
 	{
-		Entity *entity = pair.second.get();
-		entityPtrs.push_back(entity);
+		for (const auto &entity : group.entities)
+		{
+			entityPtrs.push_back(entity.get());
+		}
 	}
 
 	return entityPtrs;
@@ -37,46 +119,438 @@ std::vector<Entity*> EntityManager::getAllEntities() const
 
 std::vector<Entity*> EntityManager::getEntities(EntityType entityType) const
 {
+	const EntityGroup &group = this->getGroup(entityType);
+
 	std::vector<Entity*> entityPtrs;
+	entityPtrs.reserve(group.entities.size());
 
-	// Gather up entities whose type matches the given type.
-	for (const auto &pair : this->entities)
+	for (const auto &entity : group.entities)
 	{
-		Entity *entity = pair.second.get();
-		if (entity->getEntityType() == entityType)
+		entityPtrs.push_back(entity.get());
+	}
+
+	return entityPtrs;
+}
+
+const std::vector<EntityManager::EntityGroup> &EntityManager::getGroups() const
+{
+	return this->groups;
+}
+
+const EntityManager::EntityGroup &EntityManager::getGroup(EntityType entityType) const
+{
+	return this->groups.at(static_cast<int>(entityType));
+}
+
+int EntityManager::getCount() const
+{
+	return this->count;
+}
+
+const Double3 &EntityManager::getPosition(int id) const
+{
+	const EntitySlot &location = this->getSlot(id);
+	return this->groups.at(location.groupIndex).positions.at(location.index);
+}
+
+int EntityManager::getTextureID(int id) const
+{
+	const EntitySlot &location = this->getSlot(id);
+	return this->groups.at(location.groupIndex).textureIDs.at(location.index);
+}
+
+bool EntityManager::isFlipped(int id) const
+{
+	const EntitySlot &location = this->getSlot(id);
+	return this->groups.at(location.groupIndex).flipped.at(location.index);
+}
+
+void EntityManager::getEntitiesInRadius(const Double3 &point, double radius,
+	std::vector<int> &ids) const
+{
+	const Int2 minCell = EntityGrid::getCell(point - Double3(radius, 0.0, radius));
+	const Int2 maxCell = EntityGrid::getCell(point + Double3(radius, 0.0, radius));
+	const double radiusSqr = radius * radius;
+
+	for (int z = minCell.y; z <= maxCell.y; z++)
+	{
+		for (int x = minCell.x; x <= maxCell.x; x++)
 		{
-			entityPtrs.push_back(entity);
+			const std::vector<int> *cellIDs = this->grid.getIDs(Int2(x, z));
+			if (cellIDs == nullptr)
+			{
+				continue;
+			}
+
+			// IDs in the grid are always live, so their slots are read directly.
+			for (const int id : *cellIDs)
+			{
+				const EntitySlot &slot = this->slots[EntityManager::getSlotIndex(id)];
+				const Double3 diff = this->groups[slot.groupIndex].positions[slot.index] - point;
+				if (diff.lengthSquared() <= radiusSqr)
+				{
+					ids.push_back(id);
+				}
+			}
 		}
 	}
+}
 
-	return entityPtrs;
+void EntityManager::getNearestEntities(const Double3 &point, int count, double maxDistance,
+	std::vector<int> &ids) const
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// Candidates as distance and ID pairs, so ties are broken the same way every time.
+	std::vector<std::pair<double, int>> candidates;
+	const double maxDistanceSqr = maxDistance * maxDistance;
+	const Int2 center = EntityGrid::getCell(point);
+	const int maxRing = static_cast<int>(std::ceil(maxDistance)) + 1;
+
+	auto visitCell = [this, &point, &candidates, maxDistanceSqr](int x, int z)
+	{
+		const std::vector<int> *cellIDs = this->grid.getIDs(Int2(x, z));
+		if (cellIDs != nullptr)
+		{
+			for (const int id : *cellIDs)
+			{
+				const EntitySlot &slot = this->slots[EntityManager::getSlotIndex(id)];
+				const Double3 &position = this->groups[slot.groupIndex].positions[slot.index];
+				const double distanceSqr = (position - point).lengthSquared();
+				if (distanceSqr <= maxDistanceSqr)
+				{
+					candidates.push_back(std::make_pair(distanceSqr, id));
+				}
+			}
+		}
+	};
+
+	// Search outward one square ring of cells at a time. Anything in a ring past the
+	// current one is at least the current ring's radius away on XZ, so the search can
+	// stop once enough candidates are closer than that.
+	for (int ring = 0; ring <= maxRing; ring++)
+	{
+		if (ring == 0)
+		{
+			visitCell(center.x, center.y);
+		}
+		else
+		{
+			for (int i = -ring; i <= ring; i++)
+			{
+				visitCell(center.x + i, center.y - ring);
+				visitCell(center.x + i, center.y + ring);
+			}
+
+			for (int i = -ring + 1; i <= ring - 1; i++)
+			{
+				visitCell(center.x - ring, center.y + i);
+				visitCell(center.x + ring, center.y + i);
+			}
+		}
+
+		if (static_cast<int>(candidates.size()) >= count)
+		{
+			std::nth_element(candidates.begin(), candidates.begin() + (count - 1),
+				candidates.end());
+			const double ringDistance = static_cast<double>(ring);
+			if (candidates.at(count - 1).first <= (ringDistance * ringDistance))
+			{
+				break;
+			}
+		}
+	}
+
+	const int resultCount = std::min(count, static_cast<int>(candidates.size()));
+	std::partial_sort(candidates.begin(), candidates.begin() + resultCount, candidates.end());
+	for (int i = 0; i < resultCount; i++)
+	{
+		ids.push_back(candidates.at(i).second);
+	}
 }
 
-int EntityManager::nextID() const
+int EntityManager::pickEntity(const Double3 &origin, const Double3 &direction,
+	double maxDistance, const VoxelGrid &voxelGrid) const
 {
-	// Iterate through IDs from 0 to infinity until one is available.
-	int id = 0;
-	while (this->entities.find(id) != this->entities.end())
+	int hitID = -1;
+	double hitDistance = maxDistance;
+
+	// Tests the entities around a cell against the ray as upright cylinders, keeping
+	// the nearest hit.
+	auto testCell = [this, &origin, &direction, &hitID, &hitDistance](const Int2 &cell)
+	{
+		const double a = (direction.x * direction.x) + (direction.z * direction.z);
+
+		for (int z = cell.y - 1; z <= cell.y + 1; z++)
+		{
+			for (int x = cell.x - 1; x <= cell.x + 1; x++)
+			{
+				const std::vector<int> *cellIDs = this->grid.getIDs(Int2(x, z));
+				if (cellIDs == nullptr)
+				{
+					continue;
+				}
+
+				for (const int id : *cellIDs)
+				{
+					const EntitySlot &slot = this->slots[EntityManager::getSlotIndex(id)];
+					const EntityGroup &group = this->groups[slot.groupIndex];
+					const Double3 &position = group.positions[slot.index];
+					const Double2 &size = group.sizes[slot.index];
+					const double radius = size.x * 0.50;
+
+					// Intersect the ray with the cylinder's circle on XZ.
+					const double dx = origin.x - position.x;
+					const double dz = origin.z - position.z;
+					const double b = 2.0 * ((dx * direction.x) + (dz * direction.z));
+					const double c = ((dx * dx) + (dz * dz)) - (radius * radius);
+					const double discriminant = (b * b) - (4.0 * a * c);
+					if ((a == 0.0) || (discriminant < 0.0))
+					{
+						continue;
+					}
+
+					const double root = std::sqrt(discriminant);
+					const double tNear = (-b - root) / (2.0 * a);
+					const double tFar = (-b + root) / (2.0 * a);
+					if (tFar < 0.0)
+					{
+						continue;
+					}
+
+					// The hit must also be between the bottom and top of the flat. Ties
+					// (i.e., the ray starts inside several) go to the lowest ID.
+					const double t = std::max(tNear, 0.0);
+					const double y = origin.y + (direction.y * t);
+					const bool nearer = (t < hitDistance) ||
+						((t == hitDistance) && (hitID != -1) && (id < hitID));
+					if (nearer && (y >= position.y) && (y <= (position.y + size.y)))
+					{
+						hitID = id;
+						hitDistance = t;
+					}
+				}
+			}
+		}
+	};
+
+	// Step through voxel columns along the ray on XZ, like the 2D ray caster.
+	Int2 cell = EntityGrid::getCell(origin);
+	const Int2 step(direction.x >= 0.0 ? 1 : -1, direction.z >= 0.0 ? 1 : -1);
+	const double infinity = std::numeric_limits<double>::infinity();
+	const double deltaX = (direction.x != 0.0) ? std::abs(1.0 / direction.x) : infinity;
+	const double deltaZ = (direction.z != 0.0) ? std::abs(1.0 / direction.z) : infinity;
+	double sideX = (direction.x != 0.0) ? (((direction.x >= 0.0) ?
+		(static_cast<double>(cell.x) + 1.0 - origin.x) :
+		(origin.x - static_cast<double>(cell.x))) * deltaX) : infinity;
+	double sideZ = (direction.z != 0.0) ? (((direction.z >= 0.0) ?
+		(static_cast<double>(cell.y) + 1.0 - origin.z) :
+		(origin.z - static_cast<double>(cell.y))) * deltaZ) : infinity;
+	double entryDistance = 0.0;
+
+	// An entity hit at some distance is within one cell of the cell the ray is in at
+	// that distance, so the search is done once the ray enters cells past the hit.
+	while (entryDistance < hitDistance)
 	{
-		++id;
+		// Stop at walls and floors, except in the cell the ray starts in.
+		if (entryDistance > 0.0)
+		{
+			const int voxelY = static_cast<int>(std::floor(
+				origin.y + (direction.y * entryDistance)));
+			const auto &voxels = voxelGrid.getVoxels();
+			if (voxels.contains(cell.x, voxelY, cell.y) &&
+				(voxels.get(cell.x, voxelY, cell.y) != 0))
+			{
+				hitDistance = std::min(hitDistance, entryDistance);
+				testCell(cell);
+				break;
+			}
+		}
+
+		testCell(cell);
+
+		if (sideX < sideZ)
+		{
+			entryDistance = sideX;
+			sideX += deltaX;
+			cell.x += step.x;
+		}
+		else
+		{
+			entryDistance = sideZ;
+			sideZ += deltaZ;
+			cell.y += step.y;
+		}
 	}
 
-	return id;
+	return hitID;
+}
+
+int EntityManager::nextID() const
+{
+	// Reuse the oldest freed slot, or make a new one if there aren't any.
+	if (this->freeSlots.size() > 0)
+	{
+		const int slotIndex = this->freeSlots.front();
+		return EntityManager::makeID(slotIndex, this->slots[slotIndex].generation);
+	}
+	else
+	{
+		return EntityManager::makeID(static_cast<int>(this->slots.size()), 0);
+	}
 }
 
-void EntityManager::add(std::unique_ptr<Entity> entity)
+void EntityManager::add(std::unique_ptr<Entity> entity, const Double3 &position,
+	const Double2 &size, const Animation &animation)
 {
 	assert(entity.get() != nullptr);
+	assert(size.x <= 2.0);
+
+	// Programmer error if the entity didn't get the next ID (i.e., two entities were
+	// made before adding the first one).
+	const int entityID = entity->getID();
+	DebugAssert(entityID == this->nextID(), "Entity ID " + std::to_string(entityID) +
+		" is not the next available ID.");
 
-	// Programmer error if two entities have the same ID.
-	assert(this->entities.find(entity->getID()) == this->entities.end());
+	const int slotIndex = EntityManager::getSlotIndex(entityID);
+	if (this->freeSlots.size() > 0)
+	{
+		this->freeSlots.pop_front();
+	}
+	else
+	{
+		DebugAssert(slotIndex < EntityManager::MAX_ENTITIES, "Too many entities.");
+
+		EntitySlot slot;
+		slot.generation = 0;
+		this->slots.push_back(slot);
+	}
+
+	const int groupIndex = static_cast<int>(entity->getEntityType());
+	EntityGroup &group = this->groups.at(groupIndex);
+
+	EntitySlot &slot = this->slots[slotIndex];
+	slot.groupIndex = groupIndex;
+	slot.index = group.getCount();
+	this->count++;
+
+	group.entities.push_back(std::move(entity));
+	group.positions.push_back(position);
+	group.animations.push_back(animation);
+	group.sizes.push_back(size);
+	group.ids.push_back(entityID);
+	group.textureIDs.push_back(animation.getCurrentID());
+	group.flipped.push_back(false);
+
+	this->grid.add(entityID, position);
+}
 
-	// Add the pair to the entities map.
-	int entityID = entity->getID();
-	this->entities.insert(std::make_pair(entityID, std::move(entity)));
+void EntityManager::setPosition(int id, const Double3 &position)
+{
+	const EntitySlot &location = this->getSlot(id);
+	Double3 &oldPosition = this->groups.at(location.groupIndex).positions.at(location.index);
+	this->grid.move(id, oldPosition, position);
+	oldPosition = position;
+}
+
+void EntityManager::setAnimation(int id, const Animation &animation)
+{
+	const EntitySlot &location = this->getSlot(id);
+	EntityGroup &group = this->groups.at(location.groupIndex);
+	group.animations.at(location.index) = animation;
+	group.textureIDs.at(location.index) = animation.getCurrentID();
+}
+
+void EntityManager::tick(double dt, JobSystem &jobSystem)
+{
+	for (auto &group : this->groups)
+	{
+		Animation *animations = group.animations.data();
+		int *textureIDs = group.textureIDs.data();
+
+		jobSystem.parallelFor(group.getCount(), TickBatchSize,
+			[dt, animations, textureIDs](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				animations[i].tick(dt);
+				textureIDs[i] = animations[i].getCurrentID();
+			}
+		});
+	}
 }
 
 void EntityManager::remove(int id)
 {
-	this->entities.erase(id);
+	if (!this->isValid(id))
+	{
+		return;
+	}
+
+	// Free the slot, and bump its generation so the removed ID is stale from now on.
+	const int slotIndex = EntityManager::getSlotIndex(id);
+	EntitySlot &slot = this->slots[slotIndex];
+	const EntitySlot location = slot;
+	this->grid.remove(id, this->groups.at(location.groupIndex).positions.at(location.index));
+	slot.generation = (slot.generation + 1) & GenerationMask;
+	slot.index = -1;
+	this->freeSlots.push_back(slotIndex);
+	this->count--;
+
+	// Move the group's last entity into the removed one's place.
+	EntityGroup &group = this->groups.at(location.groupIndex);
+	const int lastIndex = group.getCount() - 1;
+	if (location.index != lastIndex)
+	{
+		group.entities.at(location.index) = std::move(group.entities.at(lastIndex));
+		group.positions.at(location.index) = group.positions.at(lastIndex);
+		group.animations.at(location.index) = group.animations.at(lastIndex);
+		group.sizes.at(location.index) = group.sizes.at(lastIndex);
+		group.ids.at(location.index) = group.ids.at(lastIndex);
+		group.textureIDs.at(location.index) = group.textureIDs.at(lastIndex);
+		group.flipped.at(location.index) = group.flipped.at(lastIndex);
+
+		this->slots[EntityManager::getSlotIndex(group.ids.at(location.index))].index =
+			location.index;
+	}
+
+	group.entities.pop_back();
+	group.positions.pop_back();
+	group.animations.pop_back();
+	group.sizes.pop_back();
+	group.ids.pop_back();
+	group.textureIDs.pop_back();
+	group.flipped.pop_back();
+}
+
+void EntityManager::clear()
+{
+	for (auto &group : this->groups)
+	{
+		group.entities.clear();
+		group.positions.clear();
+		group.animations.clear();
+		group.sizes.clear();
+		group.ids.clear();
+		group.textureIDs.clear();
+		group.flipped.clear();
+	}
+
+	// Free every slot in use, keeping generations so old IDs stay stale.
+	for (int i = 0; i < static_cast<int>(this->slots.size()); i++)
+	{
+		EntitySlot &slot = this->slots[i];
+		if (slot.index >= 0)
+		{
+			slot.generation = (slot.generation + 1) & GenerationMask;
+			slot.index = -1;
+			this->freeSlots.push_back(i);
+		}
+	}
+
+	this->grid.clear();
+	this->count = 0;
 }
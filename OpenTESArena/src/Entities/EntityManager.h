@@ -1,42 +1,148 @@
 #ifndef ENTITY_MANAGER_H
 #define ENTITY_MANAGER_H
 
+#include <deque>
 #include <memory>
-#include <unordered_map>
 #include <vector>
 
+#include "Animation.h"
+#include "EntityGrid.h"
 #include "../Entities/Entity.h"
+#include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
+
+// The entity manager owns every entity in the world. State that's touched each frame
+// (positions, animations, and what the renderer needs) is kept in contiguous arrays
+// grouped by entity type, so it can be updated in tight loops without virtual calls.
+// The entity objects themselves only hold type-specific data and behavior.
+
+// Within a group, index i of each array belongs to the same entity. Removing an entity
+// moves the group's last entity into its place, so indices aren't stable; IDs are.
+
+// An entity ID is a slot index in the low bits and the slot's generation in the high
+// bits. Freed slots go to the back of a queue and their generation is bumped, so a
+// removed entity's ID isn't given out again for a long time, and anything still
+// holding it (i.e., a renderer flat) can tell that it's stale with isValid().
+
+// Entities are also indexed by voxel column in an entity grid, so spatial queries
+// (radius, nearest, and picking along a ray) only look at nearby entities.
+
+class JobSystem;
+class VoxelGrid;
 
 enum class EntityType;
 
 class EntityManager
 {
+public:
+	struct EntityGroup
+	{
+		std::vector<std::unique_ptr<Entity>> entities;
+		std::vector<Double3> positions;
+		std::vector<Animation> animations;
+		std::vector<Double2> sizes; // Width and height of their flats.
+		std::vector<int> ids; // Also the IDs of their flats in the renderer.
+		std::vector<int> textureIDs;
+		std::vector<bool> flipped;
+
+		int getCount() const;
+	};
 private:
-	std::unordered_map<int, std::unique_ptr<Entity>> entities;
+	struct EntitySlot
+	{
+		int generation;
+		int groupIndex, index; // Where the entity is, or -1 if the slot is free.
+	};
+
+	std::vector<EntityGroup> groups; // One per entity type.
+	std::vector<EntitySlot> slots;
+	std::deque<int> freeSlots;
+	EntityGrid grid;
+	int count;
+
+	static int makeID(int slotIndex, int generation);
+	static int getSlotIndex(int id);
+	static int getGeneration(int id);
+
+	const EntitySlot &getSlot(int id) const;
 public:
+	// Most entities that can exist at once, from the bits of an ID used by the slot.
+	static const int MAX_ENTITIES;
+
 	EntityManager();
 	EntityManager(EntityManager &&entityManager) = default;
 	~EntityManager();
 
 	EntityManager &operator=(EntityManager &&entityManager) = default;
 
-	// Gets an entity pointer, given their ID. Returns null if no ID matches.
+	// Gets an entity pointer, given their ID. Returns null if no ID matches, including
+	// IDs of removed entities.
 	Entity *at(int id) const;
 
-	// Gets all entities of all types.
+	// Returns whether an ID belongs to an entity in the manager. IDs of removed
+	// entities aren't valid, even if their slot is in use again (unless the slot has
+	// been reused so many times that its generation wrapped around).
+	bool isValid(int id) const;
+
+	// Gets all entities of all types. This allocates, so it's intended for occasional
+	// use; per-frame updates should go through the entity groups instead.
 	std::vector<Entity*> getAllEntities() const;
 
 	// Gets all entities of the given type.
 	std::vector<Entity*> getEntities(EntityType entityType) const;
 
-	// Obtains an available ID to be assigned to a new entity.
+	// Gets the arrays of entities, one group per entity type.
+	const std::vector<EntityManager::EntityGroup> &getGroups() const;
+	const EntityManager::EntityGroup &getGroup(EntityType entityType) const;
+
+	// Gets the total number of entities.
+	int getCount() const;
+
+	// Per-entity state, given an ID that belongs to an entity in the manager.
+	const Double3 &getPosition(int id) const;
+	int getTextureID(int id) const;
+	bool isFlipped(int id) const;
+
+	// Obtains the ID the next added entity will have. This takes constant time.
 	int nextID() const;
-	
-	// Adds an entity. The entity must get their ID from "nextID()" beforehand.
-	void add(std::unique_ptr<Entity> entity);
+
+	// Gets the IDs of entities within some distance of a point, appending them to the
+	// given list.
+	void getEntitiesInRadius(const Double3 &point, double radius,
+		std::vector<int> &ids) const;
+
+	// Gets the IDs of up to the given count of entities nearest to a point and within
+	// the max distance, from nearest to farthest, appending them to the given list.
+	void getNearestEntities(const Double3 &point, int count, double maxDistance,
+		std::vector<int> &ids) const;
+
+	// Gets the ID of the first entity hit by a ray (i.e., from the camera through the
+	// cursor), or -1 if none. Each entity is treated as an upright cylinder the size of
+	// its flat. The ray stops at the first non-air voxel it enters or at the max
+	// distance. The direction must be normalized.
+	int pickEntity(const Double3 &origin, const Double3 &direction, double maxDistance,
+		const VoxelGrid &voxelGrid) const;
+
+	// Adds an entity with its starting position, flat size, and animation. The entity
+	// must get their ID from "nextID()" beforehand. The flat can be at most two voxels
+	// wide, so picking only has to look at neighboring voxels.
+	void add(std::unique_ptr<Entity> entity, const Double3 &position, const Double2 &size,
+		const Animation &animation);
+
+	// Changes an entity's position or current animation.
+	void setPosition(int id, const Double3 &position);
+	void setAnimation(int id, const Animation &animation);
+
+	// Animates all entities by delta time and updates their texture IDs. Batches of
+	// entities are updated in parallel; each one only writes to its own entities, so
+	// the result doesn't depend on how the batches are scheduled.
+	void tick(double dt, JobSystem &jobSystem);
 
 	// Deletes an entity.
 	void remove(int id);
+
+	// Deletes all entities.
+	void clear();
 };
 
 #endif
@@ -3,14 +3,13 @@
 #include "EntityType.h"
 #include "../Math/Constants.h"
 
-NonPlayer::NonPlayer(const Double3 &position, const Double2 &direction,
-	const std::vector<Animation> &idleAnimations,
+NonPlayer::NonPlayer(const Double2 &direction, const std::vector<Animation> &idleAnimations,
 	const std::vector<Animation> &moveAnimations,
 	const Animation &attackAnimation, const Animation &deathAnimation, 
 	EntityManager &entityManager)
 	: Entity(entityManager), idleAnimations(idleAnimations), moveAnimations(moveAnimations),
 	attackAnimation(attackAnimation), deathAnimation(deathAnimation),
-	camera(position, direction), velocity(0.0, 0.0) { }
+	direction(direction), velocity(0.0, 0.0) { }
 
 NonPlayer::~NonPlayer()
 {
@@ -20,8 +19,8 @@ NonPlayer::~NonPlayer()
 std::unique_ptr<Entity> NonPlayer::clone(EntityManager &entityManager) const
 {
 	return std::unique_ptr<NonPlayer>(new NonPlayer(
-		this->camera.position, this->camera.direction, this->idleAnimations, 
-		this->moveAnimations, this->attackAnimation, this->deathAnimation, entityManager));
+		this->direction, this->idleAnimations, this->moveAnimations,
+		this->attackAnimation, this->deathAnimation, entityManager));
 }
 
 NonPlayer::AnimationType NonPlayer::getAnimationType() const
@@ -46,20 +45,19 @@ EntityType NonPlayer::getEntityType() const
 	return EntityType::NonPlayer;
 }
 
-const Double3 &NonPlayer::getPosition() const
+const Double2 &NonPlayer::getDirection() const
 {
-	return this->camera.position;
+	return this->direction;
 }
 
-bool NonPlayer::facesPlayer() const
+const Animation &NonPlayer::getStartAnimation() const
 {
-	return true;
+	// Idle animation of the first direction for now. It will depend on player position
+	// eventually.
+	return this->idleAnimations.at(0);
 }
 
-void NonPlayer::tick(Game &game, double dt)
+bool NonPlayer::facesPlayer() const
 {
-	// Animate first animation for now. It will depend on player position eventually.
-	Animation &animation = this->idleAnimations.at(0);
-	animation.tick(dt);
-	this->textureID = animation.getCurrentID();
+	return true;
 }
@@ -4,8 +4,8 @@
 #include <vector>
 
 #include "Animation.h"
-#include "Camera2D.h"
 #include "Entity.h"
+#include "../Math/Vector2.h"
 
 // Essentially an actor class, a non-player is an NPC or creature, usually with
 // an AI for movement and/or combat, whose texture depends on their position
@@ -27,14 +27,12 @@ private:
 	std::vector<Animation> idleAnimations, moveAnimations;
 
 	Animation attackAnimation, deathAnimation;
-	Camera2D camera;
-	Double2 velocity;
+	Double2 direction, velocity; // In the XZ plane.
 
 	// Gets the current animation type, dependent on the entity's state.
 	NonPlayer::AnimationType getAnimationType() const;
 public:
-	NonPlayer(const Double3 &position, const Double2 &direction,
-		const std::vector<Animation> &idleAnimations,
+	NonPlayer(const Double2 &direction, const std::vector<Animation> &idleAnimations,
 		const std::vector<Animation> &moveAnimations,
 		const Animation &attackAnimation, const Animation &deathAnimation,
 		EntityManager &entityManager);
@@ -42,11 +40,13 @@ public:
 
 	virtual std::unique_ptr<Entity> clone(EntityManager &entityManager) const override;
 
+	const Double2 &getDirection() const;
+
+	// Gets the animation the entity starts with, for adding them to the entity manager.
+	const Animation &getStartAnimation() const;
+
 	virtual EntityType getEntityType() const override;
-	virtual const Double3 &getPosition() const override;
 	virtual bool facesPlayer() const override;
-
-	virtual void tick(Game &game, double dt) override;
 };
 
 #endif
@@ -11,11 +11,12 @@
 #include "../Items/WeaponType.h"
 #include "../Math/Constants.h"
 #include "../Utilities/String.h"
-#include "../World/VoxelData.h"
+#include "../World/VoxelCollision.h"
 #include "../World/VoxelGrid.h"
 #include "../World/WorldData.h"
 
 const double Player::HEIGHT = 0.70;
+const double Player::HALF_WIDTH = 0.20;
 const double Player::STEPPING_HEIGHT = 0.25;
 const double Player::JUMP_VELOCITY = 3.0;
 const double Player::GRAVITY = 9.81;
@@ -83,6 +84,21 @@ const Double3 &Player::getRight() const
 	return this->camera.getRight();
 }
 
+const Double3 &Player::getVelocity() const
+{
+	return this->velocity;
+}
+
+double Player::getMaxWalkSpeed() const
+{
+	return this->maxWalkSpeed;
+}
+
+double Player::getMaxRunSpeed() const
+{
+	return this->maxRunSpeed;
+}
+
 Double2 Player::getGroundDirection() const
 {
 	const Double3 &direction = this->camera.getDirection();
@@ -114,42 +130,11 @@ double Player::getFeetY() const
 
 bool Player::onGround(const WorldData &worldData) const
 {
-	// To do: find a non-hack way to do this.
-
-	return true;
-
-	// This function seems kind of like a hack right now, since the player's feet
-	// will frequently be at Y == 1.0, which is one voxel above the ground, and
-	// it won't be considered as "on ground" unless it checks the voxel underneath
-	// of this particular Y position (due to the rounding rules being used).
-	/*const double feetY = this->getFeetY();
-	const double feetVoxelYPos = std::floor(feetY);
-	const bool closeEnoughToLowerVoxel = std::abs(feetY - feetVoxelYPos) < EPSILON;
-	const Int3 feetVoxel(
-		static_cast<int>(std::floor(this->camera.position.x)),
-		static_cast<int>(feetVoxelYPos) - (closeEnoughToLowerVoxel ? 1 : 0),
-		static_cast<int>(std::floor(this->camera.position.z)));
-
-	const bool insideWorld = [&feetVoxel, &voxelGrid]()
-	{
-		return (feetVoxel.x >= 0) && (feetVoxel.x < voxelGrid.getWidth()) &&
-			(feetVoxel.y >= 0) && (feetVoxel.y < voxelGrid.getHeight()) &&
-			(feetVoxel.z >= 0) && (feetVoxel.z < voxelGrid.getDepth());
-	}();
+	const Double3 feetPosition(this->camera.position.x, this->getFeetY(),
+		this->camera.position.z);
 
-	// Don't try to dereference the voxel grid if the player's feet are outside.
-	if (insideWorld)
-	{
-		const char feetVoxelID = voxelGrid.getVoxels()[feetVoxel.x +
-			(feetVoxel.y * voxelGrid.getWidth()) +
-			(feetVoxel.z * voxelGrid.getWidth() * voxelGrid.getHeight())];
-		const VoxelData &voxelData = voxelGrid.getVoxelData(feetVoxelID);
-
-		return (this->velocity.y == 0.0) && !voxelData.isAir() &&
-			(feetY >= (feetVoxelYPos + voxelData.yOffset)) &&
-			(feetY <= (feetVoxelYPos + voxelData.yOffset + voxelData.ySize));
-	}
-	else return false;*/
+	return (this->velocity.y <= 0.0) && VoxelCollision::isOnGround(
+		worldData.getVoxelGrid(), feetPosition, Player::HALF_WIDTH, Player::HEIGHT);
 }
 
 void Player::teleport(const Double3 &position)
@@ -168,83 +153,6 @@ void Player::lookAt(const Double3 &point)
 	this->camera.lookAt(point);
 }
 
-void Player::handleCollision(const WorldData &worldData, double dt)
-{
-	auto getVoxel = [&worldData](int x, int y, int z) -> VoxelData
-	{
-		const VoxelGrid &voxelGrid = worldData.getVoxelGrid();
-
-		// Voxels outside the world are air.
-		if ((x < 0) || (x >= voxelGrid.getWidth()) ||
-			(y < 0) || (y >= voxelGrid.getHeight()) ||
-			(z < 0) || (z >= voxelGrid.getDepth()))
-		{
-			return VoxelData(0);
-		}
-		else
-		{
-			return voxelGrid.getVoxelData(voxelGrid.getVoxels()[x +
-				(y * voxelGrid.getWidth()) +
-				(z * voxelGrid.getWidth() * voxelGrid.getHeight())]);
-		}
-	};
-
-	const double feetY = this->getFeetY();
-
-	// Coordinates of the base of the voxel the feet are in.
-	const double feetVoxelYPos = std::floor(feetY + (this->velocity.y * dt));
-
-	// Get the voxel data for each voxel the player would touch on each axis.
-	const Int3 playerVoxel = this->getVoxelPosition();
-	const VoxelData &xVoxel = getVoxel(
-		static_cast<int>(std::floor(this->camera.position.x + (this->velocity.x * dt))),
-		playerVoxel.y,
-		playerVoxel.z);
-	const VoxelData &yVoxel = getVoxel(
-		playerVoxel.x,
-		static_cast<int>(feetVoxelYPos),
-		playerVoxel.z);
-	const VoxelData &zVoxel = getVoxel(
-		playerVoxel.x,
-		playerVoxel.y,
-		static_cast<int>(std::floor(this->camera.position.z + (this->velocity.z * dt))));
-
-	// Check horizontal collisions.
-
-	// -- Temp hack until Y collision detection is implemented --
-	auto isBridge = [](const VoxelData &voxel)
-	{
-		return (voxel.sideID == 42) && (voxel.floorID == 43) &&
-			(voxel.ceilingID == 43);
-	};
-
-	if (!xVoxel.isAir() && !isBridge(xVoxel))
-	{
-		//this->velocity.x = 0.0;
-	}
-
-	if (!zVoxel.isAir() && !isBridge(zVoxel))
-	{
-		//this->velocity.z = 0.0;
-	}
-	// -- end hack --
-
-	/*if (!xVoxel.isAir())
-	{
-		this->velocity.x = 0.0;
-	}
-
-	if (!zVoxel.isAir())
-	{
-		this->velocity.z = 0.0;
-	}*/
-
-	// To do: Y collision (snap Y position above ground if inside ground?).
-	this->velocity.y = 0.0;
-
-	// To do: use an axis-aligned bounding box or cylinder instead of a point?
-}
-
 void Player::accelerate(const Double3 &direction, double magnitude,
 	bool isRunning, double dt)
 {
@@ -295,16 +203,19 @@ void Player::updatePhysics(const WorldData &worldData, double dt)
 	// Acceleration from gravity (always).
 	this->accelerate(-Double3::UnitY, Player::GRAVITY, false, dt);
 
-	// Change the player's velocity based on collision.
-	this->handleCollision(worldData, dt);
-
-	// Simple Euler integration for updating the player's position.
-	Double3 newPosition = this->camera.position + (this->velocity * dt);
+	// Move the player's collision box through the world. It slides along walls and
+	// steps up onto anything low enough, like stairs and bridges.
+	const Double3 feetPosition(this->camera.position.x, this->getFeetY(),
+		this->camera.position.z);
+	const VoxelCollision::Result result = VoxelCollision::move(worldData.getVoxelGrid(),
+		feetPosition, Player::HALF_WIDTH, Player::HEIGHT, Player::STEPPING_HEIGHT,
+		this->velocity, dt);
 
 	// Update the position if valid.
-	if (std::isfinite(newPosition.length()))
+	if (std::isfinite(result.position.length()))
 	{
-		this->camera.position = newPosition;
+		this->camera.position = result.position + (Double3::UnitY * Player::HEIGHT);
+		this->velocity = result.velocity;
 	}
 
 	if (this->onGround(worldData))
@@ -14,6 +14,7 @@ class Player
 {
 private:
 	static const double HEIGHT; // Distance from player's feet to head.
+	static const double HALF_WIDTH; // Half the width of the player's collision box.
 	static const double STEPPING_HEIGHT; // Allowed change in height for stepping on stairs.
 	static const double JUMP_VELOCITY; // Instantaneous change in Y velocity when jumping.
 	
@@ -37,9 +38,6 @@ private:
 	// Gets the Y position of the player's feet.
 	double getFeetY() const;
 
-	// Changes the player's velocity based on collision with objects in the world.
-	void handleCollision(const WorldData &worldData, double dt);
-
 	// Updates the player's position and velocity based on interactions with the world.
 	void updatePhysics(const WorldData &worldData, double dt);
 public:
@@ -63,6 +61,13 @@ public:
 	// Gets the direction pointing right from the player's direction.
 	const Double3 &getRight() const;
 
+	// Gets the player's current velocity.
+	const Double3 &getVelocity() const;
+
+	// Gets how fast the player can move while walking and running.
+	double getMaxWalkSpeed() const;
+	double getMaxRunSpeed() const;
+
 	// Gets the bird's eye view of the player's direction (in the XZ plane).
 	Double2 getGroundDirection() const;
 
@@ -90,6 +90,11 @@ const std::vector<int> &WeaponAnimation::getCurrentRange() const
 	return indices;
 }
 
+WeaponType WeaponAnimation::getWeaponType() const
+{
+	return this->weaponType;
+}
+
 bool WeaponAnimation::isSheathed() const
 {
 	return this->state == WeaponAnimation::State::Sheathed;
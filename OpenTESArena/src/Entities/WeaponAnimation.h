@@ -46,6 +46,9 @@ public:
 	WeaponAnimation(WeaponType weaponType);
 	~WeaponAnimation();
 
+	// Gets the type of weapon being animated.
+	WeaponType getWeaponType() const;
+
 	// Returns whether the weapon is currently sheathed (meaning it is not displayed).
 	bool isSheathed() const;
 
@@ -1,7 +1,9 @@
 #include <cassert>
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <ctime>
 #include <string>
 #include <thread>
 
@@ -10,21 +12,27 @@
 #include "Game.h"
 
 #include "GameData.h"
+#include "InputRecording.h"
 #include "Options.h"
 #include "OptionsParser.h"
 #include "PlayerInterface.h"
+#include "SaveWriter.h"
 #include "../Assets/CityDataFile.h"
 #include "../Assets/TextAssets.h"
 #include "../Interface/Panel.h"
+#include "../Interface/TextCache.h"
+#include "../Math/Random.h"
 #include "../Media/FontManager.h"
 #include "../Media/MusicFile.h"
 #include "../Media/MusicName.h"
 #include "../Media/PPMFile.h"
+#include "../Media/PreloadGroup.h"
 #include "../Media/TextureManager.h"
 #include "../Rendering/Renderer.h"
 #include "../Rendering/Surface.h"
 #include "../Utilities/Debug.h"
 #include "../Utilities/File.h"
+#include "../Utilities/JobSystem.h"
 #include "../Utilities/Platform.h"
 #include "../Utilities/String.h"
 
@@ -80,6 +88,33 @@ Game::Game()
 		return OptionsParser::parse(desiredOptionsPath);
 	}();
 
+	// Set up input recording or playback. Both fix the seed of random generators so
+	// anything random (i.e., a random player) comes out the same in the replay.
+	this->inputReplayFrame = 0;
+	const std::string &recordInputPath = this->options->getRecordInputPath();
+	const std::string &replayInputPath = this->options->getReplayInputPath();
+	if (!replayInputPath.empty())
+	{
+		this->inputReplay = InputRecording::load(replayInputPath);
+		DebugAssert(this->inputReplay != nullptr,
+			"Could not load input recording \"" + replayInputPath + "\".");
+
+		Random::setDefaultSeed(this->inputReplay->getSeed());
+		DebugMention("Replaying " + std::to_string(this->inputReplay->getFrameCount()) +
+			" frames of input from \"" + replayInputPath + "\".");
+
+		if (!recordInputPath.empty())
+		{
+			DebugWarning("Not recording input while replaying it.");
+		}
+	}
+	else if (!recordInputPath.empty())
+	{
+		const int seed = static_cast<int>(std::time(nullptr));
+		Random::setDefaultSeed(seed);
+		this->inputRecording = std::unique_ptr<InputRecording>(new InputRecording(seed));
+	}
+
 	// Verify that GLOBAL.BSA (the most important Arena file) exists.
 	const bool arenaPathIsRelative = File::pathIsRelative(
 		this->getOptions().getArenaPath());
@@ -105,13 +140,28 @@ Game::Game()
 		this->options->getScreenWidth(), this->options->getScreenHeight(),
 		this->options->isFullscreen(), this->options->getLetterboxAspect()));
 
+	// Initialize the job system with one thread per hardware thread.
+	this->jobSystem = std::unique_ptr<JobSystem>(new JobSystem(0));
+
+	// Initialize the save writer, which writes save files on its own thread.
+	this->saveWriter = std::unique_ptr<SaveWriter>(new SaveWriter());
+
 	// Initialize the texture manager with the SDL window's pixel format.
 	this->textureManager = std::unique_ptr<TextureManager>(new TextureManager(
 		*this->renderer.get()));
 
+	// Record which textures the menus use, and load the ones from last time while
+	// the intro plays.
+	this->textureManager->setRecordingGroup(PreloadGroup::MainMenu);
+	this->textureManager->prefetch(PreloadGroup::MainMenu);
+
 	// Initialize the font manager. Fonts (i.e., FONT_A.DAT) are loaded on demand.
 	this->fontManager = std::unique_ptr<FontManager>(new FontManager());
 
+	// Initialize the text cache for tooltips and other often-drawn strings.
+	this->textCache = std::unique_ptr<TextCache>(new TextCache(
+		TextCache::DEFAULT_MAX_ENTRIES));
+
 	// Load various plain text assets.
 	this->textAssets = std::unique_ptr<TextAssets>(new TextAssets());
 
@@ -149,7 +199,10 @@ Game::Game()
 
 Game::~Game()
 {
-
+	if (this->inputRecording != nullptr)
+	{
+		this->inputRecording->save(this->options->getRecordInputPath());
+	}
 }
 
 AudioManager &Game::getAudioManager()
@@ -180,6 +233,11 @@ GameData &Game::getGameData() const
 	return *this->gameData.get();
 }
 
+JobSystem &Game::getJobSystem() const
+{
+	return *this->jobSystem.get();
+}
+
 Options &Game::getOptions() const
 {
 	return *this->options.get();
@@ -190,6 +248,16 @@ Renderer &Game::getRenderer() const
 	return *this->renderer.get();
 }
 
+SaveWriter &Game::getSaveWriter() const
+{
+	return *this->saveWriter.get();
+}
+
+TextCache &Game::getTextCache() const
+{
+	return *this->textCache.get();
+}
+
 TextureManager &Game::getTextureManager() const
 {
 	return *this->textureManager.get();
@@ -275,60 +343,109 @@ void Game::handlePanelChanges()
 	}
 }
 
-void Game::handleEvents(bool &running)
+void Game::handleEvent(const SDL_Event &e, bool &running)
 {
-	// Handle events for the current game state.
-	SDL_Event e;
-	while (SDL_PollEvent(&e) != 0)
+	// Input state is only changed by events, so replayed input behaves the same.
+	this->inputManager.handleEvent(e);
+
+	// Application events and window resizes are handled here.
+	bool applicationExit = this->inputManager.applicationExit(e);
+	bool resized = this->inputManager.windowResized(e);
+	bool targetsReset = this->inputManager.renderTargetsReset(e);
+	bool takeScreenshot = this->inputManager.keyPressed(e, SDLK_PRINTSCREEN);
+
+	if (applicationExit)
 	{
-		// Application events and window resizes are handled here.
-		bool applicationExit = this->inputManager.applicationExit(e);
-		bool resized = this->inputManager.windowResized(e);
-		bool takeScreenshot = this->inputManager.keyPressed(e, SDLK_PRINTSCREEN);
+		running = false;
+	}
+
+	if (resized)
+	{
+		int width = e.window.data1;
+		int height = e.window.data2;
+		this->resizeWindow(width, height);
+
+		// Call each panel's resize method. The panels should not be listening for
+		// resize events themselves because it's more of an "application event" than
+		// a panel event.
+		this->panel->resize(width, height);
 
-		if (applicationExit)
+		for (auto &subPanel : this->subPanels)
 		{
-			running = false;
+			subPanel->resize(width, height);
 		}
+	}
+
+	if (targetsReset)
+	{
+		// Render target textures lose their contents, so panels should rebuild
+		// anything they cached in one, the same as after a resize.
+		const Int2 windowDims = this->renderer->getWindowDimensions();
+		this->panel->resize(windowDims.x, windowDims.y);
 
-		if (resized)
+		for (auto &subPanel : this->subPanels)
 		{
-			int width = e.window.data1;
-			int height = e.window.data2;
-			this->resizeWindow(width, height);
+			subPanel->resize(windowDims.x, windowDims.y);
+		}
+	}
 
-			// Call each panel's resize method. The panels should not be listening for
-			// resize events themselves because it's more of an "application event" than
-			// a panel event.
-			this->panel->resize(width, height);
+	if (takeScreenshot)
+	{
+		// Save a screenshot to the local folder.
+		auto &renderer = this->getRenderer();
+		Surface screenshot(renderer.getScreenshot());
+		SDL_SaveBMP(screenshot.get(), "out.bmp");
+	}
 
-			for (auto &subPanel : this->subPanels)
+	// Panel-specific events are handled by the active panel or sub-panel. If any 
+	// sub-panels exist, choose the top one. Otherwise, choose the main panel.
+	if (this->subPanels.size() > 0)
+	{
+		this->subPanels.back()->handleEvent(e);
+	}
+	else
+	{
+		this->panel->handleEvent(e);
+	}
+
+	// See if the event requested any changes in active panels.
+	this->handlePanelChanges();
+}
+
+void Game::handleEvents(bool &running)
+{
+	// Handle events for the current game state.
+	SDL_Event e;
+	if (this->inputReplay != nullptr)
+	{
+		// Live events are ignored while replaying, except for quitting early.
+		while (SDL_PollEvent(&e) != 0)
+		{
+			if (this->inputManager.applicationExit(e))
 			{
-				subPanel->resize(width, height);
+				running = false;
 			}
 		}
 
-		if (takeScreenshot)
+		const InputRecording::Frame &frame = this->inputReplay->getFrame(this->inputReplayFrame);
+		for (const SDL_Event &replayEvent : frame.events)
 		{
-			// Save a screenshot to the local folder.
-			auto &renderer = this->getRenderer();
-			Surface screenshot(renderer.getScreenshot());
-			SDL_SaveBMP(screenshot.get(), "out.bmp");
+			this->handleEvent(replayEvent, running);
 		}
 
-		// Panel-specific events are handled by the active panel or sub-panel. If any 
-		// sub-panels exist, choose the top one. Otherwise, choose the main panel.
-		if (this->subPanels.size() > 0)
-		{
-			this->subPanels.back()->handleEvent(e);
-		}
-		else
+		this->inputReplayFrame++;
+	}
+	else
+	{
+		while (SDL_PollEvent(&e) != 0)
 		{
-			this->panel->handleEvent(e);
-		}
+			if (this->inputRecording != nullptr)
+			{
+				this->inputRecording->addEvent(e);
+			}
 
-		// See if the event requested any changes in active panels.
-		this->handlePanelChanges();
+			this->handleEvent(e, running);
+		}
 	}
 }
 
@@ -383,6 +500,18 @@ void Game::loop()
 	const std::chrono::duration<int64_t, std::micro> maximumMS(1000000 / Options::MIN_FPS);
 
 	auto thisTime = std::chrono::high_resolution_clock::now();
+	const auto startTime = thisTime;
+
+	// Input state only changes with events, so the mouse's starting position is given
+	// as an event too (which also puts it in any input recording).
+	if (this->inputReplay == nullptr)
+	{
+		SDL_Event e;
+		SDL_zero(e);
+		e.type = SDL_MOUSEMOTION;
+		SDL_GetMouseState(&e.motion.x, &e.motion.y);
+		SDL_PushEvent(&e);
+	}
 
 	// Primary game loop.
 	bool running = true;
@@ -390,23 +519,47 @@ void Game::loop()
 	{
 		const auto lastTime = thisTime;
 		thisTime = std::chrono::high_resolution_clock::now();
+		auto frameTime = std::chrono::duration_cast<std::chrono::microseconds>(thisTime - lastTime);
 
-		// Fastest allowed frame time in microseconds.
-		const std::chrono::duration<int64_t, std::micro> minimumMS(
-			1000000 / this->options->getTargetFPS());
+		// Delta time of the frame in microseconds.
+		int64_t frameMicroseconds;
 
-		// Delay the current frame if the previous one was too fast.
-		auto frameTime = std::chrono::duration_cast<std::chrono::microseconds>(thisTime - lastTime);
-		if (frameTime < minimumMS)
+		if (this->inputReplay != nullptr)
+		{
+			// Replays use the recorded frame times and run as fast as possible.
+			if (this->inputReplayFrame == this->inputReplay->getFrameCount())
+			{
+				break;
+			}
+
+			frameMicroseconds = this->inputReplay->getFrame(this->inputReplayFrame).microseconds;
+		}
+		else
 		{
-			const auto sleepTime = minimumMS - frameTime;
-			std::this_thread::sleep_for(sleepTime);
-			thisTime = std::chrono::high_resolution_clock::now();
-			frameTime = std::chrono::duration_cast<std::chrono::microseconds>(thisTime - lastTime);
+			// Fastest allowed frame time in microseconds.
+			const std::chrono::duration<int64_t, std::micro> minimumMS(
+				1000000 / this->options->getTargetFPS());
+
+			// Delay the current frame if the previous one was too fast.
+			if (frameTime < minimumMS)
+			{
+				const auto sleepTime = minimumMS - frameTime;
+				std::this_thread::sleep_for(sleepTime);
+				thisTime = std::chrono::high_resolution_clock::now();
+				frameTime = std::chrono::duration_cast<std::chrono::microseconds>(thisTime - lastTime);
+			}
+
+			// Clamp the delta time to at most the maximum frame time.
+			frameMicroseconds = std::min(static_cast<int64_t>(frameTime.count()),
+				static_cast<int64_t>(maximumMS.count()));
+
+			if (this->inputRecording != nullptr)
+			{
+				this->inputRecording->addFrame(static_cast<uint32_t>(frameMicroseconds));
+			}
 		}
 
-		// Clamp the delta time to at most the maximum frame time.
-		const double dt = std::fmin(frameTime.count(), maximumMS.count()) / 1000000.0;
+		const double dt = static_cast<double>(frameMicroseconds) / 1000000.0;
 
 		// Update the input manager's state.
 		this->inputManager.update();
@@ -414,8 +567,13 @@ void Game::loop()
 		// Update the audio manager, checking for finished sounds.
 		this->audioManager.update();
 
-		// Update FPS counter.
-		this->fpsCounter.updateFrameTime(dt);
+		// Evict old textures if over budget. Nothing from the last frame is in use now.
+		this->textureManager->update();
+
+		// Update FPS counter. Replays count how long frames really took instead of the
+		// recorded delta time, so the FPS is a benchmark result.
+		this->fpsCounter.updateFrameTime((this->inputReplay != nullptr) ?
+			(static_cast<double>(frameTime.count()) / 1000000.0) : dt);
 
 		// Listen for input events.
 		this->handleEvents(running);
@@ -426,4 +584,13 @@ void Game::loop()
 		// Draw to the screen.
 		this->render();
 	}
+
+	if (this->inputReplay != nullptr)
+	{
+		const double seconds = std::chrono::duration<double>(
+			std::chrono::high_resolution_clock::now() - startTime).count();
+		DebugMention("Replayed " + std::to_string(this->inputReplayFrame) + " frames in " +
+			String::fixedPrecision(seconds, 2) + "s (" +
+			String::fixedPrecision(this->inputReplayFrame / seconds, 1) + " FPS).");
+	}
 }
@@ -22,9 +22,13 @@
 class CityDataFile;
 class GameData;
 class FontManager;
+class InputRecording;
+class JobSystem;
 class Options;
 class Panel;
 class Renderer;
+class SaveWriter;
+class TextCache;
 class TextureManager;
 class TextAssets;
 
@@ -41,14 +45,20 @@ private:
 	InputManager inputManager;
 	std::unique_ptr<FontManager> fontManager;
 	std::unique_ptr<GameData> gameData;
+	std::unique_ptr<JobSystem> jobSystem;
 	std::unique_ptr<Options> options;
 	std::unique_ptr<Panel> panel, nextPanel, nextSubPanel;
 	std::unique_ptr<Renderer> renderer;
+	std::unique_ptr<SaveWriter> saveWriter;
+	std::unique_ptr<TextCache> textCache;
 	std::unique_ptr<TextureManager> textureManager;
 	std::unique_ptr<TextAssets> textAssets;
 	std::unique_ptr<CityDataFile> cityDataFile;
+	std::unique_ptr<InputRecording> inputRecording; // Input being recorded, if any.
+	std::unique_ptr<InputRecording> inputReplay; // Input being played back, if any.
 	FPSCounter fpsCounter;
 	std::string basePath, optionsPath;
+	int inputReplayFrame; // Next frame of the input replay.
 	bool requestedSubPanelPop;
 
 	// Resizes the SDL renderer and any other renderer-associated components.
@@ -57,6 +67,9 @@ private:
 	// Handles any changes in panels after an SDL event or game tick.
 	void handlePanelChanges();
 
+	// Handles an SDL event, either live or from an input replay.
+	void handleEvent(const SDL_Event &e, bool &running);
+
 	// Handles SDL events for the current frame.
 	void handleEvents(bool &running);
 
@@ -87,12 +100,21 @@ public:
 	// do not call this method. Verify beforehand by calling Game::gameDataIsActive().
 	GameData &getGameData() const;
 
+	// Gets the job system for running per-frame simulation across threads.
+	JobSystem &getJobSystem() const;
+
 	// Gets the options object for various settings (resolution, volume, sensitivity).
 	Options &getOptions() const;
 
 	// Gets the renderer object for rendering methods.
 	Renderer &getRenderer() const;
 
+	// Gets the save writer for saving the game session in the background.
+	SaveWriter &getSaveWriter() const;
+
+	// Gets the text cache for reusing the textures of recently drawn strings.
+	TextCache &getTextCache() const;
+
 	// Gets the texture manager object for loading images from file.
 	TextureManager &getTextureManager() const;
 
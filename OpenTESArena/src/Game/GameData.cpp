@@ -22,6 +22,7 @@
 #include "../Math/Random.h"
 #include "../Media/PaletteFile.h"
 #include "../Media/PaletteName.h"
+#include "../Media/PreloadGroup.h"
 #include "../Media/TextureManager.h"
 #include "../Rendering/Renderer.h"
 #include "../Utilities/Debug.h"
@@ -35,11 +36,12 @@ const double GameData::TIME_SCALE = static_cast<double>(Clock::SECONDS_IN_A_DAY)
 
 GameData::GameData(Player &&player, WorldData &&worldData, const Location &location,
 	const Date &date, const Clock &clock, double fogDistance)
-	: player(std::move(player)), worldData(std::move(worldData)), location(location),
-	date(date), clock(clock)
+	: player(std::move(player)), worldData(std::move(worldData)),
+	levelCache(LevelCache::DEFAULT_MAX_BYTES), location(location), date(date), clock(clock)
 {
 	DebugMention("Initializing.");
 
+	this->levelIndex = 0;
 	this->fogDistance = fogDistance;
 }
 
@@ -49,8 +51,12 @@ GameData::~GameData()
 }
 
 void GameData::loadFromMIF(const MIFFile &mif, const INFFile &inf, Double3 &playerPosition,
-	WorldData &worldData, TextureManager &textureManager, Renderer &renderer)
+	TextureManager &textureManager, Renderer &renderer)
 {
+	// .MIF areas are dungeons for now, so start loading the textures they usually need
+	// while the level is built.
+	textureManager.prefetch(PreloadGroup::Dungeon);
+
 	// Convert start point to new coordinate system and set player's location 
 	// (player Y value is arbitrary for now).
 	const auto &startPoints = mif.getStartPoints();
@@ -59,17 +65,60 @@ void GameData::loadFromMIF(const MIFFile &mif, const INFFile &inf, Double3 &play
 	playerPosition = Double3(startPoint.x, playerPosition.y, startPoint.y);
 
 	// Clear all entities.
-	auto &entityManager = worldData.getEntityManager();
+	auto &entityManager = this->worldData.getEntityManager();
 	for (const auto *entity : entityManager.getAllEntities())
 	{
 		renderer.removeFlat(entity->getID());
-		entityManager.remove(entity->getID());
 	}
 
+	entityManager.clear();
+
 	// Clear software renderer textures (so the .INF file indices are correct).
 	//renderer.removeAllWorldTextures(); // To do: Uncomment once .INF files are in use.
 
-	worldData = std::move(WorldData(mif, inf));
+	// Levels of the previous area won't be visited again from here.
+	this->levelCache.clear();
+
+	this->worldData = WorldData(mif, 0, inf);
+	this->levelMIFName = mif.getName();
+	this->levelIndex = 0;
+}
+
+void GameData::changeLevel(const MIFFile &mif, int levelIndex, const INFFile &inf,
+	Renderer &renderer)
+{
+	DebugAssert((levelIndex >= 0) && (levelIndex < static_cast<int>(mif.getLevels().size())),
+		"Invalid level index " + std::to_string(levelIndex) + " for \"" + mif.getName() + "\".");
+
+	// Remove the current level's entities from the renderer. Levels from .MIF files
+	// don't have entities of their own yet, so they aren't kept in the cache.
+	auto &entityManager = this->worldData.getEntityManager();
+	for (const auto *entity : entityManager.getAllEntities())
+	{
+		renderer.removeFlat(entity->getID());
+	}
+
+	entityManager.clear();
+
+	// Keep the current level for later if it came from a .MIF file.
+	if (this->levelMIFName.size() > 0)
+	{
+		this->levelCache.put(this->levelMIFName, this->levelIndex,
+			std::unique_ptr<WorldData>(new WorldData(std::move(this->worldData))));
+	}
+
+	std::unique_ptr<WorldData> cachedLevel = this->levelCache.take(mif.getName(), levelIndex);
+	if (cachedLevel.get() != nullptr)
+	{
+		this->worldData = std::move(*cachedLevel.get());
+	}
+	else
+	{
+		this->worldData = WorldData(mif, levelIndex, inf);
+	}
+
+	this->levelMIFName = mif.getName();
+	this->levelIndex = levelIndex;
 }
 
 std::unique_ptr<GameData> GameData::createDefault(const std::string &playerName,
@@ -264,9 +313,7 @@ std::unique_ptr<GameData> GameData::createDefault(const std::string &playerName,
 	// Lambda for setting a voxel at some coordinate to some ID.
 	auto setVoxel = [&voxelGrid](int x, int y, int z, int id)
 	{
-		char *voxels = voxelGrid.getVoxels();
-		voxels[x + (y * voxelGrid.getWidth()) +
-			(z * voxelGrid.getWidth() * voxelGrid.getHeight())] = id;
+		voxelGrid.setVoxel(x, y, z, static_cast<VoxelGrid::VoxelID>(id));
 	};
 
 	// Set voxel IDs with indices into the voxel data.
@@ -512,13 +559,13 @@ std::unique_ptr<GameData> GameData::createDefault(const std::string &playerName,
 		const double timePerFrame = 0.10;
 		Animation animation(textureIDs, timePerFrame, true);
 
-		std::unique_ptr<Doodad> doodad(new Doodad(animation, position, entityManager));
+		std::unique_ptr<Doodad> doodad(new Doodad(entityManager));
 
 		// Assign the entity ID with the first texture.
 		renderer.addFlat(doodad->getID(), position, Double2::UnitX,
 			width, height, textureIDs.at(0));
 
-		entityManager.add(std::move(doodad));
+		entityManager.add(std::move(doodad), position, Double2(width, height), animation);
 	};
 
 	auto addNonPlayer = [&entityManager, &renderer](const Double3 &position,
@@ -537,14 +584,16 @@ std::unique_ptr<GameData> GameData::createDefault(const std::string &playerName,
 		Animation deathAnimation(deathIDs, timePerFrame, false);
 
 		std::unique_ptr<NonPlayer> nonPlayer(new NonPlayer(
-			position, direction, idleAnimations, moveAnimations, attackAnimation,
+			direction, idleAnimations, moveAnimations, attackAnimation,
 			deathAnimation, entityManager));
 
 		// Assign the entity ID with the first texture.
 		renderer.addFlat(nonPlayer->getID(), position, direction,
 			width, height, idleIDs.at(0));
 
-		entityManager.add(std::move(nonPlayer));
+		const Animation startAnimation = nonPlayer->getStartAnimation();
+		entityManager.add(std::move(nonPlayer), position, Double2(width, height),
+			startAnimation);
 	};
 
 	// Add entities.
@@ -638,6 +687,21 @@ WorldData &GameData::getWorldData()
 	return this->worldData;
 }
 
+const LevelCache &GameData::getLevelCache() const
+{
+	return this->levelCache;
+}
+
+const std::string &GameData::getLevelMIFName() const
+{
+	return this->levelMIFName;
+}
+
+int GameData::getLevelIndex() const
+{
+	return this->levelIndex;
+}
+
 Location &GameData::getLocation()
 {
 	return this->location;
@@ -653,6 +717,16 @@ const Clock &GameData::getClock() const
 	return this->clock;
 }
 
+void GameData::setDate(const Date &date)
+{
+	this->date = date;
+}
+
+void GameData::setClock(const Clock &clock)
+{
+	this->clock = clock;
+}
+
 double GameData::getDaytimePercent() const
 {
 	return this->clock.getPreciseTotalSeconds() /
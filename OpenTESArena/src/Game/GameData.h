@@ -11,6 +11,7 @@
 #include "../Entities/EntityManager.h"
 #include "../Entities/Player.h"
 #include "../Math/Vector2.h"
+#include "../World/LevelCache.h"
 #include "../World/Location.h"
 #include "../World/WorldData.h"
 
@@ -40,6 +41,12 @@ private:
 	std::unordered_map<Int2, std::string> textTriggers, soundTriggers;
 	Player player;
 	WorldData worldData;
+
+	// The .MIF file and level index of the current world (empty if it didn't come from
+	// a .MIF file), and the levels visited before it.
+	std::string levelMIFName;
+	int levelIndex;
+	LevelCache levelCache;
 	Location location;
 	Date date;
 	Clock clock;
@@ -50,10 +57,18 @@ public:
 		const Date &date, const Clock &clock, double fogDistance);
 	~GameData();
 
-	// Takes a .MIF file with its associated .INF file and writes data into the given 
-	// reference parameters. This overwrites parts of the existing game session.
-	static void loadFromMIF(const MIFFile &mif, const INFFile &inf, Double3 &playerPosition,
-		WorldData &worldData, TextureManager &textureManager, Renderer &renderer);
+	// Takes a .MIF file with its associated .INF file and loads its first level, writing
+	// the player's start point into the given position. This overwrites parts of the
+	// existing game session, including any cached levels, and starts prefetching the
+	// dungeon's textures.
+	void loadFromMIF(const MIFFile &mif, const INFFile &inf, Double3 &playerPosition,
+		TextureManager &textureManager, Renderer &renderer);
+
+	// Moves to another level of a .MIF file (i.e., by stairs), keeping the current level
+	// in the level cache so going back to it is instant. The target level is only built
+	// from the .MIF file if it isn't cached. The .INF file should be the target level's.
+	void changeLevel(const MIFFile &mif, int levelIndex, const INFFile &inf,
+		Renderer &renderer);
 
 	// Creates a game data object used for the test world.
 	static std::unique_ptr<GameData> createDefault(const std::string &playerName,
@@ -66,10 +81,20 @@ public:
 
 	Player &getPlayer();
 	WorldData &getWorldData();
+	const LevelCache &getLevelCache() const;
+
+	// Gets the .MIF file the current level came from (empty if it didn't), and the
+	// index of the current level in it.
+	const std::string &getLevelMIFName() const;
+	int getLevelIndex() const;
 	Location &getLocation();
 	const Date &getDate() const;
 	const Clock &getClock() const;
 
+	// Sets the current date and time of day, i.e., when loading a saved game.
+	void setDate(const Date &date);
+	void setClock(const Clock &clock);
+
 	// Gets a percentage representing how far along the current day is. 0.0 is 
 	// 12:00am and 0.50 is noon.
 	double getDaytimePercent() const;
@@ -1,7 +1,11 @@
 #include "InputManager.h"
 
 InputManager::InputManager()
-	: mouseDelta(0, 0) { }
+	: mousePosition(0, 0), mouseDelta(0, 0)
+{
+	this->keys.fill(false);
+	this->mouseButtons = 0;
+}
 
 InputManager::~InputManager()
 {
@@ -20,14 +24,12 @@ bool InputManager::keyReleased(const SDL_Event &e, SDL_Keycode keycode) const
 
 bool InputManager::keyIsDown(SDL_Scancode scancode) const
 {
-	const uint8_t *keys = SDL_GetKeyboardState(nullptr);
-	return keys[scancode] != 0;
+	return this->keys.at(scancode);
 }
 
 bool InputManager::keyIsUp(SDL_Scancode scancode) const
 {
-	const uint8_t *keys = SDL_GetKeyboardState(nullptr);
-	return keys[scancode] == 0;
+	return !this->keys.at(scancode);
 }
 
 bool InputManager::mouseButtonPressed(const SDL_Event &e, uint8_t button) const
@@ -42,14 +44,12 @@ bool InputManager::mouseButtonReleased(const SDL_Event &e, uint8_t button) const
 
 bool InputManager::mouseButtonIsDown(uint8_t button) const
 {
-	const uint32_t mouse = SDL_GetMouseState(nullptr, nullptr);
-	return (mouse & SDL_BUTTON(button)) != 0;
+	return (this->mouseButtons & SDL_BUTTON(button)) != 0;
 }
 
 bool InputManager::mouseButtonIsUp(uint8_t button) const
 {
-	const uint32_t mouse = SDL_GetMouseState(nullptr, nullptr);
-	return (mouse & SDL_BUTTON(button)) == 0;
+	return (this->mouseButtons & SDL_BUTTON(button)) == 0;
 }
 
 bool InputManager::mouseWheeledUp(const SDL_Event &e) const
@@ -67,6 +67,11 @@ bool InputManager::windowResized(const SDL_Event &e) const
 	return (e.type == SDL_WINDOWEVENT) && (e.window.event == SDL_WINDOWEVENT_RESIZED);
 }
 
+bool InputManager::renderTargetsReset(const SDL_Event &e) const
+{
+	return e.type == SDL_RENDER_TARGETS_RESET;
+}
+
 bool InputManager::applicationExit(const SDL_Event &e) const
 {
 	return e.type == SDL_QUIT;
@@ -74,9 +79,7 @@ bool InputManager::applicationExit(const SDL_Event &e) const
 
 Int2 InputManager::getMousePosition() const
 {
-	int x, y;
-	SDL_GetMouseState(&x, &y);
-	return Int2(x, y);
+	return this->mousePosition;
 }
 
 Int2 InputManager::getMouseDelta() const
@@ -90,8 +93,32 @@ void InputManager::setRelativeMouseMode(bool active)
 	SDL_SetRelativeMouseMode(enabled);
 }
 
+void InputManager::handleEvent(const SDL_Event &e)
+{
+	if ((e.type == SDL_KEYDOWN) || (e.type == SDL_KEYUP))
+	{
+		const SDL_Scancode scancode = e.key.keysym.scancode;
+		if ((scancode >= 0) && (scancode < SDL_NUM_SCANCODES))
+		{
+			this->keys[scancode] = e.type == SDL_KEYDOWN;
+		}
+	}
+	else if (e.type == SDL_MOUSEMOTION)
+	{
+		this->mousePosition = Int2(e.motion.x, e.motion.y);
+		this->mouseDelta.x += e.motion.xrel;
+		this->mouseDelta.y += e.motion.yrel;
+	}
+	else if ((e.type == SDL_MOUSEBUTTONDOWN) || (e.type == SDL_MOUSEBUTTONUP))
+	{
+		const uint32_t mask = SDL_BUTTON(e.button.button);
+		this->mouseButtons = (e.type == SDL_MOUSEBUTTONDOWN) ?
+			(this->mouseButtons | mask) : (this->mouseButtons & ~mask);
+		this->mousePosition = Int2(e.button.x, e.button.y);
+	}
+}
+
 void InputManager::update()
 {
-	// Refresh the mouse delta.
-	SDL_GetRelativeMouseState(&this->mouseDelta.x, &this->mouseDelta.y);
+	this->mouseDelta = Int2(0, 0);
 }
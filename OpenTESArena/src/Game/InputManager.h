@@ -1,6 +1,7 @@
 #ifndef INPUT_MANAGER_H
 #define INPUT_MANAGER_H
 
+#include <array>
 #include <cstdint>
 
 #include "SDL.h"
@@ -12,10 +13,16 @@
 // This became a necessity after seeing that SDL_GetRelativeMouseState() can only be 
 // called once per frame, so its value must be stored somewhere.
 
+// Key, mouse button, and mouse position state is kept from the events given to it
+// instead of read from SDL, so input replayed from a recording behaves exactly like
+// live input.
+
 class InputManager
 {
-private:	
-	Int2 mouseDelta;
+private:
+	std::array<bool, SDL_NUM_SCANCODES> keys;
+	uint32_t mouseButtons; // SDL_BUTTON() mask.
+	Int2 mousePosition, mouseDelta;
 public:
 	InputManager();
 	~InputManager();
@@ -31,6 +38,7 @@ public:
 	bool mouseWheeledUp(const SDL_Event &e) const;
 	bool mouseWheeledDown(const SDL_Event &e) const;
 	bool windowResized(const SDL_Event &e) const;
+	bool renderTargetsReset(const SDL_Event &e) const;
 	bool applicationExit(const SDL_Event &e) const;
 	Int2 getMousePosition() const;
 	Int2 getMouseDelta() const;
@@ -38,8 +46,12 @@ public:
 	// Sets whether the mouse should move during motion events (for player camera).
 	void setRelativeMouseMode(bool active);
 
-	// Updates input values whose associated SDL functions should only be called once 
-	// per frame.
+	// Updates input state from an event. Every event the game handles should be given
+	// to this first.
+	void handleEvent(const SDL_Event &e);
+
+	// Starts a new frame of input. The mouse delta is the sum of motion events in the
+	// frame.
 	void update();
 };
 
@@ -0,0 +1,328 @@
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+#include "InputRecording.h"
+
+#include "../Utilities/Bytes.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/File.h"
+
+namespace
+{
+	// Kinds of events in a recording. They are stored as one byte instead of the
+	// SDL event type.
+	enum class EventKind : uint8_t
+	{
+		Quit,
+		Window,
+		KeyDown,
+		KeyUp,
+		MouseMotion,
+		MouseButtonDown,
+		MouseButtonUp,
+		MouseWheel
+	};
+
+	void writeByte(std::vector<uint8_t> &data, uint8_t value)
+	{
+		data.push_back(value);
+	}
+
+	void writeLE16(std::vector<uint8_t> &data, uint16_t value)
+	{
+		data.push_back(static_cast<uint8_t>(value & 0xFF));
+		data.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+	}
+
+	void writeLE32(std::vector<uint8_t> &data, uint32_t value)
+	{
+		data.push_back(static_cast<uint8_t>(value & 0xFF));
+		data.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+		data.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
+		data.push_back(static_cast<uint8_t>((value >> 24) & 0xFF));
+	}
+
+	// Reads values from a byte buffer, and remembers if it ran past the end.
+	class Reader
+	{
+	private:
+		const uint8_t *ptr, *end;
+		bool overrun;
+
+		// Returns whether the given number of bytes can be read.
+		bool has(int count)
+		{
+			this->overrun |= (this->end - this->ptr) < count;
+			return !this->overrun;
+		}
+	public:
+		Reader(const uint8_t *ptr, const uint8_t *end)
+			: ptr(ptr), end(end), overrun(false) { }
+
+		bool isDone() const
+		{
+			return this->ptr == this->end;
+		}
+
+		bool isOverrun() const
+		{
+			return this->overrun;
+		}
+
+		uint8_t readByte()
+		{
+			return this->has(1) ? *this->ptr++ : 0;
+		}
+
+		uint16_t readLE16()
+		{
+			if (!this->has(2))
+			{
+				return 0;
+			}
+
+			const uint16_t value = Bytes::getLE16(this->ptr);
+			this->ptr += 2;
+			return value;
+		}
+
+		uint32_t readLE32()
+		{
+			if (!this->has(4))
+			{
+				return 0;
+			}
+
+			const uint32_t value = Bytes::getLE32(this->ptr);
+			this->ptr += 4;
+			return value;
+		}
+	};
+}
+
+const std::string InputRecording::SIGNATURE = "OTAINPUT";
+
+InputRecording::InputRecording(int seed)
+{
+	this->seed = seed;
+}
+
+InputRecording::~InputRecording()
+{
+
+}
+
+std::unique_ptr<InputRecording> InputRecording::load(const std::string &filename)
+{
+	if (!File::exists(filename))
+	{
+		DebugWarning("Input recording \"" + filename + "\" doesn't exist.");
+		return nullptr;
+	}
+
+	const std::string text = File::readAllText(filename);
+	if ((text.size() < (InputRecording::SIGNATURE.size() + 4)) ||
+		(text.compare(0, InputRecording::SIGNATURE.size(), InputRecording::SIGNATURE) != 0))
+	{
+		DebugWarning("\"" + filename + "\" isn't an input recording.");
+		return nullptr;
+	}
+
+	const uint8_t *data = reinterpret_cast<const uint8_t*>(text.data());
+	Reader reader(data + InputRecording::SIGNATURE.size(), data + text.size());
+
+	std::unique_ptr<InputRecording> recording(
+		new InputRecording(static_cast<int>(reader.readLE32())));
+
+	while (!reader.isDone() && !reader.isOverrun())
+	{
+		recording->addFrame(reader.readLE32());
+		Frame &frame = recording->frames.back();
+
+		const int eventCount = reader.readLE16();
+		for (int i = 0; i < eventCount; i++)
+		{
+			SDL_Event e;
+			std::memset(&e, 0, sizeof(e));
+
+			const EventKind kind = static_cast<EventKind>(reader.readByte());
+			if (kind == EventKind::Quit)
+			{
+				e.type = SDL_QUIT;
+			}
+			else if (kind == EventKind::Window)
+			{
+				e.type = SDL_WINDOWEVENT;
+				e.window.event = reader.readByte();
+				e.window.data1 = static_cast<int32_t>(reader.readLE32());
+				e.window.data2 = static_cast<int32_t>(reader.readLE32());
+			}
+			else if ((kind == EventKind::KeyDown) || (kind == EventKind::KeyUp))
+			{
+				const bool down = kind == EventKind::KeyDown;
+				e.type = down ? SDL_KEYDOWN : SDL_KEYUP;
+				e.key.state = down ? SDL_PRESSED : SDL_RELEASED;
+				e.key.keysym.scancode = static_cast<SDL_Scancode>(reader.readLE32());
+				e.key.keysym.sym = static_cast<SDL_Keycode>(reader.readLE32());
+				e.key.keysym.mod = reader.readLE16();
+				e.key.repeat = reader.readByte();
+			}
+			else if (kind == EventKind::MouseMotion)
+			{
+				e.type = SDL_MOUSEMOTION;
+				e.motion.state = reader.readLE32();
+				e.motion.x = static_cast<int32_t>(reader.readLE32());
+				e.motion.y = static_cast<int32_t>(reader.readLE32());
+				e.motion.xrel = static_cast<int32_t>(reader.readLE32());
+				e.motion.yrel = static_cast<int32_t>(reader.readLE32());
+			}
+			else if ((kind == EventKind::MouseButtonDown) ||
+				(kind == EventKind::MouseButtonUp))
+			{
+				const bool down = kind == EventKind::MouseButtonDown;
+				e.type = down ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+				e.button.state = down ? SDL_PRESSED : SDL_RELEASED;
+				e.button.button = reader.readByte();
+				e.button.clicks = reader.readByte();
+				e.button.x = static_cast<int32_t>(reader.readLE32());
+				e.button.y = static_cast<int32_t>(reader.readLE32());
+			}
+			else if (kind == EventKind::MouseWheel)
+			{
+				e.type = SDL_MOUSEWHEEL;
+				e.wheel.x = static_cast<int32_t>(reader.readLE32());
+				e.wheel.y = static_cast<int32_t>(reader.readLE32());
+			}
+			else
+			{
+				DebugWarning("Unrecognized event in \"" + filename + "\".");
+				return nullptr;
+			}
+
+			frame.events.push_back(e);
+		}
+	}
+
+	if (reader.isOverrun())
+	{
+		DebugWarning("\"" + filename + "\" is truncated.");
+		return nullptr;
+	}
+
+	return recording;
+}
+
+int InputRecording::getSeed() const
+{
+	return this->seed;
+}
+
+int InputRecording::getFrameCount() const
+{
+	return static_cast<int>(this->frames.size());
+}
+
+const InputRecording::Frame &InputRecording::getFrame(int index) const
+{
+	return this->frames.at(index);
+}
+
+void InputRecording::addFrame(uint32_t microseconds)
+{
+	Frame frame;
+	frame.microseconds = microseconds;
+	this->frames.push_back(std::move(frame));
+}
+
+void InputRecording::addEvent(const SDL_Event &e)
+{
+	assert(this->frames.size() > 0);
+
+	const bool recognized = (e.type == SDL_QUIT) || (e.type == SDL_WINDOWEVENT) ||
+		(e.type == SDL_KEYDOWN) || (e.type == SDL_KEYUP) || (e.type == SDL_MOUSEMOTION) ||
+		(e.type == SDL_MOUSEBUTTONDOWN) || (e.type == SDL_MOUSEBUTTONUP) ||
+		(e.type == SDL_MOUSEWHEEL);
+
+	// The event count of a frame is 16-bit.
+	std::vector<SDL_Event> &events = this->frames.back().events;
+	if (recognized && (events.size() < UINT16_MAX))
+	{
+		events.push_back(e);
+	}
+}
+
+void InputRecording::save(const std::string &filename) const
+{
+	std::vector<uint8_t> data(InputRecording::SIGNATURE.begin(),
+		InputRecording::SIGNATURE.end());
+	writeLE32(data, static_cast<uint32_t>(this->seed));
+
+	for (const Frame &frame : this->frames)
+	{
+		writeLE32(data, frame.microseconds);
+		writeLE16(data, static_cast<uint16_t>(frame.events.size()));
+
+		for (const SDL_Event &e : frame.events)
+		{
+			if (e.type == SDL_QUIT)
+			{
+				writeByte(data, static_cast<uint8_t>(EventKind::Quit));
+			}
+			else if (e.type == SDL_WINDOWEVENT)
+			{
+				writeByte(data, static_cast<uint8_t>(EventKind::Window));
+				writeByte(data, e.window.event);
+				writeLE32(data, static_cast<uint32_t>(e.window.data1));
+				writeLE32(data, static_cast<uint32_t>(e.window.data2));
+			}
+			else if ((e.type == SDL_KEYDOWN) || (e.type == SDL_KEYUP))
+			{
+				writeByte(data, static_cast<uint8_t>((e.type == SDL_KEYDOWN) ?
+					EventKind::KeyDown : EventKind::KeyUp));
+				writeLE32(data, static_cast<uint32_t>(e.key.keysym.scancode));
+				writeLE32(data, static_cast<uint32_t>(e.key.keysym.sym));
+				writeLE16(data, e.key.keysym.mod);
+				writeByte(data, e.key.repeat);
+			}
+			else if (e.type == SDL_MOUSEMOTION)
+			{
+				writeByte(data, static_cast<uint8_t>(EventKind::MouseMotion));
+				writeLE32(data, e.motion.state);
+				writeLE32(data, static_cast<uint32_t>(e.motion.x));
+				writeLE32(data, static_cast<uint32_t>(e.motion.y));
+				writeLE32(data, static_cast<uint32_t>(e.motion.xrel));
+				writeLE32(data, static_cast<uint32_t>(e.motion.yrel));
+			}
+			else if ((e.type == SDL_MOUSEBUTTONDOWN) || (e.type == SDL_MOUSEBUTTONUP))
+			{
+				writeByte(data, static_cast<uint8_t>((e.type == SDL_MOUSEBUTTONDOWN) ?
+					EventKind::MouseButtonDown : EventKind::MouseButtonUp));
+				writeByte(data, e.button.button);
+				writeByte(data, e.button.clicks);
+				writeLE32(data, static_cast<uint32_t>(e.button.x));
+				writeLE32(data, static_cast<uint32_t>(e.button.y));
+			}
+			else if (e.type == SDL_MOUSEWHEEL)
+			{
+				writeByte(data, static_cast<uint8_t>(EventKind::MouseWheel));
+				writeLE32(data, static_cast<uint32_t>(e.wheel.x));
+				writeLE32(data, static_cast<uint32_t>(e.wheel.y));
+			}
+		}
+	}
+
+	std::ofstream ofs(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
+	ofs.close();
+
+	if (ofs.good())
+	{
+		DebugMention("Saved " + std::to_string(this->frames.size()) +
+			" frames of input to \"" + filename + "\".");
+	}
+	else
+	{
+		DebugWarning("Could not write input recording \"" + filename + "\".");
+	}
+}
@@ -0,0 +1,55 @@
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+
+// An input recording is the frame times and input events of a play session, along with
+// the seed that default-constructed random generators used. Replaying it feeds the same
+// events through the same frame times, so the game takes the same path through real
+// gameplay code every time, i.e., for repeatable benchmark runs.
+
+// Only events that the game listens to are kept (quit, window, keyboard, mouse motion,
+// mouse buttons, and mouse wheel), in a compact little-endian format.
+
+class InputRecording
+{
+public:
+	struct Frame
+	{
+		uint32_t microseconds; // Delta time of the frame.
+		std::vector<SDL_Event> events;
+	};
+private:
+	static const std::string SIGNATURE;
+
+	std::vector<Frame> frames;
+	int seed;
+public:
+	InputRecording(int seed);
+	~InputRecording();
+
+	// Reads a recording from file. Returns null if it can't be read.
+	static std::unique_ptr<InputRecording> load(const std::string &filename);
+
+	// Gets the seed for default-constructed random generators.
+	int getSeed() const;
+
+	int getFrameCount() const;
+	const Frame &getFrame(int index) const;
+
+	// Starts a new frame with the given delta time.
+	void addFrame(uint32_t microseconds);
+
+	// Adds an event to the current frame, unless it's a kind the game ignores.
+	void addEvent(const SDL_Event &e);
+
+	// Writes the recording to file.
+	void save(const std::string &filename) const;
+};
+
+#endif
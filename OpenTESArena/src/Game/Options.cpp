@@ -22,9 +22,11 @@ const double Options::MAX_VERTICAL_SENSITIVITY = 50.0;
 Options::Options(std::string &&arenaPath, int screenWidth, int screenHeight, bool fullscreen,
 	int targetFPS, double resolutionScale, double verticalFOV, double letterboxAspect,
 	double cursorScale, double hSensitivity, double vSensitivity, std::string &&soundfont,
-	double musicVolume, double soundVolume, int soundChannels, bool skipIntro,
-	PlayerInterface playerInterface, bool showDebug)
-	: arenaPath(std::move(arenaPath)), soundfont(std::move(soundfont))
+	double musicVolume, double soundVolume, int soundChannels, bool prerenderMusic,
+	bool softwareMixer, bool skipIntro, PlayerInterface playerInterface, bool showDebug,
+	std::string &&recordInputPath, std::string &&replayInputPath)
+	: arenaPath(std::move(arenaPath)), soundfont(std::move(soundfont)),
+	recordInputPath(std::move(recordInputPath)), replayInputPath(std::move(replayInputPath))
 {
 	// Make sure each of the values is in a valid range.
 	DebugAssert(screenWidth > 0, "Screen width must be positive.");
@@ -78,6 +80,8 @@ Options::Options(std::string &&arenaPath, int screenWidth, int screenHeight, boo
 	this->musicVolume = musicVolume;
 	this->soundVolume = soundVolume;
 	this->soundChannels = soundChannels;
+	this->prerenderMusic = prerenderMusic;
+	this->softwareMixer = softwareMixer;
 	this->skipIntro = skipIntro;
 	this->playerInterface = playerInterface;
 	this->showDebug = showDebug;
@@ -158,6 +162,16 @@ int Options::getSoundChannelCount() const
 	return this->soundChannels;
 }
 
+bool Options::musicIsPrerendered() const
+{
+	return this->prerenderMusic;
+}
+
+bool Options::soundIsSoftwareMixed() const
+{
+	return this->softwareMixer;
+}
+
 const std::string &Options::getArenaPath() const
 {
 	return this->arenaPath;
@@ -178,6 +192,16 @@ bool Options::debugIsShown() const
 	return this->showDebug;
 }
 
+const std::string &Options::getRecordInputPath() const
+{
+	return this->recordInputPath;
+}
+
+const std::string &Options::getReplayInputPath() const
+{
+	return this->replayInputPath;
+}
+
 void Options::setScreenWidth(int width)
 {
 	assert(width > 0);
@@ -266,6 +290,16 @@ void Options::setSoundChannelCount(int count)
 	this->soundChannels = count;
 }
 
+void Options::setPrerenderMusic(bool prerender)
+{
+	this->prerenderMusic = prerender;
+}
+
+void Options::setSoftwareMixer(bool softwareMixer)
+{
+	this->softwareMixer = softwareMixer;
+}
+
 void Options::setArenaPath(std::string path)
 {
 	this->arenaPath = std::move(path);
@@ -285,3 +319,13 @@ void Options::setShowDebug(bool debug)
 {
 	this->showDebug = debug;
 }
+
+void Options::setRecordInputPath(std::string path)
+{
+	this->recordInputPath = std::move(path);
+}
+
+void Options::setReplayInputPath(std::string path)
+{
+	this->replayInputPath = std::move(path);
+}
@@ -28,17 +28,22 @@ private:
     std::string soundfont; // .cfg file.
     double musicVolume, soundVolume;
     int soundChannels;
+	bool prerenderMusic; // Synthesize each song once and play from memory.
+	bool softwareMixer; // Mix sounds in software instead of one OpenAL source each.
 
 	// Miscellaneous.
 	std::string arenaPath; // "ARENA" data path.
 	bool skipIntro;
 	bool showDebug;
+	std::string recordInputPath; // Input recording to save on exit, if not empty.
+	std::string replayInputPath; // Input recording to play back, if not empty.
 public:
 	Options(std::string &&arenaPath, int screenWidth, int screenHeight, bool fullscreen,
 		int targetFPS, double resolutionScale, double verticalFOV, double letterboxAspect,
 		double cursorScale, double hSensitivity, double vSensitivity, std::string &&soundfont,
-		double musicVolume, double soundVolume, int soundChannels, bool skipIntro,
-		PlayerInterface playerInterface, bool showDebug);
+		double musicVolume, double soundVolume, int soundChannels, bool prerenderMusic,
+		bool softwareMixer, bool skipIntro, PlayerInterface playerInterface, bool showDebug,
+		std::string &&recordInputPath, std::string &&replayInputPath);
 	~Options();
 
 	static const int MIN_FPS;
@@ -69,10 +74,14 @@ public:
 	double getMusicVolume() const;
 	double getSoundVolume() const;
 	int getSoundChannelCount() const;
+	bool musicIsPrerendered() const;
+	bool soundIsSoftwareMixed() const;
 	const std::string &getArenaPath() const;
 	bool introIsSkipped() const;
 	PlayerInterface getPlayerInterface() const;
 	bool debugIsShown() const;
+	const std::string &getRecordInputPath() const;
+	const std::string &getReplayInputPath() const;
 
 	void setScreenWidth(int width);
 	void setScreenHeight(int height);
@@ -88,10 +97,14 @@ public:
 	void setMusicVolume(double percent);
 	void setSoundVolume(double percent);
 	void setSoundChannelCount(int count);
+	void setPrerenderMusic(bool prerender);
+	void setSoftwareMixer(bool softwareMixer);
 	void setArenaPath(std::string path);
 	void setSkipIntro(bool skip);
 	void setPlayerInterface(PlayerInterface playerInterface);
 	void setShowDebug(bool debug);
+	void setRecordInputPath(std::string path);
+	void setReplayInputPath(std::string path);
 };
 
 #endif
@@ -25,9 +25,13 @@ const std::string OptionsParser::MUSIC_VOLUME_KEY = "MusicVolume";
 const std::string OptionsParser::SOUND_VOLUME_KEY = "SoundVolume";
 const std::string OptionsParser::SOUNDFONT_KEY = "Soundfont";
 const std::string OptionsParser::SOUND_CHANNELS_KEY = "SoundChannels";
+const std::string OptionsParser::PRERENDER_MUSIC_KEY = "PrerenderMusic";
+const std::string OptionsParser::SOFTWARE_MIXER_KEY = "SoftwareMixer";
 const std::string OptionsParser::ARENA_PATH_KEY = "ArenaPath";
 const std::string OptionsParser::SKIP_INTRO_KEY = "SkipIntro";
 const std::string OptionsParser::SHOW_DEBUG_KEY = "ShowDebug";
+const std::string OptionsParser::RECORD_INPUT_KEY = "RecordInput";
+const std::string OptionsParser::REPLAY_INPUT_KEY = "ReplayInput";
 
 std::unique_ptr<Options> OptionsParser::parse(const std::string &filename)
 {
@@ -56,18 +60,22 @@ std::unique_ptr<Options> OptionsParser::parse(const std::string &filename)
     double soundVolume = textMap.getDouble(OptionsParser::SOUND_VOLUME_KEY);
 	std::string soundfont = textMap.getString(OptionsParser::SOUNDFONT_KEY);
     int soundChannels = textMap.getInteger(OptionsParser::SOUND_CHANNELS_KEY);
+	bool prerenderMusic = textMap.getBoolean(OptionsParser::PRERENDER_MUSIC_KEY);
+	bool softwareMixer = textMap.getBoolean(OptionsParser::SOFTWARE_MIXER_KEY);
 
 	// Miscellaneous.
 	std::string arenaPath = textMap.getString(OptionsParser::ARENA_PATH_KEY);
 	bool skipIntro = textMap.getBoolean(OptionsParser::SKIP_INTRO_KEY);
 	bool showDebug = textMap.getBoolean(OptionsParser::SHOW_DEBUG_KEY);
+	std::string recordInputPath = textMap.getString(OptionsParser::RECORD_INPUT_KEY);
+	std::string replayInputPath = textMap.getString(OptionsParser::REPLAY_INPUT_KEY);
 	
 	return std::unique_ptr<Options>(new Options(std::move(arenaPath),
 		screenWidth, screenHeight, fullscreen, targetFPS, resolutionScale, verticalFOV,
 		letterboxAspect, cursorScale, hSensitivity, vSensitivity, std::move(soundfont),
-		musicVolume, soundVolume, soundChannels, skipIntro,
+		musicVolume, soundVolume, soundChannels, prerenderMusic, softwareMixer, skipIntro,
 		modernInterface ? PlayerInterface::Modern : PlayerInterface::Classic,
-		showDebug));
+		showDebug, std::move(recordInputPath), std::move(replayInputPath)));
 }
 
 void OptionsParser::save(const Options &options)
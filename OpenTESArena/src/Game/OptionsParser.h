@@ -31,11 +31,15 @@ private:
     static const std::string SOUND_VOLUME_KEY;
 	static const std::string SOUNDFONT_KEY;
     static const std::string SOUND_CHANNELS_KEY;
+	static const std::string PRERENDER_MUSIC_KEY;
+	static const std::string SOFTWARE_MIXER_KEY;
 
 	// Miscellaneous.
 	static const std::string ARENA_PATH_KEY;
 	static const std::string SKIP_INTRO_KEY;
 	static const std::string SHOW_DEBUG_KEY;
+	static const std::string RECORD_INPUT_KEY;
+	static const std::string REPLAY_INPUT_KEY;
 
 	OptionsParser() = delete;
 	OptionsParser(const OptionsParser&) = delete;
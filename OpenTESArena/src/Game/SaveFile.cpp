@@ -0,0 +1,938 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include "SaveFile.h"
+
+#include "Clock.h"
+#include "Date.h"
+#include "GameData.h"
+#include "../Assets/INFFile.h"
+#include "../Assets/MIFFile.h"
+#include "../Entities/CharacterClass.h"
+#include "../Entities/CharacterClassParser.h"
+#include "../Entities/Entity.h"
+#include "../Entities/EntityManager.h"
+#include "../Entities/GenderName.h"
+#include "../Entities/Player.h"
+#include "../Items/WeaponType.h"
+#include "../Rendering/Renderer.h"
+#include "../Utilities/Bytes.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/File.h"
+#include "../Utilities/MappedFile.h"
+#include "../Utilities/Platform.h"
+#include "../Utilities/String.h"
+#include "../World/ClimateName.h"
+#include "../World/Location.h"
+#include "../World/LocationType.h"
+#include "../World/WorldData.h"
+
+namespace
+{
+	// Chunk tags.
+	const std::string PlayerTag = "PLYR";
+	const std::string TimeTag = "TIME";
+	const std::string LevelTag = "LEVL";
+	const std::string VoxelsTag = "VOXL";
+	const std::string EntitiesTag = "ENTS";
+	const std::string TriggersTag = "TRIG";
+	const std::string EndTag = "END ";
+
+	// Chunk flags.
+	const uint8_t CompressedFlag = 0x1;
+
+	// Compressed chunks are run-length encoded, where each run is at most this long,
+	// so a chunk can't be more than this many times its compressed size.
+	const size_t MaxRunLength = 128;
+
+	const std::string AutosaveFilename = "autosave.sav";
+
+	void writeByte(std::vector<uint8_t> &data, uint8_t value)
+	{
+		data.push_back(value);
+	}
+
+	void writeLE16(std::vector<uint8_t> &data, uint16_t value)
+	{
+		data.push_back(static_cast<uint8_t>(value & 0xFF));
+		data.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+	}
+
+	void writeLE32(std::vector<uint8_t> &data, uint32_t value)
+	{
+		data.push_back(static_cast<uint8_t>(value & 0xFF));
+		data.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+		data.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
+		data.push_back(static_cast<uint8_t>((value >> 24) & 0xFF));
+	}
+
+	void writeDouble(std::vector<uint8_t> &data, double value)
+	{
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		writeLE32(data, static_cast<uint32_t>(bits & 0xFFFFFFFF));
+		writeLE32(data, static_cast<uint32_t>(bits >> 32));
+	}
+
+	void writeDouble3(std::vector<uint8_t> &data, const Double3 &value)
+	{
+		writeDouble(data, value.x);
+		writeDouble(data, value.y);
+		writeDouble(data, value.z);
+	}
+
+	void writeString(std::vector<uint8_t> &data, const std::string &value)
+	{
+		DebugAssert(value.size() <= UINT16_MAX, "String \"" + value + "\" too long to save.");
+		writeLE16(data, static_cast<uint16_t>(value.size()));
+		data.insert(data.end(), value.begin(), value.end());
+	}
+
+	// Reads values from a byte buffer, and remembers if it ran past the end.
+	class Reader
+	{
+	private:
+		const uint8_t *ptr, *end;
+		bool overrun;
+
+		// Returns whether the given number of bytes can be read.
+		bool has(size_t count)
+		{
+			this->overrun |= static_cast<size_t>(this->end - this->ptr) < count;
+			return !this->overrun;
+		}
+	public:
+		Reader(const uint8_t *ptr, const uint8_t *end)
+			: ptr(ptr), end(end), overrun(false) { }
+
+		bool isDone() const
+		{
+			return this->ptr == this->end;
+		}
+
+		bool isOverrun() const
+		{
+			return this->overrun;
+		}
+
+		size_t getRemaining() const
+		{
+			return static_cast<size_t>(this->end - this->ptr);
+		}
+
+		// Returns a pointer to the next bytes and skips past them, or null if there
+		// aren't enough.
+		const uint8_t *readBytes(size_t count)
+		{
+			if (!this->has(count))
+			{
+				return nullptr;
+			}
+
+			const uint8_t *bytes = this->ptr;
+			this->ptr += count;
+			return bytes;
+		}
+
+		uint8_t readByte()
+		{
+			return this->has(1) ? *this->ptr++ : 0;
+		}
+
+		uint16_t readLE16()
+		{
+			const uint8_t *bytes = this->readBytes(2);
+			return (bytes != nullptr) ? Bytes::getLE16(bytes) : 0;
+		}
+
+		uint32_t readLE32()
+		{
+			const uint8_t *bytes = this->readBytes(4);
+			return (bytes != nullptr) ? Bytes::getLE32(bytes) : 0;
+		}
+
+		double readDouble()
+		{
+			const uint64_t low = this->readLE32();
+			const uint64_t high = this->readLE32();
+			const uint64_t bits = low | (high << 32);
+
+			double value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		Double3 readDouble3()
+		{
+			const double x = this->readDouble();
+			const double y = this->readDouble();
+			const double z = this->readDouble();
+			return Double3(x, y, z);
+		}
+
+		std::string readString()
+		{
+			const uint16_t size = this->readLE16();
+			const uint8_t *bytes = this->readBytes(size);
+			return (bytes != nullptr) ?
+				std::string(reinterpret_cast<const char*>(bytes), size) : std::string();
+		}
+	};
+
+	// FNV-1a hash of a byte buffer, for detecting damaged save files.
+	uint32_t getHash(const uint8_t *data, size_t size)
+	{
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= data[i];
+			hash *= 16777619u;
+		}
+
+		return hash;
+	}
+
+	// Run-length encodes bytes. Each run starts with a control byte: 0-127 means the
+	// next 1-128 bytes are literals, and 129-255 means the next byte is repeated 2-128
+	// times (257 minus the control byte).
+	std::vector<uint8_t> compressRuns(const std::vector<uint8_t> &src)
+	{
+		std::vector<uint8_t> dst;
+		const size_t size = src.size();
+		size_t i = 0;
+
+		while (i < size)
+		{
+			size_t runLength = 1;
+			while (((i + runLength) < size) && (runLength < MaxRunLength) &&
+				(src[i + runLength] == src[i]))
+			{
+				runLength++;
+			}
+
+			if (runLength >= 3)
+			{
+				dst.push_back(static_cast<uint8_t>(257 - runLength));
+				dst.push_back(src[i]);
+				i += runLength;
+			}
+			else
+			{
+				// Take literals up to the next run of three or more.
+				const size_t start = i;
+				while ((i < size) && ((i - start) < MaxRunLength))
+				{
+					const bool runStarts = ((i + 2) < size) &&
+						(src[i] == src[i + 1]) && (src[i] == src[i + 2]);
+					if (runStarts && (i > start))
+					{
+						break;
+					}
+
+					i++;
+				}
+
+				dst.push_back(static_cast<uint8_t>(i - start - 1));
+				dst.insert(dst.end(), src.begin() + start, src.begin() + i);
+			}
+		}
+
+		return dst;
+	}
+
+	// Reverses compressRuns(). Returns whether the bytes decompressed to the expected size.
+	bool decompressRuns(const uint8_t *src, size_t srcSize, size_t dstSize,
+		std::vector<uint8_t> &dst)
+	{
+		dst.clear();
+		dst.reserve(dstSize);
+
+		size_t i = 0;
+		while (i < srcSize)
+		{
+			const uint8_t control = src[i];
+			i++;
+
+			if (control < 128)
+			{
+				const size_t count = static_cast<size_t>(control) + 1;
+				if ((count > (srcSize - i)) || (count > (dstSize - dst.size())))
+				{
+					return false;
+				}
+
+				dst.insert(dst.end(), src + i, src + i + count);
+				i += count;
+			}
+			else if (control > 128)
+			{
+				const size_t count = 257 - static_cast<size_t>(control);
+				if ((i == srcSize) || (count > (dstSize - dst.size())))
+				{
+					return false;
+				}
+
+				dst.insert(dst.end(), count, src[i]);
+				i++;
+			}
+		}
+
+		return dst.size() == dstSize;
+	}
+
+	// Appends a chunk to a save file, compressing it if that makes it smaller.
+	void writeChunk(std::vector<uint8_t> &data, const std::string &tag,
+		const std::vector<uint8_t> &chunk, bool compress)
+	{
+		const std::vector<uint8_t> compressed = compress ?
+			compressRuns(chunk) : std::vector<uint8_t>();
+		const bool useCompressed = compress && (compressed.size() < chunk.size());
+		const std::vector<uint8_t> &stored = useCompressed ? compressed : chunk;
+
+		data.insert(data.end(), tag.begin(), tag.end());
+		writeByte(data, useCompressed ? CompressedFlag : 0);
+		writeLE32(data, static_cast<uint32_t>(chunk.size()));
+		writeLE32(data, static_cast<uint32_t>(stored.size()));
+		data.insert(data.end(), stored.begin(), stored.end());
+	}
+
+	// Returns whether a saved enum value is between the enum's first and last values.
+	template <typename T>
+	bool isEnumInRange(int value, T lastValue)
+	{
+		return (value >= 0) && (value <= static_cast<int>(lastValue));
+	}
+}
+
+const uint32_t SaveFile::VERSION = 1;
+const std::string SaveFile::SIGNATURE = "OTASAVE";
+
+std::string SaveFile::getAutosavePath()
+{
+	return Platform::getOptionsPath() + AutosaveFilename;
+}
+
+std::unique_ptr<SaveFile::Snapshot> SaveFile::makeSnapshot(GameData &gameData)
+{
+	std::unique_ptr<Snapshot> snapshot(new Snapshot());
+
+	Player &player = gameData.getPlayer();
+	snapshot->playerName = player.getDisplayName();
+	snapshot->className = player.getCharacterClass().getDisplayName();
+	snapshot->gender = static_cast<int>(player.getGenderName());
+	snapshot->raceID = player.getRaceID();
+	snapshot->portraitID = player.getPortraitID();
+	snapshot->weaponType = static_cast<int>(player.getWeaponAnimation().getWeaponType());
+	snapshot->position = player.getPosition();
+	snapshot->direction = player.getDirection();
+	snapshot->velocity = player.getVelocity();
+	snapshot->maxWalkSpeed = player.getMaxWalkSpeed();
+	snapshot->maxRunSpeed = player.getMaxRunSpeed();
+
+	const Date &date = gameData.getDate();
+	snapshot->era = date.getEra();
+	snapshot->year = date.getYear();
+	snapshot->month = date.getMonth();
+	snapshot->day = date.getDay();
+
+	const Clock &clock = gameData.getClock();
+	snapshot->hours = clock.getHours24();
+	snapshot->minutes = clock.getMinutes();
+	snapshot->seconds = clock.getSeconds();
+	snapshot->fractionOfSecond = clock.getFractionOfSecond();
+
+	const Location &location = gameData.getLocation();
+	snapshot->locationName = location.getName();
+	snapshot->provinceID = location.getProvinceID();
+	snapshot->locationType = static_cast<int>(location.getLocationType());
+	snapshot->climateName = static_cast<int>(location.getClimateName());
+	snapshot->levelMIFName = gameData.getLevelMIFName();
+	snapshot->levelIndex = gameData.getLevelIndex();
+
+	const WorldData &worldData = gameData.getWorldData();
+	const VoxelGrid &voxelGrid = worldData.getVoxelGrid();
+	const auto &pristineVoxels = worldData.getPristineVoxels();
+	if (pristineVoxels.get() != nullptr)
+	{
+		snapshot->gridWidth = voxelGrid.getWidth();
+		snapshot->gridHeight = voxelGrid.getHeight();
+		snapshot->gridDepth = voxelGrid.getDepth();
+
+		// Compare one column at a time, in the same order as the pristine voxels, and
+		// gather runs of changed voxels.
+		const auto &voxels = voxelGrid.getVoxels();
+		const int height = snapshot->gridHeight;
+		const VoxelGrid::VoxelID *pristine = pristineVoxels->data();
+		VoxelRun *run = nullptr;
+		uint32_t index = 0;
+
+		for (int z = 0; z < snapshot->gridDepth; z++)
+		{
+			for (int x = 0; x < snapshot->gridWidth; x++)
+			{
+				const VoxelGrid::VoxelID *column = voxels.getColumn(x, z);
+				if (std::equal(column, column + height, pristine + index))
+				{
+					run = nullptr;
+					index += height;
+					continue;
+				}
+
+				for (int y = 0; y < height; y++, index++)
+				{
+					if (column[y] == pristine[index])
+					{
+						run = nullptr;
+					}
+					else
+					{
+						if (run == nullptr)
+						{
+							snapshot->voxelRuns.push_back(VoxelRun());
+							run = &snapshot->voxelRuns.back();
+							run->index = index;
+						}
+
+						run->ids.push_back(column[y]);
+					}
+				}
+			}
+		}
+	}
+
+	for (const auto &group : worldData.getEntityManager().getGroups())
+	{
+		for (int i = 0; i < group.getCount(); i++)
+		{
+			EntityState entity;
+			entity.id = group.ids[i];
+			entity.position = group.positions[i];
+			snapshot->entities.push_back(entity);
+		}
+	}
+
+	for (const auto &pair : worldData.getTextTriggers())
+	{
+		if (pair.second.hasBeenDisplayed())
+		{
+			snapshot->displayedTextTriggers.push_back(pair.first);
+		}
+	}
+
+	// Sort the triggers so the same session always saves the same bytes.
+	std::sort(snapshot->displayedTextTriggers.begin(), snapshot->displayedTextTriggers.end(),
+		[](const Int2 &a, const Int2 &b)
+	{
+		return (a.x < b.x) || ((a.x == b.x) && (a.y < b.y));
+	});
+
+	return snapshot;
+}
+
+std::vector<uint8_t> SaveFile::encode(const Snapshot &snapshot, bool compress)
+{
+	std::vector<uint8_t> data(SaveFile::SIGNATURE.begin(), SaveFile::SIGNATURE.end());
+	writeLE32(data, SaveFile::VERSION);
+
+	std::vector<uint8_t> chunk;
+
+	writeString(chunk, snapshot.playerName);
+	writeString(chunk, snapshot.className);
+	writeByte(chunk, static_cast<uint8_t>(snapshot.gender));
+	writeLE32(chunk, static_cast<uint32_t>(snapshot.raceID));
+	writeLE32(chunk, static_cast<uint32_t>(snapshot.portraitID));
+	writeByte(chunk, static_cast<uint8_t>(snapshot.weaponType));
+	writeDouble3(chunk, snapshot.position);
+	writeDouble3(chunk, snapshot.direction);
+	writeDouble3(chunk, snapshot.velocity);
+	writeDouble(chunk, snapshot.maxWalkSpeed);
+	writeDouble(chunk, snapshot.maxRunSpeed);
+	writeChunk(data, PlayerTag, chunk, compress);
+
+	chunk.clear();
+	writeLE32(chunk, static_cast<uint32_t>(snapshot.era));
+	writeLE32(chunk, static_cast<uint32_t>(snapshot.year));
+	writeByte(chunk, static_cast<uint8_t>(snapshot.month));
+	writeByte(chunk, static_cast<uint8_t>(snapshot.day));
+	writeByte(chunk, static_cast<uint8_t>(snapshot.hours));
+	writeByte(chunk, static_cast<uint8_t>(snapshot.minutes));
+	writeByte(chunk, static_cast<uint8_t>(snapshot.seconds));
+	writeDouble(chunk, snapshot.fractionOfSecond);
+	writeChunk(data, TimeTag, chunk, compress);
+
+	chunk.clear();
+	writeString(chunk, snapshot.locationName);
+	writeLE32(chunk, static_cast<uint32_t>(snapshot.provinceID));
+	writeByte(chunk, static_cast<uint8_t>(snapshot.locationType));
+	writeByte(chunk, static_cast<uint8_t>(snapshot.climateName));
+	writeString(chunk, snapshot.levelMIFName);
+	writeLE32(chunk, static_cast<uint32_t>(snapshot.levelIndex));
+	writeChunk(data, LevelTag, chunk, compress);
+
+	if (snapshot.gridWidth > 0)
+	{
+		chunk.clear();
+		writeLE32(chunk, static_cast<uint32_t>(snapshot.gridWidth));
+		writeLE32(chunk, static_cast<uint32_t>(snapshot.gridHeight));
+		writeLE32(chunk, static_cast<uint32_t>(snapshot.gridDepth));
+		writeLE32(chunk, static_cast<uint32_t>(snapshot.voxelRuns.size()));
+
+		for (const VoxelRun &run : snapshot.voxelRuns)
+		{
+			writeLE32(chunk, run.index);
+			writeLE32(chunk, static_cast<uint32_t>(run.ids.size()));
+
+			for (const VoxelGrid::VoxelID id : run.ids)
+			{
+				writeLE16(chunk, id);
+			}
+		}
+
+		writeChunk(data, VoxelsTag, chunk, compress);
+	}
+
+	chunk.clear();
+	writeLE32(chunk, static_cast<uint32_t>(snapshot.entities.size()));
+	for (const EntityState &entity : snapshot.entities)
+	{
+		writeLE32(chunk, static_cast<uint32_t>(entity.id));
+		writeDouble3(chunk, entity.position);
+	}
+
+	writeChunk(data, EntitiesTag, chunk, compress);
+
+	chunk.clear();
+	writeLE32(chunk, static_cast<uint32_t>(snapshot.displayedTextTriggers.size()));
+	for (const Int2 &voxel : snapshot.displayedTextTriggers)
+	{
+		writeLE32(chunk, static_cast<uint32_t>(voxel.x));
+		writeLE32(chunk, static_cast<uint32_t>(voxel.y));
+	}
+
+	writeChunk(data, TriggersTag, chunk, compress);
+
+	// The end chunk has the hash of everything before it, so a truncated or damaged
+	// file isn't mistaken for a save with fewer chunks.
+	chunk.clear();
+	writeLE32(chunk, getHash(data.data(), data.size()));
+	writeChunk(data, EndTag, chunk, false);
+
+	return data;
+}
+
+std::unique_ptr<SaveFile::Snapshot> SaveFile::decode(const uint8_t *data, size_t size)
+{
+	const size_t signatureSize = SaveFile::SIGNATURE.size();
+	if ((size < (signatureSize + 4)) ||
+		(std::memcmp(data, SaveFile::SIGNATURE.data(), signatureSize) != 0))
+	{
+		DebugWarning("Not a save file.");
+		return nullptr;
+	}
+
+	Reader reader(data + signatureSize, data + size);
+	const uint32_t version = reader.readLE32();
+	if ((version == 0) || (version > SaveFile::VERSION))
+	{
+		DebugWarning("Unsupported save file version " + std::to_string(version) + ".");
+		return nullptr;
+	}
+
+	std::unique_ptr<Snapshot> snapshot(new Snapshot());
+	bool hasPlayer = false;
+	bool hasTime = false;
+	bool hasLevel = false;
+	bool hasEnd = false;
+	std::vector<uint8_t> decompressed;
+
+	while (!hasEnd)
+	{
+		const uint8_t *chunkStart = data + (size - reader.getRemaining());
+		const uint8_t *tagBytes = reader.readBytes(4);
+		const uint8_t flags = reader.readByte();
+		const uint32_t rawSize = reader.readLE32();
+		const uint32_t storedSize = reader.readLE32();
+		const uint8_t *stored = reader.readBytes(storedSize);
+		if (reader.isOverrun())
+		{
+			DebugWarning("Save file is truncated.");
+			return nullptr;
+		}
+
+		const std::string tag(reinterpret_cast<const char*>(tagBytes), 4);
+		const uint8_t *chunkData = stored;
+		size_t chunkSize = storedSize;
+
+		if ((flags & CompressedFlag) != 0)
+		{
+			const bool valid = (rawSize <= (static_cast<size_t>(storedSize) * MaxRunLength)) &&
+				decompressRuns(stored, storedSize, rawSize, decompressed);
+			if (!valid)
+			{
+				DebugWarning("Could not decompress \"" + tag + "\" chunk.");
+				return nullptr;
+			}
+
+			chunkData = decompressed.data();
+			chunkSize = rawSize;
+		}
+		else if (rawSize != storedSize)
+		{
+			DebugWarning("Invalid \"" + tag + "\" chunk size.");
+			return nullptr;
+		}
+
+		Reader chunk(chunkData, chunkData + chunkSize);
+
+		if (tag == PlayerTag)
+		{
+			snapshot->playerName = chunk.readString();
+			snapshot->className = chunk.readString();
+			snapshot->gender = chunk.readByte();
+			snapshot->raceID = static_cast<int>(chunk.readLE32());
+			snapshot->portraitID = static_cast<int>(chunk.readLE32());
+			snapshot->weaponType = chunk.readByte();
+			snapshot->position = chunk.readDouble3();
+			snapshot->direction = chunk.readDouble3();
+			snapshot->velocity = chunk.readDouble3();
+			snapshot->maxWalkSpeed = chunk.readDouble();
+			snapshot->maxRunSpeed = chunk.readDouble();
+			hasPlayer = true;
+		}
+		else if (tag == TimeTag)
+		{
+			snapshot->era = static_cast<int>(chunk.readLE32());
+			snapshot->year = static_cast<int>(chunk.readLE32());
+			snapshot->month = chunk.readByte();
+			snapshot->day = chunk.readByte();
+			snapshot->hours = chunk.readByte();
+			snapshot->minutes = chunk.readByte();
+			snapshot->seconds = chunk.readByte();
+			snapshot->fractionOfSecond = chunk.readDouble();
+
+			const bool valid = (snapshot->era >= 0) && (snapshot->year >= 1) &&
+				(snapshot->year <= Date::YEARS_PER_ERA) &&
+				(snapshot->month < Date::MONTHS_PER_YEAR) &&
+				(snapshot->day < Date::DAYS_PER_MONTH) && (snapshot->hours < 24) &&
+				(snapshot->minutes < 60) && (snapshot->seconds < 60);
+			if (!valid)
+			{
+				DebugWarning("Invalid date or time in save file.");
+				return nullptr;
+			}
+
+			hasTime = true;
+		}
+		else if (tag == LevelTag)
+		{
+			snapshot->locationName = chunk.readString();
+			snapshot->provinceID = static_cast<int>(chunk.readLE32());
+			snapshot->locationType = chunk.readByte();
+			snapshot->climateName = chunk.readByte();
+			snapshot->levelMIFName = chunk.readString();
+			snapshot->levelIndex = static_cast<int>(chunk.readLE32());
+			hasLevel = true;
+		}
+		else if (tag == VoxelsTag)
+		{
+			snapshot->gridWidth = static_cast<int>(chunk.readLE32());
+			snapshot->gridHeight = static_cast<int>(chunk.readLE32());
+			snapshot->gridDepth = static_cast<int>(chunk.readLE32());
+
+			// Each run is at least ten bytes, so a bad count can't allocate much.
+			const uint32_t runCount = chunk.readLE32();
+			if (runCount > (chunk.getRemaining() / 10))
+			{
+				DebugWarning("Invalid voxel run count in save file.");
+				return nullptr;
+			}
+
+			snapshot->voxelRuns.resize(runCount);
+			for (VoxelRun &run : snapshot->voxelRuns)
+			{
+				run.index = chunk.readLE32();
+
+				const uint32_t idCount = chunk.readLE32();
+				if (idCount > (chunk.getRemaining() / 2))
+				{
+					DebugWarning("Invalid voxel run in save file.");
+					return nullptr;
+				}
+
+				run.ids.resize(idCount);
+				for (VoxelGrid::VoxelID &id : run.ids)
+				{
+					id = chunk.readLE16();
+				}
+			}
+		}
+		else if (tag == EntitiesTag)
+		{
+			const uint32_t entityCount = chunk.readLE32();
+			if (entityCount > (chunk.getRemaining() / 28))
+			{
+				DebugWarning("Invalid entity count in save file.");
+				return nullptr;
+			}
+
+			snapshot->entities.resize(entityCount);
+			for (EntityState &entity : snapshot->entities)
+			{
+				entity.id = static_cast<int>(chunk.readLE32());
+				entity.position = chunk.readDouble3();
+			}
+		}
+		else if (tag == TriggersTag)
+		{
+			const uint32_t triggerCount = chunk.readLE32();
+			if (triggerCount > (chunk.getRemaining() / 8))
+			{
+				DebugWarning("Invalid text trigger count in save file.");
+				return nullptr;
+			}
+
+			snapshot->displayedTextTriggers.resize(triggerCount);
+			for (Int2 &voxel : snapshot->displayedTextTriggers)
+			{
+				voxel.x = static_cast<int>(chunk.readLE32());
+				voxel.y = static_cast<int>(chunk.readLE32());
+			}
+		}
+		else if (tag == EndTag)
+		{
+			const uint32_t hash = chunk.readLE32();
+			if (hash != getHash(data, chunkStart - data))
+			{
+				DebugWarning("Save file is damaged.");
+				return nullptr;
+			}
+
+			hasEnd = true;
+		}
+
+		// Chunks with other tags are from a newer version and are skipped.
+
+		if (chunk.isOverrun())
+		{
+			DebugWarning("\"" + tag + "\" chunk is truncated.");
+			return nullptr;
+		}
+	}
+
+	if (!hasPlayer || !hasTime || !hasLevel)
+	{
+		DebugWarning("Save file is missing chunks.");
+		return nullptr;
+	}
+
+	return snapshot;
+}
+
+bool SaveFile::write(const Snapshot &snapshot, const std::string &filename)
+{
+	const std::vector<uint8_t> data = SaveFile::encode(snapshot, true);
+
+	// Write to a temporary file first so an interrupted save never replaces a good one
+	// with a truncated one.
+	const std::string tempFilename = filename + ".tmp";
+
+	std::ofstream ofs(tempFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!ofs.is_open())
+	{
+		DebugWarning("Could not write save file \"" + filename + "\".");
+		return false;
+	}
+
+	ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
+	ofs.close();
+
+	if (!ofs.good())
+	{
+		DebugWarning("Could not write save file \"" + filename + "\".");
+		std::remove(tempFilename.c_str());
+		return false;
+	}
+
+	// Swap the finished file in. The old save stays in place until then.
+	if (!File::replace(tempFilename, filename))
+	{
+		DebugWarning("Could not replace \"" + filename + "\" with \"" + tempFilename + "\".");
+		std::remove(tempFilename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+std::unique_ptr<SaveFile::Snapshot> SaveFile::read(const std::string &filename)
+{
+	if (!File::exists(filename))
+	{
+		DebugWarning("Save file \"" + filename + "\" doesn't exist.");
+		return nullptr;
+	}
+
+	const MappedFile file(filename);
+	if (!file.isOpen())
+	{
+		return nullptr;
+	}
+
+	return SaveFile::decode(file.getData(), file.getSize());
+}
+
+std::unique_ptr<GameData> SaveFile::load(const Snapshot &snapshot,
+	TextureManager &textureManager, Renderer &renderer)
+{
+	// Enums are stored as single bytes, so a damaged file can hold values past the
+	// last one.
+	if (!isEnumInRange(snapshot.gender, GenderName::Male) ||
+		!isEnumInRange(snapshot.weaponType, WeaponType::Warhammer) ||
+		!isEnumInRange(snapshot.locationType, LocationType::Unique) ||
+		!isEnumInRange(snapshot.climateName, ClimateName::Snowy))
+	{
+		DebugWarning("Invalid gender (" + std::to_string(snapshot.gender) +
+			"), weapon type (" + std::to_string(snapshot.weaponType) +
+			"), location type (" + std::to_string(snapshot.locationType) +
+			") or climate (" + std::to_string(snapshot.climateName) + ") in save file.");
+		return nullptr;
+	}
+
+	const std::vector<CharacterClass> charClasses = CharacterClassParser::parse();
+	const auto charClassIter = std::find_if(charClasses.begin(), charClasses.end(),
+		[&snapshot](const CharacterClass &charClass)
+	{
+		return charClass.getDisplayName() == snapshot.className;
+	});
+
+	if (charClassIter == charClasses.end())
+	{
+		DebugWarning("Unrecognized class \"" + snapshot.className + "\" in save file.");
+		return nullptr;
+	}
+
+	// Rebuild the level the same way it was first made, then apply the saved state.
+	std::unique_ptr<GameData> gameData = GameData::createDefault(snapshot.playerName,
+		static_cast<GenderName>(snapshot.gender), snapshot.raceID, *charClassIter,
+		snapshot.portraitID, textureManager, renderer);
+
+	if (snapshot.levelMIFName.size() > 0)
+	{
+		const MIFFile mif(snapshot.levelMIFName);
+		const auto &levels = mif.getLevels();
+		if ((snapshot.levelIndex < 0) ||
+			(snapshot.levelIndex >= static_cast<int>(levels.size())))
+		{
+			DebugWarning("Invalid level index " + std::to_string(snapshot.levelIndex) +
+				" for \"" + snapshot.levelMIFName + "\" in save file.");
+			return nullptr;
+		}
+
+		const INFFile inf(String::toUppercase(levels.front().info));
+		Double3 playerPosition = snapshot.position;
+		gameData->loadFromMIF(mif, inf, playerPosition, textureManager, renderer);
+
+		if (snapshot.levelIndex > 0)
+		{
+			const INFFile levelInf(String::toUppercase(levels.at(snapshot.levelIndex).info));
+			gameData->changeLevel(mif, snapshot.levelIndex, levelInf, renderer);
+		}
+	}
+
+	gameData->getPlayer() = Player(snapshot.playerName,
+		static_cast<GenderName>(snapshot.gender), snapshot.raceID, *charClassIter,
+		snapshot.portraitID, snapshot.position, snapshot.direction, snapshot.velocity,
+		snapshot.maxWalkSpeed, snapshot.maxRunSpeed,
+		static_cast<WeaponType>(snapshot.weaponType));
+
+	gameData->setDate(Date(snapshot.era, snapshot.year, snapshot.month, snapshot.day));
+	gameData->setClock(Clock(snapshot.hours, snapshot.minutes, snapshot.seconds,
+		snapshot.fractionOfSecond));
+	gameData->getLocation() = Location(snapshot.locationName, snapshot.provinceID,
+		static_cast<LocationType>(snapshot.locationType),
+		static_cast<ClimateName>(snapshot.climateName));
+
+	WorldData &worldData = gameData->getWorldData();
+	VoxelGrid &voxelGrid = worldData.getVoxelGrid();
+	const int width = voxelGrid.getWidth();
+	const int height = voxelGrid.getHeight();
+	const int depth = voxelGrid.getDepth();
+
+	if (snapshot.gridWidth > 0)
+	{
+		if ((snapshot.gridWidth != width) || (snapshot.gridHeight != height) ||
+			(snapshot.gridDepth != depth))
+		{
+			DebugWarning("Saved voxel grid doesn't match the level's, ignoring it.");
+		}
+		else
+		{
+			const size_t voxelCount = static_cast<size_t>(width) * height * depth;
+			const int voxelDataCount = voxelGrid.getVoxelDataCount();
+
+			for (const VoxelRun &run : snapshot.voxelRuns)
+			{
+				if ((run.index + run.ids.size()) > voxelCount)
+				{
+					DebugWarning("Saved voxel run is outside the level, ignoring it.");
+					continue;
+				}
+
+				for (size_t i = 0; i < run.ids.size(); i++)
+				{
+					const VoxelGrid::VoxelID id = run.ids[i];
+					if (id >= voxelDataCount)
+					{
+						DebugWarning("Saved voxel ID " + std::to_string(id) +
+							" has no voxel data, ignoring it.");
+						continue;
+					}
+
+					const size_t index = run.index + i;
+					const int y = static_cast<int>(index % height);
+					const int x = static_cast<int>((index / height) % width);
+					const int z = static_cast<int>(index / (static_cast<size_t>(height) * width));
+					voxelGrid.setVoxel(x, y, z, id);
+				}
+			}
+		}
+	}
+
+	// The level's entities are made in the same order every time, so they have the
+	// same IDs as when the game was saved. Entities that aren't in the save are gone.
+	std::unordered_map<int, Double3> savedPositions;
+	for (const EntityState &entity : snapshot.entities)
+	{
+		savedPositions.insert(std::make_pair(entity.id, entity.position));
+	}
+
+	EntityManager &entityManager = worldData.getEntityManager();
+	for (const Entity *entity : entityManager.getAllEntities())
+	{
+		const int id = entity->getID();
+		const auto positionIter = savedPositions.find(id);
+		if (positionIter != savedPositions.end())
+		{
+			entityManager.setPosition(id, positionIter->second);
+		}
+		else
+		{
+			renderer.removeFlat(id);
+			entityManager.remove(id);
+		}
+	}
+
+	for (const Int2 &voxel : snapshot.displayedTextTriggers)
+	{
+		WorldData::TextTrigger *trigger = worldData.getTextTrigger(voxel);
+		if (trigger != nullptr)
+		{
+			trigger->setPreviouslyDisplayed(true);
+		}
+	}
+
+	return gameData;
+}
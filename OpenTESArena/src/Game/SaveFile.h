@@ -0,0 +1,111 @@
+#ifndef SAVE_FILE_H
+#define SAVE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
+#include "../World/VoxelGrid.h"
+
+// Static class for saving and loading a game session.
+
+// A save file is a signature and format version, followed by tagged chunks: the player,
+// the date and time, the current level, its voxel edits, its entities, and its text
+// triggers. Each chunk has a size, so readers skip chunks they don't know about, and a
+// chunk is compressed if that makes it smaller. The last chunk has a hash of the rest
+// of the file, so a damaged or partly written save is never loaded.
+
+// The level itself isn't saved. It's rebuilt the same way it was first made (from its
+// .MIF file, or the test city), then the saved state is applied on top. Voxels are
+// saved as runs of IDs that differ from what the level was built with, which is
+// usually a tiny part of it.
+
+// Saving is split in two: a snapshot copies what's needed from the game data on the
+// main thread, and encoding and writing it can then happen on another thread (see
+// SaveWriter). Loading maps the file into memory and parses it in place.
+
+class GameData;
+class Renderer;
+class TextureManager;
+
+class SaveFile
+{
+public:
+	// Consecutive voxels (in the order of VoxelGrid::getVoxelIDs()) that differ from
+	// the level's original voxels.
+	struct VoxelRun
+	{
+		uint32_t index;
+		std::vector<VoxelGrid::VoxelID> ids;
+	};
+
+	struct EntityState
+	{
+		int id;
+		Double3 position;
+	};
+
+	// Everything in a save file, decoupled from the game data.
+	struct Snapshot
+	{
+		// Player.
+		std::string playerName, className;
+		int gender, raceID, portraitID, weaponType;
+		Double3 position, direction, velocity;
+		double maxWalkSpeed, maxRunSpeed;
+
+		// Date and time of day.
+		int era, year, month, day;
+		int hours, minutes, seconds;
+		double fractionOfSecond;
+
+		// Location and level (the .MIF name is empty for the test city).
+		std::string locationName, levelMIFName;
+		int provinceID, locationType, climateName, levelIndex;
+
+		// Voxel edits, entities, and displayed one-shot text triggers of the level.
+		int gridWidth, gridHeight, gridDepth;
+		std::vector<VoxelRun> voxelRuns;
+		std::vector<EntityState> entities;
+		std::vector<Int2> displayedTextTriggers;
+	};
+
+	// Newest format version. Older versions can still be read.
+	static const uint32_t VERSION;
+private:
+	static const std::string SIGNATURE;
+
+	SaveFile() = delete;
+	SaveFile(const SaveFile&) = delete;
+	~SaveFile() = delete;
+public:
+	// Gets the path of the autosave file in the preferences folder.
+	static std::string getAutosavePath();
+
+	// Copies the current game session into a snapshot.
+	static std::unique_ptr<Snapshot> makeSnapshot(GameData &gameData);
+
+	// Converts a snapshot to the bytes of a save file, optionally compressing chunks.
+	static std::vector<uint8_t> encode(const Snapshot &snapshot, bool compress);
+
+	// Parses the bytes of a save file. Returns null if they aren't a valid save.
+	static std::unique_ptr<Snapshot> decode(const uint8_t *data, size_t size);
+
+	// Encodes a snapshot and writes it to file, replacing any existing file only once
+	// the new one is complete. Returns whether it succeeded.
+	static bool write(const Snapshot &snapshot, const std::string &filename);
+
+	// Reads a save file. Returns null if it can't be read.
+	static std::unique_ptr<Snapshot> read(const std::string &filename);
+
+	// Rebuilds a game session from a snapshot. Returns null if its level can't be
+	// rebuilt. World rendering must be initialized beforehand.
+	static std::unique_ptr<GameData> load(const Snapshot &snapshot,
+		TextureManager &textureManager, Renderer &renderer);
+};
+
+#endif
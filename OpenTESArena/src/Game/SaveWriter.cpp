@@ -0,0 +1,78 @@
+#include "SaveWriter.h"
+
+SaveWriter::SaveWriter()
+{
+	this->writing = false;
+	this->quit = false;
+	this->thread = std::thread(&SaveWriter::workerProc, this);
+}
+
+SaveWriter::~SaveWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->quit = true;
+	}
+
+	this->requestCondition.notify_one();
+	this->thread.join();
+}
+
+void SaveWriter::workerProc()
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true)
+	{
+		this->requestCondition.wait(lock, [this]()
+		{
+			return this->quit || (this->pendingSnapshot.get() != nullptr);
+		});
+
+		// A waiting save is still written when quitting.
+		if (this->pendingSnapshot.get() == nullptr)
+		{
+			break;
+		}
+
+		std::unique_ptr<SaveFile::Snapshot> snapshot = std::move(this->pendingSnapshot);
+		const std::string filename = this->pendingFilename;
+		this->writing = true;
+
+		lock.unlock();
+		SaveFile::write(*snapshot.get(), filename);
+		lock.lock();
+
+		this->writing = false;
+		if (this->pendingSnapshot.get() == nullptr)
+		{
+			this->doneCondition.notify_all();
+		}
+	}
+}
+
+bool SaveWriter::isBusy() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->writing || (this->pendingSnapshot.get() != nullptr);
+}
+
+void SaveWriter::save(std::unique_ptr<SaveFile::Snapshot> snapshot,
+	const std::string &filename)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->pendingSnapshot = std::move(snapshot);
+		this->pendingFilename = filename;
+	}
+
+	this->requestCondition.notify_one();
+}
+
+void SaveWriter::wait()
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->doneCondition.wait(lock, [this]()
+	{
+		return !this->writing && (this->pendingSnapshot.get() == nullptr);
+	});
+}
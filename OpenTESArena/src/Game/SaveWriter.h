@@ -0,0 +1,49 @@
+#ifndef SAVE_WRITER_H
+#define SAVE_WRITER_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "SaveFile.h"
+
+// A save writer encodes and writes save files on its own thread, so saving (i.e., an
+// autosave) never stalls the game loop. The game loop only pays for the snapshot.
+
+// Only the newest save request is kept. If another one comes in while a save is being
+// written, it replaces any request still waiting, so a slow disk can't build up a
+// queue of outdated saves.
+
+class SaveWriter
+{
+private:
+	std::thread thread;
+	mutable std::mutex mutex;
+	std::condition_variable requestCondition, doneCondition;
+	std::unique_ptr<SaveFile::Snapshot> pendingSnapshot;
+	std::string pendingFilename;
+	bool writing, quit;
+
+	void workerProc();
+public:
+	SaveWriter();
+	SaveWriter(const SaveWriter&) = delete;
+
+	// Finishes any waiting save before returning.
+	~SaveWriter();
+
+	SaveWriter &operator=(const SaveWriter&) = delete;
+
+	// Returns whether a save is waiting or being written.
+	bool isBusy() const;
+
+	// Writes a snapshot to file in the background.
+	void save(std::unique_ptr<SaveFile::Snapshot> snapshot, const std::string &filename);
+
+	// Blocks until every requested save is written, i.e., before reading a save file.
+	void wait();
+};
+
+#endif
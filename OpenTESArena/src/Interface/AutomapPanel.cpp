@@ -11,6 +11,7 @@
 #include "GameWorldPanel.h"
 #include "RichTextString.h"
 #include "TextBox.h"
+#include "TextCache.h"
 #include "../Game/CardinalDirection.h"
 #include "../Game/CardinalDirectionName.h"
 #include "../Game/Game.h"
@@ -117,14 +118,11 @@ AutomapPanel::AutomapPanel(Game *game, const Double2 &playerPosition,
 		// Lambda for returning the Y coordinate of the highest non-air voxel in a column.
 		auto getYHitFloor = [&voxelGrid](int x, int z)
 		{
-			const char *voxels = voxelGrid.getVoxels();
+			const VoxelGrid::VoxelID *column = voxelGrid.getVoxels().getColumn(x, z);
 			for (int y = (voxelGrid.getHeight() - 1); y >= 0; --y)
 			{
-				const int index = x + (y * voxelGrid.getWidth()) +
-					(z * voxelGrid.getWidth() * voxelGrid.getHeight());
-
 				// If not air, then get the Y coordinate.
-				if (voxels[index] != 0)
+				if (column[y] != 0)
 				{
 					return y;
 				}
@@ -294,8 +292,8 @@ void AutomapPanel::handleMouse(double dt)
 
 void AutomapPanel::drawTooltip(const std::string &text, Renderer &renderer)
 {
-	const Texture tooltip(Panel::createTooltip(
-		text, FontName::D, this->getGame()->getFontManager(), renderer));
+	const Texture &tooltip = this->getGame()->getTextCache().getTooltip(
+		text, FontName::D, this->getGame()->getFontManager(), renderer);
 
 	const auto &inputManager = this->getGame()->getInputManager();
 	const Int2 mousePosition = inputManager.getMousePosition();
@@ -27,6 +27,7 @@
 #include "../Media/PaletteFile.h"
 #include "../Media/PaletteName.h"
 #include "../Media/PortraitFile.h"
+#include "../Media/PreloadGroup.h"
 #include "../Media/TextureFile.h"
 #include "../Media/TextureManager.h"
 #include "../Media/TextureName.h"
@@ -111,6 +112,9 @@ ChooseAttributesPanel::ChooseAttributesPanel(Game *game,
 
 		auto gameDataFunction = [this, charClass, name, gender, raceID](Game *game)
 		{
+			// The default world is a city.
+			game->getTextureManager().setRecordingGroup(PreloadGroup::City);
+
 			// Initialize 3D renderer.
 			auto &renderer = game->getRenderer();
 			const bool fullGameWindow =
@@ -10,6 +10,7 @@
 #include "RichTextString.h"
 #include "TextAlignment.h"
 #include "TextBox.h"
+#include "TextCache.h"
 #include "../Assets/ExeStrings.h"
 #include "../Assets/TextAssets.h"
 #include "../Game/Game.h"
@@ -169,8 +170,8 @@ void ChooseClassCreationPanel::handleEvent(const SDL_Event &e)
 
 void ChooseClassCreationPanel::drawTooltip(const std::string &text, Renderer &renderer)
 {
-	const Texture tooltip(Panel::createTooltip(
-		text, FontName::D, this->getGame()->getFontManager(), renderer));
+	const Texture &tooltip = this->getGame()->getTextCache().getTooltip(
+		text, FontName::D, this->getGame()->getFontManager(), renderer);
 
 	const auto &inputManager = this->getGame()->getInputManager();
 	const Int2 mousePosition = inputManager.getMousePosition();
@@ -12,6 +12,7 @@
 #include "RichTextString.h"
 #include "TextAlignment.h"
 #include "TextBox.h"
+#include "TextCache.h"
 #include "../Assets/ExeStrings.h"
 #include "../Assets/TextAssets.h"
 #include "../Entities/CharacterClassCategory.h"
@@ -86,10 +87,9 @@ ChooseClassPanel::ChooseClassPanel(Game *game)
 			y,
 			Color(85, 44, 20),
 			elements,
-			FontName::A,
-			maxDisplayed,
-			game->getFontManager(),
-			game->getRenderer()));
+			game->getTextCache().getFontAtlas(
+				FontName::A, game->getFontManager(), game->getRenderer()),
+			maxDisplayed));
 	}();
 
 	this->backToClassCreationButton = []()
@@ -435,9 +435,7 @@ void ChooseClassPanel::render(Renderer &renderer)
 	// Draw text: title, list.
 	renderer.drawToOriginal(this->titleTextBox->getTexture(),
 		this->titleTextBox->getX(), this->titleTextBox->getY());
-	renderer.drawToOriginal(this->classesListBox->getTexture(),
-		this->classesListBox->getPoint().x,
-		this->classesListBox->getPoint().y);
+	this->classesListBox->render(renderer);
 
 	// Draw tooltip if over a valid element in the list box.
 	const auto &inputManager = this->getGame()->getInputManager();
@@ -174,9 +174,9 @@ void ChooseNamePanel::handleEvent(const SDL_Event &e)
 
 	if (e.type == SDL_KEYDOWN)
 	{
-		const uint8_t *keys = SDL_GetKeyboardState(nullptr);
 		const SDL_Keycode keyCode = e.key.keysym.sym;
-		bool shiftPressed = keys[SDL_SCANCODE_LSHIFT] || keys[SDL_SCANCODE_RSHIFT];
+		bool shiftPressed = inputManager.keyIsDown(SDL_SCANCODE_LSHIFT) ||
+			inputManager.keyIsDown(SDL_SCANCODE_RSHIFT);
 
 		// See if the pressed key is a recognized letter.
 		if (letters.find(keyCode) != letters.end())
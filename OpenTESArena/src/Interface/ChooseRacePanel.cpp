@@ -9,6 +9,7 @@
 #include "CursorAlignment.h"
 #include "RichTextString.h"
 #include "TextAlignment.h"
+#include "TextCache.h"
 #include "TextSubPanel.h"
 #include "../Assets/ExeStrings.h"
 #include "../Assets/TextAssets.h"
@@ -191,8 +192,8 @@ void ChooseRacePanel::drawProvinceTooltip(int provinceID, Renderer &renderer)
 	const std::string &raceName = this->getGame()->getTextAssets().getAExeStrings().getList(
 		ExeStringKey::RaceNamesPlural).at(provinceID);
 	
-	const Texture tooltip(Panel::createTooltip(
-		"Land of the " + raceName, FontName::D, this->getGame()->getFontManager(), renderer));
+	const Texture &tooltip = this->getGame()->getTextCache().getTooltip(
+		"Land of the " + raceName, FontName::D, this->getGame()->getFontManager(), renderer);
 
 	const auto &inputManager = this->getGame()->getInputManager();
 	const Int2 mousePosition = inputManager.getMousePosition();
@@ -4,10 +4,12 @@
 
 #include "CinematicPanel.h"
 
+#include "../Assets/FLCFile.h"
 #include "../Game/Game.h"
 #include "../Media/TextureManager.h"
 #include "../Rendering/Renderer.h"
 #include "../Rendering/Texture.h"
+#include "../Utilities/String.h"
 
 CinematicPanel::CinematicPanel(Game *game,
 	const std::string &paletteName, const std::string &sequenceName,
@@ -19,9 +21,27 @@ CinematicPanel::CinematicPanel(Game *game,
 		return std::unique_ptr<Button<Game*>>(new Button<Game*>(endingAction));
 	}();
 
+	// FLC and CEL files are decoded on demand into a streaming texture. Other
+	// sequences still go through the texture manager.
+	const std::string extension = String::getExtension(sequenceName);
+	if ((extension == ".FLC") || (extension == ".CEL"))
+	{
+		this->flcFile = std::unique_ptr<FLCFile>(new FLCFile(sequenceName));
+
+		SDL_Texture *texture = game->getRenderer().createTexture(
+			Renderer::DEFAULT_PIXELFORMAT, SDL_TEXTUREACCESS_STREAMING,
+			this->flcFile->getWidth(), this->flcFile->getHeight());
+		this->streamTexture = Texture(texture);
+	}
+
 	this->secondsPerImage = secondsPerImage;
 	this->currentSeconds = 0.0;
 	this->imageIndex = 0;
+
+	if (this->flcFile != nullptr)
+	{
+		this->updateStreamTexture();
+	}
 }
 
 CinematicPanel::~CinematicPanel()
@@ -29,6 +49,36 @@ CinematicPanel::~CinematicPanel()
 
 }
 
+void CinematicPanel::updateStreamTexture()
+{
+	assert(this->flcFile != nullptr);
+
+	// Delta frames depend on the previous frame, so every frame up to the current
+	// one has to be decoded even if some are never shown.
+	bool frameChanged = false;
+	while (this->flcFile->getFrameIndex() < this->imageIndex)
+	{
+		if (!this->flcFile->readNextFrame())
+		{
+			break;
+		}
+
+		frameChanged = true;
+	}
+
+	if (frameChanged)
+	{
+		void *pixels;
+		int pitch;
+		if (SDL_LockTexture(this->streamTexture.get(), nullptr, &pixels, &pitch) == 0)
+		{
+			this->flcFile->writePixels(static_cast<uint32_t*>(pixels),
+				pitch / static_cast<int>(sizeof(uint32_t)));
+			SDL_UnlockTexture(this->streamTexture.get());
+		}
+	}
+}
+
 void CinematicPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame()->getInputManager();
@@ -56,17 +106,33 @@ void CinematicPanel::tick(double dt)
 		this->imageIndex++;
 	}
 
-	// Get a reference to all images in the sequence.
-	auto &textureManager = this->getGame()->getTextureManager();
-	const auto &textures = textureManager.getTextures(
-		this->sequenceName, this->paletteName);
+	// Get the number of images in the sequence.
+	const int imageCount = [this]()
+	{
+		if (this->flcFile != nullptr)
+		{
+			return this->flcFile->getFrameCount();
+		}
+		else
+		{
+			auto &textureManager = this->getGame()->getTextureManager();
+			const auto &textures = textureManager.getTextures(
+				this->sequenceName, this->paletteName);
+			return static_cast<int>(textures.size());
+		}
+	}();
 
 	// If at the end, then prepare for the next panel.
-	if (this->imageIndex >= textures.size())
+	if (this->imageIndex >= imageCount)
 	{
-		this->imageIndex = static_cast<int>(textures.size() - 1);
+		this->imageIndex = imageCount - 1;
 		this->skipButton->click(this->getGame());
 	}
+
+	if (this->flcFile != nullptr)
+	{
+		this->updateStreamTexture();
+	}
 }
 
 void CinematicPanel::render(Renderer &renderer)
@@ -75,14 +141,21 @@ void CinematicPanel::render(Renderer &renderer)
 	renderer.clearNative();
 	renderer.clearOriginal();
 
-	// Get a reference to all images in the sequence.
-	auto &textureManager = this->getGame()->getTextureManager();
-	const auto &textures = textureManager.getTextures(
-		this->sequenceName, this->paletteName);
-
 	// Draw image.
-	const auto &texture = textures.at(this->imageIndex);
-	renderer.drawToOriginal(texture.get());
+	if (this->flcFile != nullptr)
+	{
+		renderer.drawToOriginal(this->streamTexture.get());
+	}
+	else
+	{
+		// Get a reference to all images in the sequence.
+		auto &textureManager = this->getGame()->getTextureManager();
+		const auto &textures = textureManager.getTextures(
+			this->sequenceName, this->paletteName);
+
+		const auto &texture = textures.at(this->imageIndex);
+		renderer.drawToOriginal(texture.get());
+	}
 
 	// Scale the original frame buffer onto the native one.
 	renderer.drawOriginalToNative();
@@ -2,14 +2,21 @@
 #define CINEMATIC_PANEL_H
 
 #include <functional>
+#include <memory>
 #include <string>
 
 #include "Button.h"
 #include "Panel.h"
+#include "../Rendering/Texture.h"
 
 // Designed for sets of images (i.e., videos) that play one after another and
 // eventually lead to another panel. Skipping is available, too.
 
+// FLC and CEL sequences are streamed: each frame is decoded when the panel reaches
+// it and is uploaded into one reusable texture, instead of the whole video being
+// loaded into the texture manager up front.
+
+class FLCFile;
 class Game;
 class Renderer;
 
@@ -17,10 +24,16 @@ class CinematicPanel : public Panel
 {
 private:
 	std::unique_ptr<Button<Game*>> skipButton;
+	std::unique_ptr<FLCFile> flcFile; // Null if not streaming.
+	Texture streamTexture;
 	std::string paletteName;
 	std::string sequenceName;
 	double secondsPerImage, currentSeconds;
 	int imageIndex;
+
+	// Decodes FLC frames up to the current image index and uploads the newest one
+	// to the stream texture.
+	void updateStreamTexture();
 public:
 	CinematicPanel(Game *game, const std::string &paletteName,
 		const std::string &sequenceName, double secondsPerImage,
@@ -12,8 +12,10 @@
 #include "LogbookPanel.h"
 #include "PauseMenuPanel.h"
 #include "RichTextString.h"
+#include "StreamingTextBox.h"
 #include "TextAlignment.h"
 #include "TextBox.h"
+#include "TextCache.h"
 #include "TextSubPanel.h"
 #include "WorldMapPanel.h"
 #include "../Assets/CIFFile.h"
@@ -28,6 +30,8 @@
 #include "../Game/Game.h"
 #include "../Game/Options.h"
 #include "../Game/PlayerInterface.h"
+#include "../Game/SaveFile.h"
+#include "../Game/SaveWriter.h"
 #include "../Math/Constants.h"
 #include "../Math/Random.h"
 #include "../Math/Vector2.h"
@@ -41,11 +45,11 @@
 #include "../Media/PortraitFile.h"
 #include "../Media/SoundFile.h"
 #include "../Media/SoundName.h"
+#include "../Media/SoundPriority.h"
 #include "../Media/TextureFile.h"
 #include "../Media/TextureManager.h"
 #include "../Media/TextureName.h"
 #include "../Rendering/Renderer.h"
-#include "../Rendering/Surface.h"
 #include "../Rendering/Texture.h"
 #include "../Utilities/Debug.h"
 #include "../Utilities/String.h"
@@ -66,6 +70,13 @@ namespace
 	const Rect BottomRightRegion(179, 119, 141, 28);
 	const Rect UiBottomRegion(0, 147, 320, 53);
 
+	// Seconds of play between autosaves.
+	const double AutosaveInterval = 60.0;
+
+	// Size of the visible part of the compass slider.
+	const int CompassSliderWidth = 32;
+	const int CompassSliderHeight = 7;
+
 	// Arrow cursor alignments. These offset the drawn cursor relative to the mouse 
 	// position so the cursor's click area is closer to the tip of each arrow, as is 
 	// done in the original game (slightly differently, though. I think the middle 
@@ -89,6 +100,12 @@ GameWorldPanel::GameWorldPanel(Game *game)
 {
 	assert(game->gameDataIsActive());
 
+	this->autosaveTimer = AutosaveInterval;
+	this->hudCompassOffset = 0;
+	this->hudPortraitID = 0;
+	this->hudClassic = false;
+	this->hudCanCastMagic = false;
+
 	this->playerNameTextBox = [game]()
 	{
 		const int x = 17;
@@ -105,6 +122,9 @@ GameWorldPanel::GameWorldPanel(Game *game)
 			x, y, richText, game->getRenderer()));
 	}();
 
+	this->debugTextBox = std::unique_ptr<StreamingTextBox>(
+		new StreamingTextBox(2, 2, FontName::D, Color::White));
+
 	this->characterSheetButton = []()
 	{
 		auto function = [](Game *game)
@@ -381,6 +401,36 @@ GameWorldPanel::GameWorldPanel(Game *game)
 	const Int2 screenDims = game->getRenderer().getWindowDimensions();
 	this->updateCursorRegions(screenDims.x, screenDims.y);
 
+	// Keep the interface images resident, since they're drawn every frame and
+	// shouldn't be evicted when the world's textures fill the texture budget.
+	auto &textureManager = game->getTextureManager();
+	const std::vector<TextureName> interfaceTextureNames =
+	{
+		TextureName::ArrowCursors,
+		TextureName::CompassFrame,
+		TextureName::CompassSlider,
+		TextureName::GameWorldInterface,
+		TextureName::NoSpell,
+		TextureName::StatusGradients,
+		TextureName::SwordCursor
+	};
+
+	for (const auto textureName : interfaceTextureNames)
+	{
+		textureManager.setPinned(TextureFile::fromName(textureName), true);
+	}
+
+	// Start decoding the sounds the player can trigger, so they're ready by the time
+	// they're needed.
+	auto &audioManager = game->getAudioManager();
+	audioManager.preloadSound(SoundFile::fromName(SoundName::Swish));
+
+	const auto &soundTriggers = game->getGameData().getWorldData().getSoundTriggers();
+	for (const auto &pair : soundTriggers)
+	{
+		audioManager.preloadSound(pair.second);
+	}
+
 	// Load all the weapon offsets for the player's currently equipped weapon. If the
 	// player can ever change weapons in-game (i.e., with a hotkey), then this will
 	// need to be moved into update() instead.
@@ -548,6 +598,9 @@ void GameWorldPanel::resize(int windowWidth, int windowHeight)
 {
 	// Update the cursor's regions for camera motion.
 	this->updateCursorRegions(windowWidth, windowHeight);
+
+	// Redraw the HUD layer next frame, in case its render target lost its contents.
+	this->hudTexture = Texture();
 }
 
 void GameWorldPanel::handlePlayerTurning(double dt, const Int2 &mouseDelta)
@@ -1002,7 +1055,8 @@ void GameWorldPanel::handlePlayerAttack(const Int2 &mouseDelta)
 
 			// Play the swing sound.
 			auto &audioManager = this->getGame()->getAudioManager();
-			audioManager.playSound(SoundFile::fromName(SoundName::Swish));
+			audioManager.playSound(SoundFile::fromName(SoundName::Swish),
+				SoundPriority::High);
 		}
 	}	
 }
@@ -1060,16 +1114,122 @@ void GameWorldPanel::handleTriggers(const Int2 &voxel)
 	const std::string *soundTrigger = worldData.getSoundTrigger(voxel);
 	if (soundTrigger != nullptr)
 	{
-		// Play the sound.
+		// Play the sound from the middle of the voxel, at the player's height.
+		const double playerY = game.getGameData().getPlayer().getPosition().y;
+		const Double3 soundPosition(
+			static_cast<double>(voxel.x) + 0.50,
+			playerY,
+			static_cast<double>(voxel.y) + 0.50);
+
 		auto &audioManager = game.getAudioManager();
-		audioManager.playSound(*soundTrigger);
+		audioManager.playSound(*soundTrigger, SoundPriority::Normal, soundPosition);
 	}
 }
 
+void GameWorldPanel::updateHudTexture(int compassOffset, Renderer &renderer)
+{
+	auto &game = *this->getGame();
+	const auto &player = game.getGameData().getPlayer();
+	const bool classic = game.getOptions().getPlayerInterface() == PlayerInterface::Classic;
+	const std::string headsFilename = PortraitFile::getHeads(
+		player.getGenderName(), player.getRaceID(), true);
+	const int portraitID = player.getPortraitID();
+	const bool canCastMagic = player.getCharacterClass().canCastMagic();
+
+	// Nothing to do if the layer already shows the same things.
+	if ((this->hudTexture.get() != nullptr) &&
+		(compassOffset == this->hudCompassOffset) &&
+		(classic == this->hudClassic) &&
+		(portraitID == this->hudPortraitID) &&
+		(canCastMagic == this->hudCanCastMagic) &&
+		(headsFilename == this->hudPortraitFilename))
+	{
+		return;
+	}
+
+	this->hudCompassOffset = compassOffset;
+	this->hudClassic = classic;
+	this->hudPortraitID = portraitID;
+	this->hudCanCastMagic = canCastMagic;
+	this->hudPortraitFilename = headsFilename;
+
+	if (this->hudTexture.get() == nullptr)
+	{
+		SDL_Texture *texture = renderer.createTexture(Renderer::DEFAULT_PIXELFORMAT,
+			SDL_TEXTUREACCESS_TARGET, Renderer::ORIGINAL_WIDTH, Renderer::ORIGINAL_HEIGHT);
+		DebugAssert(texture != nullptr, "Could not create HUD texture.");
+
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+		this->hudTexture = Texture(texture);
+	}
+
+	// Draw into the layer with the usual original frame buffer methods. The interface
+	// images are either opaque or fully transparent per pixel, so drawing them onto a
+	// transparent layer first doesn't change how they look.
+	renderer.setOriginalTarget(this->hudTexture.get());
+	renderer.clearOriginal();
+
+	// Draw the visible part of the compass slider straight from its texture. The part
+	// past the end of the slider (if any) is left transparent.
+	auto &textureManager = game.getTextureManager();
+	const auto &compassSlider = textureManager.getTexture(
+		TextureFile::fromName(TextureName::CompassSlider));
+
+	Renderer::TextureQuad sliderQuad;
+	sliderQuad.srcX = compassOffset;
+	sliderQuad.srcY = 0;
+	sliderQuad.dstX = 0;
+	sliderQuad.dstY = 0;
+	sliderQuad.width = std::min(CompassSliderWidth, compassSlider.getWidth() - compassOffset);
+	sliderQuad.height = CompassSliderHeight;
+
+	// The slider sits one slider height below the top of the screen.
+	renderer.drawQuadsToOriginal(compassSlider.get(),
+		std::vector<Renderer::TextureQuad> { sliderQuad },
+		(Renderer::ORIGINAL_WIDTH / 2) - (CompassSliderWidth / 2),
+		CompassSliderHeight, Color::White);
+
+	// Draw compass frame over the headings.
+	const auto &compassFrame = textureManager.getTexture(
+		TextureFile::fromName(TextureName::CompassFrame));
+	renderer.drawToOriginal(compassFrame.get(),
+		(Renderer::ORIGINAL_WIDTH / 2) - (compassFrame.getWidth() / 2), 0);
+
+	if (classic)
+	{
+		// Draw game world interface.
+		const auto &gameInterface = textureManager.getTexture(
+			TextureFile::fromName(TextureName::GameWorldInterface));
+		renderer.drawToOriginal(gameInterface.get(), 0,
+			Renderer::ORIGINAL_HEIGHT - gameInterface.getHeight());
+
+		// Draw player portrait.
+		const auto &portrait = textureManager.getTextures(headsFilename).at(portraitID);
+		const auto &status = textureManager.getTextures(
+			TextureFile::fromName(TextureName::StatusGradients)).at(0);
+		renderer.drawToOriginal(status.get(), 14, 166);
+		renderer.drawToOriginal(portrait.get(), 14, 166);
+
+		// If the player's class can't use magic, show the darkened spell icon.
+		if (!canCastMagic)
+		{
+			const auto &nonMagicIcon = textureManager.getTexture(
+				TextureFile::fromName(TextureName::NoSpell));
+			renderer.drawToOriginal(nonMagicIcon.get(), 91, 177);
+		}
+
+		// Draw text: player name.
+		renderer.drawToOriginal(this->playerNameTextBox->getTexture(),
+			this->playerNameTextBox->getX(), this->playerNameTextBox->getY());
+	}
+
+	renderer.setOriginalTarget(nullptr);
+}
+
 void GameWorldPanel::drawTooltip(const std::string &text, Renderer &renderer)
 {
-	const Texture tooltip(Panel::createTooltip(
-		text, FontName::D, this->getGame()->getFontManager(), renderer));
+	const Texture &tooltip = this->getGame()->getTextCache().getTooltip(
+		text, FontName::D, this->getGame()->getFontManager(), renderer);
 
 	auto &textureManager = this->getGame()->getTextureManager();
 	const auto &gameInterface = textureManager.getTexture(
@@ -1090,9 +1250,8 @@ void GameWorldPanel::drawDebugText(Renderer &renderer)
 	const auto &player = gameData.getPlayer();
 	const Double3 &position = player.getPosition();
 	const Double3 &direction = player.getDirection();
-
-	const int x = 2;
-	const int y = 2;
+	const auto &textureStats = game.getTextureManager().getStats();
+	const auto &audioStats = this->getGame()->getAudioManager().getStats();
 
 	const std::string text =
 		"Screen: " + std::to_string(windowDims.x) + "x" + std::to_string(windowDims.y) + "\n" +
@@ -1103,18 +1262,23 @@ void GameWorldPanel::drawDebugText(Renderer &renderer)
 		"Z: " + String::fixedPrecision(position.z, 5) + "\n" +
 		"DirX: " + String::fixedPrecision(direction.x, 5) + "\n" +
 		"DirY: " + String::fixedPrecision(direction.y, 5) + "\n" +
-		"DirZ: " + String::fixedPrecision(direction.z, 5);
-
-	const RichTextString richText(
-		text,
-		FontName::D,
-		Color::White,
-		TextAlignment::Left,
-		game.getFontManager());
-
-	TextBox tempText(x, y, richText, renderer);
-
-	renderer.drawToOriginal(tempText.getTexture(), tempText.getX(), tempText.getY());
+		"DirZ: " + String::fixedPrecision(direction.z, 5) + "\n" +
+		"Textures: " + std::to_string(textureStats.residentBytes / (1024 * 1024)) + "/" +
+		std::to_string(textureStats.budgetBytes / (1024 * 1024)) + "MB (" +
+		String::fixedPrecision(textureStats.getHitRate(), 1) + "% hits)\n" +
+		"Sounds: " + std::to_string(audioStats.activeVoices + audioStats.mixerVoices) +
+		" playing, " +
+		std::to_string(audioStats.droppedSounds) + " dropped, " +
+		String::fixedPrecision(audioStats.getAverageLatencyMS(), 1) + "ms load\n" +
+		"Music: " + std::to_string(audioStats.musicQueuedBuffers) + "/" +
+		std::to_string(audioStats.musicTargetBuffers) + " buffers, " +
+		std::to_string(audioStats.musicUnderruns) + " underruns";
+
+	// Most of the text changes every frame, so it's drawn into the same texture each
+	// time instead of making a new text box.
+	this->debugTextBox->setText(text, game.getFontManager(), renderer);
+	renderer.drawToOriginal(this->debugTextBox->getTexture().get(),
+		this->debugTextBox->getX(), this->debugTextBox->getY());
 }
 
 void GameWorldPanel::updateCursorRegions(int width, int height)
@@ -1198,23 +1362,44 @@ void GameWorldPanel::tick(double dt)
 
 	auto &worldData = gameData.getWorldData();
 
-	// Update entities and their state in the renderer.
+	// Hear positional sounds from where the player is now.
+	game.getAudioManager().setListener(player.getPosition(), player.getDirection());
+
+	// Animate all entities across the job system's threads. This phase only writes to
+	// the entities' own state, and the renderer is updated from it afterwards.
 	auto &entityManager = worldData.getEntityManager();
-	for (auto *entity : entityManager.getAllEntities())
+	entityManager.tick(dt, game.getJobSystem());
+
+	// Update entity flat properties for rendering. Only update the flat's direction
+	// if they face the player each frame (like a sprite).
+	auto &renderer = game.getRenderer();
+	const Double2 direction = -player.getGroundDirection();
+	for (const auto &group : entityManager.getGroups())
 	{
-		// Tick entity state.
-		entity->tick(game, dt);
-
-		// Update entity flat properties for rendering. Only update the flat's direction
-		// if they face the player each frame (like a sprite).
-		auto &renderer = game.getRenderer();
-		const Double3 position = entity->getPosition();
-		const Double2 direction = -player.getGroundDirection();
-		const int textureID = entity->getTextureID();
-		const bool flipped = entity->getFlipped();
-		renderer.updateFlat(entity->getID(), &position,
-			entity->facesPlayer() ? &direction : nullptr, nullptr, nullptr,
-			&textureID, &flipped);
+		for (int i = 0; i < group.getCount(); i++)
+		{
+			const Double3 &position = group.positions[i];
+			const int textureID = group.textureIDs[i];
+			const bool flipped = group.flipped[i];
+			renderer.updateFlat(group.ids[i], &position,
+				group.entities[i]->facesPlayer() ? &direction : nullptr, nullptr, nullptr,
+				&textureID, &flipped);
+		}
+	}
+
+	// Autosave now and then. Only the snapshot is taken here; it's encoded and written
+	// on the save writer's thread. If the last autosave is still being written, this
+	// one is skipped.
+	this->autosaveTimer -= dt;
+	if (this->autosaveTimer <= 0.0)
+	{
+		this->autosaveTimer = AutosaveInterval;
+
+		auto &saveWriter = game.getSaveWriter();
+		if (!saveWriter.isBusy())
+		{
+			saveWriter.save(SaveFile::makeSnapshot(gameData), SaveFile::getAutosavePath());
+		}
 	}
 }
 
@@ -1263,48 +1448,22 @@ void GameWorldPanel::render(Renderer &renderer)
 			(Renderer::ORIGINAL_HEIGHT - weaponTexture.getHeight()));
 	}
 
-	// Draw compass slider based on player direction. +X is north, +Z is east.
-	auto *compassSlider = textureManager.getSurface(
-		TextureFile::fromName(TextureName::CompassSlider));
+	// Get the compass slider offset from the player's direction. +X is north, +Z
+	// is east.
 	const Double2 groundDirection = player.getGroundDirection();
 
-	Texture compassSliderSegment = [&renderer, &compassSlider, &groundDirection]()
-	{
-		SDL_Surface *segmentTemp = Surface::createSurfaceWithFormat(32, 7,
-			Renderer::DEFAULT_BPP, Renderer::DEFAULT_PIXELFORMAT);
-
-		// Angle between 0 and 2 pi.
-		const double angle = std::atan2(groundDirection.y, groundDirection.x);
-
-		// Offset in the "slider" texture. Due to how SLIDER.IMG is drawn, there's a 
-		// small "pop-in" when turning from N to NE, because N is drawn in two places, 
-		// but the second place (offset == 256) has tick marks where "NE" should be.
-		const int xOffset = static_cast<int>(240.0 +
-			std::round(256.0 * (angle / (2.0 * PI)))) % 256;
-
-		SDL_Rect clipRect;
-		clipRect.x = xOffset;
-		clipRect.y = 0;
-		clipRect.w = segmentTemp->w;
-		clipRect.h = segmentTemp->h;
-
-		SDL_BlitSurface(compassSlider, &clipRect, segmentTemp, nullptr);
-
-		SDL_Texture *segment = renderer.createTextureFromSurface(segmentTemp);
-		SDL_FreeSurface(segmentTemp);
-
-		return Texture(segment);
-	}();
+	// Angle between 0 and 2 pi.
+	const double angle = std::atan2(groundDirection.y, groundDirection.x);
 
-	renderer.drawToOriginal(compassSliderSegment.get(),
-		(Renderer::ORIGINAL_WIDTH / 2) - (compassSliderSegment.getWidth() / 2),
-		compassSliderSegment.getHeight());
+	// Offset in the "slider" texture. Due to how SLIDER.IMG is drawn, there's a 
+	// small "pop-in" when turning from N to NE, because N is drawn in two places, 
+	// but the second place (offset == 256) has tick marks where "NE" should be.
+	const int compassOffset = static_cast<int>(240.0 +
+		std::round(256.0 * (angle / (2.0 * PI)))) % 256;
 
-	// Draw compass frame over the headings.
-	const auto &compassFrame = textureManager.getTexture(
-		TextureFile::fromName(TextureName::CompassFrame));
-	renderer.drawToOriginal(compassFrame.get(),
-		(Renderer::ORIGINAL_WIDTH / 2) - (compassFrame.getWidth() / 2), 0);
+	// Draw the compass and (in classic mode) the game world interface.
+	this->updateHudTexture(compassOffset, renderer);
+	renderer.drawToOriginal(this->hudTexture.get());
 
 	const auto &inputManager = this->getGame()->getInputManager();
 	const Int2 mousePosition = inputManager.getMousePosition();
@@ -1312,34 +1471,6 @@ void GameWorldPanel::render(Renderer &renderer)
 	// Continue drawing more interface objects if in classic mode.
 	if (playerInterface == PlayerInterface::Classic)
 	{
-		// Draw game world interface.
-		const auto &gameInterface = textureManager.getTexture(
-			TextureFile::fromName(TextureName::GameWorldInterface));
-		renderer.drawToOriginal(gameInterface.get(), 0,
-			Renderer::ORIGINAL_HEIGHT - gameInterface.getHeight());
-
-		// Draw player portrait.
-		const auto &headsFilename = PortraitFile::getHeads(
-			player.getGenderName(), player.getRaceID(), true);
-		const auto &portrait = textureManager.getTextures(headsFilename)
-			.at(player.getPortraitID());
-		const auto &status = textureManager.getTextures(
-			TextureFile::fromName(TextureName::StatusGradients)).at(0);
-		renderer.drawToOriginal(status.get(), 14, 166);
-		renderer.drawToOriginal(portrait.get(), 14, 166);
-
-		// If the player's class can't use magic, show the darkened spell icon.
-		if (!player.getCharacterClass().canCastMagic())
-		{
-			const auto &nonMagicIcon = textureManager.getTexture(
-				TextureFile::fromName(TextureName::NoSpell));
-			renderer.drawToOriginal(nonMagicIcon.get(), 91, 177);
-		}
-
-		// Draw text: player name.
-		renderer.drawToOriginal(this->playerNameTextBox->getTexture(),
-			this->playerNameTextBox->getX(), this->playerNameTextBox->getY());
-
 		// Check if the mouse is over one of the buttons for tooltips.
 		const Int2 originalPosition = renderer.nativePointToOriginal(mousePosition);
 
@@ -2,11 +2,13 @@
 #define GAME_WORLD_PANEL_H
 
 #include <array>
+#include <string>
 #include <vector>
 
 #include "Button.h"
 #include "Panel.h"
 #include "../Math/Rect.h"
+#include "../Rendering/Texture.h"
 
 // When the GameWorldPanel is active, the game world is ticking.
 
@@ -16,12 +18,14 @@
 
 class Player;
 class Renderer;
+class StreamingTextBox;
 class TextBox;
 
 class GameWorldPanel : public Panel
 {
 private:
 	std::unique_ptr<TextBox> playerNameTextBox;
+	std::unique_ptr<StreamingTextBox> debugTextBox; // Redrawn only when its text changes.
 	std::unique_ptr<Button<Game*>> characterSheetButton, statusButton,
 		logbookButton, pauseButton;
 	std::unique_ptr<Button<Player&>> drawWeaponButton;
@@ -31,6 +35,14 @@ private:
 	std::array<Rect, 9> nativeCursorRegions;
 	std::vector<Int2> weaponOffsets;
 	std::pair<double, std::unique_ptr<TextBox>> triggeredText; // Time remaining + text box.
+	double autosaveTimer; // Time remaining until the next autosave.
+
+	// The compass and classic interface (status, portrait, etc.) are drawn into one
+	// layer that's only redrawn when what it shows changes. It's null until drawn.
+	Texture hudTexture;
+	std::string hudPortraitFilename;
+	int hudCompassOffset, hudPortraitID;
+	bool hudClassic, hudCanCastMagic;
 
 	// Modifies the values in the native cursor regions array so rectangles in
 	// the current window correctly represent regions for different arrow cursors.
@@ -50,6 +62,9 @@ private:
 	// sound events.
 	void handleTriggers(const Int2 &voxel);
 
+	// Redraws the HUD layer if the compass heading or anything else in it changed.
+	void updateHudTexture(int compassOffset, Renderer &renderer);
+
 	// Draws a tooltip sitting on the top left of the game interface.
 	void drawTooltip(const std::string &text, Renderer &renderer);
 
@@ -1,10 +1,10 @@
 #ifndef LIST_BOX_H
 #define LIST_BOX_H
 
-#include <memory>
 #include <string>
 #include <vector>
 
+#include "TextLayout.h"
 #include "../Math/Vector2.h"
 #include "../Media/Color.h"
 
@@ -12,35 +12,30 @@
 // box can be obtained, and the list can be scrolled up and down. A list box is
 // intended to only be left-aligned.
 
+// Elements are text layouts drawn straight from a font atlas, so a list box has no
+// surfaces or textures of its own, and scrolling doesn't redraw anything.
+
 // Though the index of a selected item can be obtained, this class is not intended
 // for holding data about those selected items. It is simply a view for the text.
 
-class FontManager;
+class FontAtlas;
 class Renderer;
-class TextBox;
-
-enum class FontName;
-
-struct SDL_Surface;
-struct SDL_Texture;
 
 class ListBox
 {
 private:
-	std::vector<std::unique_ptr<TextBox>> textBoxes;
+	std::vector<TextLayout> textLayouts;
+	const FontAtlas &fontAtlas;
 	Color textColor;
 	Int2 point;
-	FontName fontName;
-	SDL_Surface *clearSurface; // For clearing the texture upon updating.
-	SDL_Texture *texture;
+	int width; // Width of the longest element.
+	int maxDisplayed;
 	int scrollIndex;
 	int characterHeight;
-
-	// Updates the texture to show the currently visible text boxes.
-	void updateDisplay();
 public:
+	// The font atlas must outlive the list box (i.e., one from the text cache).
 	ListBox(int x, int y, const Color &textColor, const std::vector<std::string> &elements, 
-		FontName fontName, int maxDisplayed, FontManager &fontManager, Renderer &renderer);
+		const FontAtlas &fontAtlas, int maxDisplayed);
 	~ListBox();
 
 	// Gets the index of the top-most displayed element.
@@ -55,8 +50,6 @@ public:
 	// Gets the top left corner of the list box.
 	const Int2 &getPoint() const;
 
-	// Gets the texture for drawing to the screen.
-	SDL_Texture *getTexture() const;
 
 	// Returns whether the given point is within the bounds of the list box.
 	bool contains(const Int2 &point);
@@ -73,6 +66,9 @@ public:
 	// it can keep scrolling down for a really long time.
 	void scrollDown();
 
+	// Draws the displayed elements to the original frame buffer.
+	void render(Renderer &renderer) const;
+
 	// Instead of a remove() method, just recreate the list box.
 };
 
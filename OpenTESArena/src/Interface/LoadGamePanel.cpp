@@ -5,12 +5,19 @@
 #include "LoadGamePanel.h"
 
 #include "CursorAlignment.h"
+#include "GameWorldPanel.h"
 #include "MainMenuPanel.h"
 #include "PauseMenuPanel.h"
+#include "RichTextString.h"
 #include "TextAlignment.h"
 #include "TextBox.h"
+#include "TextSubPanel.h"
 #include "../Game/Game.h"
+#include "../Game/GameData.h"
 #include "../Game/Options.h"
+#include "../Game/PlayerInterface.h"
+#include "../Game/SaveFile.h"
+#include "../Game/SaveWriter.h"
 #include "../Math/Vector2.h"
 #include "../Media/Color.h"
 #include "../Media/FontManager.h"
@@ -18,11 +25,51 @@
 #include "../Media/MusicName.h"
 #include "../Media/PaletteFile.h"
 #include "../Media/PaletteName.h"
+#include "../Media/PreloadGroup.h"
 #include "../Media/TextureFile.h"
 #include "../Media/TextureManager.h"
 #include "../Media/TextureName.h"
 #include "../Rendering/Renderer.h"
 #include "../Rendering/Texture.h"
+#include "../Utilities/Debug.h"
+
+namespace
+{
+	// Area of the first slot on the slots background. Only the autosave can be loaded
+	// for now, and it's listed there.
+	const int AutosaveSlotX = 13;
+	const int AutosaveSlotY = 5;
+	const int AutosaveSlotWidth = 294;
+	const int AutosaveSlotHeight = 14;
+
+	// Makes a pop-up that tells the player the autosave couldn't be loaded.
+	std::unique_ptr<Panel> makeLoadFailedSubPanel(Game *game)
+	{
+		const Int2 center((Renderer::ORIGINAL_WIDTH / 2) - 1, 98);
+		const Color color(48, 12, 12);
+		const int lineSpacing = 1;
+
+		const RichTextString richText(
+			"The saved game could not be loaded.",
+			FontName::A,
+			color,
+			TextAlignment::Center,
+			lineSpacing,
+			game->getFontManager());
+
+		const Int2 &richTextDimensions = richText.getDimensions();
+
+		Texture texture(Texture::generate(Texture::PatternType::Parchment,
+			richTextDimensions.x + 24, richTextDimensions.y + 24,
+			game->getTextureManager(), game->getRenderer()));
+
+		// The sub-panel does nothing after it's removed.
+		auto function = [](Game *game) {};
+
+		return std::unique_ptr<Panel>(new TextSubPanel(
+			game, center, richText, function, std::move(texture), center));
+	}
+}
 
 LoadGamePanel::LoadGamePanel(Game *game)
 	: Panel(game)
@@ -39,6 +86,63 @@ LoadGamePanel::LoadGamePanel(Game *game)
 		};
 		return std::unique_ptr<Button<Game*>>(new Button<Game*>(function));
 	}();
+
+	this->loadButton = []()
+	{
+		auto function = [](Game *game)
+		{
+			// Let an autosave that's being written finish before reading it.
+			game->getSaveWriter().wait();
+
+			const std::unique_ptr<SaveFile::Snapshot> snapshot =
+				SaveFile::read(SaveFile::getAutosavePath());
+			if (snapshot.get() == nullptr)
+			{
+				game->pushSubPanel(makeLoadFailedSubPanel(game));
+				return;
+			}
+
+			// Saves from the test city and from .MIF files are like new games and
+			// the fast start, respectively. Dungeon textures are prefetched when the
+			// .MIF level is loaded.
+			const bool isCity = snapshot->levelMIFName.empty();
+			game->getTextureManager().setRecordingGroup(isCity ?
+				PreloadGroup::City : PreloadGroup::Dungeon);
+
+			if (isCity)
+			{
+				game->getTextureManager().prefetch(PreloadGroup::City);
+			}
+
+			// Initialize 3D renderer.
+			auto &renderer = game->getRenderer();
+			const auto &options = game->getOptions();
+			const bool fullGameWindow = options.getPlayerInterface() == PlayerInterface::Modern;
+			renderer.initializeWorldRendering(options.getResolutionScale(), fullGameWindow);
+
+			std::unique_ptr<GameData> gameData = SaveFile::load(
+				*snapshot.get(), game->getTextureManager(), renderer);
+			if (gameData.get() == nullptr)
+			{
+				// The previous session's world rendering is gone, so it can't be
+				// returned to.
+				DebugWarning("Could not load the saved game.");
+				game->setGameData(nullptr);
+				game->setPanel(std::unique_ptr<Panel>(new MainMenuPanel(game)));
+				game->pushSubPanel(makeLoadFailedSubPanel(game));
+				return;
+			}
+
+			// Set the game data before constructing the game world panel.
+			game->setGameData(std::move(gameData));
+
+			std::unique_ptr<Panel> gameWorldPanel(new GameWorldPanel(game));
+			game->setPanel(std::move(gameWorldPanel));
+			game->setMusic(isCity ? MusicName::SunnyDay : MusicName::Dungeon1);
+		};
+		return std::unique_ptr<Button<Game*>>(new Button<Game*>(AutosaveSlotX,
+			AutosaveSlotY, AutosaveSlotWidth, AutosaveSlotHeight, function));
+	}();
 }
 
 LoadGamePanel::~LoadGamePanel()
@@ -74,6 +178,12 @@ void LoadGamePanel::handleEvent(const SDL_Event &e)
 			.nativePointToOriginal(mousePosition);
 
 		// Listen for up/down arrow click, saved game click...
+
+		// Only the autosave can be loaded for now.
+		if (this->loadButton->contains(mouseOriginalPoint))
+		{
+			this->loadButton->click(this->getGame());
+		}
 	}
 }
 
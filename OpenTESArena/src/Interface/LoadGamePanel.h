@@ -11,7 +11,7 @@ class TextBox;
 class LoadGamePanel : public Panel
 {
 private:
-	std::unique_ptr<Button<Game*>> backButton;
+	std::unique_ptr<Button<Game*>> backButton, loadButton;
 	// up/down arrow buttons, saved game buttons...
 public:
 	LoadGamePanel(Game *game);
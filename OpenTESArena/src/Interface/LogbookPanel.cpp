@@ -6,15 +6,16 @@
 
 #include "CursorAlignment.h"
 #include "GameWorldPanel.h"
-#include "RichTextString.h"
 #include "TextAlignment.h"
-#include "TextBox.h"
+#include "TextCache.h"
+#include "TextLayout.h"
 #include "../Assets/ExeStrings.h"
 #include "../Assets/TextAssets.h"
 #include "../Game/Game.h"
 #include "../Game/Options.h"
 #include "../Math/Vector2.h"
 #include "../Media/Color.h"
+#include "../Media/FontAtlas.h"
 #include "../Media/FontManager.h"
 #include "../Media/FontName.h"
 #include "../Media/PaletteFile.h"
@@ -25,25 +26,29 @@
 #include "../Rendering/Renderer.h"
 #include "../Rendering/Texture.h"
 
+namespace
+{
+	const Color TitleColor(255, 207, 12);
+	const FontName TitleFontName = FontName::A;
+}
+
 LogbookPanel::LogbookPanel(Game *game)
 	: Panel(game)
 {
-	this->titleTextBox = [game]()
-	{
-		const Int2 center(
-			Renderer::ORIGINAL_WIDTH / 2, 
-			Renderer::ORIGINAL_HEIGHT / 2);
-
-		const RichTextString richText(
-			game->getTextAssets().getAExeStrings().get(ExeStringKey::LogbookIsEmpty),
-			FontName::A,
-			Color(255, 207, 12),
-			TextAlignment::Center,
-			game->getFontManager());
-
-		return std::unique_ptr<TextBox>(new TextBox(
-			center, richText, game->getRenderer()));
-	}();
+	const auto &fontAtlas = game->getTextCache().getFontAtlas(
+		TitleFontName, game->getFontManager(), game->getRenderer());
+
+	this->titleLayout = std::unique_ptr<TextLayout>(new TextLayout(
+		game->getTextAssets().getAExeStrings().get(ExeStringKey::LogbookIsEmpty),
+		TextAlignment::Center,
+		0,
+		fontAtlas));
+
+	// Centered on the screen.
+	const Int2 &titleDimensions = this->titleLayout->getDimensions();
+	this->titlePosition = Int2(
+		(Renderer::ORIGINAL_WIDTH / 2) - (titleDimensions.x / 2),
+		(Renderer::ORIGINAL_HEIGHT / 2) - (titleDimensions.y / 2));
 
 	this->backButton = []()
 	{
@@ -118,8 +123,12 @@ void LogbookPanel::render(Renderer &renderer)
 	renderer.drawToOriginal(logbookBackground.get());
 
 	// Draw text: title.
-	renderer.drawToOriginal(this->titleTextBox->getTexture(),
-		this->titleTextBox->getX(), this->titleTextBox->getY());
+	auto &game = *this->getGame();
+	const auto &fontAtlas = game.getTextCache().getFontAtlas(
+		TitleFontName, game.getFontManager(), renderer);
+	renderer.drawQuadsToOriginal(fontAtlas.getTexture().get(),
+		this->titleLayout->getQuads(), this->titlePosition.x, this->titlePosition.y,
+		TitleColor);
 
 	// Scale the original frame buffer onto the native one.
 	renderer.drawOriginalToNative();
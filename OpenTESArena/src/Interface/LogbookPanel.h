@@ -3,14 +3,16 @@
 
 #include "Button.h"
 #include "Panel.h"
+#include "../Math/Vector2.h"
 
 class Renderer;
-class TextBox;
+class TextLayout;
 
 class LogbookPanel : public Panel
 {
 private:
-	std::unique_ptr<TextBox> titleTextBox;
+	std::unique_ptr<TextLayout> titleLayout;
+	Int2 titlePosition; // Top left corner.
 	std::unique_ptr<Button<Game*>> backButton;
 public:
 	LogbookPanel(Game *game);
@@ -22,6 +22,7 @@
 #include "../Media/MusicName.h"
 #include "../Media/PaletteFile.h"
 #include "../Media/PaletteName.h"
+#include "../Media/PreloadGroup.h"
 #include "../Media/TextureFile.h"
 #include "../Media/TextureManager.h"
 #include "../Media/TextureName.h"
@@ -94,6 +95,10 @@ MainMenuPanel::MainMenuPanel(Game *game)
 				game->setPanel(std::move(newGameStoryPanel));
 			};
 
+			// New games start in a city, so load its textures during the cinematic
+			// and character creation.
+			game->getTextureManager().prefetch(PreloadGroup::City);
+
 			std::unique_ptr<Panel> cinematicPanel(new CinematicPanel(
 				game,
 				PaletteFile::fromName(PaletteName::Default),
@@ -111,6 +116,9 @@ MainMenuPanel::MainMenuPanel(Game *game)
 	{
 		auto function = [](Game *game)
 		{
+			// The test level is a dungeon. Its textures are prefetched when it's loaded.
+			game->getTextureManager().setRecordingGroup(PreloadGroup::Dungeon);
+
 			// Initialize 3D renderer.
 			auto &renderer = game->getRenderer();
 			const auto &options = game->getOptions();
@@ -128,8 +136,7 @@ MainMenuPanel::MainMenuPanel(Game *game)
 
 			auto &player = gameData->getPlayer();
 			Double3 playerPosition = player.getPosition();
-			GameData::loadFromMIF(mif, inf, playerPosition, gameData->getWorldData(),
-				game->getTextureManager(), renderer);
+			gameData->loadFromMIF(mif, inf, playerPosition, game->getTextureManager(), renderer);
 
 			player.teleport(playerPosition);
 
@@ -10,6 +10,7 @@
 #include "RichTextString.h"
 #include "TextAlignment.h"
 #include "TextBox.h"
+#include "TextCache.h"
 #include "../Entities/Player.h"
 #include "../Game/Game.h"
 #include "../Game/GameData.h"
@@ -724,8 +725,8 @@ void OptionsPanel::updateVerticalSensitivityText(double vSensitivity)
 
 void OptionsPanel::drawTooltip(const std::string &text, Renderer &renderer)
 {
-	const Texture tooltip(Panel::createTooltip(
-		text, FontName::D, this->getGame()->getFontManager(), renderer));
+	const Texture &tooltip = this->getGame()->getTextCache().getTooltip(
+		text, FontName::D, this->getGame()->getFontManager(), renderer);
 
 	const auto &inputManager = this->getGame()->getInputManager();
 	const Int2 originalPosition = renderer.nativePointToOriginal(
@@ -31,11 +31,6 @@ class Panel
 private:
 	Game *game;
 protected:
-	// Generates a tooltip texture with the default white foreground and gray
-	// background with alpha blending.
-	static SDL_Texture *createTooltip(const std::string &text,
-		FontName fontName, FontManager &fontManager, Renderer &renderer);
-
 	Game *getGame() const;
 public:
 	Panel(Game *game);
@@ -43,6 +38,12 @@ public:
 
 	static std::unique_ptr<Panel> defaultPanel(Game *game);
 
+	// Generates a tooltip texture with the default white foreground and gray
+	// background with alpha blending. Tooltips drawn every frame should come from
+	// the text cache instead, which calls this once per string.
+	static SDL_Texture *createTooltip(const std::string &text,
+		FontName fontName, FontManager &fontManager, Renderer &renderer);
+
 	// Gets the panel's active mouse cursor and alignment. Override this method if
 	// the panel has at least one cursor defined. The texture must be supplied by 
 	// the texture manager.
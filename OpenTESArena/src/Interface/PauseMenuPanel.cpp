@@ -28,6 +28,7 @@
 #include "../Media/PaletteFile.h"
 #include "../Media/PaletteName.h"
 #include "../Media/PortraitFile.h"
+#include "../Media/PreloadGroup.h"
 #include "../Media/TextureFile.h"
 #include "../Media/TextureManager.h"
 #include "../Media/TextureName.h"
@@ -140,6 +141,7 @@ PauseMenuPanel::PauseMenuPanel(Game *game)
 		auto function = [](Game *game)
 		{
 			game->setGameData(nullptr);
+			game->getTextureManager().setRecordingGroup(PreloadGroup::MainMenu);
 
 			std::unique_ptr<Panel> mainMenuPanel(new MainMenuPanel(game));
 			game->setPanel(std::move(mainMenuPanel));
@@ -9,9 +9,8 @@
 
 #include "CursorAlignment.h"
 #include "ProvinceButtonName.h"
-#include "RichTextString.h"
 #include "TextAlignment.h"
-#include "TextBox.h"
+#include "TextCache.h"
 #include "WorldMapPanel.h"
 #include "../Assets/CityDataFile.h"
 #include "../Assets/ExeStrings.h"
@@ -175,8 +174,8 @@ void ProvinceMapPanel::drawButtonTooltip(ProvinceButtonName buttonName, Renderer
 {
 	const std::string &text = ProvinceButtonTooltips.at(buttonName);
 
-	Texture tooltip(Panel::createTooltip(
-		text, FontName::D, this->getGame()->getFontManager(), renderer));
+	const Texture &tooltip = this->getGame()->getTextCache().getTooltip(
+		text, FontName::D, this->getGame()->getFontManager(), renderer);
 
 	const auto &inputManager = this->getGame()->getInputManager();
 	const Int2 mousePosition = inputManager.getMousePosition();
@@ -194,24 +193,28 @@ void ProvinceMapPanel::drawButtonTooltip(ProvinceButtonName buttonName, Renderer
 void ProvinceMapPanel::drawLocationName(const std::string &name, const Int2 &center,
 	Renderer &renderer)
 {
-	const RichTextString richText(
-		name,
-		FontName::Arena,
-		Color(158, 0, 0),
-		TextAlignment::Center,
-		this->getGame()->getFontManager());
+	auto &game = *this->getGame();
+	auto &textCache = game.getTextCache();
 
-	const TextBox textBox(
-		center - Int2(0, 10), richText, Color(48, 48, 48), renderer);
+	// The shadow is the same text in another color. Each texture is drawn before the
+	// next one is requested, since a cache lookup may evict the other one.
+	const Texture &shadowTexture = textCache.getText(name, FontName::Arena,
+		Color(48, 48, 48), TextAlignment::Center, game.getFontManager(), renderer);
+	const int width = shadowTexture.getWidth();
+	const int height = shadowTexture.getHeight();
+	const Int2 textCenter = center - Int2(0, 10);
 
 	// Clamp to screen edges, with some extra space on the left and right.
-	const int x = std::max(std::min(textBox.getX(),
-		Renderer::ORIGINAL_WIDTH - textBox.getSurface()->w - 2), 2);
-	const int y = std::max(std::min(textBox.getY(),
-		Renderer::ORIGINAL_HEIGHT - textBox.getSurface()->h), 0);
-	
-	renderer.drawToOriginal(textBox.getShadowTexture(), x + 1, y);
-	renderer.drawToOriginal(textBox.getTexture(), x, y);
+	const int x = std::max(std::min(textCenter.x - (width / 2),
+		Renderer::ORIGINAL_WIDTH - width - 2), 2);
+	const int y = std::max(std::min(textCenter.y - (height / 2),
+		Renderer::ORIGINAL_HEIGHT - height), 0);
+
+	renderer.drawToOriginal(shadowTexture.get(), x + 1, y);
+
+	const Texture &texture = textCache.getText(name, FontName::Arena,
+		Color(158, 0, 0), TextAlignment::Center, game.getFontManager(), renderer);
+	renderer.drawToOriginal(texture.get(), x, y);
 }
 
 void ProvinceMapPanel::render(Renderer &renderer)
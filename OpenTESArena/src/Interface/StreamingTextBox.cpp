@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "SDL.h"
+
+#include "StreamingTextBox.h"
+
+#include "../Media/Font.h"
+#include "../Media/FontManager.h"
+#include "../Media/FontName.h"
+#include "../Rendering/Renderer.h"
+#include "../Utilities/Debug.h"
+
+StreamingTextBox::StreamingTextBox(int x, int y, FontName fontName, const Color &color)
+	: color(color)
+{
+	this->fontName = fontName;
+	this->x = x;
+	this->y = y;
+	this->width = 0;
+	this->height = 0;
+}
+
+int StreamingTextBox::getX() const
+{
+	return this->x;
+}
+
+int StreamingTextBox::getY() const
+{
+	return this->y;
+}
+
+int StreamingTextBox::getWidth() const
+{
+	return this->width;
+}
+
+int StreamingTextBox::getHeight() const
+{
+	return this->height;
+}
+
+const std::string &StreamingTextBox::getText() const
+{
+	return this->text;
+}
+
+const Texture &StreamingTextBox::getTexture() const
+{
+	return this->texture;
+}
+
+void StreamingTextBox::setText(const std::string &text, FontManager &fontManager,
+	Renderer &renderer)
+{
+	if ((this->texture.get() != nullptr) && (text == this->text))
+	{
+		return;
+	}
+
+	this->text = text;
+
+	const Font &font = fontManager.getFont(this->fontName);
+	const int characterHeight = font.getCharacterHeight();
+
+	// Measure the text, line by line.
+	int lineWidth = 0;
+	int maxLineWidth = 0;
+	int lineCount = 1;
+	for (const char c : text)
+	{
+		if (c == '\n')
+		{
+			maxLineWidth = std::max(maxLineWidth, lineWidth);
+			lineWidth = 0;
+			lineCount++;
+		}
+		else
+		{
+			lineWidth += font.getSurface(c)->w;
+		}
+	}
+
+	this->width = std::max(maxLineWidth, lineWidth);
+	this->height = lineCount * characterHeight;
+
+	// Grow the texture if the text doesn't fit. It never shrinks, so text that
+	// changes length every frame doesn't make a new texture every frame.
+	const bool hasTexture = this->texture.get() != nullptr;
+	const int textureWidth = hasTexture ? this->texture.getWidth() : 0;
+	const int textureHeight = hasTexture ? this->texture.getHeight() : 0;
+	if ((this->width > textureWidth) || (this->height > textureHeight))
+	{
+		SDL_Texture *newTexture = renderer.createTexture(Renderer::DEFAULT_PIXELFORMAT,
+			SDL_TEXTUREACCESS_STREAMING, std::max(std::max(this->width, textureWidth), 1),
+			std::max(std::max(this->height, textureHeight), 1));
+		DebugAssert(newTexture != nullptr, "Could not create streaming text texture.");
+
+		SDL_SetTextureBlendMode(newTexture, SDL_BLENDMODE_BLEND);
+		this->texture = Texture(newTexture);
+	}
+
+	void *pixels;
+	int pitch;
+	if (SDL_LockTexture(this->texture.get(), nullptr, &pixels, &pitch) != 0)
+	{
+		DebugWarning("Could not lock streaming text texture.");
+		return;
+	}
+
+	// Clear to transparent, then write the text color wherever a glyph pixel isn't
+	// black (the same rule text boxes use).
+	const int rowLength = pitch / static_cast<int>(sizeof(uint32_t));
+	const int rowCount = this->texture.getHeight();
+	uint32_t *dstPixels = static_cast<uint32_t*>(pixels);
+	std::memset(dstPixels, 0, static_cast<size_t>(pitch) * rowCount);
+
+	// Streaming textures use the renderer's default ARGB8888 format.
+	const uint32_t textColor = this->color.toARGB();
+
+	int xOffset = 0;
+	int yOffset = 0;
+	for (const char c : text)
+	{
+		if (c == '\n')
+		{
+			xOffset = 0;
+			yOffset += characterHeight;
+			continue;
+		}
+
+		const SDL_Surface *glyph = font.getSurface(c);
+		const uint32_t *glyphPixels = static_cast<const uint32_t*>(glyph->pixels);
+		const int glyphRowLength = glyph->pitch / static_cast<int>(sizeof(uint32_t));
+		const uint32_t black = SDL_MapRGBA(glyph->format, 0, 0, 0, 0);
+
+		for (int glyphY = 0; glyphY < glyph->h; glyphY++)
+		{
+			const uint32_t *srcRow = glyphPixels + (glyphY * glyphRowLength);
+			uint32_t *dstRow = dstPixels + ((yOffset + glyphY) * rowLength) + xOffset;
+			for (int glyphX = 0; glyphX < glyph->w; glyphX++)
+			{
+				if (srcRow[glyphX] != black)
+				{
+					dstRow[glyphX] = textColor;
+				}
+			}
+		}
+
+		xOffset += glyph->w;
+	}
+
+	SDL_UnlockTexture(this->texture.get());
+}
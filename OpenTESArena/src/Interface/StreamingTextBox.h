@@ -0,0 +1,49 @@
+#ifndef STREAMING_TEXT_BOX_H
+#define STREAMING_TEXT_BOX_H
+
+#include <string>
+
+#include "../Media/Color.h"
+#include "../Rendering/Texture.h"
+
+// A text box for left-aligned text that changes often (i.e., the debug text). Instead
+// of making new surfaces and textures for each string like TextBox does, it blits
+// glyphs straight into one streaming texture that it keeps, and only when the text
+// actually changes. The texture only grows, so a string that's shorter than an older
+// one leaves transparent space at the right and bottom.
+
+class FontManager;
+class Renderer;
+
+enum class FontName;
+
+class StreamingTextBox
+{
+private:
+	Texture texture;
+	std::string text;
+	FontName fontName;
+	Color color;
+	int x, y;
+	int width, height; // Dimensions of the current text, not the texture.
+public:
+	StreamingTextBox(int x, int y, FontName fontName, const Color &color);
+	StreamingTextBox(const StreamingTextBox&) = delete;
+
+	StreamingTextBox &operator=(const StreamingTextBox&) = delete;
+
+	int getX() const;
+	int getY() const;
+	int getWidth() const;
+	int getHeight() const;
+	const std::string &getText() const;
+
+	// Gets the texture to draw. It may be larger than the text itself.
+	const Texture &getTexture() const;
+
+	// Sets the text to draw. The texture is only redrawn if the text is different
+	// from before. Newlines start a new line.
+	void setText(const std::string &text, FontManager &fontManager, Renderer &renderer);
+};
+
+#endif
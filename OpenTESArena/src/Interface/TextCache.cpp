@@ -0,0 +1,198 @@
+#include <functional>
+#include <iterator>
+
+#include "SDL.h"
+
+#include "TextCache.h"
+
+#include "Panel.h"
+#include "RichTextString.h"
+#include "TextAlignment.h"
+#include "TextBox.h"
+#include "../Media/Font.h"
+#include "../Media/FontManager.h"
+#include "../Media/FontName.h"
+#include "../Rendering/Renderer.h"
+#include "../Utilities/Debug.h"
+
+const int TextCache::DEFAULT_MAX_ENTRIES = 64;
+
+TextCache::Stats::Stats()
+{
+	this->entryCount = 0;
+	this->hits = 0;
+	this->misses = 0;
+	this->evictions = 0;
+}
+
+TextCache::Entry::Entry(const std::string &text, FontName fontName, const Color &color,
+	TextAlignment alignment, bool tooltip, size_t hash, Texture &&texture)
+	: text(text), color(color), texture(std::move(texture))
+{
+	this->fontName = fontName;
+	this->alignment = alignment;
+	this->tooltip = tooltip;
+	this->hash = hash;
+}
+
+TextCache::TextCache(int maxEntries)
+{
+	DebugAssert(maxEntries > 0, "Text cache must hold at least one entry.");
+
+	this->maxEntries = maxEntries;
+}
+
+TextCache::~TextCache()
+{
+	// Entries release their own textures.
+	this->entryMap.clear();
+	this->entries.clear();
+}
+
+size_t TextCache::makeHash(const std::string &text, FontName fontName,
+	const Color &color, TextAlignment alignment, bool tooltip)
+{
+	size_t hash = std::hash<std::string>()(text);
+
+	// Same combining step as boost::hash_combine.
+	auto combine = [&hash](size_t value)
+	{
+		hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	};
+
+	combine(static_cast<size_t>(fontName));
+	combine(static_cast<size_t>(color.toARGB()));
+	combine(static_cast<size_t>(alignment));
+	combine(tooltip ? 1 : 0);
+	return hash;
+}
+
+const Texture *TextCache::findTexture(const std::string &text, FontName fontName,
+	const Color &color, TextAlignment alignment, bool tooltip, size_t hash)
+{
+	const auto range = this->entryMap.equal_range(hash);
+	for (auto iter = range.first; iter != range.second; ++iter)
+	{
+		const EntryIterator entryIter = iter->second;
+		if ((entryIter->fontName == fontName) && (entryIter->color == color) &&
+			(entryIter->alignment == alignment) && (entryIter->tooltip == tooltip) &&
+			(entryIter->text == text))
+		{
+			// Move it to the front of the recently used list. This doesn't invalidate
+			// any iterators.
+			this->entries.splice(this->entries.begin(), this->entries, entryIter);
+			this->stats.hits++;
+			return &entryIter->texture;
+		}
+	}
+
+	this->stats.misses++;
+	return nullptr;
+}
+
+const Texture &TextCache::addTexture(const std::string &text, FontName fontName,
+	const Color &color, TextAlignment alignment, bool tooltip, size_t hash,
+	Texture &&texture)
+{
+	// Make room first, so the new entry is never the one evicted.
+	while (static_cast<int>(this->entries.size()) >= this->maxEntries)
+	{
+		this->removeLast();
+	}
+
+	this->entries.emplace_front(text, fontName, color, alignment, tooltip, hash,
+		std::move(texture));
+	this->entryMap.emplace(std::make_pair(hash, this->entries.begin()));
+	this->stats.entryCount++;
+
+	return this->entries.front().texture;
+}
+
+void TextCache::removeLast()
+{
+	const EntryIterator iter = std::prev(this->entries.end());
+	const auto range = this->entryMap.equal_range(iter->hash);
+	for (auto mapIter = range.first; mapIter != range.second; ++mapIter)
+	{
+		if (mapIter->second == iter)
+		{
+			this->entryMap.erase(mapIter);
+			break;
+		}
+	}
+
+	this->entries.erase(iter);
+	this->stats.entryCount--;
+	this->stats.evictions++;
+}
+
+const TextCache::Stats &TextCache::getStats() const
+{
+	return this->stats;
+}
+
+const Texture &TextCache::getText(const std::string &text, FontName fontName,
+	const Color &color, TextAlignment alignment, FontManager &fontManager,
+	Renderer &renderer)
+{
+	const size_t hash = TextCache::makeHash(text, fontName, color, alignment, false);
+	const Texture *cachedTexture = this->findTexture(
+		text, fontName, color, alignment, false, hash);
+
+	if (cachedTexture != nullptr)
+	{
+		return *cachedTexture;
+	}
+
+	const RichTextString richText(text, fontName, color, alignment, fontManager);
+	const TextBox textBox(0, 0, richText, renderer);
+
+	// The text box's surface already has the text color.
+	Texture texture(renderer.createTextureFromSurface(textBox.getSurface()));
+	SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+
+	return this->addTexture(text, fontName, color, alignment, false, hash,
+		std::move(texture));
+}
+
+const Texture &TextCache::getTooltip(const std::string &text, FontName fontName,
+	FontManager &fontManager, Renderer &renderer)
+{
+	// Tooltips are always white, left-aligned text.
+	const Color &color = Color::White;
+	const TextAlignment alignment = TextAlignment::Left;
+
+	const size_t hash = TextCache::makeHash(text, fontName, color, alignment, true);
+	const Texture *cachedTexture = this->findTexture(
+		text, fontName, color, alignment, true, hash);
+
+	if (cachedTexture != nullptr)
+	{
+		return *cachedTexture;
+	}
+
+	Texture texture(Panel::createTooltip(text, fontName, fontManager, renderer));
+	return this->addTexture(text, fontName, color, alignment, true, hash,
+		std::move(texture));
+}
+
+const FontAtlas &TextCache::getFontAtlas(FontName fontName, FontManager &fontManager,
+	Renderer &renderer)
+{
+	auto iter = this->fontAtlases.find(fontName);
+	if (iter == this->fontAtlases.end())
+	{
+		FontAtlas fontAtlas(fontManager.getFont(fontName), renderer);
+		iter = this->fontAtlases.emplace(std::make_pair(
+			fontName, std::move(fontAtlas))).first;
+	}
+
+	return iter->second;
+}
+
+void TextCache::clear()
+{
+	this->entryMap.clear();
+	this->entries.clear();
+	this->stats.entryCount = 0;
+}
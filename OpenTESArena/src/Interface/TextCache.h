@@ -0,0 +1,117 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "../Media/Color.h"
+#include "../Media/FontAtlas.h"
+#include "../Rendering/Texture.h"
+
+// A text cache keeps the textures of recently drawn strings, so text that is drawn
+// every frame (i.e., tooltips and labels) is only laid out and uploaded once instead
+// of being rebuilt from glyph surfaces each time.
+
+// Entries are keyed by text, font, color, alignment, and whether it's a tooltip. Once
+// the cache is full, the least recently used entry is destroyed. A returned texture
+// stays valid until the next call that adds an entry, so it should be drawn right away
+// and not held onto.
+
+// It also keeps a glyph atlas for each font that has been drawn with a text layout.
+// Atlases are never evicted, so references to them stay valid.
+
+class FontManager;
+class Renderer;
+
+enum class FontName;
+enum class TextAlignment;
+
+class TextCache
+{
+public:
+	// Lookup statistics, i.e., for the debug text.
+	struct Stats
+	{
+		int entryCount;
+		uint64_t hits, misses, evictions;
+
+		Stats();
+	};
+private:
+	struct Entry
+	{
+		std::string text;
+		FontName fontName;
+		Color color;
+		TextAlignment alignment;
+		bool tooltip;
+		size_t hash;
+		Texture texture;
+
+		Entry(const std::string &text, FontName fontName, const Color &color,
+			TextAlignment alignment, bool tooltip, size_t hash, Texture &&texture);
+		Entry(const Entry&) = delete;
+
+		Entry &operator=(const Entry&) = delete;
+	};
+
+	typedef std::list<Entry>::iterator EntryIterator;
+
+	// Entries ordered from most to least recently used, and looked up by hash.
+	std::list<Entry> entries;
+	std::unordered_multimap<size_t, EntryIterator> entryMap;
+	std::map<FontName, FontAtlas> fontAtlases;
+	Stats stats;
+	int maxEntries;
+
+	// Hashes an entry's key without building a combined string.
+	static size_t makeHash(const std::string &text, FontName fontName,
+		const Color &color, TextAlignment alignment, bool tooltip);
+
+	// Finds an entry and marks it as most recently used. Returns null if it isn't
+	// cached.
+	const Texture *findTexture(const std::string &text, FontName fontName,
+		const Color &color, TextAlignment alignment, bool tooltip, size_t hash);
+
+	// Adds a texture as the most recently used entry, evicting the least recently used
+	// ones if the cache is full.
+	const Texture &addTexture(const std::string &text, FontName fontName,
+		const Color &color, TextAlignment alignment, bool tooltip, size_t hash,
+		Texture &&texture);
+
+	// Removes the least recently used entry.
+	void removeLast();
+public:
+	TextCache(int maxEntries);
+	TextCache(const TextCache&) = delete;
+	~TextCache();
+
+	TextCache &operator=(const TextCache&) = delete;
+
+	// Default number of strings kept before old ones are evicted.
+	static const int DEFAULT_MAX_ENTRIES;
+
+	// Gets the lookup statistics.
+	const TextCache::Stats &getStats() const;
+
+	// Gets the texture of some text, as a text box with the same settings would draw it.
+	const Texture &getText(const std::string &text, FontName fontName, const Color &color,
+		TextAlignment alignment, FontManager &fontManager, Renderer &renderer);
+
+	// Gets the texture of a tooltip, as Panel::createTooltip() would make it.
+	const Texture &getTooltip(const std::string &text, FontName fontName,
+		FontManager &fontManager, Renderer &renderer);
+
+	// Gets the glyph atlas of a font, making it if necessary.
+	const FontAtlas &getFontAtlas(FontName fontName, FontManager &fontManager,
+		Renderer &renderer);
+
+	// Destroys all cached text textures. Font atlases are kept.
+	void clear();
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include <algorithm>
+
+#include "TextLayout.h"
+
+#include "RichTextString.h"
+#include "TextAlignment.h"
+#include "../Media/FontAtlas.h"
+#include "../Utilities/Debug.h"
+
+TextLayout::TextLayout(const std::string &text, TextAlignment alignment,
+	int lineSpacing, const FontAtlas &fontAtlas)
+{
+	// Empty text is laid out as a space, like rich text strings do, so it still has
+	// a size.
+	const std::string space(" ");
+	const std::string &layoutText = (text.size() > 0) ? text : space;
+	const int characterHeight = fontAtlas.getCharacterHeight();
+
+	// Get the width of each line first, for centering.
+	std::vector<int> lineWidths(1, 0);
+	for (const char c : layoutText)
+	{
+		if (c == '\n')
+		{
+			lineWidths.push_back(0);
+		}
+		else
+		{
+			lineWidths.back() += fontAtlas.getGlyph(c).width;
+		}
+	}
+
+	const int lineCount = static_cast<int>(lineWidths.size());
+	this->dimensions = Int2(
+		*std::max_element(lineWidths.begin(), lineWidths.end()),
+		(characterHeight * lineCount) + (lineSpacing * (lineCount - 1)));
+
+	// Same placement as text boxes.
+	auto getLineStart = [this, alignment, &lineWidths](int lineIndex)
+	{
+		if (alignment == TextAlignment::Left)
+		{
+			return 0;
+		}
+		else if (alignment == TextAlignment::Center)
+		{
+			return (this->dimensions.x / 2) - (lineWidths.at(lineIndex) / 2);
+		}
+		else
+		{
+			DebugCrash("Alignment \"" +
+				std::to_string(static_cast<int>(alignment)) + "\" unrecognized.");
+			return 0;
+		}
+	};
+
+	this->quads.reserve(layoutText.size());
+
+	int lineIndex = 0;
+	int x = getLineStart(lineIndex);
+	int y = 0;
+	for (const char c : layoutText)
+	{
+		if (c == '\n')
+		{
+			lineIndex++;
+			x = getLineStart(lineIndex);
+			y += characterHeight + lineSpacing;
+			continue;
+		}
+
+		const FontAtlas::Glyph &glyph = fontAtlas.getGlyph(c);
+
+		Renderer::TextureQuad quad;
+		quad.srcX = glyph.x;
+		quad.srcY = glyph.y;
+		quad.dstX = x;
+		quad.dstY = y;
+		quad.width = glyph.width;
+		quad.height = characterHeight;
+		this->quads.push_back(quad);
+
+		x += glyph.width;
+	}
+}
+
+TextLayout::TextLayout(const RichTextString &richText, const FontAtlas &fontAtlas)
+	: TextLayout(richText.getText(), richText.getAlignment(), richText.getLineSpacing(),
+		fontAtlas) { }
+
+const std::vector<Renderer::TextureQuad> &TextLayout::getQuads() const
+{
+	return this->quads;
+}
+
+const Int2 &TextLayout::getDimensions() const
+{
+	return this->dimensions;
+}
@@ -0,0 +1,40 @@
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <string>
+#include <vector>
+
+#include "../Math/Vector2.h"
+#include "../Rendering/Renderer.h"
+
+// A text layout is where each character of some text goes, as quads into a font
+// atlas. Unlike a text box, it has no surfaces or textures of its own. It's drawn
+// straight from the atlas with Renderer::drawQuadsToOriginal() (or ToNative()), which
+// suits text that is laid out once and drawn often, like dialogs and list boxes.
+
+// Lines are split on newlines and placed like a text box would, so a layout is the
+// same size as a rich text string with the same settings.
+
+class FontAtlas;
+class RichTextString;
+
+enum class TextAlignment;
+
+class TextLayout
+{
+private:
+	std::vector<Renderer::TextureQuad> quads;
+	Int2 dimensions;
+public:
+	TextLayout(const std::string &text, TextAlignment alignment, int lineSpacing,
+		const FontAtlas &fontAtlas);
+	TextLayout(const RichTextString &richText, const FontAtlas &fontAtlas);
+
+	// Gets the quads of the characters, relative to the top left corner.
+	const std::vector<Renderer::TextureQuad> &getQuads() const;
+
+	// Gets the width and height of the text in pixels.
+	const Int2 &getDimensions() const;
+};
+
+#endif
@@ -4,9 +4,10 @@
 
 #include "CursorAlignment.h"
 #include "RichTextString.h"
-#include "TextBox.h"
+#include "TextCache.h"
 #include "../Game/Game.h"
 #include "../Math/Rect.h"
+#include "../Media/FontAtlas.h"
 #include "../Media/FontManager.h"
 #include "../Media/PaletteFile.h"
 #include "../Media/PaletteName.h"
@@ -18,11 +19,16 @@
 TextSubPanel::TextSubPanel(Game *game, const Int2 &textCenter,
 	const RichTextString &richText, const std::function<void(Game*)> &endingAction,
 	Texture &&texture, const Int2 &textureCenter)
-	: Panel(game), endingAction(endingAction), texture(std::move(texture)),
-	textureCenter(textureCenter)
+	: Panel(game), fontAtlas(game->getTextCache().getFontAtlas(richText.getFontName(),
+		game->getFontManager(), game->getRenderer())),
+	textLayout(richText, fontAtlas), textColor(richText.getColor()),
+	endingAction(endingAction), texture(std::move(texture)), textureCenter(textureCenter)
 {
-	this->textBox = std::unique_ptr<TextBox>(new TextBox(
-		textCenter, richText, game->getRenderer()));
+	// Centered on the given point, like a text box.
+	const Int2 &dimensions = this->textLayout.getDimensions();
+	this->textPosition = Int2(
+		textCenter.x - (dimensions.x / 2),
+		textCenter.y - (dimensions.y / 2));
 }
 
 TextSubPanel::TextSubPanel(Game *game, const Int2 &textCenter,
@@ -78,12 +84,8 @@ void TextSubPanel::render(Renderer &renderer)
 			nativeTextureRect.getHeight());
 	}
 
-	const Rect nativeTextBoxRect = renderer.originalRectToNative(this->textBox->getRect());
-
 	// Draw text.
-	renderer.drawToNative(this->textBox->getTexture(),
-		nativeTextBoxRect.getLeft(),
-		nativeTextBoxRect.getTop(),
-		nativeTextBoxRect.getWidth(),
-		nativeTextBoxRect.getHeight());
+	renderer.drawQuadsToNative(this->fontAtlas.getTexture().get(),
+		this->textLayout.getQuads(), this->textPosition.x, this->textPosition.y,
+		this->textColor);
 }
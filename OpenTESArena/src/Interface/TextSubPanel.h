@@ -5,18 +5,23 @@
 #include <string>
 
 #include "Panel.h"
+#include "TextLayout.h"
 #include "../Math/Vector2.h"
+#include "../Media/Color.h"
 #include "../Rendering/Texture.h"
 
 // A simple sub-panel for displaying a text pop-up on-screen.
 
+class FontAtlas;
 class RichTextString;
-class TextBox;
 
 class TextSubPanel : public Panel
 {
 private:
-	std::unique_ptr<TextBox> textBox;
+	const FontAtlas &fontAtlas;
+	TextLayout textLayout; // Drawn straight from the font atlas.
+	Color textColor;
+	Int2 textPosition; // Top left corner.
 	std::function<void(Game*)> endingAction;
 	Texture texture;
 	Int2 textureCenter;
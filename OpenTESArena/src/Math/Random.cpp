@@ -2,6 +2,9 @@
 
 #include "Random.h"
 
+std::atomic<bool> Random::hasDefaultSeed(false);
+std::atomic<int> Random::nextDefaultSeed(0);
+
 Random::Random(int seed)
 {
 	this->generator = std::default_random_engine(seed);
@@ -12,13 +15,27 @@ Random::Random(int seed)
 }
 
 Random::Random()
-	: Random(static_cast<int>(time(nullptr))) { }
+	: Random(Random::makeDefaultSeed()) { }
 
 Random::~Random()
 {
 
 }
 
+int Random::makeDefaultSeed()
+{
+	return Random::hasDefaultSeed ? Random::nextDefaultSeed++ :
+		static_cast<int>(time(nullptr));
+}
+
+void Random::setDefaultSeed(int seed)
+{
+	// Set the seed first, so a generator made on another thread in between doesn't
+	// get an old one.
+	Random::nextDefaultSeed = seed;
+	Random::hasDefaultSeed = true;
+}
+
 int Random::next()
 {
 	return this->integerDistribution(this->generator);
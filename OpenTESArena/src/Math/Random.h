@@ -1,6 +1,7 @@
 #ifndef RANDOM_H
 #define RANDOM_H
 
+#include <atomic>
 #include <random>
 
 class Random
@@ -9,14 +10,26 @@ private:
 	std::default_random_engine generator;
 	std::uniform_int_distribution<int> integerDistribution;
 	std::uniform_real_distribution<double> realDistribution;
+
+	// Seed for the next default-constructed generator, if set. Atomic so generators
+	// can be made on any thread, and each one still gets its own seed.
+	static std::atomic<bool> hasDefaultSeed;
+	static std::atomic<int> nextDefaultSeed;
+
+	// Gets the seed for a default-constructed generator.
+	static int makeDefaultSeed();
 public:
 	// Initialized with the given seed.
 	Random(int seed);
 
-	// Initialized with the current time.
+	// Initialized with the current time, or the next default seed if there is one.
 	Random();
 	~Random();
 
+	// Makes default-constructed generators use consecutive seeds starting at this one
+	// instead of the current time, so a run can be repeated (i.e., replaying input).
+	static void setDefaultSeed(int seed);
+
 	// Includes 0 to ~2.14 billion.
 	int next();
 
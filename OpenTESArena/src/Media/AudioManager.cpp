@@ -2,9 +2,13 @@
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <functional>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -15,18 +19,238 @@
 
 #include "AudioManager.h"
 
+#include "PrerenderedMusic.hpp"
+#include "SoundMixer.h"
+#include "SoundPriority.h"
 #include "WildMidi.hpp"
 #include "../Assets/VOCFile.h"
 #include "../Game/Options.h"
+#include "../Math/Vector3.h"
 #include "../Utilities/Debug.h"
 
 std::unique_ptr<MidiDevice> MidiDevice::sInstance;
 
 class OpenALStream;
 
+typedef std::chrono::steady_clock AudioClock;
+
+namespace
+{
+	double getElapsedMS(AudioClock::time_point start, AudioClock::time_point end)
+	{
+		return static_cast<double>(std::chrono::duration_cast<
+			std::chrono::microseconds>(end - start).count()) / 1000.0;
+	}
+}
+
+/* Decodes .VOC files on a background thread. Requests are handled in order, and
+ * finished sounds wait in a queue until the game thread polls for them.
+ */
+class SoundDecoder {
+public:
+	struct DecodedSound {
+		std::string filename;
+		std::vector<uint8_t> audioData;
+		int sampleRate;
+		SoundMixer::SamplesPtr mixerSamples; // Set instead of audioData when mixing.
+		double decodeMS;
+	};
+
+private:
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	std::deque<std::string> mRequests;
+	std::deque<DecodedSound> mResults;
+	int mMixerSampleRate; // Nonzero if sounds are resampled for the software mixer.
+	bool mQuit;
+	std::thread mThread;
+
+	void backgroundProc()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		while (true)
+		{
+			mCondition.wait(lock, [this]() { return mQuit || !mRequests.empty(); });
+			if (mQuit)
+				break;
+
+			const std::string filename = std::move(mRequests.front());
+			mRequests.pop_front();
+
+			/* Decode without holding the lock so more requests can be queued. */
+			lock.unlock();
+
+			const auto startTime = AudioClock::now();
+			const VOCFile voc(filename);
+
+			DecodedSound sound;
+			sound.filename = filename;
+			sound.sampleRate = voc.getSampleRate();
+			if (mMixerSampleRate != 0)
+			{
+				sound.mixerSamples = std::make_shared<const std::vector<int16_t>>(
+					SoundMixer::resample(voc.getAudioData(), sound.sampleRate,
+						mMixerSampleRate));
+				sound.sampleRate = mMixerSampleRate;
+			}
+			else
+			{
+				sound.audioData = voc.getAudioData();
+			}
+
+			sound.decodeMS = getElapsedMS(startTime, AudioClock::now());
+
+			lock.lock();
+			mResults.push_back(std::move(sound));
+		}
+	}
+
+public:
+	SoundDecoder()
+		: mMixerSampleRate(0), mQuit(false)
+	{
+	}
+
+	~SoundDecoder()
+	{
+		stop();
+	}
+
+	/* Starts the thread. If the mixer sample rate is nonzero, sounds are resampled
+	 * to it for the software mixer instead of being left for OpenAL.
+	 */
+	void start(int mixerSampleRate)
+	{
+		assert(mThread.get_id() == std::thread::id());
+		mMixerSampleRate = mixerSampleRate;
+		mThread = std::thread(std::mem_fn(&SoundDecoder::backgroundProc), this);
+	}
+
+	void stop()
+	{
+		if (mThread.get_id() != std::thread::id())
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mQuit = true;
+			}
+
+			mCondition.notify_one();
+			mThread.join();
+		}
+	}
+
+	void request(const std::string &filename)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mRequests.push_back(filename);
+		}
+
+		mCondition.notify_one();
+	}
+
+	/* Takes the oldest decoded sound, if any. */
+	bool poll(DecodedSound &sound)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mResults.empty())
+			return false;
+
+		sound = std::move(mResults.front());
+		mResults.pop_front();
+		return true;
+	}
+};
+
+/* Presents the software mixer's output as an endless song, so it can be streamed
+ * through one source the same way music is.
+ */
+class MixerSong : public MidiSong {
+    SoundMixer &mMixer;
+
+public:
+    MixerSong(SoundMixer &mixer) : mMixer(mixer) { }
+
+    virtual void getFormat(int *sampleRate) override
+    {
+        *sampleRate = mMixer.getSampleRate();
+    }
+
+    virtual size_t read(char *buffer, size_t count) override
+    {
+        mMixer.mix(reinterpret_cast<int16_t*>(buffer), count);
+        return count;
+    }
+
+    virtual bool seek(size_t offset) override
+    {
+        static_cast<void>(offset);
+        return true;
+    }
+};
+
+/* Health counters of one stream, written by its background thread. */
+struct StreamCounters {
+	std::atomic<uint64_t> mUnderruns;
+	std::atomic<int> mQueuedBuffers, mTargetBuffers;
+	std::atomic<double> mSynthesisLoad;
+
+	StreamCounters()
+		: mUnderruns(0), mQueuedBuffers(0), mTargetBuffers(0), mSynthesisLoad(0.0)
+	{
+	}
+};
+
 class AudioManagerImpl
 {
 public:
+	// A sound that is playing on a source. Distance is from the listener, and is
+	// zero for sounds that aren't positional.
+	struct Voice
+	{
+		ALuint source;
+		SoundPriority priority;
+		Double3 position;
+		bool isPositional;
+		double distance;
+		uint64_t serial; // Higher is newer.
+	};
+
+	// A sound that was requested before it finished decoding.
+	struct PendingSound
+	{
+		std::string filename;
+		SoundPriority priority;
+		Double3 position;
+		bool isPositional;
+		AudioClock::time_point requestTime;
+	};
+
+	// A positional sound requested this frame. They are all started together in
+	// update(), closest and most important first.
+	struct QueuedSound
+	{
+		std::string filename;
+		SoundPriority priority;
+		Double3 position;
+		double distance;
+	};
+
+	// Most newly decoded sounds uploaded to OpenAL per frame.
+	static const int MAX_UPLOADS_PER_FRAME;
+
+	// How long a sound can wait for decoding before it's too late to play.
+	static const double MAX_PENDING_MS;
+
+	// Sample rate of the software mixer if the device's can't be queried.
+	static const int DEFAULT_MIXER_SAMPLE_RATE;
+
+	// The mixer stream uses smaller buffers and a shallower queue than music, since
+	// sound effects have to start soon after they're requested.
+	static const int MIXER_BUFFER_FRAMES;
+	static const double MIXER_MIN_QUEUE_MS;
+
 	float mMusicVolume;
 	float mSfxVolume;
 
@@ -34,23 +258,88 @@ public:
 	MidiSongPtr mCurrentSong;
 	std::unique_ptr<OpenALStream> mSongStream;
 
+	// Songs synthesized once and played from memory, if enabled in the options.
+	MusicPrerenderer mMusicPrerenderer;
+	bool mPrerenderMusic;
+
 	// Loaded sound buffers from .VOC files.
 	std::unordered_map<std::string, ALuint> mSoundBuffers;
 
+	// Sounds mixed in software (if enabled in the options) and streamed through one
+	// source, instead of each playing on its own source. Their samples are already
+	// at the mixer's sample rate.
+	std::unique_ptr<SoundMixer> mSoundMixer;
+	std::unique_ptr<MixerSong> mMixerSong;
+	std::unique_ptr<OpenALStream> mMixerStream;
+	std::unordered_map<std::string, SoundMixer::SamplesPtr> mMixerSounds;
+
+	// Sounds being decoded, and when each was first requested.
+	SoundDecoder mDecoder;
+	std::unordered_map<std::string, AudioClock::time_point> mPendingDecodes;
+	std::vector<PendingSound> mPendingSounds;
+
 	// A deque of available sources to play sounds and streams with.
 	std::deque<ALuint> mFreeSources;
 
-	// A deque of currently used sources for sounds (the music source is owned 
-	// by OpenALStream).
-	std::deque<ALuint> mUsedSources;
+	// Currently playing sounds (the music source is owned by OpenALStream).
+	std::vector<Voice> mVoices;
+	uint64_t mNextVoiceSerial;
+
+	// Positional sounds waiting for the next update.
+	std::vector<QueuedSound> mQueuedSounds;
+
+	// Listener state, applied to OpenAL once per update if it changed.
+	Double3 mListenerPosition, mListenerDirection;
+	bool mListenerDirty;
+
+	AudioManager::Stats mStats;
+
+	StreamCounters mMusicCounters, mMixerCounters;
 
 	AudioManagerImpl();
 	~AudioManagerImpl();
 
 	void init(const Options &options);
 
+	// Gets the index of the voice that should be stopped first to free a source.
+	// There must be at least one voice.
+	size_t findVictimVoice() const;
+
+	// Stops a voice and returns its source to the free sources.
+	void releaseVoice(size_t index);
+
+	// Gets a free source for a sound, stealing one from a less important sound if
+	// necessary. Returns 0 if every playing sound is more important.
+	ALuint acquireSource(SoundPriority priority, double distance);
+
+	// Starts the software mixer and its stream. Returns false if it couldn't get a
+	// source, in which case sounds use their own sources.
+	bool initSoundMixer(ALCdevice *device);
+
+	bool isSoundLoaded(const std::string &filename) const;
+	void requestDecode(const std::string &filename);
+
+	// Plays a loaded sound on its own source, or in the software mixer if it's enabled.
+	// The position is null for sounds that aren't positional. Returns false if it
+	// couldn't get a source or mixer voice.
+	bool startSound(const std::string &filename, SoundPriority priority,
+		const Double3 *position);
+	bool startSourceSound(ALuint buffer, SoundPriority priority, const Double3 *position);
+	bool startMixerSound(const SoundMixer::SamplesPtr &samples, const Double3 *position);
+
+	// Plays a sound when it's loaded, or later once it's decoded.
+	void playOrQueueSound(const std::string &filename, SoundPriority priority,
+		const Double3 *position);
+
+	// Starts this frame's positional sounds, skipping ones that can't be heard.
+	void startQueuedSounds();
+
 	void playMusic(const std::string &filename);
-	void playSound(const std::string &filename);
+	void preloadSound(const std::string &filename);
+	void playSound(const std::string &filename, SoundPriority priority);
+	void playSound(const std::string &filename, SoundPriority priority,
+		const Double3 &position);
+	void setListener(const Double3 &position, const Double3 &direction);
 
 	void stopMusic();
 	void stopSound();
@@ -64,43 +353,100 @@ public:
 class OpenALStream {
 	AudioManagerImpl *mManager;
 	MidiSong *mSong;
+	StreamCounters &mCounters;
 
-	/* Background thread and control. */
+	/* Background thread and control. The thread sleeps on the condition variable
+	 * until the queue runs low or it is told to quit.
+	 */
 	std::atomic<bool> mQuit;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
 	std::thread mThread;
 
-	/* Playback source and buffer queue. */
-	static const int sBufferFrames = 16384;
+	/* Playback source and buffer queue. Only the first mTargetBuffers buffers'
+	 * worth of audio is queued at once; the rest are there for when synthesis is
+	 * slow and the queue needs to grow.
+	 */
+	const int mBufferFrames;
+	static const int sMinBuffers = 3;
+	static const int sMaxBuffers = 16;
 	ALuint mSource;
-	std::array<ALuint, 4> mBuffers;
+	std::array<ALuint, sMaxBuffers> mBuffers;
 	ALuint mBufferIdx;
+	int mTargetBuffers;
+
+	/* Least amount of audio to keep queued (in milliseconds), and how many times
+	 * the slowest recent synthesis of one buffer to keep queued on top of that.
+	 */
+	const double mMinQueueMS;
+	static const double sSynthesisSafety;
+
+	/* Measured synthesis cost of one buffer. The peak decays slowly so one slow
+	 * buffer keeps the queue deeper for a while. Extra buffers are added after
+	 * each underrun.
+	 */
+	double mAverageSynthesisMS;
+	double mPeakSynthesisMS;
+	int mExtraBuffers;
 
 	/* Stream format. */
 	ALenum mFormat;
 	ALuint mSampleRate;
 	ALuint mFrameSize;
 
+	double getBufferMS() const
+	{
+		return (static_cast<double>(mBufferFrames) * 1000.0) / mSampleRate;
+	}
+
+	/* Amount of queued audio to wake up at, before the queue is refilled. */
+	double getLowWaterMS() const
+	{
+		return mMinQueueMS + (sSynthesisSafety * mPeakSynthesisMS);
+	}
+
+	/* Resizes the queue for the current synthesis cost and underrun count. */
+	void updateTargetBuffers()
+	{
+		const int lowWaterBuffers = static_cast<int>(
+			std::ceil(getLowWaterMS() / getBufferMS()));
+		mTargetBuffers = std::max(sMinBuffers,
+			std::min(lowWaterBuffers + 2 + mExtraBuffers, sMaxBuffers));
+	}
+
 	/* Read samples from the song and fill the given OpenAL buffer ID (buffer
 	 * vector is for temporary storage). Returns true if the buffer was filled.
 	 */
 	bool fillBuffer(ALuint bufid, std::vector<char> &buffer)
 	{
+		const auto startTime = AudioClock::now();
+
 		size_t totalSize = 0;
+		bool rewound = false;
 		while (totalSize < buffer.size())
 		{
 			size_t toget = (buffer.size() - totalSize) / mFrameSize;
 			size_t got = mSong->read(buffer.data() + totalSize, toget);
+			totalSize += got*mFrameSize;
 			if (got < toget)
 			{
-				/* End of song, rewind to loop. */
-				if (!mSong->seek(0))
+				/* End of song, rewind to loop. An empty song would loop forever,
+				 * so give up if nothing was read since the last rewind.
+				 */
+				if ((rewound && (got == 0)) || !mSong->seek(0))
 					break;
+				rewound = true;
 			}
-			totalSize += got*mFrameSize;
+			else
+				rewound = false;
 		}
 		if (totalSize == 0)
 			return false;
 
+		const double synthesisMS = getElapsedMS(startTime, AudioClock::now());
+		mAverageSynthesisMS += (synthesisMS - mAverageSynthesisMS) * 0.1;
+		mPeakSynthesisMS = std::max(synthesisMS, mPeakSynthesisMS * 0.99);
+
 		std::fill(buffer.begin() + totalSize, buffer.end(), 0);
 		alBufferData(bufid, mFormat, buffer.data(),
 			static_cast<ALsizei>(buffer.size()), mSampleRate);
@@ -112,9 +458,11 @@ class OpenALStream {
 	 */
 	ALint fillBufferQueue(std::vector<char> &buffer)
 	{
+		updateTargetBuffers();
+
 		ALint queued;
 		alGetSourcei(mSource, AL_BUFFERS_QUEUED, &queued);
-		while (queued < mBuffers.size())
+		while (queued < mTargetBuffers)
 		{
 			ALuint bufid = mBuffers[mBufferIdx];
 			if (!fillBuffer(bufid, buffer))
@@ -126,6 +474,36 @@ class OpenALStream {
 		return queued;
 	}
 
+	/* Remove buffers that have finished playing from the queue. */
+	void unqueueProcessed()
+	{
+		ALint processed;
+		alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
+		while (processed > 0)
+		{
+			ALuint bufid;
+			alSourceUnqueueBuffers(mSource, 1, &bufid);
+			--processed;
+		}
+	}
+
+	/* Gets how long to sleep before the queue needs more audio. */
+	std::chrono::microseconds getWaitTime(ALint queued)
+	{
+		ALint offset;
+		alGetSourcei(mSource, AL_SAMPLE_OFFSET, &offset);
+
+		/* Queued audio that hasn't been played yet, and the time until the buffer
+		 * being played now finishes (nothing can be refilled before then).
+		 */
+		const double frameMS = 1000.0 / mSampleRate;
+		const double remainingMS = ((queued * mBufferFrames) - offset) * frameMS;
+		const double currentMS = (mBufferFrames - (offset % mBufferFrames)) * frameMS;
+		const double waitMS = std::max(remainingMS - getLowWaterMS(), currentMS);
+
+		return std::chrono::microseconds(static_cast<long long>(waitMS * 1000.0));
+	}
+
 	/* A method run in a backround thread, to keep filling the queue with new
 	 * audio over time.
 	 */
@@ -134,35 +512,36 @@ class OpenALStream {
 		/* Temporary storage to read samples into, before passing to OpenAL.
 		 * Kept here to avoid reallocating it during playback.
 		 */
-		std::vector<char> buffer(sBufferFrames * mFrameSize);
+		std::vector<char> buffer(mBufferFrames * mFrameSize);
+		bool started = false;
 
 		while (!mQuit.load())
 		{
 			/* First, make sure the buffer queue is filled. */
-			fillBufferQueue(buffer);
+			ALint queued = fillBufferQueue(buffer);
 
 			ALint state;
 			alGetSourcei(mSource, AL_SOURCE_STATE, &state);
 			if (state != AL_PLAYING && state != AL_PAUSED)
 			{
 				/* If the source is not playing or paused, it either underrun
-				 * or hasn't started at all yet. So remove any buffers that
-				 * have been played (will be 0 when first starting).
+				 * or hasn't started at all yet. Keep more audio queued from
+				 * now on if it underran.
 				 */
-				ALint processed;
-				alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
-				while (processed > 0)
+				if (started)
 				{
-					ALuint bufid;
-					alSourceUnqueueBuffers(mSource, 1, &bufid);
-					--processed;
+					mCounters.mUnderruns++;
+					mExtraBuffers = std::min(mExtraBuffers + 1, sMaxBuffers);
 				}
 
-				/* Make sure the buffer queue is still filled, in case another
-				 * buffer had finished before checking the state and after the
-				 * last fill. If the queue is empty, playback is over.
+				/* Remove any buffers that have been played (will be 0 when first
+				 * starting), and make sure the buffer queue is still filled, in
+				 * case another buffer had finished before checking the state and
+				 * after the last fill. If the queue is empty, playback is over.
 				 */
-				if (fillBufferQueue(buffer) == 0)
+				unqueueProcessed();
+				queued = fillBufferQueue(buffer);
+				if (queued == 0)
 				{
 					mQuit.store(true);
 					return;
@@ -170,35 +549,53 @@ class OpenALStream {
 
 				/* Now start the sound source. */
 				alSourcePlay(mSource);
+				started = true;
 			}
 
-			ALint processed;
-			alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
-			if (processed == 0)
+			mCounters.mQueuedBuffers.store(queued);
+			mCounters.mTargetBuffers.store(mTargetBuffers);
+			mCounters.mSynthesisLoad.store(mAverageSynthesisMS / getBufferMS());
+
+			/* Sleep until the queue runs low, or until told to stop. */
 			{
-				/* Wait until a buffer in the queue has been processed. */
-				do {
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					if (mQuit.load()) break;
-					alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
-				} while (processed == 0);
+				std::unique_lock<std::mutex> lock(mMutex);
+				mCondition.wait_for(lock, getWaitTime(queued),
+					[this]() { return mQuit.load(); });
 			}
+
 			/* Remove processed buffers, then restart the loop to keep the
 			 * queue filled.
 			 */
-			while (processed > 0)
+			unqueueProcessed();
+		}
+	}
+
+	/* Tells the background thread to quit and waits for it to stop. */
+	void stopThread()
+	{
+		if (mThread.get_id() != std::thread::id())
+		{
 			{
-				ALuint bufid;
-				alSourceUnqueueBuffers(mSource, 1, &bufid);
-				--processed;
+				std::lock_guard<std::mutex> lock(mMutex);
+				mQuit.store(true);
 			}
+
+			mCondition.notify_one();
+			mThread.join();
 		}
 	}
 
 public:
-	OpenALStream(AudioManagerImpl *manager, MidiSong *song)
-		: mManager(manager), mSong(song), mQuit(false), mSource(0)
-		, mBufferIdx(0), mSampleRate(0)
+	/* Default buffer size and least queued audio, suited to music. */
+	static const int sDefaultBufferFrames = 4096;
+	static const double sDefaultMinQueueMS;
+
+	OpenALStream(AudioManagerImpl *manager, MidiSong *song, StreamCounters &counters,
+		int bufferFrames, double minQueueMS)
+		: mManager(manager), mSong(song), mCounters(counters), mQuit(false)
+		, mBufferFrames(bufferFrames), mSource(0), mBufferIdx(0)
+		, mTargetBuffers(sMinBuffers), mMinQueueMS(minQueueMS), mAverageSynthesisMS(0.0)
+		, mPeakSynthesisMS(0.0), mExtraBuffers(0), mSampleRate(0)
 	{
 		// Using std::fill for mBuffers since VS2013 doesn't support mBuffers{0}.
 		std::fill(mBuffers.begin(), mBuffers.end(), 0);
@@ -206,12 +603,8 @@ public:
 
 	~OpenALStream()
 	{
-		if (mThread.get_id() != std::thread::id())
-		{
-			/* Tell the thread to quit and wait for it to stop. */
-			mQuit.store(true);
-			mThread.join();
-		}
+		stopThread();
+
 		if (mSource)
 		{
 			/* Stop the source, remove the buffers, then put it back so it can
@@ -249,11 +642,7 @@ public:
 
 	void stop()
 	{
-		if (mThread.get_id() != std::thread::id())
-		{
-			mQuit.store(true);
-			mThread.join();
-		}
+		stopThread();
 
 		alSourceRewind(mSource);
 		alSourcei(mSource, AL_BUFFER, 0);
@@ -306,19 +695,41 @@ public:
 	}
 };
 
+const double OpenALStream::sDefaultMinQueueMS = 100.0;
+const double OpenALStream::sSynthesisSafety = 4.0;
+
 // Audio Manager Impl
 
+const int AudioManagerImpl::MAX_UPLOADS_PER_FRAME = 4;
+const double AudioManagerImpl::MAX_PENDING_MS = 250.0;
+const int AudioManagerImpl::DEFAULT_MIXER_SAMPLE_RATE = 44100;
+const int AudioManagerImpl::MIXER_BUFFER_FRAMES = 1024;
+const double AudioManagerImpl::MIXER_MIN_QUEUE_MS = 30.0;
+
 AudioManagerImpl::AudioManagerImpl()
-	: mMusicVolume(1.0f), mSfxVolume(1.0f)
+	: mMusicVolume(1.0f), mSfxVolume(1.0f), mPrerenderMusic(false), mNextVoiceSerial(0)
+	, mListenerDirection(0.0, 0.0, -1.0), mListenerDirty(true)
 {
 
 }
 
 AudioManagerImpl::~AudioManagerImpl()
 {
+	mDecoder.stop();
+
+	// Stop prerendering first so the music stream is never left waiting on frames
+	// that won't be rendered.
+	mMusicPrerenderer.stop();
+
 	this->stopMusic();
 	this->stopSound();
 
+	// The stream returns its source to the free sources, so stop it before they
+	// are deleted.
+	mMixerStream = nullptr;
+	mMixerSong = nullptr;
+	mSoundMixer = nullptr;
+
 	MidiDevice::shutdown();
 
 	ALCcontext *context = alcGetCurrentContext();
@@ -374,23 +785,348 @@ void AudioManagerImpl::init(const Options &options)
 	this->setMusicVolume(musicVolume);
 	this->setSoundVolume(soundVolume);
 
+	// Positional sounds fade out linearly, so they are silent at the max distance
+	// and can be skipped beyond it.
+	alDistanceModel(AL_LINEAR_DISTANCE_CLAMPED);
+
 	for (size_t i = 0; i < maxChannels; ++i)
 	{
 		ALuint source;
 		alGenSources(1, &source);
 		if (alGetError() != AL_NO_ERROR)
 			break;
+
+		alSourcef(source, AL_REFERENCE_DISTANCE,
+			static_cast<ALfloat>(AudioManager::REFERENCE_SOUND_DISTANCE));
+		alSourcef(source, AL_MAX_DISTANCE,
+			static_cast<ALfloat>(AudioManager::MAX_SOUND_DISTANCE));
 		mFreeSources.push_back(source);
 	}
+
+	mVoices.reserve(mFreeSources.size());
+
+	if (options.soundIsSoftwareMixed() && this->initSoundMixer(device))
+	{
+		mDecoder.start(mSoundMixer->getSampleRate());
+	}
+	else
+	{
+		mDecoder.start(0);
+	}
+
+	mPrerenderMusic = options.musicIsPrerendered();
+	if (mPrerenderMusic)
+	{
+		mMusicPrerenderer.start();
+	}
+}
+
+size_t AudioManagerImpl::findVictimVoice() const
+{
+	assert(mVoices.size() > 0);
+
+	// Lowest priority first, then farthest away, then oldest.
+	size_t victim = 0;
+	for (size_t i = 1; i < mVoices.size(); i++)
+	{
+		const Voice &voice = mVoices[i];
+		const Voice &best = mVoices[victim];
+
+		const bool isLessImportant = (voice.priority < best.priority) ||
+			((voice.priority == best.priority) && ((voice.distance > best.distance) ||
+			((voice.distance == best.distance) && (voice.serial < best.serial))));
+
+		if (isLessImportant)
+		{
+			victim = i;
+		}
+	}
+
+	return victim;
+}
+
+void AudioManagerImpl::releaseVoice(size_t index)
+{
+	const ALuint source = mVoices[index].source;
+	alSourceStop(source);
+	alSourceRewind(source);
+	alSourcei(source, AL_BUFFER, 0);
+	mFreeSources.push_front(source);
+
+	// Order doesn't matter, so swap with the last one.
+	mVoices[index] = mVoices.back();
+	mVoices.pop_back();
+}
+
+ALuint AudioManagerImpl::acquireSource(SoundPriority priority, double distance)
+{
+	if (mFreeSources.empty())
+	{
+		if (mVoices.empty())
+		{
+			return 0;
+		}
+
+		// The new sound wins ties with an equally far sound, since it's newer.
+		const size_t victim = this->findVictimVoice();
+		const Voice &voice = mVoices[victim];
+		const bool canSteal = (voice.priority < priority) ||
+			((voice.priority == priority) && (voice.distance >= distance));
+
+		if (!canSteal)
+		{
+			return 0;
+		}
+
+		this->releaseVoice(victim);
+		mStats.stolenVoices++;
+	}
+
+	const ALuint source = mFreeSources.front();
+	mFreeSources.pop_front();
+	return source;
+}
+
+bool AudioManagerImpl::initSoundMixer(ALCdevice *device)
+{
+	if (mFreeSources.empty())
+	{
+		DebugWarning("No source for the sound mixer.");
+		return false;
+	}
+
+	// Mix at the device's rate so OpenAL doesn't resample the mix again.
+	ALCint sampleRate = 0;
+	alcGetIntegerv(device, ALC_FREQUENCY, 1, &sampleRate);
+	if (sampleRate <= 0)
+	{
+		sampleRate = DEFAULT_MIXER_SAMPLE_RATE;
+	}
+
+	mSoundMixer.reset(new SoundMixer(sampleRate));
+	mSoundMixer->setVolume(mSfxVolume);
+	mMixerSong.reset(new MixerSong(*mSoundMixer.get()));
+	mMixerStream.reset(new OpenALStream(this, mMixerSong.get(), mMixerCounters,
+		MIXER_BUFFER_FRAMES, MIXER_MIN_QUEUE_MS));
+
+	if (!mMixerStream->init(mFreeSources.front(), 1.0f))
+	{
+		DebugWarning("Failed to init sound mixer stream.");
+		mMixerStream = nullptr;
+		mMixerSong = nullptr;
+		mSoundMixer = nullptr;
+		return false;
+	}
+
+	mFreeSources.pop_front();
+	mMixerStream->play();
+	DebugMention("Mixing sounds at " + std::to_string(sampleRate) + " Hz.");
+	return true;
+}
+
+bool AudioManagerImpl::isSoundLoaded(const std::string &filename) const
+{
+	return (mSoundMixer != nullptr) ?
+		(mMixerSounds.find(filename) != mMixerSounds.end()) :
+		(mSoundBuffers.find(filename) != mSoundBuffers.end());
+}
+
+void AudioManagerImpl::requestDecode(const std::string &filename)
+{
+	const bool isLoaded = this->isSoundLoaded(filename);
+	const bool isPending = mPendingDecodes.find(filename) != mPendingDecodes.end();
+
+	if (!isLoaded && !isPending)
+	{
+		mPendingDecodes.insert(std::make_pair(filename, AudioClock::now()));
+		mDecoder.request(filename);
+	}
+}
+
+bool AudioManagerImpl::startSound(const std::string &filename, SoundPriority priority,
+	const Double3 *position)
+{
+	if (mSoundMixer != nullptr)
+	{
+		const auto soundIter = mMixerSounds.find(filename);
+		assert(soundIter != mMixerSounds.end());
+		return this->startMixerSound(soundIter->second, position);
+	}
+	else
+	{
+		const auto vocIter = mSoundBuffers.find(filename);
+		assert(vocIter != mSoundBuffers.end());
+		return this->startSourceSound(vocIter->second, priority, position);
+	}
+}
+
+bool AudioManagerImpl::startMixerSound(const SoundMixer::SamplesPtr &samples,
+	const Double3 *position)
+{
+	// Positional gains are found once when the sound starts, with the same linear
+	// falloff that OpenAL uses for sources. Panning uses the listener's right vector.
+	float leftGain = 1.0f;
+	float rightGain = 1.0f;
+	if (position != nullptr)
+	{
+		const Double3 toSound = *position - mListenerPosition;
+		const double distance = toSound.length();
+		const double falloff = (distance - AudioManager::REFERENCE_SOUND_DISTANCE) /
+			(AudioManager::MAX_SOUND_DISTANCE - AudioManager::REFERENCE_SOUND_DISTANCE);
+		const double gain = 1.0 - std::max(0.0, std::min(falloff, 1.0));
+
+		const Double3 right = mListenerDirection.cross(Double3(0.0, 1.0, 0.0));
+		const double pan = ((distance > 0.0) && (right.lengthSquared() > 0.0)) ?
+			toSound.normalized().dot(right.normalized()) : 0.0;
+
+		leftGain = static_cast<float>(gain * std::min(1.0, 1.0 - pan));
+		rightGain = static_cast<float>(gain * std::min(1.0, 1.0 + pan));
+	}
+
+	if (!mSoundMixer->play(samples, leftGain, rightGain))
+	{
+		mStats.droppedSounds++;
+		return false;
+	}
+
+	mStats.playedSounds++;
+	return true;
+}
+
+bool AudioManagerImpl::startSourceSound(ALuint buffer, SoundPriority priority,
+	const Double3 *position)
+{
+	const double distance = (position != nullptr) ?
+		(*position - mListenerPosition).length() : 0.0;
+
+	const ALuint source = this->acquireSource(priority, distance);
+	if (source == 0)
+	{
+		mStats.droppedSounds++;
+		return false;
+	}
+
+	// Sources are shared by both kinds of sounds, so set the positional state each time.
+	if (position != nullptr)
+	{
+		alSourcei(source, AL_SOURCE_RELATIVE, AL_FALSE);
+		alSource3f(source, AL_POSITION, static_cast<ALfloat>(position->x),
+			static_cast<ALfloat>(position->y), static_cast<ALfloat>(position->z));
+		alSourcef(source, AL_ROLLOFF_FACTOR, 1.0f);
+	}
+	else
+	{
+		alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
+		alSource3f(source, AL_POSITION, 0.0f, 0.0f, 0.0f);
+		alSourcef(source, AL_ROLLOFF_FACTOR, 0.0f);
+	}
+
+	alSourcei(source, AL_BUFFER, buffer);
+	alSourcePlay(source);
+
+	Voice voice;
+	voice.source = source;
+	voice.priority = priority;
+	voice.position = (position != nullptr) ? *position : Double3();
+	voice.isPositional = position != nullptr;
+	voice.distance = distance;
+	voice.serial = mNextVoiceSerial++;
+	mVoices.push_back(voice);
+
+	mStats.playedSounds++;
+	return true;
+}
+
+void AudioManagerImpl::playOrQueueSound(const std::string &filename,
+	SoundPriority priority, const Double3 *position)
+{
+	if (this->isSoundLoaded(filename))
+	{
+		this->startSound(filename, priority, position);
+	}
+	else
+	{
+		// Play it once it's decoded.
+		this->requestDecode(filename);
+
+		PendingSound pendingSound;
+		pendingSound.filename = filename;
+		pendingSound.priority = priority;
+		pendingSound.position = (position != nullptr) ? *position : Double3();
+		pendingSound.isPositional = position != nullptr;
+		pendingSound.requestTime = AudioClock::now();
+		mPendingSounds.push_back(std::move(pendingSound));
+	}
+}
+
+void AudioManagerImpl::startQueuedSounds()
+{
+	// Skip sounds that are too far away to hear before they take a voice.
+	const double maxDistance = AudioManager::MAX_SOUND_DISTANCE;
+	size_t audibleCount = 0;
+	for (size_t i = 0; i < mQueuedSounds.size(); i++)
+	{
+		QueuedSound &queuedSound = mQueuedSounds[i];
+		queuedSound.distance = (queuedSound.position - mListenerPosition).length();
+		if (queuedSound.distance < maxDistance)
+		{
+			if (i != audibleCount)
+			{
+				mQueuedSounds[audibleCount] = std::move(queuedSound);
+			}
+
+			audibleCount++;
+		}
+	}
+
+	mStats.culledSounds += mQueuedSounds.size() - audibleCount;
+	mQueuedSounds.resize(audibleCount);
+
+	// Most important and closest first, so they get voices before the others.
+	std::sort(mQueuedSounds.begin(), mQueuedSounds.end(),
+		[](const QueuedSound &a, const QueuedSound &b)
+	{
+		return (a.priority > b.priority) ||
+			((a.priority == b.priority) && (a.distance < b.distance));
+	});
+
+	for (size_t i = 0; i < mQueuedSounds.size(); i++)
+	{
+		const QueuedSound &queuedSound = mQueuedSounds[i];
+		if (!this->isSoundLoaded(queuedSound.filename))
+		{
+			this->playOrQueueSound(queuedSound.filename, queuedSound.priority,
+				&queuedSound.position);
+		}
+		else if (!this->startSound(queuedSound.filename, queuedSound.priority,
+			&queuedSound.position))
+		{
+			// Every sound after this one is less important, so none of them can get
+			// a voice either.
+			mStats.droppedSounds += mQueuedSounds.size() - (i + 1);
+			break;
+		}
+	}
+
+	mQueuedSounds.clear();
 }
 
 void AudioManagerImpl::playMusic(const std::string &filename)
 {
 	stopMusic();
 
+	// Music always gets a source, even if a sound has to stop for it.
+	if (mFreeSources.empty() && !mVoices.empty())
+	{
+		this->releaseVoice(this->findVictimVoice());
+		mStats.stolenVoices++;
+	}
+
 	if (!mFreeSources.empty())
 	{
-		if (MidiDevice::isInited())
+		if (mPrerenderMusic)
+			mCurrentSong = mMusicPrerenderer.open(filename);
+		else if (MidiDevice::isInited())
 			mCurrentSong = MidiDevice::get().open(filename);
 		if (!mCurrentSong)
 		{
@@ -398,7 +1134,8 @@ void AudioManagerImpl::playMusic(const std::string &filename)
 			return;
 		}
 
-		mSongStream.reset(new OpenALStream(this, mCurrentSong.get()));
+		mSongStream.reset(new OpenALStream(this, mCurrentSong.get(), mMusicCounters,
+			OpenALStream::sDefaultBufferFrames, OpenALStream::sDefaultMinQueueMS));
 		if (mSongStream->init(mFreeSources.front(), mMusicVolume))
 		{
 			mFreeSources.pop_front();
@@ -412,39 +1149,32 @@ void AudioManagerImpl::playMusic(const std::string &filename)
 	}
 }
 
-void AudioManagerImpl::playSound(const std::string &filename)
+void AudioManagerImpl::preloadSound(const std::string &filename)
 {
-	if (!mFreeSources.empty())
-	{
-		auto vocIter = mSoundBuffers.find(filename);
-
-		if (vocIter == mSoundBuffers.end())
-		{
-			// Load the .VOC file and give its PCM data to a new OpenAL buffer.
-			const VOCFile voc(filename);
-
-			ALuint bufferID;
-			alGenBuffers(1, &bufferID);
-			DebugAssert(alGetError() == AL_NO_ERROR, "alGenBuffers");
-
-			const std::vector<uint8_t> &audioData = voc.getAudioData();
-
-			alBufferData(bufferID, AL_FORMAT_MONO8,
-				static_cast<const ALvoid*>(audioData.data()),
-				static_cast<ALsizei>(audioData.size()),
-				static_cast<ALsizei>(voc.getSampleRate()));
+	this->requestDecode(filename);
+}
 
-			vocIter = mSoundBuffers.insert(std::make_pair(filename, bufferID)).first;
-		}
+void AudioManagerImpl::playSound(const std::string &filename, SoundPriority priority)
+{
+	this->playOrQueueSound(filename, priority, nullptr);
+}
 
-		// Play the sound.
-		const ALuint source = mFreeSources.front();
-		alSourcei(source, AL_BUFFER, vocIter->second);
-		alSourcePlay(source);
+void AudioManagerImpl::playSound(const std::string &filename, SoundPriority priority,
+	const Double3 &position)
+{
+	QueuedSound queuedSound;
+	queuedSound.filename = filename;
+	queuedSound.priority = priority;
+	queuedSound.position = position;
+	queuedSound.distance = 0.0;
+	mQueuedSounds.push_back(std::move(queuedSound));
+}
 
-		mUsedSources.push_front(source);
-		mFreeSources.pop_front();
-	}
+void AudioManagerImpl::setListener(const Double3 &position, const Double3 &direction)
+{
+	mListenerPosition = position;
+	mListenerDirection = direction;
+	mListenerDirty = true;
 }
 
 void AudioManagerImpl::stopMusic()
@@ -461,15 +1191,18 @@ void AudioManagerImpl::stopMusic()
 void AudioManagerImpl::stopSound()
 {
 	// Reset all used sources and return them to the free sources.
-	for (ALuint source : mUsedSources)
+	while (!mVoices.empty())
+	{
+		this->releaseVoice(mVoices.size() - 1);
+	}
+
+	if (mSoundMixer != nullptr)
 	{
-		alSourceStop(source);
-		alSourceRewind(source);
-		alSourcei(source, AL_BUFFER, 0);
-		mFreeSources.push_front(source);
+		mSoundMixer->stop();
 	}
 
-	mUsedSources.clear();
+	mPendingSounds.clear();
+	mQueuedSounds.clear();
 }
 
 void AudioManagerImpl::setMusicVolume(double percent)
@@ -492,37 +1225,185 @@ void AudioManagerImpl::setSoundVolume(double percent)
 		alSourcef(source, AL_GAIN, mSfxVolume);
 	}
 
-	for (ALuint source : mUsedSources)
+	for (const Voice &voice : mVoices)
 	{
-		alSourcef(source, AL_GAIN, mSfxVolume);
+		alSourcef(voice.source, AL_GAIN, mSfxVolume);
+	}
+
+	if (mSoundMixer != nullptr)
+	{
+		mSoundMixer->setVolume(mSfxVolume);
 	}
 }
 
 void AudioManagerImpl::update()
 {
-	// If a sound source is done, reset it and return the ID to the free sources.
-	for (size_t i = 0; i < mUsedSources.size(); i++)
+	// Apply the listener once per frame, and update the distances that voice
+	// stealing uses.
+	if (mListenerDirty)
 	{
-		const ALuint source = mUsedSources.at(i);
+		const ALfloat orientation[6] =
+		{
+			static_cast<ALfloat>(mListenerDirection.x),
+			static_cast<ALfloat>(mListenerDirection.y),
+			static_cast<ALfloat>(mListenerDirection.z),
+			0.0f, 1.0f, 0.0f
+		};
+
+		alListener3f(AL_POSITION, static_cast<ALfloat>(mListenerPosition.x),
+			static_cast<ALfloat>(mListenerPosition.y),
+			static_cast<ALfloat>(mListenerPosition.z));
+		alListenerfv(AL_ORIENTATION, orientation);
+
+		for (Voice &voice : mVoices)
+		{
+			if (voice.isPositional)
+			{
+				voice.distance = (voice.position - mListenerPosition).length();
+			}
+		}
+
+		mListenerDirty = false;
+	}
 
+	// If a sound source is done, reset it and return the ID to the free sources.
+	for (size_t i = 0; i < mVoices.size(); )
+	{
 		ALint state;
-		alGetSourcei(source, AL_SOURCE_STATE, &state);
+		alGetSourcei(mVoices[i].source, AL_SOURCE_STATE, &state);
 
 		if (state == AL_STOPPED)
 		{
-			alSourceRewind(source);
-			alSourcei(source, AL_BUFFER, 0);
+			this->releaseVoice(i);
+		}
+		else
+		{
+			i++;
+		}
+	}
 
-			mFreeSources.push_front(source);
-			mUsedSources.erase(mUsedSources.begin() + i);
+	// Upload a few newly decoded sounds to OpenAL. The rest wait for later frames so
+	// the time spent here stays bounded. Mixer sounds were already resampled by the
+	// decoder, so they only need to be stored.
+	const auto now = AudioClock::now();
+	SoundDecoder::DecodedSound sound;
+	for (int i = 0; (i < MAX_UPLOADS_PER_FRAME) && mDecoder.poll(sound); i++)
+	{
+		if (mSoundMixer != nullptr)
+		{
+			mMixerSounds.insert(std::make_pair(sound.filename, sound.mixerSamples));
 		}
+		else
+		{
+			ALuint bufferID;
+			alGenBuffers(1, &bufferID);
+			DebugAssert(alGetError() == AL_NO_ERROR, "alGenBuffers");
+
+			alBufferData(bufferID, AL_FORMAT_MONO8,
+				static_cast<const ALvoid*>(sound.audioData.data()),
+				static_cast<ALsizei>(sound.audioData.size()),
+				static_cast<ALsizei>(sound.sampleRate));
+
+			mSoundBuffers.insert(std::make_pair(sound.filename, bufferID));
+		}
+
+		const auto pendingIter = mPendingDecodes.find(sound.filename);
+		assert(pendingIter != mPendingDecodes.end());
+
+		const double latencyMS = getElapsedMS(pendingIter->second, now);
+		mPendingDecodes.erase(pendingIter);
+
+		mStats.decodedSounds++;
+		mStats.totalDecodeMS += sound.decodeMS;
+		mStats.maxDecodeMS = std::max(mStats.maxDecodeMS, sound.decodeMS);
+		mStats.totalLatencyMS += latencyMS;
+		mStats.maxLatencyMS = std::max(mStats.maxLatencyMS, latencyMS);
 	}
+
+	// Start any requested sounds that are loaded now, and drop ones that waited too
+	// long to still make sense.
+	for (size_t i = 0; i < mPendingSounds.size(); )
+	{
+		const PendingSound &pendingSound = mPendingSounds[i];
+		const bool isLoaded = this->isSoundLoaded(pendingSound.filename);
+		const bool isLate = getElapsedMS(pendingSound.requestTime, now) > MAX_PENDING_MS;
+
+		if (isLoaded || isLate)
+		{
+			if (isLate)
+			{
+				mStats.droppedSounds++;
+			}
+			else
+			{
+				this->startSound(pendingSound.filename, pendingSound.priority,
+					pendingSound.isPositional ? &pendingSound.position : nullptr);
+			}
+
+			mPendingSounds.erase(mPendingSounds.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	// Start the positional sounds from this frame after the finished voices were
+	// freed, so they have as many sources to use as possible.
+	if (!mQueuedSounds.empty())
+	{
+		this->startQueuedSounds();
+	}
+
+	mStats.activeVoices = static_cast<int>(mVoices.size());
+	mStats.mixerVoices = (mSoundMixer != nullptr) ? mSoundMixer->getVoiceCount() : 0;
+	mStats.pendingDecodes = static_cast<int>(mPendingDecodes.size());
+	mStats.musicUnderruns = mMusicCounters.mUnderruns.load();
+	mStats.musicQueuedBuffers = mMusicCounters.mQueuedBuffers.load();
+	mStats.musicTargetBuffers = mMusicCounters.mTargetBuffers.load();
+	mStats.musicSynthesisLoad = mMusicCounters.mSynthesisLoad.load();
+	mStats.mixerUnderruns = mMixerCounters.mUnderruns.load();
 }
 
 // Audio Manager
 
 const double AudioManager::MIN_VOLUME = 0.0;
 const double AudioManager::MAX_VOLUME = 1.0;
+const double AudioManager::REFERENCE_SOUND_DISTANCE = 1.0;
+const double AudioManager::MAX_SOUND_DISTANCE = 24.0;
+
+AudioManager::Stats::Stats()
+{
+	this->activeVoices = 0;
+	this->mixerVoices = 0;
+	this->pendingDecodes = 0;
+	this->decodedSounds = 0;
+	this->playedSounds = 0;
+	this->droppedSounds = 0;
+	this->stolenVoices = 0;
+	this->culledSounds = 0;
+	this->totalDecodeMS = 0.0;
+	this->maxDecodeMS = 0.0;
+	this->totalLatencyMS = 0.0;
+	this->maxLatencyMS = 0.0;
+	this->musicUnderruns = 0;
+	this->musicQueuedBuffers = 0;
+	this->musicTargetBuffers = 0;
+	this->musicSynthesisLoad = 0.0;
+	this->mixerUnderruns = 0;
+}
+
+double AudioManager::Stats::getAverageDecodeMS() const
+{
+	return (this->decodedSounds > 0) ?
+		(this->totalDecodeMS / static_cast<double>(this->decodedSounds)) : 0.0;
+}
+
+double AudioManager::Stats::getAverageLatencyMS() const
+{
+	return (this->decodedSounds > 0) ?
+		(this->totalLatencyMS / static_cast<double>(this->decodedSounds)) : 0.0;
+}
 
 AudioManager::AudioManager()
 	: pImpl(new AudioManagerImpl())
@@ -545,9 +1426,35 @@ void AudioManager::playMusic(const std::string &filename)
 	pImpl->playMusic(filename);
 }
 
+const AudioManager::Stats &AudioManager::getStats() const
+{
+	return pImpl->mStats;
+}
+
+void AudioManager::preloadSound(const std::string &filename)
+{
+	pImpl->preloadSound(filename);
+}
+
+void AudioManager::playSound(const std::string &filename, SoundPriority priority)
+{
+	pImpl->playSound(filename, priority);
+}
+
+void AudioManager::playSound(const std::string &filename, SoundPriority priority,
+	const Double3 &position)
+{
+	pImpl->playSound(filename, priority, position);
+}
+
+void AudioManager::setListener(const Double3 &position, const Double3 &direction)
+{
+	pImpl->setListener(position, direction);
+}
+
 void AudioManager::playSound(const std::string &filename)
 {
-	pImpl->playSound(filename);
+	pImpl->playSound(filename, SoundPriority::Normal);
 }
 
 void AudioManager::stopMusic()
@@ -1,15 +1,65 @@
 #ifndef AUDIO_MANAGER_H
 #define AUDIO_MANAGER_H
 
+#include <cstdint>
 #include <memory>
+#include <string>
+
+#include "../Math/Vector3.h"
 
 // This class manages what sounds and music are played by OpenAL Soft.
 
+// Sounds are decoded on a background thread the first time they are requested, and
+// are uploaded to OpenAL a few at a time in AudioManager::update(), so the game
+// thread never waits on a .VOC file. When all sound channels are busy, a new sound
+// takes the channel of the least important one instead of being dropped.
+
+// Positional sounds are played at a point in the world, relative to the listener
+// (the player), and fade out linearly up to a max distance. They are batched and
+// started in update(), where ones beyond the max distance are skipped before they
+// take a channel, so many emitters can request sounds each frame cheaply.
+
+// Optionally, sounds are instead resampled once when decoded and mixed in software,
+// then streamed through a single OpenAL source. Any number of sounds (up to the
+// mixer's limit) can play at once that way, at the cost of a little more latency.
+
 class AudioManagerImpl;
 class Options;
 
+enum class SoundPriority;
+
 class AudioManager
 {
+public:
+	// Sound loading and scheduling statistics, i.e., for the debug text.
+	struct Stats
+	{
+		int activeVoices, pendingDecodes;
+		int mixerVoices; // Sounds in the software mixer, if it's enabled.
+		uint64_t decodedSounds, playedSounds, droppedSounds, stolenVoices;
+		uint64_t culledSounds; // Positional sounds too far away to hear.
+
+		// Time spent decoding each sound on the background thread, and time from a
+		// sound first being requested to it being ready to play.
+		double totalDecodeMS, maxDecodeMS;
+		double totalLatencyMS, maxLatencyMS;
+
+		// Music stream health: how often playback ran out of audio, how much is
+		// queued versus how much the stream wants queued, and synthesis time as a
+		// fraction of real time.
+		uint64_t musicUnderruns;
+		int musicQueuedBuffers, musicTargetBuffers;
+		double musicSynthesisLoad;
+
+		// Times the software mixer's stream ran out of audio.
+		uint64_t mixerUnderruns;
+
+		Stats();
+
+		double getAverageDecodeMS() const;
+		double getAverageLatencyMS() const;
+	};
+private:
 	std::unique_ptr<AudioManagerImpl> pImpl;
 public:
 	AudioManager();
@@ -20,12 +70,35 @@ public:
 	static const double MIN_VOLUME;
 	static const double MAX_VOLUME;
 
+	// Distance (in voxels) at which positional sounds start to fade, and where they
+	// become silent.
+	static const double REFERENCE_SOUND_DISTANCE;
+	static const double MAX_SOUND_DISTANCE;
+
 	// Plays a music file. All music should loop until changed.
 	void playMusic(const std::string &filename);
 
-	// Plays a sound file. All sounds should play once.
+	// Gets the sound loading and scheduling statistics.
+	const AudioManager::Stats &getStats() const;
+
+	// Starts decoding a sound file in the background so it can be played without
+	// delay later. Does nothing if it's already loaded or being decoded.
+	void preloadSound(const std::string &filename);
+
+	// Plays a sound file. All sounds should play once. If the sound isn't loaded yet,
+	// it starts once decoding is done (or is dropped if that takes too long).
+	void playSound(const std::string &filename, SoundPriority priority);
 	void playSound(const std::string &filename);
 
+	// Plays a sound at a point in the world. It starts in the next update(), unless
+	// it's too far from the listener to hear.
+	void playSound(const std::string &filename, SoundPriority priority,
+		const Double3 &position);
+
+	// Sets the position and facing that positional sounds are heard from (i.e., the
+	// player's). It's given to OpenAL in the next update().
+	void setListener(const Double3 &position, const Double3 &direction);
+
 	// Stops the music.
 	void stopMusic();
 
@@ -39,7 +112,7 @@ public:
 	void setSoundVolume(double percent);
 
 	// Updates any state not handled by a background thread, such as resetting 
-	// the sources of finished sounds.
+	// the sources of finished sounds and uploading newly decoded sounds.
 	void update();
 };
 
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "SDL.h"
+
+#include "FontAtlas.h"
+
+#include "Color.h"
+#include "Font.h"
+#include "../Rendering/Renderer.h"
+#include "../Utilities/Debug.h"
+
+namespace
+{
+	// Characters per row of the atlas, and pixels between neighboring characters
+	// so scaled drawing doesn't pick up a neighbor's edge.
+	const int GlyphsPerRow = 16;
+	const int GlyphPadding = 1;
+
+	// There are 95 characters, plus space (ASCII 32 to 127).
+	const int GlyphCount = 96;
+}
+
+FontAtlas::FontAtlas(const Font &font, Renderer &renderer)
+{
+	this->characterHeight = font.getCharacterHeight();
+	this->glyphs.resize(GlyphCount);
+
+	// Place the characters row by row, then size the texture to fit them.
+	int atlasWidth = 0;
+	int x = 0;
+	int y = 0;
+	for (int i = 0; i < GlyphCount; i++)
+	{
+		if ((i > 0) && ((i % GlyphsPerRow) == 0))
+		{
+			x = 0;
+			y += this->characterHeight + GlyphPadding;
+		}
+
+		const SDL_Surface *surface = font.getSurface(static_cast<char>(i + 32));
+
+		Glyph &glyph = this->glyphs.at(i);
+		glyph.x = x;
+		glyph.y = y;
+		glyph.width = surface->w;
+
+		x += surface->w + GlyphPadding;
+		atlasWidth = std::max(atlasWidth, x);
+	}
+
+	const int atlasHeight = y + this->characterHeight;
+
+	// Copy each character's non-black pixels as white.
+	std::vector<uint32_t> pixels(atlasWidth * atlasHeight, 0);
+	const uint32_t white = Color::White.toARGB();
+	for (int i = 0; i < GlyphCount; i++)
+	{
+		const SDL_Surface *surface = font.getSurface(static_cast<char>(i + 32));
+		const uint32_t *srcPixels = static_cast<const uint32_t*>(surface->pixels);
+		const int srcRowLength = surface->pitch / static_cast<int>(sizeof(uint32_t));
+		const uint32_t black = SDL_MapRGBA(surface->format, 0, 0, 0, 0);
+		const Glyph &glyph = this->glyphs.at(i);
+
+		for (int glyphY = 0; glyphY < surface->h; glyphY++)
+		{
+			const uint32_t *srcRow = srcPixels + (glyphY * srcRowLength);
+			uint32_t *dstRow = pixels.data() + ((glyph.y + glyphY) * atlasWidth) + glyph.x;
+			for (int glyphX = 0; glyphX < surface->w; glyphX++)
+			{
+				if (srcRow[glyphX] != black)
+				{
+					dstRow[glyphX] = white;
+				}
+			}
+		}
+	}
+
+	SDL_Texture *texture = renderer.createTexture(Renderer::DEFAULT_PIXELFORMAT,
+		SDL_TEXTUREACCESS_STATIC, atlasWidth, atlasHeight);
+	DebugAssert(texture != nullptr, "Could not create font atlas texture.");
+
+	SDL_UpdateTexture(texture, nullptr, pixels.data(),
+		atlasWidth * static_cast<int>(sizeof(uint32_t)));
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	this->texture = Texture(texture);
+}
+
+FontAtlas::FontAtlas(FontAtlas &&fontAtlas)
+	: glyphs(std::move(fontAtlas.glyphs)), texture(std::move(fontAtlas.texture))
+{
+	this->characterHeight = fontAtlas.characterHeight;
+}
+
+int FontAtlas::getCharacterHeight() const
+{
+	return this->characterHeight;
+}
+
+const FontAtlas::Glyph &FontAtlas::getGlyph(char c) const
+{
+	DebugAssert((c >= 32) && (c <= 127), "Character value \"" +
+		std::to_string(c) + "\" out of range (must be ASCII 32-127).");
+
+	// Space (ASCII 32) is at index 0.
+	return this->glyphs.at(c - 32);
+}
+
+const Texture &FontAtlas::getTexture() const
+{
+	return this->texture;
+}
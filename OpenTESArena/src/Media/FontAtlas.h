@@ -0,0 +1,48 @@
+#ifndef FONT_ATLAS_H
+#define FONT_ATLAS_H
+
+#include <vector>
+
+#include "../Rendering/Texture.h"
+
+// A font atlas packs every character of a font into one texture, so text can be drawn
+// straight from it with one texture copy per character instead of being blitted into
+// a new surface and texture first (see TextLayout).
+
+// Characters are drawn in white where the font's pixels aren't black, and transparent
+// everywhere else, so any text color can be applied with color modulation.
+
+class Font;
+class Renderer;
+
+class FontAtlas
+{
+public:
+	// Where a character is in the atlas texture. Every character has the font's height.
+	struct Glyph
+	{
+		int x, y, width;
+	};
+private:
+	// ASCII character-indexed glyphs, where space (ASCII 32) is index 0.
+	std::vector<Glyph> glyphs;
+	Texture texture;
+	int characterHeight;
+public:
+	FontAtlas(const Font &font, Renderer &renderer);
+	FontAtlas(FontAtlas &&fontAtlas);
+	FontAtlas(const FontAtlas&) = delete;
+
+	FontAtlas &operator=(const FontAtlas&) = delete;
+
+	// Gets the height in pixels for all characters in the font.
+	int getCharacterHeight() const;
+
+	// Gets where a character is in the atlas texture.
+	const FontAtlas::Glyph &getGlyph(char c) const;
+
+	// Gets the texture that all characters are in.
+	const Texture &getTexture() const;
+};
+
+#endif
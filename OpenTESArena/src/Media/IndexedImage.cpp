@@ -0,0 +1,101 @@
+#include <cassert>
+
+#include "IndexedImage.h"
+#include "Palette.h"
+
+IndexedImage::IndexedImage(int width, int height, std::vector<uint8_t> &&indices)
+	: indices(std::move(indices))
+{
+	assert(this->indices.size() == static_cast<size_t>(width * height));
+
+	this->width = width;
+	this->height = height;
+}
+
+IndexedImage::IndexedImage(IndexedImage &&indexedImage)
+	: indices(std::move(indexedImage.indices))
+{
+	this->width = indexedImage.width;
+	this->height = indexedImage.height;
+}
+
+IndexedImage::~IndexedImage()
+{
+
+}
+
+std::array<uint32_t, 256> IndexedImage::makePaletteARGB(const Palette &palette)
+{
+	std::array<uint32_t, 256> paletteARGB;
+	for (size_t i = 0; i < paletteARGB.size(); ++i)
+	{
+		paletteARGB[i] = palette.get()[i].toARGB();
+	}
+
+	return paletteARGB;
+}
+
+void IndexedImage::expandToARGB(const uint8_t *src, int count,
+	const std::array<uint32_t, 256> &paletteARGB, uint32_t *dst)
+{
+	const uint32_t *lut = paletteARGB.data();
+	int i = 0;
+
+	// Unrolled so the loads and stores of independent pixels can overlap.
+	for (; (i + 4) <= count; i += 4)
+	{
+		const uint32_t color0 = lut[src[i]];
+		const uint32_t color1 = lut[src[i + 1]];
+		const uint32_t color2 = lut[src[i + 2]];
+		const uint32_t color3 = lut[src[i + 3]];
+		dst[i] = color0;
+		dst[i + 1] = color1;
+		dst[i + 2] = color2;
+		dst[i + 3] = color3;
+	}
+
+	for (; i < count; ++i)
+	{
+		dst[i] = lut[src[i]];
+	}
+}
+
+int IndexedImage::getWidth() const
+{
+	return this->width;
+}
+
+int IndexedImage::getHeight() const
+{
+	return this->height;
+}
+
+const uint8_t *IndexedImage::getIndices() const
+{
+	return this->indices.data();
+}
+
+size_t IndexedImage::getByteCount() const
+{
+	return this->indices.size();
+}
+
+void IndexedImage::writeARGB(const Palette &palette, uint32_t *dst, int pitch) const
+{
+	const std::array<uint32_t, 256> paletteARGB = IndexedImage::makePaletteARGB(palette);
+
+	if (pitch == this->width)
+	{
+		// Contiguous destination, so do it in one pass.
+		IndexedImage::expandToARGB(this->indices.data(),
+			static_cast<int>(this->indices.size()), paletteARGB, dst);
+	}
+	else
+	{
+		for (int y = 0; y < this->height; ++y)
+		{
+			IndexedImage::expandToARGB(this->indices.data() + (y * this->width),
+				this->width, paletteARGB, dst + (y * pitch));
+		}
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef INDEXED_IMAGE_H
+#define INDEXED_IMAGE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// An 8-bit palette-indexed image. Arena images are stored this way, so keeping them
+// as indices means one copy per image regardless of how many palettes it's drawn
+// with. ARGB pixels are only made when an image is needed with a certain palette.
+
+class Palette;
+
+class IndexedImage
+{
+private:
+	std::vector<uint8_t> indices;
+	int width, height;
+public:
+	IndexedImage(int width, int height, std::vector<uint8_t> &&indices);
+	IndexedImage(IndexedImage &&indexedImage);
+	~IndexedImage();
+
+	// Converts a palette to ARGB colors for use with expandToARGB().
+	static std::array<uint32_t, 256> makePaletteARGB(const Palette &palette);
+
+	// Converts a run of palette indices to ARGB colors with an unrolled table lookup.
+	static void expandToARGB(const uint8_t *src, int count,
+		const std::array<uint32_t, 256> &paletteARGB, uint32_t *dst);
+
+	int getWidth() const;
+	int getHeight() const;
+	const uint8_t *getIndices() const;
+
+	// Gets the number of bytes used by the indices.
+	size_t getByteCount() const;
+
+	// Writes the image as ARGB pixels into the given buffer. The pitch is in pixels.
+	void writeARGB(const Palette &palette, uint32_t *dst, int pitch) const;
+};
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef PRELOAD_GROUP_H
+#define PRELOAD_GROUP_H
+
+// A preload group is a part of the game that uses a mostly predictable set of
+// textures, so they can be loaded ahead of time (i.e., during a cinematic) instead
+// of when they are first drawn. Each group has its own preload manifest.
+
+enum class PreloadGroup
+{
+	MainMenu,
+	City,
+	Dungeon
+};
+
+#endif
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "PreloadManifest.h"
+
+#include "PreloadGroup.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/File.h"
+#include "../Utilities/String.h"
+
+namespace
+{
+	const std::map<PreloadGroup, std::string> PreloadGroupNames =
+	{
+		{ PreloadGroup::MainMenu, "MainMenu" },
+		{ PreloadGroup::City, "City" },
+		{ PreloadGroup::Dungeon, "Dungeon" }
+	};
+
+	const std::map<PreloadManifest::AssetType, std::string> PreloadManifestTypeNames =
+	{
+		{ PreloadManifest::AssetType::Surface, "surface" },
+		{ PreloadManifest::AssetType::Texture, "texture" },
+		{ PreloadManifest::AssetType::Surfaces, "surfaces" },
+		{ PreloadManifest::AssetType::Textures, "textures" }
+	};
+}
+
+const char PreloadManifest::COMMENT = '#';
+const int PreloadManifest::MAX_UNUSED_SESSIONS = 5;
+const int PreloadManifest::MAX_ASSETS = 2048;
+
+PreloadManifest::Asset::Asset(AssetType type, const std::string &filename,
+	const std::string &paletteName, int unusedSessions)
+	: filename(filename), paletteName(paletteName)
+{
+	this->type = type;
+	this->unusedSessions = unusedSessions;
+	this->used = false;
+}
+
+PreloadManifest::PreloadManifest()
+{
+	this->dirty = false;
+}
+
+std::string PreloadManifest::getFilename(PreloadGroup group)
+{
+	return "preload_" + String::toLowercase(
+		PreloadManifest::getGroupName(group)) + ".txt";
+}
+
+const std::string &PreloadManifest::getGroupName(PreloadGroup group)
+{
+	return PreloadGroupNames.at(group);
+}
+
+const std::vector<PreloadManifest::Asset> &PreloadManifest::getAssets() const
+{
+	return this->assets;
+}
+
+bool PreloadManifest::isDirty() const
+{
+	return this->dirty;
+}
+
+void PreloadManifest::add(AssetType type, const std::string &filename,
+	const std::string &paletteName)
+{
+	this->assets.push_back(Asset(type, filename, paletteName, 0));
+	this->assets.back().used = true;
+	this->dirty = true;
+}
+
+void PreloadManifest::markUsed(int index)
+{
+	Asset &asset = this->assets.at(index);
+	if (!asset.used)
+	{
+		asset.used = true;
+
+		if (asset.unusedSessions > 0)
+		{
+			asset.unusedSessions = 0;
+			this->dirty = true;
+		}
+	}
+}
+
+void PreloadManifest::endSession()
+{
+	const bool anyUsed = std::any_of(this->assets.begin(), this->assets.end(),
+		[](const Asset &asset) { return asset.used; });
+
+	// Quitting right after entering a part of the game shouldn't age its manifest.
+	if (!anyUsed)
+	{
+		return;
+	}
+
+	std::vector<Asset> keptAssets;
+	for (auto &asset : this->assets)
+	{
+		if (!asset.used)
+		{
+			asset.unusedSessions++;
+			this->dirty = true;
+		}
+
+		asset.used = false;
+
+		if (asset.unusedSessions <= PreloadManifest::MAX_UNUSED_SESSIONS)
+		{
+			keptAssets.push_back(asset);
+		}
+	}
+
+	// Past the size limit, drop the assets that have gone unused the longest. The rest
+	// stay in the order they were first requested.
+	if (keptAssets.size() > static_cast<size_t>(PreloadManifest::MAX_ASSETS))
+	{
+		std::vector<int> ages;
+		for (const auto &asset : keptAssets)
+		{
+			ages.push_back(asset.unusedSessions);
+		}
+
+		std::sort(ages.begin(), ages.end());
+		const int maxAge = ages.at(PreloadManifest::MAX_ASSETS - 1);
+		int maxAgeRemaining = static_cast<int>(std::count(ages.begin(),
+			ages.begin() + PreloadManifest::MAX_ASSETS, maxAge));
+
+		std::vector<Asset> limitedAssets;
+		for (const auto &asset : keptAssets)
+		{
+			if (asset.unusedSessions < maxAge)
+			{
+				limitedAssets.push_back(asset);
+			}
+			else if ((asset.unusedSessions == maxAge) && (maxAgeRemaining > 0))
+			{
+				limitedAssets.push_back(asset);
+				maxAgeRemaining--;
+			}
+		}
+
+		keptAssets = std::move(limitedAssets);
+	}
+
+	if (keptAssets.size() != this->assets.size())
+	{
+		this->dirty = true;
+	}
+
+	this->assets = std::move(keptAssets);
+}
+
+void PreloadManifest::load(const std::string &filename)
+{
+	this->assets.clear();
+	this->dirty = false;
+
+	// A missing manifest just means nothing has been recorded for the group yet.
+	if (!File::exists(filename))
+	{
+		return;
+	}
+
+	std::string text = File::readAllText(filename);
+	std::istringstream iss(text);
+
+	std::string line;
+	while (std::getline(iss, line))
+	{
+		line = String::trimLines(line);
+
+		// Ignore comments and blank lines.
+		if ((line.length() == 0) || (line.at(0) == PreloadManifest::COMMENT))
+		{
+			continue;
+		}
+
+		// The manifest is generated, so a bad line is skipped instead of being fatal.
+		const std::vector<std::string> tokens = String::split(line, ' ');
+		if (tokens.size() != 4)
+		{
+			DebugWarning("Invalid line \"" + line + "\" in " + filename + ".");
+			continue;
+		}
+
+		const auto typeIter = std::find_if(PreloadManifestTypeNames.begin(),
+			PreloadManifestTypeNames.end(), [&tokens](
+				const std::pair<const PreloadManifest::AssetType, std::string> &pair)
+		{
+			return pair.second == tokens.at(0);
+		});
+
+		if (typeIter == PreloadManifestTypeNames.end())
+		{
+			DebugWarning("Invalid asset type \"" + tokens.at(0) + "\" in " + filename + ".");
+			continue;
+		}
+
+		const std::string &countStr = tokens.at(3);
+		const bool isCount = (countStr.size() > 0) && (countStr.size() < 4) &&
+			std::all_of(countStr.begin(), countStr.end(), ::isdigit);
+
+		if (!isCount)
+		{
+			DebugWarning("Invalid unused session count \"" + countStr + "\" in " +
+				filename + ".");
+			continue;
+		}
+
+		this->assets.push_back(Asset(typeIter->first,
+			tokens.at(1), tokens.at(2), std::stoi(countStr)));
+	}
+}
+
+void PreloadManifest::save(const std::string &filename)
+{
+	std::ofstream ofs(filename, std::ios::out | std::ios::trunc);
+	if (!ofs.is_open())
+	{
+		DebugWarning("Could not write \"" + filename + "\".");
+		return;
+	}
+
+	ofs << PreloadManifest::COMMENT << " Generated by recording texture requests. " <<
+		"Delete this file to record it again." << '\n';
+
+	for (const auto &asset : this->assets)
+	{
+		ofs << PreloadManifestTypeNames.at(asset.type) << ' ' << asset.filename <<
+			' ' << asset.paletteName << ' ' << asset.unusedSessions << '\n';
+	}
+
+	this->dirty = false;
+}
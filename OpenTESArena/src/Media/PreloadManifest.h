@@ -0,0 +1,87 @@
+#ifndef PRELOAD_MANIFEST_H
+#define PRELOAD_MANIFEST_H
+
+#include <string>
+#include <vector>
+
+// A preload manifest is a list of the textures a part of the game uses, along with
+// the palette each one was requested with. It is generated by recording which
+// textures are actually requested while playing, and is read back later so the
+// texture manager can load them before they are needed.
+
+// Manifests are plain text files in the options folder, with one asset per line:
+// "<type> <filename> <palette name> <unused sessions>", where the type is one of
+// "surface", "texture", "surfaces", or "textures".
+
+// Each recording session ages the assets it didn't request. Ones that go unused for
+// several sessions are dropped, and the manifest has a size limit, so it follows
+// what the game currently uses instead of growing forever.
+
+enum class PreloadGroup;
+
+class PreloadManifest
+{
+public:
+	// Which texture manager method the asset was requested through.
+	enum class AssetType
+	{
+		Surface,
+		Texture,
+		Surfaces,
+		Textures
+	};
+
+	struct Asset
+	{
+		AssetType type;
+		std::string filename, paletteName;
+		int unusedSessions; // Recording sessions in a row that didn't request it.
+		bool used; // Whether it was requested in the current recording session.
+
+		Asset(AssetType type, const std::string &filename, const std::string &paletteName,
+			int unusedSessions);
+	};
+private:
+	static const char COMMENT;
+	static const int MAX_UNUSED_SESSIONS;
+	static const int MAX_ASSETS;
+
+	std::vector<Asset> assets;
+	bool dirty;
+public:
+	PreloadManifest();
+
+	// Gets the manifest filename for a preload group (i.e., "preload_city.txt").
+	static std::string getFilename(PreloadGroup group);
+
+	// Gets the display name of a preload group, for debug messages.
+	static const std::string &getGroupName(PreloadGroup group);
+
+	// Gets the assets in the order they were first requested.
+	const std::vector<Asset> &getAssets() const;
+
+	// Returns whether the manifest changed since it was last loaded or saved.
+	bool isDirty() const;
+
+	// Adds an asset to the end of the manifest, as requested in the current recording
+	// session. The caller is responsible for not adding the same asset twice.
+	void add(AssetType type, const std::string &filename, const std::string &paletteName);
+
+	// Marks an existing asset as requested in the current recording session.
+	void markUsed(int index);
+
+	// Ends the current recording session. Assets it didn't request age by one session,
+	// and ones unused for too long or past the size limit are dropped. A session that
+	// requested nothing leaves the manifest as it is. Asset indices are invalid after
+	// this.
+	void endSession();
+
+	// Replaces the manifest's assets with the ones in the given file. If the file
+	// doesn't exist, the manifest is left empty.
+	void load(const std::string &filename);
+
+	// Writes the manifest's assets to the given file.
+	void save(const std::string &filename);
+};
+
+#endif
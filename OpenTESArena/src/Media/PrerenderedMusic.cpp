@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+#include "PrerenderedMusic.hpp"
+
+#include "../Utilities/Debug.h"
+
+namespace
+{
+	const int ImaIndexTable[16] =
+	{
+		-1, -1, -1, -1, 2, 4, 6, 8,
+		-1, -1, -1, -1, 2, 4, 6, 8
+	};
+
+	const int ImaStepTable[89] =
+	{
+		7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+		50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+		253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+		1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+		3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+		12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+	};
+
+	// Decodes one 4-bit IMA ADPCM code, updating the channel's predictor state.
+	int16_t decodeIma(uint8_t code, int &predictor, int &stepIndex)
+	{
+		const int step = ImaStepTable[stepIndex];
+
+		int diff = step >> 3;
+		if ((code & 1) != 0) diff += step >> 2;
+		if ((code & 2) != 0) diff += step >> 1;
+		if ((code & 4) != 0) diff += step;
+		if ((code & 8) != 0) diff = -diff;
+
+		predictor = std::max(-32768, std::min(predictor + diff, 32767));
+		stepIndex = std::max(0, std::min(stepIndex + ImaIndexTable[code], 88));
+		return static_cast<int16_t>(predictor);
+	}
+
+	// Encodes one sample as a 4-bit IMA ADPCM code. The state is updated through the
+	// decoder so it matches what playback will see.
+	uint8_t encodeIma(int16_t sample, int &predictor, int &stepIndex)
+	{
+		const int step = ImaStepTable[stepIndex];
+
+		int diff = static_cast<int>(sample) - predictor;
+		uint8_t code = 0;
+		if (diff < 0)
+		{
+			code = 8;
+			diff = -diff;
+		}
+
+		if (diff >= step) { code |= 4; diff -= step; }
+		if (diff >= (step >> 1)) { code |= 2; diff -= step >> 1; }
+		if (diff >= (step >> 2)) { code |= 1; }
+
+		decodeIma(code, predictor, stepIndex);
+		return code;
+	}
+}
+
+PrerenderedMusic::PrerenderedMusic(int sampleRate)
+	: mFrameCount(0), mComplete(false), mCancelled(false), mSampleRate(sampleRate)
+{
+	mChunks.reserve(sMaxChunks);
+}
+
+void PrerenderedMusic::append(const uint8_t *frames, size_t count)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		while (count > 0)
+		{
+			const size_t chunkOffset = mFrameCount % sChunkFrames;
+			if (chunkOffset == 0)
+			{
+				assert(mChunks.size() < sMaxChunks);
+				mChunks.push_back(std::vector<uint8_t>(sChunkFrames));
+			}
+
+			const size_t copyCount = std::min(count, sChunkFrames - chunkOffset);
+			std::copy(frames, frames + copyCount, mChunks.back().begin() + chunkOffset);
+
+			frames += copyCount;
+			count -= copyCount;
+			mFrameCount += copyCount;
+		}
+	}
+
+	mCondition.notify_all();
+}
+
+void PrerenderedMusic::finish()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mComplete = true;
+	}
+
+	mCondition.notify_all();
+}
+
+void PrerenderedMusic::cancel()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mCancelled = true;
+	}
+
+	mCondition.notify_all();
+}
+
+bool PrerenderedMusic::isComplete() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mComplete;
+}
+
+bool PrerenderedMusic::isCancelled() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mCancelled;
+}
+
+size_t PrerenderedMusic::waitForFrames(size_t count) const
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mCondition.wait(lock, [this, count]()
+	{
+		return mComplete || mCancelled || (mFrameCount >= count);
+	});
+
+	return mFrameCount;
+}
+
+PrerenderedSong::PrerenderedSong(const PrerenderedMusicPtr &music)
+	: mMusic(music), mFrame(0)
+{
+	seek(0);
+}
+
+void PrerenderedSong::getFormat(int *sampleRate)
+{
+	*sampleRate = mMusic->getSampleRate();
+}
+
+size_t PrerenderedSong::read(char *buffer, size_t count)
+{
+	/* Wait for the whole request, so a short read always means the end of the
+	 * song. This only waits if playback caught up with rendering.
+	 */
+	const size_t available = mMusic->waitForFrames(mFrame + count);
+	const size_t frameCount = std::min(count, available - mFrame);
+
+	int16_t *samples = reinterpret_cast<int16_t*>(buffer);
+	for (size_t i = 0; i < frameCount; i++)
+	{
+		const uint8_t frame = mMusic->getFrame(mFrame + i);
+		samples[i * 2] = decodeIma(frame & 0xF, mPredictors[0], mStepIndices[0]);
+		samples[(i * 2) + 1] = decodeIma(frame >> 4, mPredictors[1], mStepIndices[1]);
+	}
+
+	mFrame += frameCount;
+	return frameCount;
+}
+
+bool PrerenderedSong::seek(size_t offset)
+{
+	if ((offset != 0) || mMusic->isCancelled())
+		return false;
+
+	mFrame = 0;
+	std::fill(std::begin(mPredictors), std::end(mPredictors), 0);
+	std::fill(std::begin(mStepIndices), std::end(mStepIndices), 0);
+	return true;
+}
+
+MusicPrerenderer::MusicPrerenderer()
+	: mQuit(false)
+{
+}
+
+MusicPrerenderer::~MusicPrerenderer()
+{
+	stop();
+}
+
+void MusicPrerenderer::render(MidiSong &song, PrerenderedMusic &music)
+{
+	const size_t blockFrames = 4096;
+	std::vector<int16_t> samples(blockFrames * 2);
+	std::vector<uint8_t> frames(blockFrames);
+
+	int predictors[2] = { 0, 0 };
+	int stepIndices[2] = { 0, 0 };
+
+	const size_t maxFrames = PrerenderedMusic::sChunkFrames * PrerenderedMusic::sMaxChunks;
+	size_t totalFrames = 0;
+
+	while (totalFrames < maxFrames)
+	{
+		/* Stop as soon as another song is opened or the prerenderer stops. */
+		if (music.isCancelled())
+			return;
+
+		const size_t toget = std::min(blockFrames, maxFrames - totalFrames);
+		const size_t got = song.read(reinterpret_cast<char*>(samples.data()), toget);
+
+		for (size_t i = 0; i < got; i++)
+		{
+			const uint8_t left = encodeIma(samples[i * 2], predictors[0], stepIndices[0]);
+			const uint8_t right = encodeIma(samples[(i * 2) + 1], predictors[1], stepIndices[1]);
+			frames[i] = left | (right << 4);
+		}
+
+		music.append(frames.data(), got);
+		totalFrames += got;
+
+		/* A short read is the end of the song. */
+		if (got < toget)
+			break;
+	}
+
+	music.finish();
+}
+
+void MusicPrerenderer::backgroundProc()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true)
+	{
+		mCondition.wait(lock, [this]() { return mQuit || !mRequests.empty(); });
+		if (mQuit)
+			break;
+
+		std::pair<MidiSongPtr, PrerenderedMusicPtr> request = std::move(mRequests.front());
+		mRequests.pop_front();
+
+		/* Songs cancelled while they were waiting are skipped. */
+		if (request.second->isCancelled())
+			continue;
+
+		mCurrentMusic = request.second;
+		lock.unlock();
+		render(*request.first, *request.second);
+		lock.lock();
+		mCurrentMusic = nullptr;
+	}
+}
+
+void MusicPrerenderer::start()
+{
+	assert(mThread.get_id() == std::thread::id());
+	mThread = std::thread(std::mem_fn(&MusicPrerenderer::backgroundProc), this);
+}
+
+void MusicPrerenderer::stop()
+{
+	if (mThread.get_id() != std::thread::id())
+	{
+		{
+			/* Cancelling wakes any reader right away, and the background thread
+			 * stops rendering at its next block.
+			 */
+			std::lock_guard<std::mutex> lock(mMutex);
+			mQuit = true;
+
+			if (mCurrentMusic)
+				mCurrentMusic->cancel();
+
+			for (auto &request : mRequests)
+				request.second->cancel();
+			mRequests.clear();
+		}
+
+		mCondition.notify_one();
+		mThread.join();
+	}
+}
+
+MidiSongPtr MusicPrerenderer::open(const std::string &name)
+{
+	/* Only one song plays at a time, so unfinished renders of other songs are
+	 * stale. Cancel them so the requested song doesn't wait behind them; they're
+	 * rendered again from the start if played later.
+	 */
+	for (auto iter = mSongs.begin(); iter != mSongs.end(); )
+	{
+		const PrerenderedMusicPtr &music = iter->second;
+		const bool stale = music->isCancelled() ||
+			((iter->first != name) && !music->isComplete());
+
+		if (stale)
+		{
+			music->cancel();
+			mSongOrder.remove(iter->first);
+			iter = mSongs.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	auto songIter = mSongs.find(name);
+	if (songIter == mSongs.end())
+	{
+		/* First use, so open the song for synthesis and render it in the
+		 * background.
+		 */
+		if (!MidiDevice::isInited())
+			return MidiSongPtr(nullptr);
+
+		MidiSongPtr song = MidiDevice::get().open(name);
+		if (!song)
+			return MidiSongPtr(nullptr);
+
+		int sampleRate;
+		song->getFormat(&sampleRate);
+
+		PrerenderedMusicPtr music(new PrerenderedMusic(sampleRate));
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mRequests.push_back(std::make_pair(std::move(song), music));
+		}
+
+		mCondition.notify_one();
+
+		songIter = mSongs.insert(std::make_pair(name, music)).first;
+		mSongOrder.push_front(name);
+
+		/* Forget the least recently played song if there are too many. Anything
+		 * still playing it keeps its own reference.
+		 */
+		if (mSongOrder.size() > sMaxSongs)
+		{
+			mSongs.erase(mSongOrder.back());
+			mSongOrder.pop_back();
+		}
+	}
+	else
+	{
+		mSongOrder.remove(name);
+		mSongOrder.push_front(name);
+	}
+
+	return MidiSongPtr(new PrerenderedSong(songIter->second));
+}
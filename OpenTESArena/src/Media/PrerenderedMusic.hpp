@@ -0,0 +1,146 @@
+#ifndef MEDIA_PRERENDERED_MUSIC_HPP
+#define MEDIA_PRERENDERED_MUSIC_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Midi.hpp"
+
+/* Songs synthesized once on a background thread and kept in memory, so playing
+ * them again needs no synthesis. Audio is stored as 4-bit IMA ADPCM (one byte per
+ * 16-bit stereo frame), which is about 2.8 MB per minute at 48 kHz. A song can
+ * start playing while it is still being rendered, since rendering is much faster
+ * than real time.
+ *
+ * Only one song plays at a time, so opening a song cancels the unfinished renders
+ * of every other song. The requested song is always the one being rendered, and
+ * switching songs never waits behind older renders.
+ */
+
+/* PCM for one song. Written by the prerenderer thread, read by any number of
+ * PrerenderedSongs.
+ */
+class PrerenderedMusic {
+public:
+    /* One second of frames at 48 kHz. */
+    static const size_t sChunkFrames = 48000;
+
+    /* Longest song that is rendered, in chunks. Anything longer is cut off. */
+    static const size_t sMaxChunks = 20 * 60;
+
+private:
+    mutable std::mutex mMutex;
+    mutable std::condition_variable mCondition;
+
+    /* Chunks are reserved up front so the outer vector never reallocates while
+     * readers are using it.
+     */
+    std::vector<std::vector<uint8_t>> mChunks;
+    size_t mFrameCount;
+    bool mComplete;
+    bool mCancelled;
+    int mSampleRate;
+
+public:
+    PrerenderedMusic(int sampleRate);
+
+    int getSampleRate() const { return mSampleRate; }
+
+    /* Adds encoded frames to the end of the song. */
+    void append(const uint8_t *frames, size_t count);
+
+    /* Marks the song as fully rendered, waking any waiting readers. */
+    void finish();
+
+    /* Stops the song from getting any more frames, waking any waiting readers. */
+    void cancel();
+
+    bool isComplete() const;
+    bool isCancelled() const;
+
+    /* Waits until there are at least the given number of frames, or until the song
+     * is complete or cancelled, then returns the total number of frames available.
+     */
+    size_t waitForFrames(size_t count) const;
+
+    /* Gets an encoded frame. It must be below a count returned by waitForFrames(). */
+    uint8_t getFrame(size_t index) const
+    {
+        return mChunks[index / sChunkFrames][index % sChunkFrames];
+    }
+};
+typedef std::shared_ptr<PrerenderedMusic> PrerenderedMusicPtr;
+
+/* Plays back a prerendered song through the MidiSong interface, so the music
+ * stream doesn't need to know where its samples come from.
+ */
+class PrerenderedSong : public MidiSong {
+    PrerenderedMusicPtr mMusic;
+    size_t mFrame;
+    int mPredictors[2];
+    int mStepIndices[2];
+
+public:
+    PrerenderedSong(const PrerenderedMusicPtr &music);
+
+    virtual void getFormat(int *sampleRate) override;
+
+    /* Waits for all of the requested frames to be rendered. Only returns fewer at
+     * the end of the song, or if its render was cancelled.
+     */
+    virtual size_t read(char *buffer, size_t count) override;
+
+    /* Only rewinding is supported, since ADPCM can't be decoded from the middle.
+     * A cancelled song can't be rewound, since it's missing its ending.
+     */
+    virtual bool seek(size_t offset) override;
+};
+
+/* Renders songs on a background thread and keeps the most recently played ones. */
+class MusicPrerenderer {
+    /* Most songs kept in memory at once. */
+    static const size_t sMaxSongs = 8;
+
+    /* Songs waiting to be rendered, and the one being rendered now (if any). */
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<std::pair<MidiSongPtr, PrerenderedMusicPtr>> mRequests;
+    PrerenderedMusicPtr mCurrentMusic;
+    bool mQuit;
+    std::thread mThread;
+
+    /* Owned by the caller's thread. Most recently played songs are first. */
+    std::unordered_map<std::string, PrerenderedMusicPtr> mSongs;
+    std::list<std::string> mSongOrder;
+
+    void render(MidiSong &song, PrerenderedMusic &music);
+    void backgroundProc();
+
+public:
+    MusicPrerenderer();
+    ~MusicPrerenderer();
+
+    void start();
+
+    /* Cancels every unfinished render, waking anything reading them, then waits for
+     * the background thread to finish.
+     */
+    void stop();
+
+    /* Gets a song that plays from the cache, starting to render it if this is its
+     * first use. Unfinished renders of other songs are cancelled. Returns null if
+     * the song can't be opened.
+     */
+    MidiSongPtr open(const std::string &name);
+};
+
+#endif /* MEDIA_PRERENDERED_MUSIC_HPP */
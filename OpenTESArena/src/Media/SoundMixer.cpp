@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "SoundMixer.h"
+
+const int SoundMixer::MAX_VOICES = 128;
+
+SoundMixer::SoundMixer(int sampleRate)
+{
+	assert(sampleRate > 0);
+
+	this->volume = 1.0f;
+	this->sampleRate = sampleRate;
+	this->voices.reserve(SoundMixer::MAX_VOICES);
+}
+
+SoundMixer::~SoundMixer()
+{
+
+}
+
+std::vector<int16_t> SoundMixer::resample(const std::vector<uint8_t> &src, int srcRate,
+	int dstRate)
+{
+	assert(srcRate > 0);
+	assert(dstRate > 0);
+
+	if (src.size() == 0)
+	{
+		return std::vector<int16_t>();
+	}
+
+	const double step = static_cast<double>(srcRate) / static_cast<double>(dstRate);
+	const size_t dstCount = static_cast<size_t>(std::ceil(
+		static_cast<double>(src.size()) / step));
+	std::vector<int16_t> dst(dstCount);
+
+	// Unsigned 8-bit samples are centered on 128.
+	auto toFloat = [](uint8_t sample)
+	{
+		return static_cast<float>((static_cast<int>(sample) - 128) * 256);
+	};
+
+	const size_t lastIndex = src.size() - 1;
+	for (size_t i = 0; i < dstCount; i++)
+	{
+		const double srcPosition = static_cast<double>(i) * step;
+		const size_t index = std::min(static_cast<size_t>(srcPosition), lastIndex);
+		const size_t nextIndex = std::min(index + 1, lastIndex);
+		const float percent = static_cast<float>(srcPosition - static_cast<double>(index));
+
+		const float sample = toFloat(src[index]) +
+			((toFloat(src[nextIndex]) - toFloat(src[index])) * percent);
+		dst[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(sample, 32767.0f)));
+	}
+
+	return dst;
+}
+
+void SoundMixer::mixVoice(const int16_t *src, size_t count, float leftGain,
+	float rightGain, float *dst)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	// Four mono samples become four stereo frames per iteration.
+	const __m128 left = _mm_set1_ps(leftGain);
+	const __m128 right = _mm_set1_ps(rightGain);
+	for (; (i + 4) <= count; i += 4)
+	{
+		const __m128i samples16 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+		const __m128i samples32 = _mm_srai_epi32(_mm_unpacklo_epi16(samples16, samples16), 16);
+		const __m128 samples = _mm_cvtepi32_ps(samples32);
+
+		const __m128 leftSamples = _mm_mul_ps(samples, left);
+		const __m128 rightSamples = _mm_mul_ps(samples, right);
+
+		float *frames = dst + (i * 2);
+		_mm_storeu_ps(frames, _mm_add_ps(_mm_loadu_ps(frames),
+			_mm_unpacklo_ps(leftSamples, rightSamples)));
+		_mm_storeu_ps(frames + 4, _mm_add_ps(_mm_loadu_ps(frames + 4),
+			_mm_unpackhi_ps(leftSamples, rightSamples)));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		const float sample = static_cast<float>(src[i]);
+		dst[i * 2] += sample * leftGain;
+		dst[(i * 2) + 1] += sample * rightGain;
+	}
+}
+
+void SoundMixer::convertToInt16(const float *src, size_t count, float volume, int16_t *dst)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	// The pack instruction saturates, so no separate clamp is needed.
+	const __m128 scale = _mm_set1_ps(volume);
+	for (; (i + 8) <= count; i += 8)
+	{
+		const __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), scale));
+		const __m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(low, high));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		const float sample = src[i] * volume;
+		dst[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(sample, 32767.0f)));
+	}
+}
+
+int SoundMixer::getSampleRate() const
+{
+	return this->sampleRate;
+}
+
+int SoundMixer::getVoiceCount()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return static_cast<int>(this->voices.size());
+}
+
+bool SoundMixer::play(const SamplesPtr &samples, float leftGain, float rightGain)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (this->voices.size() >= static_cast<size_t>(SoundMixer::MAX_VOICES))
+	{
+		return false;
+	}
+
+	Voice voice;
+	voice.samples = samples;
+	voice.offset = 0;
+	voice.leftGain = leftGain;
+	voice.rightGain = rightGain;
+	this->voices.push_back(std::move(voice));
+	return true;
+}
+
+void SoundMixer::stop()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->voices.clear();
+}
+
+void SoundMixer::setVolume(float volume)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->volume = volume;
+}
+
+void SoundMixer::mix(int16_t *dst, size_t frameCount)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	const size_t sampleCount = frameCount * 2;
+	this->mixBuffer.resize(sampleCount);
+	std::fill(this->mixBuffer.begin(), this->mixBuffer.end(), 0.0f);
+
+	for (size_t i = 0; i < this->voices.size(); )
+	{
+		Voice &voice = this->voices[i];
+		const std::vector<int16_t> &samples = *voice.samples.get();
+		const size_t count = std::min(frameCount, samples.size() - voice.offset);
+
+		SoundMixer::mixVoice(samples.data() + voice.offset, count, voice.leftGain,
+			voice.rightGain, this->mixBuffer.data());
+		voice.offset += count;
+
+		// Order doesn't matter, so swap finished voices with the last one.
+		if (voice.offset == samples.size())
+		{
+			this->voices[i] = std::move(this->voices.back());
+			this->voices.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	SoundMixer::convertToInt16(this->mixBuffer.data(), sampleCount, this->volume, dst);
+}
@@ -0,0 +1,75 @@
+#ifndef SOUND_MIXER_H
+#define SOUND_MIXER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A software mixer for sound effects. Sounds are resampled to the mixer's rate once
+// when they're loaded, and any number of them (up to a CPU-friendly limit) are mixed
+// into one 16-bit stereo stream, so concurrency isn't bound by how many OpenAL
+// sources there are.
+
+// The mixer doesn't depend on any audio API. The audio manager pulls mixed frames
+// from it on its streaming thread, but anything can call mix() (i.e., to write to a
+// file or discard the output).
+
+class SoundMixer
+{
+public:
+	typedef std::shared_ptr<const std::vector<int16_t>> SamplesPtr;
+private:
+	struct Voice
+	{
+		SamplesPtr samples;
+		size_t offset;
+		float leftGain, rightGain;
+	};
+
+	std::vector<Voice> voices;
+	std::vector<float> mixBuffer;
+	std::mutex mutex;
+	float volume;
+	int sampleRate;
+
+	// Adds mono samples to an interleaved stereo buffer with the given gains.
+	static void mixVoice(const int16_t *src, size_t count, float leftGain,
+		float rightGain, float *dst);
+
+	// Converts interleaved stereo floats to 16-bit samples, clamping them.
+	static void convertToInt16(const float *src, size_t count, float volume, int16_t *dst);
+public:
+	SoundMixer(int sampleRate);
+	~SoundMixer();
+
+	// Most sounds that can be mixed at once.
+	static const int MAX_VOICES;
+
+	// Converts 8-bit unsigned mono PCM (i.e., from a .VOC file) to 16-bit mono PCM at
+	// another sample rate, using linear interpolation.
+	static std::vector<int16_t> resample(const std::vector<uint8_t> &src, int srcRate,
+		int dstRate);
+
+	int getSampleRate() const;
+
+	// Gets the number of sounds being mixed.
+	int getVoiceCount();
+
+	// Starts mixing a sound. The samples must be at the mixer's sample rate. Returns
+	// false if too many sounds are already playing.
+	bool play(const SamplesPtr &samples, float leftGain, float rightGain);
+
+	// Stops all sounds.
+	void stop();
+
+	// Sets the volume applied to the mixed output.
+	void setVolume(float volume);
+
+	// Writes the next frames of all sounds as interleaved 16-bit stereo. Sounds that
+	// finish are removed.
+	void mix(int16_t *dst, size_t frameCount);
+};
+
+#endif
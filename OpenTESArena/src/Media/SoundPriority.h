@@ -0,0 +1,15 @@
+#ifndef SOUND_PRIORITY_H
+#define SOUND_PRIORITY_H
+
+// How important a sound is when there are no free channels to play it. A sound can
+// take the channel of a playing sound with lower priority, or of one with the same
+// priority that is farther away (or older, if they are equally far).
+
+enum class SoundPriority
+{
+	Low, // Ambience.
+	Normal,
+	High // Direct results of player actions.
+};
+
+#endif
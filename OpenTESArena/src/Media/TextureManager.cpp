@@ -1,9 +1,12 @@
 #include <cassert>
+#include <chrono>
+#include <functional>
 
 #include "SDL.h"
 
 #include "TextureManager.h"
 
+#include "IndexedImage.h"
 #include "PaletteFile.h"
 #include "PaletteName.h"
 #include "../Assets/CFAFile.h"
@@ -19,35 +22,346 @@
 #include "../Rendering/Renderer.h"
 #include "../Rendering/Surface.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/Platform.h"
 #include "../Utilities/String.h"
 
 #include "components/vfs/manager.hpp"
 
+const size_t TextureManager::DEFAULT_BUDGET_BYTES = 128 * 1024 * 1024;
+const double TextureManager::PREFETCH_MS_PER_FRAME = 4.0;
+
+TextureManager::Stats::Stats()
+{
+	this->residentBytes = 0;
+	this->budgetBytes = 0;
+	this->indexedBytes = 0;
+	this->entryCount = 0;
+	this->hits = 0;
+	this->misses = 0;
+	this->evictions = 0;
+}
+
+double TextureManager::Stats::getHitRate() const
+{
+	const uint64_t lookups = this->hits + this->misses;
+	return (lookups > 0) ? ((static_cast<double>(this->hits) * 100.0) /
+		static_cast<double>(lookups)) : 0.0;
+}
+
+TextureManager::Entry::Entry(EntryType type, const std::string &filename,
+	const std::string &paletteName, size_t hash, bool pinned)
+	: filename(filename), paletteName(paletteName)
+{
+	this->hash = hash;
+	this->type = type;
+	this->surface = nullptr;
+	this->bytes = 0;
+	this->pinned = pinned;
+}
+
+TextureManager::Entry::~Entry()
+{
+	// Release the SDL_Surfaces. Textures release themselves.
+	if (this->surface != nullptr)
+	{
+		SDL_FreeSurface(this->surface);
+	}
+
+	for (auto *surface : this->surfaceSet)
+	{
+		SDL_FreeSurface(surface);
+	}
+}
+
 TextureManager::TextureManager(Renderer &renderer)
-	: renderer(renderer), palettes(), surfaces(), textures(),
-	surfaceSets(), textureSets()
+	: renderer(renderer), palettes(), indexedImages(), entries(), entryMap(),
+	pinnedFilenames(), prefetchCancelled(false), prefetchThreadDone(true)
 {
 	DebugMention("Initializing.");
 
+	this->stats.budgetBytes = TextureManager::DEFAULT_BUDGET_BYTES;
+	this->recordingGroup = PreloadGroup::MainMenu;
+	this->prefetching = false;
+
 	// Load default palette.
 	this->setPalette(PaletteFile::fromName(PaletteName::Default));
 }
 
 TextureManager::~TextureManager()
 {
-	// Release the SDL_Surfaces.
-	for (auto &pair : this->surfaces)
+	this->stopPrefetch();
+	this->saveRecording();
+
+	// Entries release their own images.
+	this->entryMap.clear();
+	this->entries.clear();
+}
+
+size_t TextureManager::makeHash(EntryType type, const std::string &filename,
+	const std::string &paletteName)
+{
+	const std::hash<std::string> stringHash;
+	size_t hash = stringHash(filename);
+
+	// Same combining step as boost::hash_combine.
+	auto combine = [&hash](size_t value)
+	{
+		hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	};
+
+	combine(stringHash(paletteName));
+	combine(static_cast<size_t>(type));
+	return hash;
+}
+
+PreloadManifest::AssetType TextureManager::getAssetType(EntryType type)
+{
+	if (type == EntryType::Surface)
+	{
+		return PreloadManifest::AssetType::Surface;
+	}
+	else if (type == EntryType::Texture)
+	{
+		return PreloadManifest::AssetType::Texture;
+	}
+	else if (type == EntryType::SurfaceSet)
+	{
+		return PreloadManifest::AssetType::Surfaces;
+	}
+	else
+	{
+		return PreloadManifest::AssetType::Textures;
+	}
+}
+
+TextureManager::EntryType TextureManager::getEntryType(PreloadManifest::AssetType type)
+{
+	if (type == PreloadManifest::AssetType::Surface)
+	{
+		return EntryType::Surface;
+	}
+	else if (type == PreloadManifest::AssetType::Texture)
+	{
+		return EntryType::Texture;
+	}
+	else if (type == PreloadManifest::AssetType::Surfaces)
+	{
+		return EntryType::SurfaceSet;
+	}
+	else
+	{
+		return EntryType::TextureSet;
+	}
+}
+
+std::string TextureManager::getManifestPath(PreloadGroup group)
+{
+	return Platform::getOptionsPath() + PreloadManifest::getFilename(group);
+}
+
+bool TextureManager::isIndexedImage(const std::string &filename)
+{
+	const std::string extension = String::getExtension(filename);
+	return (extension == ".IMG") || (extension == ".MNU");
+}
+
+size_t TextureManager::getSurfaceBytes(const SDL_Surface *surface)
+{
+	return static_cast<size_t>(surface->pitch) * static_cast<size_t>(surface->h);
+}
+
+size_t TextureManager::getTextureBytes(const Texture &texture)
+{
+	return static_cast<size_t>(texture.getWidth()) *
+		static_cast<size_t>(texture.getHeight()) * sizeof(uint32_t);
+}
+
+TextureManager::Entry *TextureManager::findEntry(EntryType type,
+	const std::string &filename, const std::string &paletteName)
+{
+	const size_t hash = TextureManager::makeHash(type, filename, paletteName);
+	const auto range = this->entryMap.equal_range(hash);
+
+	if ((this->recordingManifest != nullptr) && !this->prefetching)
+	{
+		this->recordAccess(hash, type, filename, paletteName);
+	}
+
+	for (auto iter = range.first; iter != range.second; ++iter)
+	{
+		const EntryIterator entryIter = iter->second;
+		if ((entryIter->type == type) && (entryIter->filename == filename) &&
+			(entryIter->paletteName == paletteName))
+		{
+			// Move it to the front of the recently used list. This doesn't invalidate
+			// any iterators.
+			this->entries.splice(this->entries.begin(), this->entries, entryIter);
+			this->stats.hits++;
+			return &(*entryIter);
+		}
+	}
+
+	this->stats.misses++;
+	return nullptr;
+}
+
+TextureManager::Entry &TextureManager::addEntry(EntryType type,
+	const std::string &filename, const std::string &paletteName)
+{
+	const size_t hash = TextureManager::makeHash(type, filename, paletteName);
+	const bool pinned = this->pinnedFilenames.find(filename) != this->pinnedFilenames.end();
+
+	this->entries.emplace_front(type, filename, paletteName, hash, pinned);
+	this->entryMap.emplace(std::make_pair(hash, this->entries.begin()));
+	this->stats.entryCount++;
+
+	return this->entries.front();
+}
+
+void TextureManager::setEntryBytes(Entry &entry, size_t bytes)
+{
+	this->stats.residentBytes -= entry.bytes;
+	entry.bytes = bytes;
+	this->stats.residentBytes += entry.bytes;
+}
+
+void TextureManager::removeEntry(EntryIterator iter)
+{
+	const auto range = this->entryMap.equal_range(iter->hash);
+	for (auto mapIter = range.first; mapIter != range.second; ++mapIter)
+	{
+		if (mapIter->second == iter)
+		{
+			this->entryMap.erase(mapIter);
+			break;
+		}
+	}
+
+	this->stats.residentBytes -= iter->bytes;
+	this->stats.entryCount--;
+	this->entries.erase(iter);
+}
+
+void TextureManager::recordAccess(size_t hash, EntryType type,
+	const std::string &filename, const std::string &paletteName)
+{
+	const auto iter = this->recordedIndices.find(hash);
+	if (iter != this->recordedIndices.end())
+	{
+		this->recordingManifest->markUsed(iter->second);
+	}
+	else
+	{
+		const int index = static_cast<int>(this->recordingManifest->getAssets().size());
+		this->recordingManifest->add(TextureManager::getAssetType(type),
+			filename, paletteName);
+		this->recordedIndices.insert(std::make_pair(hash, index));
+	}
+}
+
+void TextureManager::saveRecording()
+{
+	if (this->recordingManifest != nullptr)
+	{
+		// The recording session is over, so age the assets it didn't use.
+		this->recordingManifest->endSession();
+		this->recordedIndices.clear();
+
+		if (this->recordingManifest->isDirty())
+		{
+			this->recordingManifest->save(
+				TextureManager::getManifestPath(this->recordingGroup));
+		}
+	}
+}
+
+void TextureManager::stopPrefetch()
+{
+	this->prefetchCancelled = true;
+
+	if (this->prefetchThread.joinable())
+	{
+		this->prefetchThread.join();
+	}
+
+	this->prefetchCancelled = false;
+	this->prefetchQueue.clear();
+	this->prefetchedImages.clear();
+}
+
+void TextureManager::updatePrefetch()
+{
+	// Take the IMGs that the worker thread has decoded so far. Ones that were loaded
+	// on demand in the meantime are already in the map.
 	{
-		SDL_FreeSurface(pair.second);
+		std::lock_guard<std::mutex> lock(this->prefetchMutex);
+		for (auto &pair : this->prefetchedImages)
+		{
+			if (this->indexedImages.find(pair.first) == this->indexedImages.end())
+			{
+				this->stats.indexedBytes += pair.second.getByteCount();
+				this->indexedImages.emplace(std::move(pair));
+			}
+		}
+
+		this->prefetchedImages.clear();
 	}
 
-	for (auto &pair : this->surfaceSets)
+	const bool threadDone = this->prefetchThreadDone;
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	this->prefetching = true;
+
+	while (!this->prefetchQueue.empty())
 	{
-		for (auto *surface : pair.second)
+		const PreloadManifest::Asset &asset = this->prefetchQueue.front();
+
+		// Wait for the worker thread instead of decoding an IMG on this one.
+		const bool waitingForImage = !threadDone &&
+			TextureManager::isIndexedImage(asset.filename) &&
+			(this->indexedImages.find(asset.filename) == this->indexedImages.end());
+
+		if (waitingForImage)
+		{
+			break;
+		}
+
+		const EntryType type = TextureManager::getEntryType(asset.type);
+		if (type == EntryType::Surface)
+		{
+			this->getSurface(asset.filename, asset.paletteName);
+		}
+		else if (type == EntryType::Texture)
+		{
+			this->getTexture(asset.filename, asset.paletteName);
+		}
+		else if (type == EntryType::SurfaceSet)
 		{
-			SDL_FreeSurface(surface);
+			this->getSurfaces(asset.filename, asset.paletteName);
+		}
+		else
+		{
+			this->getTextures(asset.filename, asset.paletteName);
+		}
+
+		this->prefetchQueue.pop_front();
+
+		const auto elapsed = std::chrono::high_resolution_clock::now() - startTime;
+		const double elapsedMS = static_cast<double>(std::chrono::duration_cast<
+			std::chrono::microseconds>(elapsed).count()) / 1000.0;
+
+		if (elapsedMS >= TextureManager::PREFETCH_MS_PER_FRAME)
+		{
+			break;
 		}
 	}
+
+	this->prefetching = false;
+
+	if (this->prefetchQueue.empty())
+	{
+		DebugMention("Finished prefetching.");
+	}
 }
 
 void TextureManager::loadCOLPalette(const std::string &colName)
@@ -92,18 +406,40 @@ void TextureManager::loadPalette(const std::string &paletteName)
 	assert(this->palettes.find(paletteName) != this->palettes.end());
 }
 
+const TextureManager::Stats &TextureManager::getStats() const
+{
+	return this->stats;
+}
+
+const IndexedImage &TextureManager::getIndexedImage(const std::string &filename)
+{
+	auto iter = this->indexedImages.find(filename);
+	if (iter == this->indexedImages.end())
+	{
+		// Only IMGs are stored as indices for now.
+		DebugAssert(TextureManager::isIndexedImage(filename),
+			"Unrecognized indexed image \"" + filename + "\".");
+
+		IMGFile img(filename);
+		IndexedImage image(img.getWidth(), img.getHeight(), std::move(img.getPixels()));
+
+		this->stats.indexedBytes += image.getByteCount();
+		iter = this->indexedImages.emplace(std::make_pair(
+			filename, std::move(image))).first;
+	}
+
+	return iter->second;
+}
+
 SDL_Surface *TextureManager::getSurface(const std::string &filename,
 	const std::string &paletteName)
 {
-	// Use this name when interfacing with the surfaces map.
-	const std::string fullName = filename + paletteName;
-
 	// See if the image file has already been loaded with the palette.
-	auto surfaceIter = this->surfaces.find(fullName);
-	if (surfaceIter != this->surfaces.end())
+	Entry *existingEntry = this->findEntry(EntryType::Surface, filename, paletteName);
+	if (existingEntry != nullptr)
 	{
 		// The requested surface exists.
-		return surfaceIter->second;
+		return existingEntry->surface;
 	}
 
 	// Attempt to use the image's built-in palette if requested.
@@ -148,16 +484,17 @@ SDL_Surface *TextureManager::getSurface(const std::string &filename,
 	else if (isIMG || isMNU)
 	{
 		// Decide if the IMG will use its own palette or not.
-		const Palette *palette = useBuiltInPalette ? nullptr : 
-			&this->palettes.at(paletteName);
+		const Palette &palette = this->palettes.at(
+			useBuiltInPalette ? filename : paletteName);
 
-		// Load the IMG file.
-		IMGFile img(filename, palette);
-		
-		// Create a surface from the IMG.
-		surface = Surface::createSurfaceWithFormat(img.getWidth(), img.getHeight(),
+		// Get the palette indices of the IMG (only decoded once for all palettes).
+		const IndexedImage &image = this->getIndexedImage(filename);
+
+		// Create a surface from the IMG with the requested palette.
+		surface = Surface::createSurfaceWithFormat(image.getWidth(), image.getHeight(),
 			Renderer::DEFAULT_BPP, Renderer::DEFAULT_PIXELFORMAT);
-		SDL_memcpy(surface->pixels, img.getPixels(), surface->pitch * surface->h);
+		image.writeARGB(palette, static_cast<uint32_t*>(surface->pixels),
+			surface->pitch / sizeof(uint32_t));
 	}
 	else
 	{
@@ -165,8 +502,10 @@ SDL_Surface *TextureManager::getSurface(const std::string &filename,
 	}
 
 	// Add the new surface and return it.
-	auto iter = this->surfaces.emplace(std::make_pair(fullName, surface)).first;
-	return iter->second;
+	Entry &entry = this->addEntry(EntryType::Surface, filename, paletteName);
+	entry.surface = surface;
+	this->setEntryBytes(entry, TextureManager::getSurfaceBytes(surface));
+	return entry.surface;
 }
 
 SDL_Surface *TextureManager::getSurface(const std::string &filename)
@@ -177,16 +516,14 @@ SDL_Surface *TextureManager::getSurface(const std::string &filename)
 const Texture &TextureManager::getTexture(const std::string &filename,
 	const std::string &paletteName)
 {
-	// Use this name when interfacing with the textures map.
-	const std::string fullName = filename + paletteName;
-
 	// See if the image file has already been loaded with the palette.
-	auto textureIter = this->textures.find(fullName);
-	if (textureIter != this->textures.end())
+	Entry *existingEntry = this->findEntry(EntryType::Texture, filename, paletteName);
+	if (existingEntry != nullptr)
 	{
 		// The requested texture exists.
-		return textureIter->second;
+		return existingEntry->texture;
 	}
+
 	// Attempt to use the image's built-in palette if requested.
 	const bool useBuiltInPalette = Palette::isBuiltIn(paletteName);
 
@@ -212,18 +549,20 @@ const Texture &TextureManager::getTexture(const std::string &filename,
 	if (isIMG || isMNU)
 	{
 		// Decide if the IMG will use its own palette or not.
-		const Palette *palette = useBuiltInPalette ? nullptr : 
-			&this->palettes.at(paletteName);
+		const Palette &palette = this->palettes.at(
+			useBuiltInPalette ? filename : paletteName);
 
-		// Load the IMG file.
-		IMGFile img(filename, palette);
+		// Get the palette indices of the IMG (only decoded once for all palettes).
+		const IndexedImage &image = this->getIndexedImage(filename);
 
-		// Create a texture from the IMG.
+		// Create a texture from the IMG with the requested palette.
 		texture = this->renderer.createTexture(Renderer::DEFAULT_PIXELFORMAT,
-			SDL_TEXTUREACCESS_STATIC, img.getWidth(), img.getHeight());
+			SDL_TEXTUREACCESS_STATIC, image.getWidth(), image.getHeight());
 
-		uint32_t *pixels = img.getPixels();
-		SDL_UpdateTexture(texture, nullptr, pixels, img.getWidth() * sizeof(*pixels));
+		std::vector<uint32_t> pixels(image.getWidth() * image.getHeight());
+		image.writeARGB(palette, pixels.data(), image.getWidth());
+		SDL_UpdateTexture(texture, nullptr, pixels.data(),
+			image.getWidth() * sizeof(pixels.front()));
 
 		// Set alpha transparency on.
 		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
@@ -234,8 +573,10 @@ const Texture &TextureManager::getTexture(const std::string &filename,
 	}
 
 	// Add the new texture and return it.
-	auto iter = this->textures.emplace(std::make_pair(fullName, Texture(texture))).first;
-	return iter->second;
+	Entry &entry = this->addEntry(EntryType::Texture, filename, paletteName);
+	entry.texture = Texture(texture);
+	this->setEntryBytes(entry, TextureManager::getTextureBytes(entry.texture));
+	return entry.texture;
 }
 
 const Texture &TextureManager::getTexture(const std::string &filename)
@@ -249,15 +590,12 @@ const std::vector<SDL_Surface*> &TextureManager::getSurfaces(
 	// This method deals with animations and movies, so it will check filenames 
 	// for ".CFA", ".CIF", ".DFA", ".FLC", ".SET", etc..
 
-	// Use this name when interfacing with the surface sets map.
-	const std::string fullName = filename + paletteName;
-
 	// See if the file has already been loaded with the palette.
-	auto setIter = this->surfaceSets.find(fullName);
-	if (setIter != this->surfaceSets.end())
+	Entry *existingEntry = this->findEntry(EntryType::SurfaceSet, filename, paletteName);
+	if (existingEntry != nullptr)
 	{
-		// The requested texture set exists.
-		return setIter->second;
+		// The requested surface set exists.
+		return existingEntry->surfaceSet;
 	}
 
 	// Do not use a built-in palette for surface sets.
@@ -271,10 +609,8 @@ const std::vector<SDL_Surface*> &TextureManager::getSurfaces(
 	}
 
 	// The file hasn't been loaded with the palette yet, so make a new entry.
-	auto iter = this->surfaceSets.emplace(std::make_pair(
-		fullName, std::vector<SDL_Surface*>())).first;
-
-	std::vector<SDL_Surface*> &surfaceSet = iter->second;
+	Entry &entry = this->addEntry(EntryType::SurfaceSet, filename, paletteName);
+	std::vector<SDL_Surface*> &surfaceSet = entry.surfaceSet;
 	const Palette &palette = this->palettes.at(paletteName);
 
 	const std::string extension = String::getExtension(filename);
@@ -345,15 +681,15 @@ const std::vector<SDL_Surface*> &TextureManager::getSurfaces(
 		// Load the FLC file. CELs are basically identical to FLCs.
 		FLCFile flcFile(filename);
 
-		// Create an SDL_Surface for each frame in the FLC.
-		const int imageCount = flcFile.getFrameCount();
-		for (int i = 0; i < imageCount; ++i)
+		// Create an SDL_Surface for each frame in the FLC. Frames are decoded one at
+		// a time, so only the current frame's indices are kept in the meantime.
+		while (flcFile.readNextFrame())
 		{
-			uint32_t *pixels = flcFile.getPixels(i);
 			SDL_Surface *surface = Surface::createSurfaceWithFormat(
 				flcFile.getWidth(), flcFile.getHeight(),
 				Renderer::DEFAULT_BPP, Renderer::DEFAULT_PIXELFORMAT);
-			SDL_memcpy(surface->pixels, pixels, surface->pitch * surface->h);
+			flcFile.writePixels(static_cast<uint32_t*>(surface->pixels),
+				surface->pitch / sizeof(uint32_t));
 
 			surfaceSet.push_back(surface);
 		}
@@ -399,6 +735,14 @@ const std::vector<SDL_Surface*> &TextureManager::getSurfaces(
 		DebugCrash("Unrecognized surface list \"" + filename + "\".");
 	}
 
+	size_t bytes = 0;
+	for (const auto *surface : surfaceSet)
+	{
+		bytes += TextureManager::getSurfaceBytes(surface);
+	}
+
+	this->setEntryBytes(entry, bytes);
+
 	return surfaceSet;
 }
 
@@ -413,15 +757,12 @@ const std::vector<Texture> &TextureManager::getTextures(
 	// This method deals with animations and movies, so it will check filenames 
 	// for ".CFA", ".CIF", ".DFA", ".FLC", ".SET", etc..
 
-	// Use this name when interfacing with the texture sets map.
-	const std::string fullName = filename + paletteName;
-
 	// See if the file has already been loaded with the palette.
-	auto setIter = this->textureSets.find(fullName);
-	if (setIter != this->textureSets.end())
+	Entry *existingEntry = this->findEntry(EntryType::TextureSet, filename, paletteName);
+	if (existingEntry != nullptr)
 	{
 		// The requested texture set exists.
-		return setIter->second;
+		return existingEntry->textureSet;
 	}
 
 	// Do not use a built-in palette for texture sets.
@@ -435,10 +776,8 @@ const std::vector<Texture> &TextureManager::getTextures(
 	}
 
 	// The file hasn't been loaded with the palette yet, so make a new entry.
-	auto iter = this->textureSets.emplace(std::make_pair(
-		fullName, std::vector<Texture>())).first;
-
-	std::vector<Texture> &textureSet = iter->second;
+	Entry &entry = this->addEntry(EntryType::TextureSet, filename, paletteName);
+	std::vector<Texture> &textureSet = entry.textureSet;
 	const Palette &palette = this->palettes.at(paletteName);
 
 	const std::string extension = String::getExtension(filename);
@@ -515,17 +854,18 @@ const std::vector<Texture> &TextureManager::getTextures(
 		// Load the FLC file. CELs are basically identical to FLCs.
 		FLCFile flcFile(filename);
 
-		// Create an SDL_Texture for each frame in the FLC.
-		const int imageCount = flcFile.getFrameCount();
-		for (int i = 0; i < imageCount; ++i)
+		// Create an SDL_Texture for each frame in the FLC, reusing one scratch buffer
+		// for converting each decoded frame.
+		std::vector<uint32_t> pixels(flcFile.getWidth() * flcFile.getHeight());
+		while (flcFile.readNextFrame())
 		{
 			SDL_Texture *texture = this->renderer.createTexture(
 				Renderer::DEFAULT_PIXELFORMAT, SDL_TEXTUREACCESS_STATIC,
 				flcFile.getWidth(), flcFile.getHeight());
 
-			const uint32_t *pixels = flcFile.getPixels(i);
-			SDL_UpdateTexture(texture, nullptr, pixels,
-				flcFile.getWidth() * sizeof(*pixels));
+			flcFile.writePixels(pixels.data(), flcFile.getWidth());
+			SDL_UpdateTexture(texture, nullptr, pixels.data(),
+				flcFile.getWidth() * sizeof(pixels.front()));
 
 			textureSet.push_back(Texture(texture));
 		}
@@ -576,11 +916,15 @@ const std::vector<Texture> &TextureManager::getTextures(
 	}
 
 	// Set alpha transparency on for each texture.
+	size_t bytes = 0;
 	for (auto &texture : textureSet)
 	{
 		SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+		bytes += TextureManager::getTextureBytes(texture);
 	}
 
+	this->setEntryBytes(entry, bytes);
+
 	return textureSet;
 }
 
@@ -599,3 +943,137 @@ void TextureManager::setPalette(const std::string &paletteName)
 
 	this->activePalette = paletteName;
 }
+
+void TextureManager::setPinned(const std::string &filename, bool pinned)
+{
+	if (pinned)
+	{
+		this->pinnedFilenames.insert(filename);
+	}
+	else
+	{
+		this->pinnedFilenames.erase(filename);
+	}
+
+	// Update any entries that are already loaded from the file.
+	for (auto &entry : this->entries)
+	{
+		if (entry.filename == filename)
+		{
+			entry.pinned = pinned;
+		}
+	}
+}
+
+void TextureManager::setBudget(size_t bytes)
+{
+	this->stats.budgetBytes = bytes;
+}
+
+void TextureManager::setRecordingGroup(PreloadGroup group)
+{
+	this->saveRecording();
+
+	this->recordingManifest = std::unique_ptr<PreloadManifest>(new PreloadManifest());
+	this->recordingManifest->load(TextureManager::getManifestPath(group));
+	this->recordingGroup = group;
+
+	// Don't record assets that were already recorded in an earlier session.
+	this->recordedIndices.clear();
+	const auto &assets = this->recordingManifest->getAssets();
+	for (size_t i = 0; i < assets.size(); i++)
+	{
+		const PreloadManifest::Asset &asset = assets.at(i);
+		this->recordedIndices.insert(std::make_pair(TextureManager::makeHash(
+			TextureManager::getEntryType(asset.type), asset.filename, asset.paletteName),
+			static_cast<int>(i)));
+	}
+}
+
+void TextureManager::prefetch(PreloadGroup group)
+{
+	this->stopPrefetch();
+
+	// Use the manifest in memory if it's the one being recorded, since it might have
+	// new assets that aren't saved yet.
+	PreloadManifest manifest;
+	if ((this->recordingManifest != nullptr) && (group == this->recordingGroup))
+	{
+		manifest = *this->recordingManifest.get();
+	}
+	else
+	{
+		manifest.load(TextureManager::getManifestPath(group));
+	}
+
+	// Queue every asset, and collect the IMGs the worker thread should decode.
+	std::vector<std::string> imageFilenames;
+	std::unordered_set<std::string> imageFilenameSet;
+	for (const auto &asset : manifest.getAssets())
+	{
+		this->prefetchQueue.push_back(asset);
+
+		const bool needsDecoding = TextureManager::isIndexedImage(asset.filename) &&
+			(this->indexedImages.find(asset.filename) == this->indexedImages.end());
+
+		if (needsDecoding && imageFilenameSet.insert(asset.filename).second)
+		{
+			imageFilenames.push_back(asset.filename);
+		}
+	}
+
+	DebugMention("Prefetching " + std::to_string(this->prefetchQueue.size()) +
+		" asset(s) for " + PreloadManifest::getGroupName(group) + ".");
+
+	// Decode IMGs on the worker thread. File access through the VFS opens its own
+	// stream for each file, so it is safe to use from here.
+	this->prefetchThreadDone = false;
+	this->prefetchThread = std::thread([this, imageFilenames]()
+	{
+		for (const auto &filename : imageFilenames)
+		{
+			if (this->prefetchCancelled)
+			{
+				break;
+			}
+
+			IMGFile img(filename);
+			IndexedImage image(img.getWidth(), img.getHeight(), std::move(img.getPixels()));
+
+			std::lock_guard<std::mutex> lock(this->prefetchMutex);
+			this->prefetchedImages.push_back(std::make_pair(filename, std::move(image)));
+		}
+
+		this->prefetchThreadDone = true;
+	});
+}
+
+bool TextureManager::isPrefetching() const
+{
+	return !this->prefetchQueue.empty();
+}
+
+void TextureManager::update()
+{
+	// Continue loading the assets being prefetched.
+	if (!this->prefetchQueue.empty())
+	{
+		this->updatePrefetch();
+	}
+
+	// Walk from the least recently used entry, evicting until within budget.
+	auto iter = this->entries.end();
+	while ((this->stats.residentBytes > this->stats.budgetBytes) &&
+		(iter != this->entries.begin()))
+	{
+		--iter;
+
+		if (!iter->pinned)
+		{
+			auto evictIter = iter;
+			++iter;
+			this->removeEntry(evictIter);
+			this->stats.evictions++;
+		}
+	}
+}
@@ -1,35 +1,177 @@
 #ifndef TEXTURE_MANAGER_H
 #define TEXTURE_MANAGER_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "IndexedImage.h"
 #include "Palette.h"
+#include "PreloadGroup.h"
+#include "PreloadManifest.h"
 #include "../Rendering/Texture.h"
 
-// Find a way to map original wall and sprite filenames to unique integer IDs 
-// (probably depending on the order they were parsed). Or perhaps the ID could 
+// Find a way to map original wall and sprite filenames to unique integer IDs
+// (probably depending on the order they were parsed). Or perhaps the ID could
 // be their offset in GLOBAL.BSA.
 
+// Loaded images are kept resident under a byte budget. Once per frame, the least
+// recently used images are evicted until the budget is met again, except for pinned
+// ones (i.e., interface images that are drawn every frame). Eviction only happens in
+// TextureManager::update(), so anything returned during a frame stays valid until the
+// start of the next frame, but should not be held onto longer than that.
+
+// IMGs are decoded once into 8-bit palette indices, which stay loaded. The ARGB 
+// surfaces and textures made from them are per-palette views in the cache above, so
+// drawing an image with another palette (i.e., for fades) doesn't touch the file again.
+
+// Every request is recorded into the preload manifest of the current preload group.
+// Prefetching a group's manifest decodes its IMGs on a worker thread, and the main
+// thread turns them into surfaces and textures in TextureManager::update() under a
+// small time budget each frame, since SDL textures can only be made on the main thread.
+
 class Renderer;
 
 struct SDL_Surface;
 
 class TextureManager
 {
+public:
+	// Residency and lookup statistics, i.e., for the debug text.
+	struct Stats
+	{
+		size_t residentBytes, budgetBytes;
+		size_t indexedBytes; // Palette indices, which aren't evicted.
+		int entryCount;
+		uint64_t hits, misses, evictions;
+
+		Stats();
+
+		// Gets the percent of lookups that found an already-loaded image.
+		double getHitRate() const;
+	};
 private:
+	enum class EntryType
+	{
+		Surface,
+		Texture,
+		SurfaceSet,
+		TextureSet
+	};
+
+	// A loaded image or set of images. Only the member matching the type is used.
+	struct Entry
+	{
+		std::string filename, paletteName;
+		size_t hash;
+		EntryType type;
+		SDL_Surface *surface;
+		Texture texture;
+		std::vector<SDL_Surface*> surfaceSet;
+		std::vector<Texture> textureSet;
+		size_t bytes;
+		bool pinned;
+
+		Entry(EntryType type, const std::string &filename, const std::string &paletteName,
+			size_t hash, bool pinned);
+		Entry(const Entry&) = delete;
+		~Entry();
+
+		Entry &operator=(const Entry&) = delete;
+	};
+
+	typedef std::list<Entry>::iterator EntryIterator;
+
+	// Milliseconds per frame that prefetched assets may spend being turned into
+	// surfaces and textures on the main thread.
+	static const double PREFETCH_MS_PER_FRAME;
+
 	Renderer &renderer;
 	std::unordered_map<std::string, Palette> palettes;
-
-	// The filename and palette name are concatenated when mapping to avoid using two 
-	// maps. I.e., "EQUIPMEN.IMG" and "PAL.COL" become "EQUIPMEN.IMGPAL.COL".
-	std::unordered_map<std::string, SDL_Surface*> surfaces;
-	std::unordered_map<std::string, Texture> textures;
-	std::unordered_map<std::string, std::vector<SDL_Surface*>> surfaceSets;
-	std::unordered_map<std::string, std::vector<Texture>> textureSets;
+	std::unordered_map<std::string, IndexedImage> indexedImages;
+
+	// Entries ordered from most to least recently used. Lookups go through the hash
+	// of the entry type, filename, and palette name, so no strings need to be
+	// concatenated for each request. Entries with the same hash are told apart by
+	// their names.
+	std::list<Entry> entries;
+	std::unordered_multimap<size_t, EntryIterator> entryMap;
+	std::unordered_set<std::string> pinnedFilenames;
+	Stats stats;
 	std::string activePalette;
 
+	// Manifest that requests are recorded into, and the index of each asset in it by
+	// hash so each one is only added once.
+	std::unique_ptr<PreloadManifest> recordingManifest;
+	std::unordered_map<size_t, int> recordedIndices;
+	PreloadGroup recordingGroup;
+	bool prefetching; // True while loading a prefetched asset, so it isn't recorded.
+
+	// Assets waiting to be loaded by TextureManager::update(), and the IMGs that the
+	// worker thread has finished decoding (guarded by the mutex).
+	std::deque<PreloadManifest::Asset> prefetchQueue;
+	std::vector<std::pair<std::string, IndexedImage>> prefetchedImages;
+	std::mutex prefetchMutex;
+	std::thread prefetchThread;
+	std::atomic<bool> prefetchCancelled, prefetchThreadDone;
+
+	// Hashes an entry's identity without building a combined string.
+	static size_t makeHash(EntryType type, const std::string &filename,
+		const std::string &paletteName);
+
+	// Converts between entry types and the asset types in preload manifests.
+	static PreloadManifest::AssetType getAssetType(EntryType type);
+	static EntryType getEntryType(PreloadManifest::AssetType type);
+
+	// Gets the path of a preload group's manifest in the options folder.
+	static std::string getManifestPath(PreloadGroup group);
+
+	// Returns whether a file is decoded into an IndexedImage.
+	static bool isIndexedImage(const std::string &filename);
+
+	// Gets the number of bytes used by an image.
+	static size_t getSurfaceBytes(const SDL_Surface *surface);
+	static size_t getTextureBytes(const Texture &texture);
+
+	// Finds an entry and marks it as most recently used. Returns null if it isn't
+	// loaded.
+	Entry *findEntry(EntryType type, const std::string &filename,
+		const std::string &paletteName);
+
+	// Adds an empty entry as the most recently used one. Its size should be set with
+	// setEntryBytes() once it is filled in.
+	Entry &addEntry(EntryType type, const std::string &filename,
+		const std::string &paletteName);
+
+	// Sets how many bytes an entry uses and updates the resident total.
+	void setEntryBytes(Entry &entry, size_t bytes);
+
+	// Removes an entry from the cache, freeing its images.
+	void removeEntry(EntryIterator iter);
+
+	// Adds a requested asset to the recording manifest if it isn't already in it.
+	void recordAccess(size_t hash, EntryType type, const std::string &filename,
+		const std::string &paletteName);
+
+	// Writes the recording manifest to file if anything new was recorded.
+	void saveRecording();
+
+	// Stops the worker thread and drops any assets that haven't been loaded yet.
+	void stopPrefetch();
+
+	// Loads prefetched assets until they are done or the frame's time budget is used.
+	void updatePrefetch();
+
 	// Specialty method for loading a COL file into the palettes map.
 	void loadCOLPalette(const std::string &colName);
 
@@ -44,7 +186,17 @@ public:
 
 	TextureManager &operator=(TextureManager &&textureManager) = delete;
 
-	// Gets a surface from file. It will be loaded if not already stored with the 
+	// Default number of bytes that loaded images may use before old ones are evicted.
+	static const size_t DEFAULT_BUDGET_BYTES;
+
+	// Gets the residency and lookup statistics.
+	const TextureManager::Stats &getStats() const;
+
+	// Gets the palette indices of an image, loading it if necessary. This is the
+	// palette-independent form that surfaces and textures are made from.
+	const IndexedImage &getIndexedImage(const std::string &filename);
+
+	// Gets a surface from file. It will be loaded if not already stored with the
 	// requested palette. A valid filename might be something like "TAMRIEL.IMG".
 	SDL_Surface *getSurface(const std::string &filename, const std::string &paletteName);
 	SDL_Surface *getSurface(const std::string &filename);
@@ -52,25 +204,49 @@ public:
 	// Similar to getSurface(), only now for hardware-accelerated textures.
 	const Texture &getTexture(const std::string &filename, const std::string &paletteName);
 	const Texture &getTexture(const std::string &filename);
-	
-	// Gets a set of surfaces from a file. Intended only for obtaining pixel data for use 
-	// with renderer buffers. TextureManager::getTextures() should be used instead for 
+
+	// Gets a set of surfaces from a file. Intended only for obtaining pixel data for use
+	// with renderer buffers. TextureManager::getTextures() should be used instead for
 	// any 2D interface objects.
 	const std::vector<SDL_Surface*> &getSurfaces(const std::string &filename,
 		const std::string &paletteName);
 	const std::vector<SDL_Surface*> &getSurfaces(const std::string &filename);
 
-	// Gets a set of textures from a file. This is intended for animations and movies, 
-	// where the filename essentially points to several images. When no palette name 
+	// Gets a set of textures from a file. This is intended for animations and movies,
+	// where the filename essentially points to several images. When no palette name
 	// is given, the active one is used.
 	const std::vector<Texture> &getTextures(const std::string &filename,
 		const std::string &paletteName);
 	const std::vector<Texture> &getTextures(const std::string &filename);
 
 	// Sets the palette to use for subsequent images. The source of the palette can be
-	// from a loose .COL file, or can be built into an IMG. If the IMG does not have a 
+	// from a loose .COL file, or can be built into an IMG. If the IMG does not have a
 	// built-in palette, an error occurs.
 	void setPalette(const std::string &paletteName);
+
+	// Sets whether images from the given file (with any palette) can be evicted. This
+	// also applies to images from the file that are loaded later.
+	void setPinned(const std::string &filename, bool pinned);
+
+	// Sets the number of bytes that loaded images may use before old ones are evicted.
+	void setBudget(size_t bytes);
+
+	// Saves the current recording and starts recording requests into the given
+	// group's manifest, adding to what was recorded for it before.
+	void setRecordingGroup(PreloadGroup group);
+
+	// Starts loading the assets in a group's manifest in the background, replacing
+	// any prefetch already in progress. This is intended to be called at the start of
+	// something that takes a while and uses few textures, like a cinematic.
+	void prefetch(PreloadGroup group);
+
+	// Returns whether prefetched assets are still waiting to be loaded.
+	bool isPrefetching() const;
+
+	// Loads some prefetched assets, then evicts least recently used images until the
+	// resident size is within budget. This should be called once per frame, when no
+	// images from the last frame are in use.
+	void update();
 };
 
 #endif
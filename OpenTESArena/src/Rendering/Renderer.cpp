@@ -60,6 +60,7 @@ Renderer::Renderer(int width, int height, bool fullscreen, double letterboxAspec
 	// Initialize 320x200 frame buffer.
 	this->originalTexture = this->createTexture(Renderer::DEFAULT_PIXELFORMAT,
 		SDL_TEXTUREACCESS_TARGET, Renderer::ORIGINAL_WIDTH, Renderer::ORIGINAL_HEIGHT);
+	this->originalTarget = this->originalTexture;
 
 	// Don't initialize the game world buffer until the 3D renderer is initialized.
 	this->gameWorldTexture = nullptr;
@@ -381,6 +382,11 @@ void Renderer::setClipRect(const SDL_Rect *rect)
 	SDL_RenderSetClipRect(this->renderer, rect);
 }
 
+void Renderer::setOriginalTarget(SDL_Texture *texture)
+{
+	this->originalTarget = (texture != nullptr) ? texture : this->originalTexture;
+}
+
 void Renderer::initializeWorldRendering(double resolutionScale, bool fullGameWindow)
 {
 	this->fullGameWindow = fullGameWindow;
@@ -492,7 +498,7 @@ void Renderer::clearNative()
 
 void Renderer::clearOriginal(const Color &color)
 {
-	SDL_SetRenderTarget(this->renderer, this->originalTexture);
+	SDL_SetRenderTarget(this->renderer, this->originalTarget);
 	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 	SDL_RenderClear(this->renderer);
 }
@@ -532,21 +538,21 @@ void Renderer::drawNativeRect(const Color &color, int x, int y, int w, int h)
 
 void Renderer::drawOriginalPixel(const Color &color, int x, int y)
 {
-	SDL_SetRenderTarget(this->renderer, this->originalTexture);
+	SDL_SetRenderTarget(this->renderer, this->originalTarget);
 	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 	SDL_RenderDrawPoint(this->renderer, x, y);
 }
 
 void Renderer::drawOriginalLine(const Color &color, int x1, int y1, int x2, int y2)
 {
-	SDL_SetRenderTarget(this->renderer, this->originalTexture);
+	SDL_SetRenderTarget(this->renderer, this->originalTarget);
 	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 	SDL_RenderDrawLine(this->renderer, x1, y1, x2, y2);
 }
 
 void Renderer::drawOriginalRect(const Color &color, int x, int y, int w, int h)
 {
-	SDL_SetRenderTarget(this->renderer, this->originalTexture);
+	SDL_SetRenderTarget(this->renderer, this->originalTarget);
 	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 
 	SDL_Rect rect;
@@ -574,7 +580,7 @@ void Renderer::fillNativeRect(const Color &color, int x, int y, int w, int h)
 
 void Renderer::fillOriginalRect(const Color &color, int x, int y, int w, int h)
 {
-	SDL_SetRenderTarget(this->renderer, this->originalTexture);
+	SDL_SetRenderTarget(this->renderer, this->originalTarget);
 	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 
 	SDL_Rect rect;
@@ -708,7 +714,7 @@ void Renderer::drawToNative(SDL_Texture *texture)
 
 void Renderer::drawToOriginal(SDL_Texture *texture, int x, int y, int w, int h)
 {
-	SDL_SetRenderTarget(this->renderer, this->originalTexture);
+	SDL_SetRenderTarget(this->renderer, this->originalTarget);
 
 	SDL_Rect rect;
 	rect.x = x;
@@ -732,6 +738,80 @@ void Renderer::drawToOriginal(SDL_Texture *texture)
 	this->drawToOriginal(texture, 0, 0);
 }
 
+void Renderer::drawQuadsToNative(SDL_Texture *texture,
+	const std::vector<TextureQuad> &quads, int x, int y, const Color &color)
+{
+	SDL_SetRenderTarget(this->renderer, this->nativeTexture);
+	SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+	SDL_SetTextureAlphaMod(texture, color.a);
+
+	// Same mapping as Renderer::originalPointToNative(), without getting the letterbox
+	// for every point. Both edges of a quad are mapped, so neighboring quads meet
+	// without gaps at any scale.
+	const SDL_Rect letterbox = this->getLetterboxDimensions();
+	const double xScale = static_cast<double>(letterbox.w) /
+		static_cast<double>(Renderer::ORIGINAL_WIDTH);
+	const double yScale = static_cast<double>(letterbox.h) /
+		static_cast<double>(Renderer::ORIGINAL_HEIGHT);
+
+	auto toNativeX = [&letterbox, xScale](int originalX)
+	{
+		return letterbox.x + static_cast<int>(std::round(
+			static_cast<double>(originalX) * xScale));
+	};
+
+	auto toNativeY = [&letterbox, yScale](int originalY)
+	{
+		return letterbox.y + static_cast<int>(std::round(
+			static_cast<double>(originalY) * yScale));
+	};
+
+	for (const auto &quad : quads)
+	{
+		SDL_Rect srcRect;
+		srcRect.x = quad.srcX;
+		srcRect.y = quad.srcY;
+		srcRect.w = quad.width;
+		srcRect.h = quad.height;
+
+		const int left = toNativeX(x + quad.dstX);
+		const int top = toNativeY(y + quad.dstY);
+
+		SDL_Rect dstRect;
+		dstRect.x = left;
+		dstRect.y = top;
+		dstRect.w = toNativeX(x + quad.dstX + quad.width) - left;
+		dstRect.h = toNativeY(y + quad.dstY + quad.height) - top;
+
+		SDL_RenderCopy(this->renderer, texture, &srcRect, &dstRect);
+	}
+}
+
+void Renderer::drawQuadsToOriginal(SDL_Texture *texture,
+	const std::vector<TextureQuad> &quads, int x, int y, const Color &color)
+{
+	SDL_SetRenderTarget(this->renderer, this->originalTarget);
+	SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+	SDL_SetTextureAlphaMod(texture, color.a);
+
+	for (const auto &quad : quads)
+	{
+		SDL_Rect srcRect;
+		srcRect.x = quad.srcX;
+		srcRect.y = quad.srcY;
+		srcRect.w = quad.width;
+		srcRect.h = quad.height;
+
+		SDL_Rect dstRect;
+		dstRect.x = x + quad.dstX;
+		dstRect.y = y + quad.dstY;
+		dstRect.w = quad.width;
+		dstRect.h = quad.height;
+
+		SDL_RenderCopy(this->renderer, texture, &srcRect, &dstRect);
+	}
+}
+
 void Renderer::fillNative(SDL_Texture *texture)
 {
 	SDL_SetRenderTarget(this->renderer, this->nativeTexture);
@@ -28,6 +28,13 @@ struct SDL_Window;
 
 class Renderer
 {
+public:
+	// A part of a texture and where to draw it, relative to some origin in original
+	// frame buffer coordinates (i.e., one character of a text layout).
+	struct TextureQuad
+	{
+		int srcX, srcY, dstX, dstY, width, height;
+	};
 private:
 	static const char *DEFAULT_RENDER_SCALE_QUALITY;
 	static const std::string DEFAULT_TITLE;
@@ -35,6 +42,7 @@ private:
 	SDL_Window *window;
 	SDL_Renderer *renderer;
 	SDL_Texture *nativeTexture, *originalTexture, *gameWorldTexture; // Frame buffers.
+	SDL_Texture *originalTarget; // Where original frame buffer drawing goes.
 	std::unique_ptr<SoftwareRenderer> softwareRenderer; // 3D renderer.
 	double letterboxAspect;
 	bool fullGameWindow; // Determines height of 3D frame buffer.
@@ -120,6 +128,12 @@ public:
 	// will not be rendered. If rect is null, then clipping is disabled.
 	void setClipRect(const SDL_Rect *rect);
 
+	// Makes the original frame buffer methods (clearing, drawing) draw into another
+	// texture instead, i.e., to cache a layer of the interface that doesn't change
+	// every frame. Null sets it back to the original frame buffer. The texture should
+	// be an original-sized render target.
+	void setOriginalTarget(SDL_Texture *texture);
+
 	// Initialize the renderer for the game world. The "fullGameWindow" argument 
 	// determines whether to render a "fullscreen" 3D image or just the part above 
 	// the game interface. If there is an existing renderer in memory, it will be 
@@ -182,6 +196,14 @@ public:
 	void drawToOriginal(SDL_Texture *texture, int x, int y);
 	void drawToOriginal(SDL_Texture *texture);
 
+	// Draws parts of one texture in a single batch of copies, offset by a position in
+	// original coordinates and tinted by a color (i.e., text from a font atlas). The
+	// native version scales each part to the letterbox like the original frame buffer.
+	void drawQuadsToNative(SDL_Texture *texture, const std::vector<TextureQuad> &quads,
+		int x, int y, const Color &color);
+	void drawQuadsToOriginal(SDL_Texture *texture, const std::vector<TextureQuad> &quads,
+		int x, int y, const Color &color);
+
 	// Stretches a texture over the entire native frame buffer.
 	void fillNative(SDL_Texture *texture);
 
@@ -46,6 +46,9 @@ SoftwareRenderer::SoftwareRenderer(int width, int height)
 
 	// Fog distance is zero by default.
 	this->fogDistance = 0.0;
+
+	// The distance field is built for the first voxel grid that is rendered.
+	this->emptySpaceRevision = 0;
 }
 
 SoftwareRenderer::~SoftwareRenderer()
@@ -456,15 +459,11 @@ void SoftwareRenderer::updateVisibleFlats(const Double3 &eye, double yShear,
 	// Step through the voxel grid while the current coordinate is valid and
 	// the total voxel distance stepped is less than the view distance.
 	// (Note that the "voxel distance" is not the same as "actual" distance.)
-	const char *voxels = voxelGrid.getVoxels();
+	const auto &voxels = voxelGrid.getVoxels();
 	while (voxelIsValid && (cellDistSquared < this->viewDistSquared))
 	{
-		// Get the index of the current voxel in the voxel grid.
-		const int gridIndex = cell.x + (cell.y * gridWidth) +
-			(cell.z * gridWidth * gridHeight);
-
 		// Check if the current voxel is solid.
-		const char voxelID = voxels[gridIndex];
+		const VoxelGrid::VoxelID voxelID = voxels.get(cell.x, cell.y, cell.z);
 
 		if (voxelID > 0)
 		{
@@ -1072,16 +1071,18 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, dou
 		}
 	}();
 
+	// Voxel IDs of the column, from the bottom up.
+	const VoxelGrid::VoxelID *voxelColumn = voxelGrid.getVoxels().getColumn(voxelX, voxelZ);
+
 	// Wall normals are always reversed for the initial voxel column.
 	const Double3 wallNormal = -SoftwareRenderer::getWallNormal(wallFacing);
 
-	auto drawPlayersVoxel = [x, voxelX, voxelZ, playerY, playerYFloor, &wallNormal, &nearPoint, 
-		&farPoint, nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid, &textures, 
-		frameWidth, frameHeight, heightReal, depthBuffer, colorBuffer]()
+	auto drawPlayersVoxel = [x, voxelX, voxelZ, voxelColumn, playerY, playerYFloor, &wallNormal,
+		&nearPoint, &farPoint, nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid,
+		&textures, frameWidth, frameHeight, heightReal, depthBuffer, colorBuffer]()
 	{
 		const int voxelY = static_cast<int>(playerYFloor);
-		const char voxelID = voxelGrid.getVoxels()[voxelX + (voxelY * voxelGrid.getWidth()) +
-			(voxelZ * voxelGrid.getWidth() * voxelGrid.getHeight())];
+		const VoxelGrid::VoxelID voxelID = voxelColumn[voxelY];
 		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
 
 		// 3D points to be used for rendering columns once they are projected.
@@ -1411,12 +1412,11 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, dou
 		}
 	};
 
-	auto drawInitialVoxelBelow = [x, voxelX, voxelZ, &wallNormal, &nearPoint, &farPoint,
-		nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid, &textures, frameWidth,
-		frameHeight, heightReal, depthBuffer, colorBuffer](int voxelY)
+	auto drawInitialVoxelBelow = [x, voxelX, voxelZ, voxelColumn, &wallNormal, &nearPoint,
+		&farPoint, nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid, &textures,
+		frameWidth, frameHeight, heightReal, depthBuffer, colorBuffer](int voxelY)
 	{
-		const char voxelID = voxelGrid.getVoxels()[voxelX + (voxelY * voxelGrid.getWidth()) +
-			(voxelZ * voxelGrid.getWidth() * voxelGrid.getHeight())];
+		const VoxelGrid::VoxelID voxelID = voxelColumn[voxelY];
 		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
 		const double voxelYReal = static_cast<double>(voxelY);
 
@@ -1545,12 +1545,11 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, dou
 		}
 	};
 
-	auto drawInitialVoxelAbove = [x, voxelX, voxelZ, playerY, &wallNormal, &nearPoint, &farPoint,
-		nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid, &textures, frameWidth,
-		frameHeight, heightReal, depthBuffer, colorBuffer](int voxelY)
+	auto drawInitialVoxelAbove = [x, voxelX, voxelZ, voxelColumn, playerY, &wallNormal,
+		&nearPoint, &farPoint, nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid,
+		&textures, frameWidth, frameHeight, heightReal, depthBuffer, colorBuffer](int voxelY)
 	{
-		const char voxelID = voxelGrid.getVoxels()[voxelX + (voxelY * voxelGrid.getWidth()) +
-			(voxelZ * voxelGrid.getWidth() * voxelGrid.getHeight())];
+		const VoxelGrid::VoxelID voxelID = voxelColumn[voxelY];
 		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
 		const double voxelYReal = static_cast<double>(voxelY);
 
@@ -1744,17 +1743,20 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, double pla
 		}
 	}();
 
+	// Voxel IDs of the column, from the bottom up, and which of them aren't air.
+	const VoxelGrid::VoxelID *voxelColumn = voxelGrid.getVoxels().getColumn(voxelX, voxelZ);
+	const VoxelGrid::ColumnSummary &columnSummary = voxelGrid.getColumnSummary(voxelX, voxelZ);
+
 	// Wall normals behave as they usually would when rendering after the initial voxel 
 	// column; no need to cover special cases like wall back faces.
 	const Double3 wallNormal = SoftwareRenderer::getWallNormal(wallFacing);
 
-	auto drawVoxel = [x, voxelX, voxelZ, playerY, playerYFloor, &wallNormal, &nearPoint,
-		&farPoint, nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid, &textures,
-		frameWidth, frameHeight, heightReal, depthBuffer, colorBuffer]()
+	auto drawVoxel = [x, voxelX, voxelZ, voxelColumn, playerY, playerYFloor, &wallNormal,
+		&nearPoint, &farPoint, nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid,
+		&textures, frameWidth, frameHeight, heightReal, depthBuffer, colorBuffer]()
 	{
 		const int voxelY = static_cast<int>(playerYFloor);
-		const char voxelID = voxelGrid.getVoxels()[voxelX + (voxelY * voxelGrid.getWidth()) +
-			(voxelZ * voxelGrid.getWidth() * voxelGrid.getHeight())];
+		const VoxelGrid::VoxelID voxelID = voxelColumn[voxelY];
 		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
 
 		// 3D points to be used for rendering columns once they are projected.
@@ -2084,12 +2086,11 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, double pla
 		}
 	};
 
-	auto drawVoxelBelow = [x, voxelX, voxelZ, &wallNormal, &nearPoint, &farPoint,
-		nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid, &textures, frameWidth,
-		frameHeight, heightReal, depthBuffer, colorBuffer](int voxelY)
+	auto drawVoxelBelow = [x, voxelX, voxelZ, voxelColumn, &wallNormal, &nearPoint,
+		&farPoint, nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid, &textures,
+		frameWidth, frameHeight, heightReal, depthBuffer, colorBuffer](int voxelY)
 	{
-		const char voxelID = voxelGrid.getVoxels()[voxelX + (voxelY * voxelGrid.getWidth()) +
-			(voxelZ * voxelGrid.getWidth() * voxelGrid.getHeight())];
+		const VoxelGrid::VoxelID voxelID = voxelColumn[voxelY];
 		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
 		const double voxelYReal = static_cast<double>(voxelY);
 
@@ -2218,12 +2219,11 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, double pla
 		}
 	};
 
-	auto drawVoxelAbove = [x, voxelX, voxelZ, &wallNormal, &nearPoint, &farPoint,
-		nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid, &textures, frameWidth,
-		frameHeight, heightReal, depthBuffer, colorBuffer](int voxelY)
+	auto drawVoxelAbove = [x, voxelX, voxelZ, voxelColumn, &wallNormal, &nearPoint,
+		&farPoint, nearZ, farZ, u, &transform, yShear, &shadingInfo, &voxelGrid, &textures,
+		frameWidth, frameHeight, heightReal, depthBuffer, colorBuffer](int voxelY)
 	{
-		const char voxelID = voxelGrid.getVoxels()[voxelX + (voxelY * voxelGrid.getWidth()) +
-			(voxelZ * voxelGrid.getWidth() * voxelGrid.getHeight())];
+		const VoxelGrid::VoxelID voxelID = voxelColumn[voxelY];
 		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
 		const double voxelYReal = static_cast<double>(voxelY);
 
@@ -2352,19 +2352,31 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, double pla
 		}
 	};
 
-	// Draw voxel straight ahead first.
-	drawVoxel();
+	// Draw voxel straight ahead first. Air voxels draw nothing, so only the range of
+	// voxels that aren't air is visited.
+	if (columnSummary.isOccupied(playerVoxelY))
+	{
+		drawVoxel();
+	}
 
 	// Draw voxels below the voxel.
-	for (int voxelY = (playerVoxelY - 1); voxelY >= 0; voxelY--)
+	for (int voxelY = std::min(playerVoxelY - 1, columnSummary.maxY);
+		voxelY >= std::max(columnSummary.minY, 0); voxelY--)
 	{
-		drawVoxelBelow(voxelY);
+		if (columnSummary.isOccupied(voxelY))
+		{
+			drawVoxelBelow(voxelY);
+		}
 	}
 
 	// Draw voxels above the voxel.
-	for (int voxelY = (playerVoxelY + 1); voxelY < voxelGrid.getHeight(); voxelY++)
+	for (int voxelY = std::max(playerVoxelY + 1, columnSummary.minY);
+		voxelY <= columnSummary.maxY; voxelY++)
 	{
-		drawVoxelAbove(voxelY);
+		if (columnSummary.isOccupied(voxelY))
+		{
+			drawVoxelAbove(voxelY);
+		}
 	}
 }
 
@@ -2433,9 +2445,6 @@ void SoftwareRenderer::rayCast2D(int x, const Double3 &eye, const Double2 &direc
 		sideDistZ = (eye.z - startCellReal.z) * deltaDistZ;
 	}
 
-	// Pointer to voxel ID grid data.
-	const char *voxels = voxelGrid.getVoxels();
-
 	// The Z distance from the camera to the wall, and the X or Z normal of the intersected
 	// voxel face. The first Z distance is a special case, so it's brought outside the 
 	// DDA loop.
@@ -2450,8 +2459,8 @@ void SoftwareRenderer::rayCast2D(int x, const Double3 &eye, const Double2 &direc
 	if (voxelIsValid)
 	{
 		// Get the initial voxel ID and see how it should be rendered.
-		const char initialVoxelID = voxels[startCell.x + (startCell.y * voxelGrid.getWidth()) +
-			(startCell.z * voxelGrid.getWidth() * voxelGrid.getHeight())];
+		const VoxelGrid::VoxelID initialVoxelID = voxelGrid.getVoxels().get(
+			startCell.x, startCell.y, startCell.z);
 
 		// Decide how far the wall is, and which voxel face was hit.
 		if (sideDistX < sideDistZ)
@@ -2514,13 +2523,96 @@ void SoftwareRenderer::rayCast2D(int x, const Double3 &eye, const Double2 &direc
 			(static_cast<double>(cell.z) - eye.z + static_cast<double>((1 - stepZ) / 2)) / dirZ;
 	};
 
+	// Lambda for jumping to the first XZ coordinate outside a square of columns that
+	// are all air, centered on the current one. Nothing would be drawn in them, so this
+	// reaches the same coordinate and Z distance as stepping through them one at a time.
+	auto skipEmptySpace = [&sideDistX, &sideDistZ, &cell, &wallFacing, &voxelIsValid,
+		&zDistance, deltaDistX, deltaDistZ, dirX, dirZ, nonNegativeDirX, nonNegativeDirZ,
+		&eye, &voxelGrid](int radius)
+	{
+		// Z distances to where the ray leaves the square on each axis.
+		const double exitDistX = nonNegativeDirX ?
+			((static_cast<double>(cell.x + radius + 1) - eye.x) * deltaDistX) :
+			((eye.x - static_cast<double>(cell.x - radius)) * deltaDistX);
+		const double exitDistZ = nonNegativeDirZ ?
+			((static_cast<double>(cell.z + radius + 1) - eye.z) * deltaDistZ) :
+			((eye.z - static_cast<double>(cell.z - radius)) * deltaDistZ);
+
+		// The other axis is clamped to the square in case of rounding error.
+		auto getExitCell = [radius](double position, int center)
+		{
+			return std::min(std::max(static_cast<int>(std::floor(position)),
+				center - radius), center + radius);
+		};
+
+		if (exitDistX < exitDistZ)
+		{
+			cell.z = getExitCell(eye.z + (dirZ * exitDistX), cell.z);
+			cell.x += nonNegativeDirX ? (radius + 1) : -(radius + 1);
+			wallFacing = nonNegativeDirX ? WallFacing::NegativeX : WallFacing::PositiveX;
+			zDistance = exitDistX;
+		}
+		else
+		{
+			cell.x = getExitCell(eye.x + (dirX * exitDistZ), cell.x);
+			cell.z += nonNegativeDirZ ? (radius + 1) : -(radius + 1);
+			wallFacing = nonNegativeDirZ ? WallFacing::NegativeZ : WallFacing::PositiveZ;
+			zDistance = exitDistZ;
+		}
+
+		// Distances to the next grid lines from the new coordinate, found the same way
+		// as for the start of the ray.
+		sideDistX = nonNegativeDirX ?
+			((static_cast<double>(cell.x) + 1.0 - eye.x) * deltaDistX) :
+			((eye.x - static_cast<double>(cell.x)) * deltaDistX);
+		sideDistZ = nonNegativeDirZ ?
+			((static_cast<double>(cell.z) + 1.0 - eye.z) * deltaDistZ) :
+			((eye.z - static_cast<double>(cell.z)) * deltaDistZ);
+
+		voxelIsValid = (cell.x >= 0) && (cell.x < voxelGrid.getWidth()) &&
+			(cell.z >= 0) && (cell.z < voxelGrid.getDepth());
+	};
+
 	// Step forward in the grid once to leave the initial voxel and update the Z distance.
 	doDDAStep();
 
+	// Nothing past a column of solid walls can be seen while the eye is within the
+	// grid's height, so the ray can stop there.
+	const bool eyeInsideGridHeight = (eye.y >= 0.0) &&
+		(eye.y <= static_cast<double>(voxelGrid.getHeight()));
+	auto isOccluder = [this, &voxelGrid, eyeInsideGridHeight](int cellX, int cellZ,
+		const VoxelGrid::ColumnSummary &columnSummary)
+	{
+		if (!eyeInsideGridHeight || !columnSummary.opaque)
+		{
+			return false;
+		}
+
+		const VoxelGrid::VoxelID *column = voxelGrid.getVoxels().getColumn(cellX, cellZ);
+		for (int y = 0; y < voxelGrid.getHeight(); y++)
+		{
+			const VoxelData &voxelData = voxelGrid.getVoxelData(column[y]);
+			if (this->textures[voxelData.sideID - 1].containsTransparency)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	};
+
 	// Step through the voxel grid while the current coordinate is valid and
 	// the distance stepped is less than the distance at which fog is maximum.
 	while (voxelIsValid && (zDistance < this->fogDistance))
 	{
+		// If the current column is surrounded by more columns of air, jump past them.
+		const int emptyRadius = this->emptySpace.getDistance(cell.x, cell.z) - 1;
+		if (emptyRadius > 0)
+		{
+			skipEmptySpace(emptyRadius);
+			continue;
+		}
+
 		// Store the cell coordinates, axis, and Z distance for wall rendering. The
 		// loop needs to do another DDA step to calculate the far point.
 		const int savedCellX = cell.x;
@@ -2540,11 +2632,22 @@ void SoftwareRenderer::rayCast2D(int x, const Double3 &eye, const Double2 &direc
 			eye.x + (dirX * zDistance),
 			eye.z + (dirZ * zDistance));
 
-		// Draw all voxels in a column at the given XZ coordinate.
-		SoftwareRenderer::drawVoxelColumn(x, savedCellX, savedCellZ, eye.y, savedNormal,
-			nearPoint, farPoint, wallDistance, zDistance, transform, yShear, shadingInfo, 
-			voxelGrid, this->textures, this->width, this->height, this->zBuffer.data(), 
-			colorBuffer);
+		// Draw all voxels in a column at the given XZ coordinate, unless they're all air.
+		const VoxelGrid::ColumnSummary &columnSummary =
+			voxelGrid.getColumnSummary(savedCellX, savedCellZ);
+
+		if (!columnSummary.isEmpty())
+		{
+			SoftwareRenderer::drawVoxelColumn(x, savedCellX, savedCellZ, eye.y, savedNormal,
+				nearPoint, farPoint, wallDistance, zDistance, transform, yShear, shadingInfo,
+				voxelGrid, this->textures, this->width, this->height, this->zBuffer.data(),
+				colorBuffer);
+
+			if (isOccluder(savedCellX, savedCellZ, columnSummary))
+			{
+				break;
+			}
+		}
 	}
 
 	// Flats (sprites, doors, diagonal walls, fences, etc.).
@@ -2662,6 +2765,13 @@ void SoftwareRenderer::render(const Double3 &eye, const Double3 &direction, doub
 	const double heightReal = static_cast<double>(this->height);
 	const double aspect = widthReal / heightReal;
 
+	// Rebuild the distance field if the voxels changed since it was last built.
+	if (voxelGrid.getRevision() != this->emptySpaceRevision)
+	{
+		this->emptySpace.build(voxelGrid);
+		this->emptySpaceRevision = voxelGrid.getRevision();
+	}
+
 	// Camera values for rendering. We trick the 2.5D ray caster into thinking the player is 
 	// always looking straight forward, but we use the Y component of the player's direction 
 	// to offset projected coordinates via Y-shearing. Assume "direction" is normalized.
@@ -9,6 +9,7 @@
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Vector4.h"
+#include "../World/VoxelDistanceField.h"
 
 // This class runs the CPU-based 3D rendering for the application.
 
@@ -93,6 +94,8 @@ private:
 	std::vector<std::pair<const Flat*, Flat::Projection>> visibleFlats;
 	std::vector<TextureData> textures;
 	std::vector<Double3> skyPalette; // Colors for each time of day.
+	VoxelDistanceField emptySpace; // For skipping open areas while ray casting.
+	uint64_t emptySpaceRevision; // Voxel grid revision the distance field is from.
 	double fogDistance; // Distance at which fog is maximum.
 	int width, height; // Dimensions of frame buffer.
 	int renderThreadCount; // Number of threads to use for rendering.
@@ -164,7 +167,8 @@ private:
 		int frameHeight, double *depthBuffer, uint32_t *colorBuffer);
 
 	// Casts a 2D ray that steps through the current floor, rendering all voxels
-	// in the XZ column of each voxel.
+	// in the XZ column of each voxel. Open areas are crossed in one step using the
+	// distance field.
 	void rayCast2D(int x, const Double3 &eye, const Double2 &direction,
 		const Matrix4d &transform, double yShear, const ShadingInfo &shadingInfo, 
 		const VoxelGrid &voxelGrid, uint32_t *colorBuffer);
@@ -37,8 +37,18 @@ Texture::~Texture()
 
 Texture &Texture::operator=(Texture &&texture)
 {
-	this->texture = texture.texture;
-	texture.texture = nullptr;
+	if (this != &texture)
+	{
+		// Free the texture being replaced, i.e., when a streaming texture is resized.
+		if (this->texture != nullptr)
+		{
+			SDL_DestroyTexture(this->texture);
+		}
+
+		this->texture = texture.texture;
+		texture.texture = nullptr;
+	}
+
 	return *this;
 }
 
@@ -1,4 +1,10 @@
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
 #include <cctype>
+#include <cstdio>
 #include <fstream>
 #include <vector>
 
@@ -71,3 +77,15 @@ void File::copy(const std::string &srcFilename, const std::string &dstFilename)
 	ifs.close();
 	ofs.close();
 }
+
+bool File::replace(const std::string &srcFilename, const std::string &dstFilename)
+{
+#if defined(_WIN32)
+	// Windows' rename() fails if the destination exists, so ask for a replacing move.
+	return MoveFileExA(srcFilename.c_str(), dstFilename.c_str(),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	// POSIX rename() atomically replaces the destination.
+	return std::rename(srcFilename.c_str(), dstFilename.c_str()) == 0;
+#endif
+}
@@ -21,6 +21,11 @@ public:
 
 	// Copies a file to a destination file.
 	static void copy(const std::string &srcFilename, const std::string &dstFilename);
+
+	// Moves a file onto a destination file, replacing it if it exists. The destination
+	// is never missing in between, so it's safe for swapping in a finished temp file.
+	// Returns whether the move succeeded.
+	static bool replace(const std::string &srcFilename, const std::string &dstFilename);
 };
 
 #endif
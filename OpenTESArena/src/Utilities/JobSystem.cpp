@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cassert>
+
+#include "JobSystem.h"
+
+#include "Debug.h"
+
+JobSystem::JobSystem(int threadCount)
+{
+	// "hardware_concurrency()" might return 0, so it needs to be clamped positive.
+	if (threadCount == 0)
+	{
+		threadCount = static_cast<int>(std::thread::hardware_concurrency());
+		if (threadCount == 0)
+		{
+			DebugMention("hardware_concurrency() returned 0.");
+			threadCount = 1;
+		}
+	}
+
+	this->function = nullptr;
+	this->count = 0;
+	this->batchSize = 0;
+	this->batchCount = 0;
+	this->nextBatch = 0;
+	this->busyWorkers = 0;
+	this->phase = 0;
+	this->quit = false;
+
+	// The calling thread is one of the threads that run batches.
+	for (int i = 0; i < (threadCount - 1); i++)
+	{
+		this->threads.push_back(std::thread([this]() { this->workerProc(); }));
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->quit = true;
+	}
+
+	this->startCondition.notify_all();
+
+	for (auto &thread : this->threads)
+	{
+		thread.join();
+	}
+}
+
+void JobSystem::runBatches()
+{
+	while (true)
+	{
+		const int batch = this->nextBatch++;
+		if (batch >= this->batchCount)
+		{
+			break;
+		}
+
+		const int begin = batch * this->batchSize;
+		const int end = std::min(begin + this->batchSize, this->count);
+		(*this->function)(begin, end);
+	}
+}
+
+void JobSystem::workerProc()
+{
+	uint64_t lastPhase = 0;
+
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true)
+	{
+		this->startCondition.wait(lock, [this, lastPhase]()
+		{
+			return this->quit || (this->phase != lastPhase);
+		});
+
+		if (this->quit)
+		{
+			break;
+		}
+
+		lastPhase = this->phase;
+
+		lock.unlock();
+		this->runBatches();
+		lock.lock();
+
+		this->busyWorkers--;
+		if (this->busyWorkers == 0)
+		{
+			this->doneCondition.notify_one();
+		}
+	}
+}
+
+int JobSystem::getThreadCount() const
+{
+	return static_cast<int>(this->threads.size()) + 1;
+}
+
+void JobSystem::parallelFor(int count, int batchSize, const BatchFunction &function)
+{
+	assert(batchSize > 0);
+
+	if (count <= 0)
+	{
+		return;
+	}
+
+	const int batchCount = (count + batchSize - 1) / batchSize;
+	if ((batchCount == 1) || (this->threads.size() == 0))
+	{
+		function(0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->function = &function;
+		this->count = count;
+		this->batchSize = batchSize;
+		this->batchCount = batchCount;
+		this->nextBatch = 0;
+		this->busyWorkers = static_cast<int>(this->threads.size());
+		this->phase++;
+	}
+
+	this->startCondition.notify_all();
+	this->runBatches();
+
+	// Wait for the workers to finish their last batches before the caller moves on.
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->doneCondition.wait(lock, [this]() { return this->busyWorkers == 0; });
+	this->function = nullptr;
+}
@@ -0,0 +1,63 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A job system runs batches of independent work across a pool of worker threads that
+// stay alive for the whole program, so there's no thread creation cost per frame.
+
+// Per-frame simulation is split into phases. A parallel phase may only read shared
+// state and write to the elements of its own batch, and the calling thread waits
+// for every batch to finish before the next phase starts, so serial phases in between
+// can apply the results. Batches are split up by count alone (not by thread count or
+// timing), and no batch depends on another, so results are the same no matter which
+// thread runs which batch. Anything random in a batch should be seeded from what it
+// works on (i.e., an entity ID), not from a shared generator.
+
+class JobSystem
+{
+public:
+	// Runs the elements in [begin, end) of a parallel phase.
+	typedef std::function<void(int begin, int end)> BatchFunction;
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable startCondition, doneCondition;
+
+	// The phase currently running. The workers start a phase when the phase number
+	// changes, and the caller waits until no workers are busy with it.
+	const BatchFunction *function;
+	int count, batchSize, batchCount;
+	std::atomic<int> nextBatch;
+	int busyWorkers;
+	uint64_t phase;
+	bool quit;
+
+	// Takes batches of the current phase until there are none left.
+	void runBatches();
+
+	void workerProc();
+public:
+	// A thread count of zero uses one thread per hardware thread, including the caller.
+	JobSystem(int threadCount);
+	JobSystem(const JobSystem&) = delete;
+	~JobSystem();
+
+	JobSystem &operator=(const JobSystem&) = delete;
+
+	// Gets the number of threads that run batches, including the calling thread.
+	int getThreadCount() const;
+
+	// Runs a function over the elements in [0, count) in batches of the given size,
+	// returning once every batch is done. The calling thread runs batches too. If there
+	// is only one batch, it is run on the calling thread without waking the workers.
+	void parallelFor(int count, int batchSize, const BatchFunction &function);
+};
+
+#endif
@@ -0,0 +1,130 @@
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+#include "Debug.h"
+
+MappedFile::MappedFile(const std::string &filename)
+{
+	this->data = nullptr;
+	this->size = 0;
+
+#if defined(_WIN32)
+	this->fileHandle = INVALID_HANDLE_VALUE;
+	this->mappingHandle = nullptr;
+
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		DebugWarning("Could not open \"" + filename + "\".");
+		return;
+	}
+
+	this->fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || (fileSize.QuadPart == 0))
+	{
+		DebugWarning("Could not map \"" + filename + "\" (empty or unreadable).");
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		DebugWarning("Could not map \"" + filename + "\".");
+		return;
+	}
+
+	this->mappingHandle = mapping;
+
+	const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		DebugWarning("Could not map \"" + filename + "\".");
+		return;
+	}
+
+	this->data = static_cast<const uint8_t*>(view);
+	this->size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	const int file = open(filename.c_str(), O_RDONLY);
+	if (file == -1)
+	{
+		DebugWarning("Could not open \"" + filename + "\".");
+		return;
+	}
+
+	struct stat fileStat;
+	if ((fstat(file, &fileStat) != 0) || (fileStat.st_size == 0))
+	{
+		DebugWarning("Could not map \"" + filename + "\" (empty or unreadable).");
+		close(file);
+		return;
+	}
+
+	const size_t fileSize = static_cast<size_t>(fileStat.st_size);
+	void *view = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+
+	// The mapping stays valid after the file descriptor is closed.
+	close(file);
+
+	if (view == MAP_FAILED)
+	{
+		DebugWarning("Could not map \"" + filename + "\".");
+		return;
+	}
+
+	this->data = static_cast<const uint8_t*>(view);
+	this->size = fileSize;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(_WIN32)
+	if (this->data != nullptr)
+	{
+		UnmapViewOfFile(this->data);
+	}
+
+	if (this->mappingHandle != nullptr)
+	{
+		CloseHandle(this->mappingHandle);
+	}
+
+	if (this->fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(this->fileHandle);
+	}
+#else
+	if (this->data != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(this->data), this->size);
+	}
+#endif
+}
+
+bool MappedFile::isOpen() const
+{
+	return this->data != nullptr;
+}
+
+const uint8_t *MappedFile::getData() const
+{
+	return this->data;
+}
+
+size_t MappedFile::getSize() const
+{
+	return this->size;
+}
@@ -0,0 +1,35 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A read-only view of a whole file mapped into memory, so it can be parsed in place
+// without reading it into a buffer first. The file is unmapped when the object is
+// destroyed. Empty files can't be mapped.
+
+class MappedFile
+{
+private:
+	const uint8_t *data;
+	size_t size;
+
+#if defined(_WIN32)
+	void *fileHandle, *mappingHandle;
+#endif
+public:
+	MappedFile(const std::string &filename);
+	MappedFile(const MappedFile&) = delete;
+	~MappedFile();
+
+	MappedFile &operator=(const MappedFile&) = delete;
+
+	// Returns whether the file was mapped. If not, the data is null.
+	bool isOpen() const;
+
+	const uint8_t *getData() const;
+	size_t getSize() const;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cassert>
+
+#include "LevelCache.h"
+
+#include "../Utilities/Debug.h"
+
+// Enough for a handful of typical dungeon levels.
+const size_t LevelCache::DEFAULT_MAX_BYTES = 8 * 1024 * 1024;
+
+LevelCache::LevelCache(size_t maxBytes)
+{
+	this->bytes = 0;
+	this->maxBytes = maxBytes;
+}
+
+LevelCache::~LevelCache()
+{
+
+}
+
+void LevelCache::evict()
+{
+	while ((this->bytes > this->maxBytes) && (this->entries.size() > 0))
+	{
+		const Entry &entry = this->entries.back();
+		DebugMention("Evicting level " + std::to_string(entry.levelIndex) +
+			" of \"" + entry.mifName + "\".");
+
+		this->bytes -= entry.bytes;
+		this->entries.pop_back();
+	}
+}
+
+int LevelCache::getCount() const
+{
+	return static_cast<int>(this->entries.size());
+}
+
+size_t LevelCache::getByteCount() const
+{
+	return this->bytes;
+}
+
+bool LevelCache::contains(const std::string &mifName, int levelIndex) const
+{
+	const auto iter = std::find_if(this->entries.begin(), this->entries.end(),
+		[&mifName, levelIndex](const Entry &entry)
+	{
+		return (entry.levelIndex == levelIndex) && (entry.mifName == mifName);
+	});
+
+	return iter != this->entries.end();
+}
+
+std::unique_ptr<WorldData> LevelCache::take(const std::string &mifName, int levelIndex)
+{
+	const auto iter = std::find_if(this->entries.begin(), this->entries.end(),
+		[&mifName, levelIndex](const Entry &entry)
+	{
+		return (entry.levelIndex == levelIndex) && (entry.mifName == mifName);
+	});
+
+	if (iter == this->entries.end())
+	{
+		return nullptr;
+	}
+
+	std::unique_ptr<WorldData> worldData = std::move(iter->worldData);
+	this->bytes -= iter->bytes;
+	this->entries.erase(iter);
+	return worldData;
+}
+
+void LevelCache::put(const std::string &mifName, int levelIndex,
+	std::unique_ptr<WorldData> worldData)
+{
+	assert(worldData.get() != nullptr);
+
+	// Drop any older copy so the level is only in the cache once.
+	this->take(mifName, levelIndex);
+
+	Entry entry;
+	entry.mifName = mifName;
+	entry.levelIndex = levelIndex;
+	entry.bytes = worldData->getByteCount();
+	entry.worldData = std::move(worldData);
+
+	this->bytes += entry.bytes;
+	this->entries.push_front(std::move(entry));
+	this->evict();
+}
+
+void LevelCache::setMaxBytes(size_t maxBytes)
+{
+	this->maxBytes = maxBytes;
+	this->evict();
+}
+
+void LevelCache::clear()
+{
+	this->entries.clear();
+	this->bytes = 0;
+}
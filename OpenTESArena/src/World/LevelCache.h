@@ -0,0 +1,64 @@
+#ifndef LEVEL_CACHE_H
+#define LEVEL_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "WorldData.h"
+
+// A level cache holds on to the worlds of recently visited levels, so going back to one
+// (i.e., taking the stairs in a dungeon) doesn't rebuild its voxel grid from the .MIF
+// file again. Levels are kept under a byte budget, and the least recently stored ones
+// are evicted first.
+
+class LevelCache
+{
+private:
+	struct Entry
+	{
+		std::string mifName;
+		int levelIndex;
+		std::unique_ptr<WorldData> worldData;
+		size_t bytes;
+	};
+
+	// Cached levels, ordered from most to least recently stored.
+	std::list<Entry> entries;
+	size_t bytes, maxBytes;
+
+	// Evicts the least recently stored levels until the cache is within budget.
+	void evict();
+public:
+	LevelCache(size_t maxBytes);
+	~LevelCache();
+
+	// Default number of bytes that cached levels may use.
+	static const size_t DEFAULT_MAX_BYTES;
+
+	// Gets the number of levels in the cache.
+	int getCount() const;
+
+	// Gets the number of bytes used by cached levels.
+	size_t getByteCount() const;
+
+	// Returns whether a level is in the cache.
+	bool contains(const std::string &mifName, int levelIndex) const;
+
+	// Removes a level from the cache and returns it, or null if it isn't cached.
+	std::unique_ptr<WorldData> take(const std::string &mifName, int levelIndex);
+
+	// Stores a level, replacing any cached copy of it. A level bigger than the whole
+	// budget isn't kept.
+	void put(const std::string &mifName, int levelIndex,
+		std::unique_ptr<WorldData> worldData);
+
+	// Sets the number of bytes that cached levels may use, evicting levels if needed.
+	void setMaxBytes(size_t maxBytes);
+
+	// Removes all levels.
+	void clear();
+};
+
+#endif
@@ -0,0 +1,427 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "VoxelCollision.h"
+
+#include "VoxelData.h"
+#include "VoxelGrid.h"
+
+namespace
+{
+	// Gap at which two surfaces count as touching instead of overlapping. Touching
+	// surfaces only block movement into each other, so a box can slide along a floor
+	// or wall it's resting against.
+	const double CONTACT_EPSILON = 1.0e-7;
+
+	// Movement along an axis shorter than this counts as not moving along it.
+	const double MIN_MOVEMENT = 1.0e-12;
+
+	// How far below the feet is checked for ground.
+	const double GROUND_PROBE_DISTANCE = 1.0e-3;
+
+	// Most surfaces a sub-step can slide along before the rest of its movement is dropped.
+	const int MAX_SLIDES = 4;
+
+	// Index of a diagonal wall's normal, after the X, Y, and Z axes.
+	const int DIAGONAL_AXIS = 3;
+
+	// The solid part of a voxel.
+	struct Shape
+	{
+		Double3 min, max; // Bounding box.
+		int diagonal; // 0 for a box, otherwise the diagonal's number (1 or 2).
+	};
+
+	// The first shape a moving box touches.
+	struct Hit
+	{
+		Shape shape;
+		double time; // Fraction of the movement before contact.
+		int axis; // Axis that the box and shape stop being separated along.
+	};
+
+	Double3 getBoxMin(const Double3 &feetPosition, double halfWidth)
+	{
+		return Double3(feetPosition.x - halfWidth, feetPosition.y, feetPosition.z - halfWidth);
+	}
+
+	Double3 getBoxMax(const Double3 &feetPosition, double halfWidth, double height)
+	{
+		return Double3(feetPosition.x + halfWidth, feetPosition.y + height,
+			feetPosition.z + halfWidth);
+	}
+
+	// Gets the XZ direction perpendicular to a diagonal. It isn't normalized, so both the
+	// box and the diagonal are projected onto it the same way.
+	Double3 getDiagonalAxis(int diagonal)
+	{
+		return (diagonal == 1) ? Double3(-1.0, 0.0, 1.0) : Double3(1.0, 0.0, 1.0);
+	}
+
+	// Gets where a diagonal is along its axis. Diagonal 1 is z = x, and diagonal 2 is
+	// z = -x + 1, relative to the voxel.
+	double getDiagonalValue(const Shape &shape)
+	{
+		return (shape.diagonal == 1) ? (shape.min.z - shape.min.x) :
+			(shape.min.x + shape.min.z + 1.0);
+	}
+
+	// Gets the shape of a voxel. Returns false if it's air.
+	bool getShape(const VoxelData &voxelData, int x, int y, int z, Shape &shape)
+	{
+		if (voxelData.isAir())
+		{
+			return false;
+		}
+
+		const double bottom = static_cast<double>(y) + voxelData.yOffset;
+		shape.min = Double3(static_cast<double>(x), bottom, static_cast<double>(z));
+		shape.max = Double3(static_cast<double>(x + 1), bottom + voxelData.ySize,
+			static_cast<double>(z + 1));
+		shape.diagonal = (voxelData.diag1ID != 0) ? 1 : ((voxelData.diag2ID != 0) ? 2 : 0);
+		return true;
+	}
+
+	// Calls a function for each voxel shape that might be in a region.
+	template <typename T>
+	void forEachShape(const VoxelGrid &voxelGrid, const Double3 &regionMin,
+		const Double3 &regionMax, const T &function)
+	{
+		const int minX = std::max(static_cast<int>(std::floor(regionMin.x)), 0);
+		const int minY = std::max(static_cast<int>(std::floor(regionMin.y)), 0);
+		const int minZ = std::max(static_cast<int>(std::floor(regionMin.z)), 0);
+		const int maxX = std::min(static_cast<int>(std::floor(regionMax.x)),
+			voxelGrid.getWidth() - 1);
+		const int maxY = std::min(static_cast<int>(std::floor(regionMax.y)),
+			voxelGrid.getHeight() - 1);
+		const int maxZ = std::min(static_cast<int>(std::floor(regionMax.z)),
+			voxelGrid.getDepth() - 1);
+
+		for (int z = minZ; z <= maxZ; z++)
+		{
+			for (int x = minX; x <= maxX; x++)
+			{
+				const VoxelGrid::ColumnSummary &columnSummary = voxelGrid.getColumnSummary(x, z);
+				if (columnSummary.isEmpty())
+				{
+					continue;
+				}
+
+				const VoxelGrid::VoxelID *column = voxelGrid.getVoxels().getColumn(x, z);
+				const int startY = std::max(minY, columnSummary.minY);
+				const int endY = std::min(maxY, columnSummary.maxY);
+				for (int y = startY; y <= endY; y++)
+				{
+					Shape shape;
+					if (getShape(voxelGrid.getVoxelData(column[y]), x, y, z, shape))
+					{
+						function(shape);
+					}
+				}
+			}
+		}
+	}
+
+	// Gets the range of time (as a fraction of the movement) where an interval moving by
+	// some amount overlaps another one. Returns false if they never overlap.
+	bool sweepInterval(double a0, double a1, double b0, double b1, double movement,
+		double &entry, double &exit)
+	{
+		if (std::abs(movement) <= MIN_MOVEMENT)
+		{
+			if ((a1 <= (b0 + CONTACT_EPSILON)) || (a0 >= (b1 - CONTACT_EPSILON)))
+			{
+				return false;
+			}
+
+			entry = -std::numeric_limits<double>::infinity();
+			exit = std::numeric_limits<double>::infinity();
+		}
+		else if (movement > 0.0)
+		{
+			entry = (b0 - a1) / movement;
+			exit = (b1 - a0) / movement;
+		}
+		else
+		{
+			entry = (b1 - a0) / movement;
+			exit = (b0 - a1) / movement;
+		}
+
+		return true;
+	}
+
+	// Gets when a moving box first touches a shape, using the separating axes of both.
+	// Returns false if it doesn't touch during the movement, or if they already overlap
+	// (so a box that's stuck can still get out).
+	bool sweepShape(const Double3 &feetPosition, double halfWidth, double height,
+		const Shape &shape, const Double3 &movement, double &time, int &axis)
+	{
+		const Double3 boxMin = getBoxMin(feetPosition, halfWidth);
+		const Double3 boxMax = getBoxMax(feetPosition, halfWidth, height);
+
+		double entry = -std::numeric_limits<double>::infinity();
+		double exit = std::numeric_limits<double>::infinity();
+		double entrySpeed = 0.0;
+		axis = -1;
+
+		for (int i = 0; i < 3; i++)
+		{
+			double axisEntry, axisExit;
+			if (!sweepInterval(boxMin[i], boxMax[i], shape.min[i], shape.max[i],
+				movement[i], axisEntry, axisExit))
+			{
+				return false;
+			}
+
+			if (axisEntry > entry)
+			{
+				entry = axisEntry;
+				entrySpeed = std::abs(movement[i]);
+				axis = i;
+			}
+
+			exit = std::min(exit, axisExit);
+		}
+
+		if (shape.diagonal != 0)
+		{
+			const Double3 diagonalAxis = getDiagonalAxis(shape.diagonal);
+			const double center = feetPosition.dot(diagonalAxis);
+			const double radius = 2.0 * halfWidth;
+			const double value = getDiagonalValue(shape);
+			const double axisMovement = movement.dot(diagonalAxis);
+
+			double axisEntry, axisExit;
+			if (!sweepInterval(center - radius, center + radius, value, value,
+				axisMovement, axisEntry, axisExit))
+			{
+				return false;
+			}
+
+			if (axisEntry > entry)
+			{
+				entry = axisEntry;
+				entrySpeed = std::abs(axisMovement);
+				axis = DIAGONAL_AXIS;
+			}
+
+			exit = std::min(exit, axisExit);
+		}
+
+		if ((axis < 0) || (entry >= exit) || (entry > 1.0) || (exit <= 0.0) ||
+			((entry * entrySpeed) < -CONTACT_EPSILON))
+		{
+			return false;
+		}
+
+		time = entry;
+		return true;
+	}
+
+	// Returns whether a box overlaps a shape by more than touching.
+	bool overlapsShape(const Double3 &feetPosition, double halfWidth, double height,
+		const Shape &shape)
+	{
+		const Double3 boxMin = getBoxMin(feetPosition, halfWidth);
+		const Double3 boxMax = getBoxMax(feetPosition, halfWidth, height);
+
+		for (int i = 0; i < 3; i++)
+		{
+			if ((boxMax[i] <= (shape.min[i] + CONTACT_EPSILON)) ||
+				(boxMin[i] >= (shape.max[i] - CONTACT_EPSILON)))
+			{
+				return false;
+			}
+		}
+
+		if (shape.diagonal != 0)
+		{
+			const double center = feetPosition.dot(getDiagonalAxis(shape.diagonal));
+			const double distance = std::abs(center - getDiagonalValue(shape));
+			return distance < ((2.0 * halfWidth) - CONTACT_EPSILON);
+		}
+
+		return true;
+	}
+
+	// Finds the first shape a box touches while moving. Ties go to the first shape found.
+	bool findHit(const VoxelGrid &voxelGrid, const Double3 &feetPosition, double halfWidth,
+		double height, const Double3 &movement, Hit &hit)
+	{
+		const Double3 boxMin = getBoxMin(feetPosition, halfWidth);
+		const Double3 boxMax = getBoxMax(feetPosition, halfWidth, height);
+		const Double3 regionMin(
+			std::min(boxMin.x, boxMin.x + movement.x) - CONTACT_EPSILON,
+			std::min(boxMin.y, boxMin.y + movement.y) - CONTACT_EPSILON,
+			std::min(boxMin.z, boxMin.z + movement.z) - CONTACT_EPSILON);
+		const Double3 regionMax(
+			std::max(boxMax.x, boxMax.x + movement.x) + CONTACT_EPSILON,
+			std::max(boxMax.y, boxMax.y + movement.y) + CONTACT_EPSILON,
+			std::max(boxMax.z, boxMax.z + movement.z) + CONTACT_EPSILON);
+
+		bool found = false;
+		hit.time = std::numeric_limits<double>::infinity();
+
+		forEachShape(voxelGrid, regionMin, regionMax,
+			[feetPosition, halfWidth, height, &movement, &hit, &found](const Shape &shape)
+		{
+			double time;
+			int axis;
+			if (sweepShape(feetPosition, halfWidth, height, shape, movement, time, axis) &&
+				(time < hit.time))
+			{
+				hit.shape = shape;
+				hit.time = time;
+				hit.axis = axis;
+				found = true;
+			}
+		});
+
+		return found;
+	}
+}
+
+const int VoxelCollision::MAX_SUB_STEPS = 16;
+
+bool VoxelCollision::overlaps(const VoxelGrid &voxelGrid, const Double3 &feetPosition,
+	double halfWidth, double height)
+{
+	const Double3 boxMin = getBoxMin(feetPosition, halfWidth);
+	const Double3 boxMax = getBoxMax(feetPosition, halfWidth, height);
+
+	bool overlapping = false;
+	forEachShape(voxelGrid, boxMin, boxMax,
+		[feetPosition, halfWidth, height, &overlapping](const Shape &shape)
+	{
+		overlapping |= overlapsShape(feetPosition, halfWidth, height, shape);
+	});
+
+	return overlapping;
+}
+
+bool VoxelCollision::isOnGround(const VoxelGrid &voxelGrid, const Double3 &feetPosition,
+	double halfWidth, double height)
+{
+	Hit hit;
+	const Double3 probe(0.0, -GROUND_PROBE_DISTANCE, 0.0);
+	return findHit(voxelGrid, feetPosition, halfWidth, height, probe, hit) &&
+		(hit.axis == 1);
+}
+
+VoxelCollision::Result VoxelCollision::move(const VoxelGrid &voxelGrid,
+	const Double3 &feetPosition, double halfWidth, double height, double stepHeight,
+	const Double3 &velocity, double dt)
+{
+	Result result;
+	result.position = feetPosition;
+	result.velocity = velocity;
+	result.hitWall = false;
+	result.hitCeiling = false;
+	result.onGround = false;
+
+	// Split the movement so no sub-step goes farther than half the box, or else a fast
+	// box would check a long strip of voxels at once.
+	const double distance = velocity.length() * dt;
+	const double maxSubStepDistance = std::min(halfWidth, height * 0.50);
+	const int subStepCount = std::max(1, std::min(VoxelCollision::MAX_SUB_STEPS,
+		static_cast<int>(std::ceil(distance / maxSubStepDistance))));
+	const double subStepDt = dt / static_cast<double>(subStepCount);
+
+	for (int subStep = 0; subStep < subStepCount; subStep++)
+	{
+		Double3 movement = result.velocity * subStepDt;
+
+		// Normal of the last wall slid along, for noticing when the box is wedged.
+		Double3 lastNormal(0.0, 0.0, 0.0);
+
+		for (int slide = 0; slide < MAX_SLIDES; slide++)
+		{
+			if (movement.length() <= MIN_MOVEMENT)
+			{
+				break;
+			}
+
+			Hit hit;
+			if (!findHit(voxelGrid, result.position, halfWidth, height, movement, hit))
+			{
+				result.position = result.position + movement;
+				break;
+			}
+
+			// Move up to the surface, then slide along it with what's left.
+			const double time = std::max(hit.time, 0.0);
+			const Double3 direction = movement;
+			result.position = result.position + (movement * time);
+			movement = movement * (1.0 - time);
+
+			if (hit.axis == 1)
+			{
+				if (direction.y < 0.0)
+				{
+					result.position.y = hit.shape.max.y;
+					result.onGround = true;
+				}
+				else
+				{
+					result.position.y = hit.shape.min.y - height;
+					result.hitCeiling = true;
+				}
+
+				movement.y = 0.0;
+				result.velocity.y = 0.0;
+				continue;
+			}
+
+			// Step up onto the shape if it's low enough and there's room above it.
+			const double rise = hit.shape.max.y - result.position.y;
+			if ((result.velocity.y <= 0.0) && (rise <= stepHeight))
+			{
+				const Double3 steppedPosition(result.position.x,
+					hit.shape.max.y, result.position.z);
+
+				if (!VoxelCollision::overlaps(voxelGrid, steppedPosition, halfWidth, height))
+				{
+					result.position = steppedPosition;
+					result.onGround = true;
+					continue;
+				}
+			}
+
+			result.hitWall = true;
+
+			Double3 normal(0.0, 0.0, 0.0);
+			if (hit.axis == DIAGONAL_AXIS)
+			{
+				normal = getDiagonalAxis(hit.shape.diagonal).normalized();
+				normal = (direction.dot(normal) > 0.0) ? -normal : normal;
+				movement = movement - (normal * movement.dot(normal));
+				result.velocity = result.velocity - (normal * result.velocity.dot(normal));
+			}
+			else
+			{
+				const int i = hit.axis;
+				result.position[i] = (direction[i] > 0.0) ?
+					(hit.shape.min[i] - halfWidth) : (hit.shape.max[i] + halfWidth);
+				normal[i] = (direction[i] > 0.0) ? -1.0 : 1.0;
+				movement[i] = 0.0;
+				result.velocity[i] = 0.0;
+			}
+
+			// Sliding along this wall would go back into the last one, so the box is in
+			// a corner and can't move horizontally.
+			if (movement.dot(lastNormal) < 0.0)
+			{
+				movement.x = 0.0;
+				movement.z = 0.0;
+				result.velocity.x = 0.0;
+				result.velocity.z = 0.0;
+			}
+
+			lastNormal = normal;
+		}
+	}
+
+	return result;
+}
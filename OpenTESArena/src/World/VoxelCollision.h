@@ -0,0 +1,55 @@
+#ifndef VOXEL_COLLISION_H
+#define VOXEL_COLLISION_H
+
+#include "../Math/Vector3.h"
+
+// Static class for moving an upright axis-aligned box through a voxel grid, i.e., for
+// the player and NPCs. A box is described by the point at the center of its bottom face
+// (its "feet"), its half-width in X and Z, and its height.
+
+// Each voxel that isn't air is solid between its Y offset and Y offset plus Y size, so
+// raised platforms and thin floors like bridges are solid only where they're drawn.
+// Diagonal walls are zero-thickness walls along their line. Voxels outside the grid
+// are air.
+
+// Movement is swept, so a box can't tunnel through thin walls at high speed. When it
+// hits something, it slides along the surface with the rest of its movement, and it
+// can step up onto ledges no higher than its step height. Long moves are split into
+// sub-steps no longer than half the box so each one only touches a few voxels.
+
+class VoxelGrid;
+
+class VoxelCollision
+{
+public:
+	struct Result
+	{
+		Double3 position, velocity; // New feet position and velocity.
+		bool hitWall; // Stopped by the side of something (including diagonals).
+		bool hitCeiling; // Stopped by the bottom of something.
+		bool onGround; // Landed on top of something.
+	};
+
+	// Most sub-steps a single move is split into.
+	static const int MAX_SUB_STEPS;
+private:
+	VoxelCollision() = delete;
+	VoxelCollision(const VoxelCollision&) = delete;
+	~VoxelCollision() = delete;
+public:
+	// Returns whether a box overlaps any solid voxel geometry. Touching doesn't count.
+	static bool overlaps(const VoxelGrid &voxelGrid, const Double3 &feetPosition,
+		double halfWidth, double height);
+
+	// Returns whether a box is resting on top of solid voxel geometry.
+	static bool isOnGround(const VoxelGrid &voxelGrid, const Double3 &feetPosition,
+		double halfWidth, double height);
+
+	// Moves a box by its velocity over delta time, colliding with the voxel grid.
+	// Velocity into a surface that was hit is removed.
+	static Result move(const VoxelGrid &voxelGrid, const Double3 &feetPosition,
+		double halfWidth, double height, double stepHeight, const Double3 &velocity,
+		double dt);
+};
+
+#endif
@@ -45,5 +45,5 @@ VoxelData::~VoxelData()
 bool VoxelData::isAir() const
 {
 	return (this->sideID == 0) && (this->floorID == 0) &&
-		(this->ceilingID == 0);
+		(this->ceilingID == 0) && (this->diag1ID == 0) && (this->diag2ID == 0);
 }
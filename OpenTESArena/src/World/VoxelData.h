@@ -39,7 +39,7 @@ public:
 
 	~VoxelData();
 
-	// Returns whether all of the voxel's sides have an ID of zero.
+	// Returns whether all of the voxel's sides and diagonals have an ID of zero.
 	bool isAir() const;
 };
 
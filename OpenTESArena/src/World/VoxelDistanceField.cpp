@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include "VoxelDistanceField.h"
+#include "VoxelGrid.h"
+
+const int VoxelDistanceField::MAX_DISTANCE = 255;
+
+VoxelDistanceField::VoxelDistanceField()
+{
+	this->width = 0;
+	this->depth = 0;
+}
+
+VoxelDistanceField::~VoxelDistanceField()
+{
+
+}
+
+int VoxelDistanceField::getWidth() const
+{
+	return this->width;
+}
+
+int VoxelDistanceField::getDepth() const
+{
+	return this->depth;
+}
+
+int VoxelDistanceField::getDistance(int x, int z) const
+{
+	const bool inside = (x >= 0) && (x < this->width) && (z >= 0) && (z < this->depth);
+	return inside ? static_cast<int>(this->distances[x + (z * this->width)]) : 0;
+}
+
+void VoxelDistanceField::build(const VoxelGrid &voxelGrid)
+{
+	this->width = voxelGrid.getWidth();
+	this->depth = voxelGrid.getDepth();
+
+	// Distances are found as ints first so they don't overflow while being summed.
+	std::vector<int> field(this->width * this->depth);
+	for (int z = 0; z < this->depth; z++)
+	{
+		for (int x = 0; x < this->width; x++)
+		{
+			field[x + (z * this->width)] = voxelGrid.getColumnSummary(x, z).isEmpty() ?
+				VoxelDistanceField::MAX_DISTANCE : 0;
+		}
+	}
+
+	// Gets the distance at a column plus one step, or the max if it's outside.
+	auto getStepped = [this, &field](int x, int z)
+	{
+		const bool inside = (x >= 0) && (x < this->width) && (z >= 0) && (z < this->depth);
+		return inside ? (field[x + (z * this->width)] + 1) : VoxelDistanceField::MAX_DISTANCE;
+	};
+
+	// Forward pass, from the neighbors that come before each column.
+	for (int z = 0; z < this->depth; z++)
+	{
+		for (int x = 0; x < this->width; x++)
+		{
+			int &distance = field[x + (z * this->width)];
+			distance = std::min(distance, std::min(
+				std::min(getStepped(x - 1, z), getStepped(x - 1, z - 1)),
+				std::min(getStepped(x, z - 1), getStepped(x + 1, z - 1))));
+		}
+	}
+
+	// Backward pass, from the neighbors that come after each column.
+	for (int z = this->depth - 1; z >= 0; z--)
+	{
+		for (int x = this->width - 1; x >= 0; x--)
+		{
+			int &distance = field[x + (z * this->width)];
+			distance = std::min(distance, std::min(
+				std::min(getStepped(x + 1, z), getStepped(x + 1, z + 1)),
+				std::min(getStepped(x, z + 1), getStepped(x - 1, z + 1))));
+		}
+	}
+
+	this->distances.resize(field.size());
+	for (size_t i = 0; i < field.size(); i++)
+	{
+		this->distances[i] = static_cast<uint8_t>(
+			std::min(field[i], VoxelDistanceField::MAX_DISTANCE));
+	}
+}
@@ -0,0 +1,42 @@
+#ifndef VOXEL_DISTANCE_FIELD_H
+#define VOXEL_DISTANCE_FIELD_H
+
+#include <cstdint>
+#include <vector>
+
+// A voxel distance field stores, for each XZ column of a voxel grid, the Chebyshev
+// distance to the nearest column that has any voxel that isn't air. A distance of N
+// means every column less than N steps away (counting diagonal steps as one) is all
+// air, so a ray can cross that whole square without hitting anything. Columns that
+// aren't all air have a distance of 0.
+
+// It's built from a voxel grid's column summaries with a two-pass distance transform,
+// and is meant to be rebuilt when the grid changes (i.e., when a level is loaded).
+
+class VoxelGrid;
+
+class VoxelDistanceField
+{
+private:
+	std::vector<uint8_t> distances;
+	int width, depth;
+public:
+	VoxelDistanceField();
+	~VoxelDistanceField();
+
+	// Largest distance stored. Open areas farther from any wall than this still
+	// have this distance.
+	static const int MAX_DISTANCE;
+
+	int getWidth() const;
+	int getDepth() const;
+
+	// Gets the distance at an XZ column. Columns outside the field are treated as
+	// next to a wall, so rays never skip from them.
+	int getDistance(int x, int z) const;
+
+	// Recalculates the distances for a voxel grid.
+	void build(const VoxelGrid &voxelGrid);
+};
+
+#endif
@@ -1,16 +1,43 @@
-#include <algorithm>
+#include <cassert>
+#include <limits>
 
 #include "VoxelGrid.h"
 
-VoxelGrid::VoxelGrid(int width, int height, int depth)
+#include "../Utilities/Debug.h"
+
+bool VoxelGrid::ColumnSummary::isEmpty() const
+{
+	return this->occupancy == 0;
+}
+
+bool VoxelGrid::ColumnSummary::isOccupied(int y) const
 {
-	const int voxelCount = width * height * depth;
-	this->voxels = std::vector<char>(voxelCount);
-	std::fill(this->voxels.begin(), this->voxels.end(), 0);
+	// Shifting by a negative amount or by the width of the mask is undefined.
+	if ((y < 0) || (y >= VoxelGrid::MAX_HEIGHT))
+	{
+		return false;
+	}
 
-	this->width = width;
-	this->height = height;
-	this->depth = depth;
+	return ((this->occupancy >> y) & 1) != 0;
+}
+
+const int VoxelGrid::MAX_HEIGHT = 64;
+std::atomic<uint64_t> VoxelGrid::nextRevision(1);
+
+VoxelGrid::VoxelGrid(int width, int height, int depth)
+	: voxels(width, height, depth)
+{
+	DebugAssert(height <= VoxelGrid::MAX_HEIGHT, "Voxel grid height (" +
+		std::to_string(height) + ") too tall for column summaries.");
+
+	// Every voxel starts as air.
+	ColumnSummary emptySummary;
+	emptySummary.occupancy = 0;
+	emptySummary.minY = -1;
+	emptySummary.maxY = -1;
+	emptySummary.opaque = false;
+	this->columnSummaries = std::vector<ColumnSummary>(width * depth, emptySummary);
+	this->revision = VoxelGrid::nextRevision++;
 }
 
 VoxelGrid::~VoxelGrid()
@@ -18,6 +45,37 @@ VoxelGrid::~VoxelGrid()
 
 }
 
+bool VoxelGrid::isFullWall(const VoxelData &voxelData)
+{
+	return (voxelData.sideID > 0) && (voxelData.diag1ID == 0) &&
+		(voxelData.diag2ID == 0) && (voxelData.yOffset == 0.0) && (voxelData.ySize == 1.0);
+}
+
+void VoxelGrid::updateColumnSummary(int x, int z)
+{
+	const int height = this->voxels.getHeight();
+	const VoxelID *column = this->voxels.getColumn(x, z);
+
+	ColumnSummary &summary = this->columnSummaries[x + (z * this->voxels.getWidth())];
+	summary.occupancy = 0;
+	summary.minY = -1;
+	summary.maxY = -1;
+	summary.opaque = true;
+
+	for (int y = 0; y < height; y++)
+	{
+		const VoxelData &voxelData = this->voxelData.at(column[y]);
+		if (!voxelData.isAir())
+		{
+			summary.occupancy |= static_cast<uint64_t>(1) << y;
+			summary.minY = (summary.minY == -1) ? y : summary.minY;
+			summary.maxY = y;
+		}
+
+		summary.opaque &= VoxelGrid::isFullWall(voxelData);
+	}
+}
+
 Int2 VoxelGrid::arenaVoxelToNewVoxel(const Int2 &voxel, int gridWidth, int gridDepth)
 {
 	return Int2(gridDepth - voxel.y, gridWidth - voxel.x);
@@ -32,32 +90,63 @@ Double2 VoxelGrid::arenaVoxelToNewVoxel(const Double2 &voxel, int gridWidth, int
 
 int VoxelGrid::getWidth() const
 {
-	return this->width;
+	return this->voxels.getWidth();
 }
 
 int VoxelGrid::getHeight() const
 {
-	return this->height;
+	return this->voxels.getHeight();
 }
 
 int VoxelGrid::getDepth() const
 {
-	return this->depth;
+	return this->voxels.getDepth();
 }
 
-char *VoxelGrid::getVoxels()
+const VoxelStorage<VoxelGrid::VoxelID> &VoxelGrid::getVoxels() const
 {
-	return this->voxels.data();
+	return this->voxels;
 }
 
-const char *VoxelGrid::getVoxels() const
+std::vector<VoxelGrid::VoxelID> VoxelGrid::getVoxelIDs() const
 {
-	return this->voxels.data();
+	const int width = this->voxels.getWidth();
+	const int height = this->voxels.getHeight();
+	const int depth = this->voxels.getDepth();
+
+	std::vector<VoxelID> ids;
+	ids.reserve(static_cast<size_t>(width) * height * depth);
+
+	for (int z = 0; z < depth; z++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			const VoxelID *column = this->voxels.getColumn(x, z);
+			ids.insert(ids.end(), column, column + height);
+		}
+	}
+
+	return ids;
 }
 
-VoxelData &VoxelGrid::getVoxelData(int id)
+uint64_t VoxelGrid::getRevision() const
 {
-	return this->voxelData.at(id);
+	return this->revision;
+}
+
+size_t VoxelGrid::getByteCount() const
+{
+	const size_t voxelCount = static_cast<size_t>(this->getWidth()) *
+		static_cast<size_t>(this->getHeight()) * static_cast<size_t>(this->getDepth());
+	return sizeof(*this) + (voxelCount * sizeof(VoxelID)) +
+		(this->voxelData.size() * sizeof(VoxelData)) +
+		(this->columnSummaries.size() * sizeof(ColumnSummary));
+}
+
+const VoxelGrid::ColumnSummary &VoxelGrid::getColumnSummary(int x, int z) const
+{
+	assert(this->voxels.contains(x, 0, z));
+	return this->columnSummaries[x + (z * this->voxels.getWidth())];
 }
 
 const VoxelData &VoxelGrid::getVoxelData(int id) const
@@ -65,9 +154,29 @@ const VoxelData &VoxelGrid::getVoxelData(int id) const
 	return this->voxelData.at(id);
 }
 
+int VoxelGrid::getVoxelDataCount() const
+{
+	return static_cast<int>(this->voxelData.size());
+}
+
 int VoxelGrid::addVoxelData(const VoxelData &voxelData)
 {
+	DebugAssert(this->voxelData.size() < std::numeric_limits<VoxelID>::max(),
+		"Too many voxel data definitions (" + std::to_string(this->voxelData.size()) + ").");
+
 	this->voxelData.push_back(voxelData);
 
 	return static_cast<int>(this->voxelData.size() - 1);
 }
+
+void VoxelGrid::setVoxel(int x, int y, int z, VoxelID id)
+{
+	assert(id < this->voxelData.size());
+
+	if (this->voxels.get(x, y, z) != id)
+	{
+		this->voxels.set(x, y, z, id);
+		this->updateColumnSummary(x, z);
+		this->revision = VoxelGrid::nextRevision++;
+	}
+}
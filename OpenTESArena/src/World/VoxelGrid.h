@@ -1,19 +1,60 @@
 #ifndef VOXEL_GRID_H
 #define VOXEL_GRID_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "VoxelData.h"
+#include "VoxelStorage.h"
 #include "../Math/Vector2.h"
 
 // A voxel grid is a 3D array of voxel IDs with their associated voxel definitions.
 
+// Voxel IDs are 16-bit, so a level can have many more voxel definitions than the
+// number of wall and floor combinations in Arena's .MIF files.
+
+// Each XZ column also has a summary of which of its voxels aren't air and whether it
+// can be seen past, so ray casting can skip empty columns and stop behind solid ones.
+// Summaries are kept up to date as voxels are set, one column at a time. Voxel ID 0
+// is assumed to be air, like in a new grid.
+
 class VoxelGrid
 {
+public:
+	typedef uint16_t VoxelID;
+
+	struct ColumnSummary
+	{
+		uint64_t occupancy; // Bit Y is set if the voxel at Y isn't air.
+		int minY, maxY; // Lowest and highest voxels that aren't air, or -1 if none.
+		bool opaque; // Every voxel is a full-size wall (not counting transparent texels).
+
+		// Returns whether every voxel in the column is air.
+		bool isEmpty() const;
+
+		// Returns whether the voxel at Y isn't air. Y outside the grid is air.
+		bool isOccupied(int y) const;
+	};
+
+	// Tallest grid that column summaries can describe.
+	static const int MAX_HEIGHT;
 private:
-	std::vector<char> voxels;
+	VoxelStorage<VoxelID> voxels;
 	std::vector<VoxelData> voxelData;
-	int width, height, depth;
+	std::vector<ColumnSummary> columnSummaries; // One per XZ column, X innermost.
+
+	// Changes whenever a voxel changes. Revisions are unique across all grids, so
+	// anything derived from a grid can tell if it's out of date.
+	uint64_t revision;
+	static std::atomic<uint64_t> nextRevision;
+
+	// Returns whether voxel data fills its whole voxel with walls.
+	static bool isFullWall(const VoxelData &voxelData);
+
+	// Recalculates the summary of a column after its voxels changed.
+	void updateColumnSummary(int x, int z);
 public:
 	VoxelGrid(int width, int height, int depth);
 	~VoxelGrid();
@@ -28,17 +69,36 @@ public:
 	int getHeight() const;
 	int getDepth() const;
 
-	// Gets a pointer to the voxel grid data.
-	char *getVoxels();
-	const char *getVoxels() const;
+	// Gets the voxel IDs of the grid. Voxels are changed with setVoxel() so the
+	// column summaries stay up to date.
+	const VoxelStorage<VoxelID> &getVoxels() const;
+
+	// Copies all the voxel IDs of the grid, one column at a time in the same order as
+	// the voxel storage (Y innermost, then X, then Z).
+	std::vector<VoxelID> getVoxelIDs() const;
+
+	// Gets a number that changes whenever the grid's voxels change.
+	uint64_t getRevision() const;
+
+	// Gets the approximate number of bytes used by the grid, i.e., for cache budgets.
+	size_t getByteCount() const;
+
+	// Gets the summary of the column at an XZ coordinate, which must be inside the grid.
+	const ColumnSummary &getColumnSummary(int x, int z) const;
 
 	// Gets the voxel data associated with an ID. If the voxel ID of air is 0,
 	// then pass the voxel ID minus 1 instead to get the first one.
-	VoxelData &getVoxelData(int id);
 	const VoxelData &getVoxelData(int id) const;
 
+	// Gets the number of voxel data objects. Valid voxel IDs are less than this.
+	int getVoxelDataCount() const;
+
 	// Adds a voxel data object and returns its assigned ID (index).
 	int addVoxelData(const VoxelData &voxelData);
+
+	// Sets the voxel ID at a coordinate, which must be inside the grid. The ID must
+	// already have voxel data.
+	void setVoxel(int x, int y, int z, VoxelID id);
 };
 
 #endif
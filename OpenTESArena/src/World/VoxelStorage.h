@@ -0,0 +1,129 @@
+#ifndef VOXEL_STORAGE_H
+#define VOXEL_STORAGE_H
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <vector>
+
+// Voxel storage is a 3D array of voxel IDs, laid out one column at a time, with Y
+// innermost. Ray casting draws a whole column of voxels at each XZ coordinate it
+// steps through, so all of a column's IDs are next to each other in memory.
+
+// Accessors are not bounds-checked except by assertions in debug builds. Callers that
+// may be outside the grid should check contains() first, or use getOrDefault().
+
+template <class T>
+class VoxelStorage
+{
+private:
+	static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value,
+		"VoxelStorage<T> must be unsigned integral type.");
+
+	std::vector<T> voxels;
+	int width, height, depth;
+
+	int getIndex(int x, int y, int z) const;
+public:
+	VoxelStorage(int width, int height, int depth);
+
+	int getWidth() const;
+	int getHeight() const;
+	int getDepth() const;
+
+	// Returns whether the coordinate is inside the grid.
+	bool contains(int x, int y, int z) const;
+
+	// Gets the voxel ID at a coordinate, which must be inside the grid.
+	T get(int x, int y, int z) const;
+
+	// Gets the voxel ID at a coordinate, or the default ID if it's outside the grid.
+	T getOrDefault(int x, int y, int z, T defaultID) const;
+
+	// Gets the voxel IDs of the column at an XZ coordinate, from Y = 0 upward. There
+	// are getHeight() of them.
+	T *getColumn(int x, int z);
+	const T *getColumn(int x, int z) const;
+
+	// Sets the voxel ID at a coordinate, which must be inside the grid.
+	void set(int x, int y, int z, T id);
+};
+
+template <class T>
+VoxelStorage<T>::VoxelStorage(int width, int height, int depth)
+{
+	assert(width > 0);
+	assert(height > 0);
+	assert(depth > 0);
+
+	this->voxels = std::vector<T>(width * height * depth);
+	std::fill(this->voxels.begin(), this->voxels.end(), 0);
+
+	this->width = width;
+	this->height = height;
+	this->depth = depth;
+}
+
+template <class T>
+int VoxelStorage<T>::getIndex(int x, int y, int z) const
+{
+	assert(this->contains(x, y, z));
+	return y + (x * this->height) + (z * this->width * this->height);
+}
+
+template <class T>
+int VoxelStorage<T>::getWidth() const
+{
+	return this->width;
+}
+
+template <class T>
+int VoxelStorage<T>::getHeight() const
+{
+	return this->height;
+}
+
+template <class T>
+int VoxelStorage<T>::getDepth() const
+{
+	return this->depth;
+}
+
+template <class T>
+bool VoxelStorage<T>::contains(int x, int y, int z) const
+{
+	return (x >= 0) && (x < this->width) && (y >= 0) && (y < this->height) &&
+		(z >= 0) && (z < this->depth);
+}
+
+template <class T>
+T VoxelStorage<T>::get(int x, int y, int z) const
+{
+	return this->voxels[this->getIndex(x, y, z)];
+}
+
+template <class T>
+T VoxelStorage<T>::getOrDefault(int x, int y, int z, T defaultID) const
+{
+	return this->contains(x, y, z) ? this->voxels[this->getIndex(x, y, z)] : defaultID;
+}
+
+template <class T>
+T *VoxelStorage<T>::getColumn(int x, int z)
+{
+	return this->voxels.data() + this->getIndex(x, 0, z);
+}
+
+template <class T>
+const T *VoxelStorage<T>::getColumn(int x, int z) const
+{
+	return this->voxels.data() + this->getIndex(x, 0, z);
+}
+
+template <class T>
+void VoxelStorage<T>::set(int x, int y, int z, T id)
+{
+	this->voxels[this->getIndex(x, y, z)] = id;
+}
+
+#endif
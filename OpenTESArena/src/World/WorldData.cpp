@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 #include "WorldData.h"
 
@@ -7,6 +9,7 @@
 #include "../Media/TextureManager.h"
 #include "../Rendering/Renderer.h"
 #include "../Utilities/Bytes.h"
+#include "../Utilities/Debug.h"
 
 WorldData::TextTrigger::TextTrigger(const std::string &text, bool displayedOnce)
 	: text(text)
@@ -40,7 +43,7 @@ void WorldData::TextTrigger::setPreviouslyDisplayed(bool previouslyDisplayed)
 	this->previouslyDisplayed = previouslyDisplayed;
 }
 
-WorldData::WorldData(const MIFFile &mif, const INFFile &inf)
+WorldData::WorldData(const MIFFile &mif, int levelIndex, const INFFile &inf)
 	: voxelGrid(mif.getWidth(), 5, mif.getDepth()) // To do: eventually get height from .MIF file.
 {
 	// Arena's level origins start at the top-right corner of the map, so X increases 
@@ -60,13 +63,10 @@ WorldData::WorldData(const MIFFile &mif, const INFFile &inf)
 	// Lambda for setting a voxel at some coordinate to some ID.
 	auto setVoxel = [this](int x, int y, int z, int id)
 	{
-		char *voxels = this->voxelGrid.getVoxels();
-		voxels[x + (y * this->voxelGrid.getWidth()) +
-			(z * this->voxelGrid.getWidth() * this->voxelGrid.getHeight())] = id;
+		this->voxelGrid.setVoxel(x, y, z, static_cast<VoxelGrid::VoxelID>(id));
 	};
 
-	// Load first level in .MIF file.
-	const MIFFile::Level &level = mif.getLevels().front();
+	const MIFFile::Level &level = mif.getLevels().at(levelIndex);
 	const uint8_t *florData = level.flor.data();
 	const uint8_t *map1Data = level.map1.data();
 
@@ -245,10 +245,17 @@ WorldData::WorldData(const MIFFile &mif, const INFFile &inf)
 			this->soundTriggers.insert(std::make_pair(voxel, inf.getSound(trigger.soundIndex)));
 		}
 	}
+
+	this->pristineVoxels = std::make_shared<const std::vector<VoxelGrid::VoxelID>>(
+		this->voxelGrid.getVoxelIDs());
 }
 
 WorldData::WorldData(VoxelGrid &&voxelGrid, EntityManager &&entityManager)
-	: voxelGrid(std::move(voxelGrid)), entityManager(std::move(entityManager)) { }
+	: voxelGrid(std::move(voxelGrid)), entityManager(std::move(entityManager))
+{
+	this->pristineVoxels = std::make_shared<const std::vector<VoxelGrid::VoxelID>>(
+		this->voxelGrid.getVoxelIDs());
+}
 
 WorldData::~WorldData()
 {
@@ -275,14 +282,52 @@ const EntityManager &WorldData::getEntityManager() const
 	return this->entityManager;
 }
 
+size_t WorldData::getByteCount() const
+{
+	size_t byteCount = sizeof(*this) + this->voxelGrid.getByteCount();
+
+	for (const auto &pair : this->textTriggers)
+	{
+		byteCount += sizeof(pair) + pair.second.getText().capacity();
+	}
+
+	for (const auto &pair : this->soundTriggers)
+	{
+		byteCount += sizeof(pair) + pair.second.capacity();
+	}
+
+	// Voxels the world was built with.
+	if (this->pristineVoxels.get() != nullptr)
+	{
+		byteCount += this->pristineVoxels->size() * sizeof(VoxelGrid::VoxelID);
+	}
+
+	return byteCount;
+}
+
+const std::shared_ptr<const std::vector<VoxelGrid::VoxelID>> &WorldData::getPristineVoxels() const
+{
+	return this->pristineVoxels;
+}
+
 WorldData::TextTrigger *WorldData::getTextTrigger(const Int2 &voxel)
 {
 	const auto textIter = this->textTriggers.find(voxel);
 	return (textIter != this->textTriggers.end()) ? (&textIter->second) : nullptr;
 }
 
+const std::unordered_map<Int2, WorldData::TextTrigger> &WorldData::getTextTriggers() const
+{
+	return this->textTriggers;
+}
+
 const std::string *WorldData::getSoundTrigger(const Int2 &voxel) const
 {
 	const auto soundIter = this->soundTriggers.find(voxel);
 	return (soundIter != this->soundTriggers.end()) ? (&soundIter->second) : nullptr;
 }
+
+const std::unordered_map<Int2, std::string> &WorldData::getSoundTriggers() const
+{
+	return this->soundTriggers;
+}
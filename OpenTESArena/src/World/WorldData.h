@@ -1,8 +1,11 @@
 #ifndef WORLD_DATA_H
 #define WORLD_DATA_H
 
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "VoxelGrid.h"
 #include "../Entities/EntityManager.h"
@@ -11,6 +14,9 @@
 // This class stores data regarding elements in the game world. It should be constructible
 // from a pair of .MIF and .INF files.
 
+// The voxel IDs a world was built with are kept alongside it (shared, since they
+// never change), so a saved game only needs the voxels that changed since then.
+
 class INFFile;
 class MIFFile;
 
@@ -37,8 +43,12 @@ private:
 	std::unordered_map<Int2, std::string> soundTriggers;
 	VoxelGrid voxelGrid;
 	EntityManager entityManager;
+
+	// Voxel IDs from when the world was built.
+	std::shared_ptr<const std::vector<VoxelGrid::VoxelID>> pristineVoxels;
 public:
-	WorldData(const MIFFile &mif, const INFFile &inf);
+	// Makes the world of one level in a .MIF file. The .INF file should be the level's.
+	WorldData(const MIFFile &mif, int levelIndex, const INFFile &inf);
 	WorldData(VoxelGrid &&voxelGrid, EntityManager &&entityManager);
 	WorldData(WorldData &&worldData) = default;
 	~WorldData();
@@ -51,14 +61,27 @@ public:
 	EntityManager &getEntityManager();
 	const EntityManager &getEntityManager() const;
 
+	// Gets the approximate number of bytes used by the world's voxels and triggers.
+	size_t getByteCount() const;
+
+	// Gets the voxel IDs the world was built with, in the order of the voxel grid's
+	// getVoxelIDs().
+	const std::shared_ptr<const std::vector<VoxelGrid::VoxelID>> &getPristineVoxels() const;
+
 	// Returns a pointer to some trigger text if the given voxel has a text trigger, or
 	// null if it doesn't. Also returns a pointer to one-shot text triggers that have 
 	// been activated previously (use another function to check activation).
 	TextTrigger *getTextTrigger(const Int2 &voxel);
 
+	// Gets all text triggers, i.e., for saving which ones have been displayed.
+	const std::unordered_map<Int2, TextTrigger> &getTextTriggers() const;
+
 	// Returns a pointer to a sound filename if the given voxel has a sound trigger, or
 	// null if it doesn't.
 	const std::string *getSoundTrigger(const Int2 &voxel) const;
+
+	// Gets all sound triggers, i.e., for loading their sounds ahead of time.
+	const std::unordered_map<Int2, std::string> &getSoundTriggers() const;
 };
 
 #endif
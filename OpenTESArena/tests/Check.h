@@ -0,0 +1,62 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Helpers shared by the test and benchmark programs. A failed check prints its message
+// and is counted, and the program returns Check::getExitCode() so CTest sees failures.
+
+class Check
+{
+private:
+	Check() = delete;
+	~Check() = delete;
+
+	static int &getFailureCount()
+	{
+		static int failureCount = 0;
+		return failureCount;
+	}
+public:
+	// Records a failure with a message if the condition is false.
+	static void that(bool condition, const std::string &message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << "\n";
+			getFailureCount()++;
+		}
+	}
+
+	// Zero if every check passed, otherwise one.
+	static int getExitCode()
+	{
+		const int failureCount = getFailureCount();
+		if (failureCount > 0)
+		{
+			std::cerr << failureCount << " check(s) failed.\n";
+		}
+
+		return (failureCount > 0) ? 1 : 0;
+	}
+
+	// Runs a function the given number of times and returns the average milliseconds
+	// per run.
+	template <typename T>
+	static double timeMs(int runs, T &&function)
+	{
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < runs; i++)
+		{
+			function();
+		}
+
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(endTime - startTime).count() /
+			static_cast<double>(runs);
+	}
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Check.h"
+
+#include "OpenTESArena/src/Entities/Animation.h"
+#include "OpenTESArena/src/Entities/Doodad.h"
+#include "OpenTESArena/src/Entities/Entity.h"
+#include "OpenTESArena/src/Entities/EntityManager.h"
+#include "OpenTESArena/src/Math/Random.h"
+#include "OpenTESArena/src/Math/Vector2.h"
+#include "OpenTESArena/src/Math/Vector3.h"
+#include "OpenTESArena/src/Utilities/String.h"
+
+// Spawns and despawns 100k entities in a random order and checks that IDs stay unique,
+// that IDs of despawned entities are stale (even once their slots are in use again),
+// and that every live entity's state is still found by their ID after the others have
+// been moved around in the arrays. Also times spawning and despawning.
+
+namespace
+{
+	const int EntityCount = 100000;
+	const int Rounds = 4;
+
+	// Spreads entities over a square of voxel columns, with a few per column.
+	Double3 makePosition(int index)
+	{
+		const int side = 200;
+		return Double3(static_cast<double>(index % side) + 0.50, 0.0,
+			static_cast<double>((index / side) % side) + 0.50);
+	}
+
+	// Spawns a doodad and returns their ID. Their texture ID is the index they were
+	// spawned with, so it can be checked later.
+	int spawn(int index, EntityManager &entityManager)
+	{
+		std::unique_ptr<Entity> doodad(new Doodad(entityManager));
+		const int id = doodad->getID();
+		const Animation animation(std::vector<int>(1, index), 1.0, true);
+		entityManager.add(std::move(doodad), makePosition(index), Double2(1.0, 1.0),
+			animation);
+		return id;
+	}
+
+	void shuffle(std::vector<std::pair<int, int>> &entities, Random &random)
+	{
+		for (int i = static_cast<int>(entities.size()) - 1; i > 0; i--)
+		{
+			std::swap(entities.at(i), entities.at(random.next(i + 1)));
+		}
+	}
+
+	// Checks that each live entity (ID and spawn index) is found with the right state.
+	bool liveEntitiesMatch(const std::vector<std::pair<int, int>> &entities,
+		const EntityManager &entityManager)
+	{
+		for (const auto &pair : entities)
+		{
+			const int id = pair.first;
+			const int index = pair.second;
+			const Entity *entity = entityManager.at(id);
+			if ((entity == nullptr) || (entity->getID() != id) ||
+				(entityManager.getTextureID(id) != index))
+			{
+				return false;
+			}
+
+			const Double3 &position = entityManager.getPosition(id);
+			const Double3 expected = makePosition(index);
+			if ((position.x != expected.x) || (position.z != expected.z))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool allStale(const std::vector<int> &ids, const EntityManager &entityManager)
+	{
+		return std::all_of(ids.begin(), ids.end(), [&entityManager](int id)
+		{
+			return !entityManager.isValid(id) && (entityManager.at(id) == nullptr);
+		});
+	}
+}
+
+int main()
+{
+	EntityManager entityManager;
+	Random random(12345);
+
+	// Live entities as ID and spawn index pairs, and every ID handed out so far.
+	std::vector<std::pair<int, int>> live;
+	std::unordered_set<int> usedIDs;
+	int nextIndex = 0;
+
+	double spawnMs = 0.0;
+	double despawnMs = 0.0;
+
+	for (int round = 0; round < Rounds; round++)
+	{
+		const std::string roundString = "Round " + std::to_string(round) + ": ";
+
+		// Fill up to the full count. After the first round, this reuses the slots that
+		// were freed.
+		const int spawnCount = EntityCount - static_cast<int>(live.size());
+		std::vector<std::pair<int, int>> spawned;
+		spawned.reserve(spawnCount);
+		spawnMs += Check::timeMs(1, [&]()
+		{
+			for (int i = 0; i < spawnCount; i++)
+			{
+				spawned.push_back(std::make_pair(spawn(nextIndex, entityManager), nextIndex));
+				nextIndex++;
+			}
+		});
+
+		bool idsUnique = true;
+		for (const auto &pair : spawned)
+		{
+			idsUnique &= usedIDs.insert(pair.first).second;
+		}
+
+		Check::that(idsUnique, roundString + "an ID was given out twice.");
+
+		live.insert(live.end(), spawned.begin(), spawned.end());
+		Check::that(entityManager.getCount() == EntityCount, roundString + "wrong count.");
+		Check::that(liveEntitiesMatch(live, entityManager),
+			roundString + "entity state is wrong after spawning.");
+
+		// Despawn a random half, or everyone in the last round.
+		shuffle(live, random);
+		const int despawnCount = (round == (Rounds - 1)) ? EntityCount : (EntityCount / 2);
+		std::vector<int> staleIDs;
+		staleIDs.reserve(despawnCount);
+		despawnMs += Check::timeMs(1, [&]()
+		{
+			for (int i = 0; i < despawnCount; i++)
+			{
+				const int id = live.back().first;
+				entityManager.remove(id);
+				staleIDs.push_back(id);
+				live.pop_back();
+			}
+		});
+
+		Check::that(entityManager.getCount() == static_cast<int>(live.size()),
+			roundString + "wrong count after despawning.");
+		Check::that(allStale(staleIDs, entityManager),
+			roundString + "a despawned entity's ID is still valid.");
+		Check::that(liveEntitiesMatch(live, entityManager),
+			roundString + "entity state is wrong after despawning.");
+
+		// Removing a stale ID again does nothing.
+		entityManager.remove(staleIDs.front());
+		Check::that(entityManager.getCount() == static_cast<int>(live.size()),
+			roundString + "removing a stale ID changed the count.");
+	}
+
+	// Every entity is gone, and the arrays are empty.
+	Check::that(entityManager.getCount() == 0, "Entities left at the end.");
+	for (const auto &group : entityManager.getGroups())
+	{
+		Check::that(group.getCount() == 0, "Entity group not empty at the end.");
+		Check::that(group.positions.size() == 0, "Entity positions left at the end.");
+	}
+
+	// Slots are reused, so slot indices (the low bits of IDs) stay under the most
+	// entities alive at once.
+	int maxSlotIndex = 0;
+	for (const int id : usedIDs)
+	{
+		maxSlotIndex = std::max(maxSlotIndex, id & (EntityManager::MAX_ENTITIES - 1));
+	}
+
+	Check::that(maxSlotIndex < EntityCount, "Slots weren't reused.");
+
+	std::cout << nextIndex << " entities spawned in " <<
+		String::fixedPrecision(spawnMs, 2) << "ms and despawned in " <<
+		String::fixedPrecision(despawnMs, 2) << "ms over " << Rounds << " rounds\n";
+
+	return Check::getExitCode();
+}
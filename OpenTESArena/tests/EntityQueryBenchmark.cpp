@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Check.h"
+
+#include "OpenTESArena/src/Entities/Animation.h"
+#include "OpenTESArena/src/Entities/Doodad.h"
+#include "OpenTESArena/src/Entities/EntityManager.h"
+#include "OpenTESArena/src/Entities/EntityType.h"
+#include "OpenTESArena/src/Math/Constants.h"
+#include "OpenTESArena/src/Math/Random.h"
+#include "OpenTESArena/src/Math/Vector2.h"
+#include "OpenTESArena/src/Math/Vector3.h"
+#include "OpenTESArena/src/Utilities/String.h"
+#include "OpenTESArena/src/World/VoxelData.h"
+#include "OpenTESArena/src/World/VoxelGrid.h"
+
+// Times the entity manager's spatial queries (radius, nearest-N, and picking along a
+// ray) for 1k and 10k entities scattered over an open area, against checking every
+// entity. Both have to give the same results. Picking is also checked against a wall
+// between the ray and an entity.
+
+namespace
+{
+	const int AreaSize = 256;
+	const int GridHeight = 3;
+	const int QueryCount = 2000;
+
+	const double Radius = 4.0;
+	const int NearestCount = 8;
+	const double NearestDistance = 16.0;
+	const double PickDistance = 32.0;
+	const double EyeHeight = 0.60;
+
+	struct Query
+	{
+		Double3 point, direction;
+	};
+
+	int spawn(const Double3 &position, EntityManager &entityManager)
+	{
+		std::unique_ptr<Entity> doodad(new Doodad(entityManager));
+		const int id = doodad->getID();
+		const Animation animation(std::vector<int>(1, 0), 1.0, true);
+		entityManager.add(std::move(doodad), position, Double2(1.0, 1.0), animation);
+		return id;
+	}
+
+	// Query points and directions like the player's: at eye height and looking
+	// mostly level.
+	std::vector<Query> makeQueries(Random &random)
+	{
+		std::vector<Query> queries;
+		for (int i = 0; i < QueryCount; i++)
+		{
+			const double angle = random.nextReal() * 2.0 * PI;
+			const double pitch = (random.nextReal() - 0.50) * 0.20;
+
+			Query query;
+			query.point = Double3(random.nextReal() * AreaSize, EyeHeight,
+				random.nextReal() * AreaSize);
+			query.direction = Double3(std::cos(angle), pitch, std::sin(angle)).normalized();
+			queries.push_back(query);
+		}
+
+		return queries;
+	}
+
+	// Brute force versions of the queries, with the same results as the entity manager
+	// (including how ties are broken).
+	void bruteRadius(const EntityManager &entityManager, const Double3 &point,
+		std::vector<int> &ids)
+	{
+		const double radiusSqr = Radius * Radius;
+		const auto &group = entityManager.getGroup(EntityType::Doodad);
+		for (int i = 0; i < group.getCount(); i++)
+		{
+			if ((group.positions[i] - point).lengthSquared() <= radiusSqr)
+			{
+				ids.push_back(group.ids[i]);
+			}
+		}
+	}
+
+	void bruteNearest(const EntityManager &entityManager, const Double3 &point,
+		std::vector<int> &ids)
+	{
+		std::vector<std::pair<double, int>> candidates;
+		const double maxDistanceSqr = NearestDistance * NearestDistance;
+		const auto &group = entityManager.getGroup(EntityType::Doodad);
+		for (int i = 0; i < group.getCount(); i++)
+		{
+			const double distanceSqr = (group.positions[i] - point).lengthSquared();
+			if (distanceSqr <= maxDistanceSqr)
+			{
+				candidates.push_back(std::make_pair(distanceSqr, group.ids[i]));
+			}
+		}
+
+		const int resultCount = std::min(NearestCount, static_cast<int>(candidates.size()));
+		std::partial_sort(candidates.begin(), candidates.begin() + resultCount,
+			candidates.end());
+		for (int i = 0; i < resultCount; i++)
+		{
+			ids.push_back(candidates.at(i).second);
+		}
+	}
+
+	int brutePick(const EntityManager &entityManager, const Double3 &origin,
+		const Double3 &direction)
+	{
+		int hitID = -1;
+		double hitDistance = PickDistance;
+		const double a = (direction.x * direction.x) + (direction.z * direction.z);
+		const auto &group = entityManager.getGroup(EntityType::Doodad);
+		for (int i = 0; i < group.getCount(); i++)
+		{
+			const int id = group.ids[i];
+			const Double3 &position = group.positions[i];
+			const Double2 &size = group.sizes[i];
+			const double radius = size.x * 0.50;
+
+			const double dx = origin.x - position.x;
+			const double dz = origin.z - position.z;
+			const double b = 2.0 * ((dx * direction.x) + (dz * direction.z));
+			const double c = ((dx * dx) + (dz * dz)) - (radius * radius);
+			const double discriminant = (b * b) - (4.0 * a * c);
+			if ((a == 0.0) || (discriminant < 0.0))
+			{
+				continue;
+			}
+
+			const double root = std::sqrt(discriminant);
+			const double tNear = (-b - root) / (2.0 * a);
+			const double tFar = (-b + root) / (2.0 * a);
+			if (tFar < 0.0)
+			{
+				continue;
+			}
+
+			const double t = std::max(tNear, 0.0);
+			const double y = origin.y + (direction.y * t);
+			const bool nearer = (t < hitDistance) ||
+				((t == hitDistance) && (hitID != -1) && (id < hitID));
+			if (nearer && (y >= position.y) && (y <= (position.y + size.y)))
+			{
+				hitID = id;
+				hitDistance = t;
+			}
+		}
+
+		return hitID;
+	}
+
+	std::vector<int> sorted(std::vector<int> ids)
+	{
+		std::sort(ids.begin(), ids.end());
+		return ids;
+	}
+
+	void runBenchmark(int entityCount, const VoxelGrid &voxelGrid)
+	{
+		Random random(entityCount);
+		EntityManager entityManager;
+		for (int i = 0; i < entityCount; i++)
+		{
+			spawn(Double3(random.nextReal() * AreaSize, 0.0, random.nextReal() * AreaSize),
+				entityManager);
+		}
+
+		const std::vector<Query> queries = makeQueries(random);
+		const std::string countString = std::to_string(entityCount) + " entities: ";
+
+		// Each query's results, so the grid and brute force can be compared afterwards.
+		std::vector<std::vector<int>> gridResults(queries.size()), bruteResults(queries.size());
+		std::vector<int> gridPicks(queries.size()), brutePicks(queries.size());
+		auto clearResults = [&gridResults, &bruteResults]()
+		{
+			for (size_t i = 0; i < gridResults.size(); i++)
+			{
+				gridResults[i].clear();
+				bruteResults[i].clear();
+			}
+		};
+
+		const double radiusGridMs = Check::timeMs(1, [&]()
+		{
+			for (size_t i = 0; i < queries.size(); i++)
+			{
+				entityManager.getEntitiesInRadius(queries[i].point, Radius, gridResults[i]);
+			}
+		});
+
+		const double radiusBruteMs = Check::timeMs(1, [&]()
+		{
+			for (size_t i = 0; i < queries.size(); i++)
+			{
+				bruteRadius(entityManager, queries[i].point, bruteResults[i]);
+			}
+		});
+
+		bool radiusMatches = true;
+		for (size_t i = 0; i < queries.size(); i++)
+		{
+			radiusMatches &= sorted(gridResults[i]) == sorted(bruteResults[i]);
+		}
+
+		Check::that(radiusMatches, countString + "radius results differ.");
+		clearResults();
+
+		const double nearestGridMs = Check::timeMs(1, [&]()
+		{
+			for (size_t i = 0; i < queries.size(); i++)
+			{
+				entityManager.getNearestEntities(queries[i].point, NearestCount,
+					NearestDistance, gridResults[i]);
+			}
+		});
+
+		const double nearestBruteMs = Check::timeMs(1, [&]()
+		{
+			for (size_t i = 0; i < queries.size(); i++)
+			{
+				bruteNearest(entityManager, queries[i].point, bruteResults[i]);
+			}
+		});
+
+		Check::that(gridResults == bruteResults, countString + "nearest results differ.");
+
+		const double pickGridMs = Check::timeMs(1, [&]()
+		{
+			for (size_t i = 0; i < queries.size(); i++)
+			{
+				gridPicks[i] = entityManager.pickEntity(queries[i].point,
+					queries[i].direction, PickDistance, voxelGrid);
+			}
+		});
+
+		const double pickBruteMs = Check::timeMs(1, [&]()
+		{
+			for (size_t i = 0; i < queries.size(); i++)
+			{
+				brutePicks[i] = brutePick(entityManager, queries[i].point,
+					queries[i].direction);
+			}
+		});
+
+		Check::that(gridPicks == brutePicks, countString + "pick results differ.");
+
+		const int hitCount = static_cast<int>(std::count_if(gridPicks.begin(),
+			gridPicks.end(), [](int id) { return id != -1; }));
+
+		auto printTimes = [&countString](const std::string &name, double gridMs,
+			double bruteMs)
+		{
+			const double queryCount = static_cast<double>(QueryCount);
+			std::cout << countString << name << " " <<
+				String::fixedPrecision((gridMs * 1000.0) / queryCount, 2) << "us, brute force " <<
+				String::fixedPrecision((bruteMs * 1000.0) / queryCount, 2) << "us (" <<
+				String::fixedPrecision(bruteMs / gridMs, 2) << "x) per query\n";
+		};
+
+		printTimes("radius", radiusGridMs, radiusBruteMs);
+		printTimes("nearest-" + std::to_string(NearestCount), nearestGridMs, nearestBruteMs);
+		printTimes("pick (" + std::to_string(hitCount) + " hits)", pickGridMs, pickBruteMs);
+	}
+
+	// An entity behind a wall can't be picked, and one in front of it can.
+	void checkPickStopsAtWalls()
+	{
+		VoxelGrid voxelGrid(8, GridHeight, 8);
+		voxelGrid.addVoxelData(VoxelData(0));
+		const int wallID = voxelGrid.addVoxelData(VoxelData(1));
+		voxelGrid.setVoxel(4, 0, 2, wallID);
+
+		EntityManager entityManager;
+		const int nearID = spawn(Double3(2.50, 0.0, 2.50), entityManager);
+		const int farID = spawn(Double3(6.50, 0.0, 2.50), entityManager);
+
+		const Double3 origin(0.50, EyeHeight, 2.50);
+		const Double3 east(1.0, 0.0, 0.0);
+		Check::that(entityManager.pickEntity(origin, east, PickDistance, voxelGrid) == nearID,
+			"Didn't pick the entity in front of the wall.");
+
+		entityManager.remove(nearID);
+		Check::that(entityManager.pickEntity(origin, east, PickDistance, voxelGrid) == -1,
+			"Picked the entity behind the wall.");
+
+		const Double3 beyondWall(5.50, EyeHeight, 2.50);
+		Check::that(entityManager.pickEntity(beyondWall, east, PickDistance, voxelGrid) ==
+			farID, "Didn't pick the entity past the wall.");
+	}
+}
+
+int main()
+{
+	// The area is open, so picking is only limited by distance.
+	VoxelGrid voxelGrid(AreaSize, GridHeight, AreaSize);
+	voxelGrid.addVoxelData(VoxelData(0));
+
+	runBenchmark(1000, voxelGrid);
+	runBenchmark(10000, voxelGrid);
+	checkPickStopsAtWalls();
+
+	return Check::getExitCode();
+}
@@ -0,0 +1,227 @@
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Check.h"
+
+#include "OpenTESArena/src/Entities/Animation.h"
+#include "OpenTESArena/src/Entities/Doodad.h"
+#include "OpenTESArena/src/Entities/EntityManager.h"
+#include "OpenTESArena/src/Entities/EntityType.h"
+#include "OpenTESArena/src/Entities/NonPlayer.h"
+#include "OpenTESArena/src/Math/Vector2.h"
+#include "OpenTESArena/src/Math/Vector3.h"
+#include "OpenTESArena/src/Utilities/JobSystem.h"
+#include "OpenTESArena/src/Utilities/String.h"
+
+// Times one frame of entity updates (animating every entity, then reading what the
+// renderer needs) for 1k and 10k entities. The entity manager's per-type arrays are
+// compared against the layout they replaced: entities in a hash map by ID, gathered
+// into a new list each frame, and each ticked through a virtual call. Both have to
+// end up with the same texture IDs.
+
+namespace
+{
+	const double FrameTime = 1.0 / 60.0;
+
+	// The layout entities had before the entity manager kept their state in arrays.
+	class LegacyEntity
+	{
+	private:
+		int id;
+		Double3 position;
+		Animation animation;
+	public:
+		LegacyEntity(int id, const Double3 &position, const Animation &animation)
+			: id(id), position(position), animation(animation) { }
+		virtual ~LegacyEntity() { }
+
+		int getID() const { return this->id; }
+		const Double3 &getPosition() const { return this->position; }
+		int getTextureID() const { return this->animation.getCurrentID(); }
+
+		virtual void tick(double dt) { this->animation.tick(dt); }
+	};
+
+	class LegacyManager
+	{
+	private:
+		std::unordered_map<int, std::unique_ptr<LegacyEntity>> entities;
+	public:
+		void add(std::unique_ptr<LegacyEntity> entity)
+		{
+			const int id = entity->getID();
+			this->entities.insert(std::make_pair(id, std::move(entity)));
+		}
+
+		LegacyEntity *at(int id) const
+		{
+			const auto iter = this->entities.find(id);
+			return (iter != this->entities.end()) ? iter->second.get() : nullptr;
+		}
+
+		std::vector<LegacyEntity*> getAllEntities() const
+		{
+			std::vector<LegacyEntity*> entityPtrs;
+			for (const auto &pair : this->entities)
+			{
+				entityPtrs.push_back(pair.second.get());
+			}
+
+			return entityPtrs;
+		}
+	};
+
+	// Gives every entity a different animation length and speed, so they don't all
+	// change frames together.
+	Animation makeAnimation(int index)
+	{
+		const int frameCount = 2 + (index % 7);
+		std::vector<int> ids;
+		for (int i = 0; i < frameCount; i++)
+		{
+			ids.push_back((index * 16) + i);
+		}
+
+		const double timePerFrame = 0.05 + (static_cast<double>(index % 11) * 0.02);
+		return Animation(ids, timePerFrame, (index % 5) != 0);
+	}
+
+	Double3 makePosition(int index)
+	{
+		return Double3(static_cast<double>(index % 100) + 0.50, 1.0,
+			static_cast<double>(index / 100) + 0.50);
+	}
+
+	// Adds the given number of doodads and non-players to the entity manager, and to the
+	// legacy manager if there is one.
+	void addEntities(int count, EntityManager &entityManager, LegacyManager *legacyManager)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			const Double3 position = makePosition(i);
+			const Animation animation = makeAnimation(i);
+
+			std::unique_ptr<Entity> entity;
+			if ((i % 3) == 0)
+			{
+				const std::vector<Animation> animations(1, animation);
+				entity = std::unique_ptr<Entity>(new NonPlayer(Double2(1.0, 0.0),
+					animations, animations, animation, animation, entityManager));
+			}
+			else
+			{
+				entity = std::unique_ptr<Entity>(new Doodad(entityManager));
+			}
+
+			const int id = entity->getID();
+			entityManager.add(std::move(entity), position, Double2(1.0, 1.0), animation);
+			if (legacyManager != nullptr)
+			{
+				legacyManager->add(std::unique_ptr<LegacyEntity>(
+					new LegacyEntity(id, position, animation)));
+			}
+		}
+	}
+
+	// Sums what the renderer reads for each entity, so the reads aren't optimized out.
+	int64_t tickArrays(EntityManager &entityManager, JobSystem &jobSystem)
+	{
+		entityManager.tick(FrameTime, jobSystem);
+
+		int64_t checksum = 0;
+		for (const auto &group : entityManager.getGroups())
+		{
+			for (int i = 0; i < group.getCount(); i++)
+			{
+				checksum += group.textureIDs[i] + static_cast<int64_t>(group.positions[i].x);
+			}
+		}
+
+		return checksum;
+	}
+
+	int64_t tickLegacy(LegacyManager &legacyManager)
+	{
+		int64_t checksum = 0;
+		for (LegacyEntity *entity : legacyManager.getAllEntities())
+		{
+			entity->tick(FrameTime);
+			checksum += entity->getTextureID() + static_cast<int64_t>(entity->getPosition().x);
+		}
+
+		return checksum;
+	}
+
+	void runBenchmark(int entityCount, int frames, JobSystem &serialJobs,
+		JobSystem &parallelJobs)
+	{
+		EntityManager serialManager, parallelManager;
+		LegacyManager legacyManager;
+		addEntities(entityCount, serialManager, &legacyManager);
+		addEntities(entityCount, parallelManager, nullptr);
+
+		int64_t legacySum = 0;
+		int64_t serialSum = 0;
+		int64_t parallelSum = 0;
+
+		const double legacyMs = Check::timeMs(frames, [&]()
+		{
+			legacySum += tickLegacy(legacyManager);
+		});
+
+		const double serialMs = Check::timeMs(frames, [&]()
+		{
+			serialSum += tickArrays(serialManager, serialJobs);
+		});
+
+		const double parallelMs = Check::timeMs(frames, [&]()
+		{
+			parallelSum += tickArrays(parallelManager, parallelJobs);
+		});
+
+		const std::string countString = std::to_string(entityCount);
+		Check::that(serialSum == legacySum, countString + " entities: serial tick differs.");
+		Check::that(parallelSum == legacySum,
+			countString + " entities: parallel tick differs.");
+
+		for (const auto &group : serialManager.getGroups())
+		{
+			for (int i = 0; i < group.getCount(); i++)
+			{
+				const int id = group.ids[i];
+				const LegacyEntity *legacyEntity = legacyManager.at(id);
+				if ((legacyEntity == nullptr) ||
+					(legacyEntity->getTextureID() != group.textureIDs[i]) ||
+					(parallelManager.getTextureID(id) != group.textureIDs[i]))
+				{
+					Check::that(false, countString + " entities: entity " +
+						std::to_string(id) + " has the wrong texture.");
+					return;
+				}
+			}
+		}
+
+		std::cout << countString << " entities: legacy " <<
+			String::fixedPrecision(legacyMs * 1000.0, 1) << "us, arrays " <<
+			String::fixedPrecision(serialMs * 1000.0, 1) << "us (" <<
+			String::fixedPrecision(legacyMs / serialMs, 2) << "x), with the job system (" <<
+			parallelJobs.getThreadCount() << " thread(s)) " <<
+			String::fixedPrecision(parallelMs * 1000.0, 1) << "us (" <<
+			String::fixedPrecision(legacyMs / parallelMs, 2) << "x) per frame\n";
+	}
+}
+
+int main()
+{
+	JobSystem serialJobs(1);
+	JobSystem parallelJobs(0);
+
+	runBenchmark(1000, 600, serialJobs, parallelJobs);
+	runBenchmark(10000, 120, serialJobs, parallelJobs);
+
+	return Check::getExitCode();
+}
@@ -0,0 +1,608 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+
+#include "OpenTESArena/src/Assets/ExeUnpacker.h"
+#include "OpenTESArena/src/Utilities/Bytes.h"
+#include "OpenTESArena/src/Utilities/String.h"
+
+#include "components/vfs/manager.hpp"
+
+// Compares the table-driven PKLITE decoder in ExeUnpacker with the bit tree decoder it
+// replaced, and times loading the unpacked image from its cache file. A.EXE can't be
+// shipped, so the input is a synthetic executable made by a small PKLITE encoder.
+
+namespace
+{
+	// Bit tables from pklite_specification.md (same as in ExeUnpacker.cpp).
+	const std::vector<std::vector<bool>> Duplication1 =
+	{
+		{ true, false }, // 2
+		{ true, true }, // 3
+		{ false, false, false }, // 4
+		{ false, false, true, false }, // 5
+		{ false, false, true, true }, // 6
+		{ false, true, false, false }, // 7
+		{ false, true, false, true, false }, // 8
+		{ false, true, false, true, true }, // 9
+		{ false, true, true, false, false }, // 10
+		{ false, true, true, false, true, false }, // 11
+		{ false, true, true, false, true, true }, // 12
+		{ false, true, true, true, false, false }, // Special case
+		{ false, true, true, true, false, true, false }, // 13
+		{ false, true, true, true, false, true, true }, // 14
+		{ false, true, true, true, true, false, false }, // 15
+		{ false, true, true, true, true, false, true, false }, // 16
+		{ false, true, true, true, true, false, true, true }, // 17
+		{ false, true, true, true, true, true, false, false }, // 18
+		{ false, true, true, true, true, true, false, true, false }, // 19
+		{ false, true, true, true, true, true, false, true, true }, // 20
+		{ false, true, true, true, true, true, true, false, false }, // 21
+		{ false, true, true, true, true, true, true, false, true }, // 22
+		{ false, true, true, true, true, true, true, true, false }, // 23
+		{ false, true, true, true, true, true, true, true, true } // 24
+	};
+
+	const std::vector<std::vector<bool>> Duplication2 =
+	{
+		{ true }, // 0
+		{ false, false, false, false }, // 1
+		{ false, false, false, true }, // 2
+		{ false, false, true, false, false }, // 3
+		{ false, false, true, false, true }, // 4
+		{ false, false, true, true, false }, // 5
+		{ false, false, true, true, true }, // 6
+		{ false, true, false, false, false, false }, // 7
+		{ false, true, false, false, false, true }, // 8
+		{ false, true, false, false, true, false }, // 9
+		{ false, true, false, false, true, true }, // 10
+		{ false, true, false, true, false, false }, // 11
+		{ false, true, false, true, false, true }, // 12
+		{ false, true, false, true, true, false }, // 13
+		{ false, true, false, true, true, true, false }, // 14
+		{ false, true, false, true, true, true, true }, // 15
+		{ false, true, true, false, false, false, false }, // 16
+		{ false, true, true, false, false, false, true }, // 17
+		{ false, true, true, false, false, true, false }, // 18
+		{ false, true, true, false, false, true, true }, // 19
+		{ false, true, true, false, true, false, false }, // 20
+		{ false, true, true, false, true, false, true }, // 21
+		{ false, true, true, false, true, true, false }, // 22
+		{ false, true, true, false, true, true, true }, // 23
+		{ false, true, true, true, false, false, false }, // 24
+		{ false, true, true, true, false, false, true }, // 25
+		{ false, true, true, true, false, true, false }, // 26
+		{ false, true, true, true, false, true, true }, // 27
+		{ false, true, true, true, true, false, false }, // 28
+		{ false, true, true, true, true, false, true }, // 29
+		{ false, true, true, true, true, true, false }, // 30
+		{ false, true, true, true, true, true, true } // 31
+	};
+
+	const int SpecialCaseIndex = 11;
+
+	// Where the compressed data starts in the executable.
+	const int CompressedStart = 752;
+
+	// Size of the unpacked synthetic executable. A.EXE unpacks to a bit more than this.
+	const int UnpackedSize = 256 * 1024;
+
+	const int DecodeRuns = 20;
+	const int CacheRuns = 20;
+
+	// Deterministic generator for the synthetic data.
+	class Lcg
+	{
+	private:
+		uint32_t state;
+	public:
+		Lcg(uint32_t seed)
+		{
+			this->state = seed;
+		}
+
+		int next(int max)
+		{
+			this->state = (this->state * 1664525u) + 1013904223u;
+			return static_cast<int>((this->state >> 8) % static_cast<uint32_t>(max));
+		}
+	};
+
+	// Makes data that compresses about like code and tables do: short unique runs,
+	// repeats of earlier bytes, and runs of zeroes.
+	std::vector<uint8_t> makeUnpackedData()
+	{
+		Lcg lcg(12345);
+		std::vector<uint8_t> data;
+		data.reserve(UnpackedSize);
+
+		while (static_cast<int>(data.size()) < UnpackedSize)
+		{
+			const int kind = lcg.next(10);
+			if ((kind < 4) || (data.size() < 64))
+			{
+				const int count = 1 + lcg.next(16);
+				for (int i = 0; i < count; i++)
+				{
+					data.push_back(static_cast<uint8_t>(lcg.next(256)));
+				}
+			}
+			else if (kind < 8)
+			{
+				const int offset = 1 + lcg.next(std::min(static_cast<int>(data.size()), 8000));
+				const int count = 3 + lcg.next(40);
+				for (int i = 0; i < count; i++)
+				{
+					data.push_back(data[data.size() - offset]);
+				}
+			}
+			else
+			{
+				data.insert(data.end(), 1 + lcg.next(64), 0);
+			}
+		}
+
+		data.resize(UnpackedSize);
+		return data;
+	}
+
+	// Writes the PKLITE bit stream, with bit arrays interleaved with plain bytes the
+	// way the decoder reads them.
+	class PkliteWriter
+	{
+	private:
+		std::vector<uint8_t> &out;
+		size_t wordIndex;
+		int bitCount;
+
+		void startWord()
+		{
+			this->wordIndex = this->out.size();
+			this->out.push_back(0);
+			this->out.push_back(0);
+			this->bitCount = 0;
+		}
+	public:
+		PkliteWriter(std::vector<uint8_t> &out)
+			: out(out)
+		{
+			this->startWord();
+		}
+
+		int getBitCount() const
+		{
+			return this->bitCount;
+		}
+
+		void writeBit(bool bit)
+		{
+			if (bit)
+			{
+				this->out[this->wordIndex + (this->bitCount / 8)] |= 1 << (this->bitCount % 8);
+			}
+
+			this->bitCount++;
+			if (this->bitCount == 16)
+			{
+				this->startWord();
+			}
+		}
+
+		void writeBits(const std::vector<bool> &bits)
+		{
+			for (const bool bit : bits)
+			{
+				this->writeBit(bit);
+			}
+		}
+
+		void writeByte(uint8_t byte)
+		{
+			this->out.push_back(byte);
+		}
+	};
+
+	// Compresses data into a PKLITE executable that ExeUnpacker accepts. Matches are
+	// found with hash chains over three byte prefixes.
+	std::vector<uint8_t> makeExecutable(const std::vector<uint8_t> &data)
+	{
+		const int windowSize = 8191;
+		const int maxMatch = 25 + 253;
+		const int maxChain = 32;
+
+		std::vector<uint8_t> exe(CompressedStart, 0);
+		PkliteWriter writer(exe);
+
+		std::vector<int> heads(1 << 16, -1);
+		std::vector<int> chain(data.size(), -1);
+		auto hashAt = [&data](size_t i)
+		{
+			return ((data[i] << 8) ^ (data[i + 1] << 4) ^ data[i + 2]) & 0xFFFF;
+		};
+
+		auto insert = [&](size_t i)
+		{
+			if ((i + 2) < data.size())
+			{
+				const int hash = hashAt(i);
+				chain[i] = heads[hash];
+				heads[hash] = static_cast<int>(i);
+			}
+		};
+
+		size_t i = 0;
+		while (i < data.size())
+		{
+			int bestLength = 0;
+			int bestOffset = 0;
+			if ((i + 2) < data.size())
+			{
+				int candidate = heads[hashAt(i)];
+				for (int step = 0; (step < maxChain) && (candidate >= 0); step++)
+				{
+					const int offset = static_cast<int>(i) - candidate;
+					if (offset > windowSize)
+					{
+						break;
+					}
+
+					const int limit = std::min(maxMatch, static_cast<int>(data.size() - i));
+					int length = 0;
+					while ((length < limit) && (data[candidate + length] == data[i + length]))
+					{
+						length++;
+					}
+
+					if (length > bestLength)
+					{
+						bestLength = length;
+						bestOffset = offset;
+					}
+
+					candidate = chain[candidate];
+				}
+			}
+
+			if (bestLength >= 3)
+			{
+				writer.writeBit(true);
+
+				if (bestLength <= 12)
+				{
+					writer.writeBits(Duplication1.at(bestLength - 2));
+				}
+				else if (bestLength <= 24)
+				{
+					writer.writeBits(Duplication1.at(bestLength - 1));
+				}
+				else
+				{
+					writer.writeBits(Duplication1.at(SpecialCaseIndex));
+					writer.writeByte(static_cast<uint8_t>(bestLength - 25));
+				}
+
+				writer.writeBits(Duplication2.at(bestOffset >> 8));
+				writer.writeByte(static_cast<uint8_t>(bestOffset & 0xFF));
+
+				for (int j = 0; j < bestLength; j++)
+				{
+					insert(i + j);
+				}
+
+				i += bestLength;
+			}
+			else
+			{
+				// Literal bytes are XORed with a key based on the bit position.
+				writer.writeBit(false);
+				const uint8_t key = static_cast<uint8_t>(16 - writer.getBitCount());
+				writer.writeByte(data[i] ^ key);
+				insert(i);
+				i++;
+			}
+		}
+
+		// End of data.
+		writer.writeBit(true);
+		writer.writeBits(Duplication1.at(SpecialCaseIndex));
+		writer.writeByte(0xFF);
+
+		// Trailer: the 0xFFFF word, then the unpacked length as segment and offset.
+		const uint16_t segment = static_cast<uint16_t>(data.size() / 16);
+		const uint16_t offset = static_cast<uint16_t>(data.size() % 16);
+		const uint8_t trailer[] =
+		{
+			0xFF, 0xFF,
+			static_cast<uint8_t>(segment & 0xFF), static_cast<uint8_t>(segment >> 8),
+			static_cast<uint8_t>(offset & 0xFF), static_cast<uint8_t>(offset >> 8),
+			0, 0, 0, 0
+		};
+
+		exe.insert(exe.end(), std::begin(trailer), std::end(trailer));
+		return exe;
+	}
+
+	// The bit tree decoder that ExeUnpacker used before its lookup tables, kept here
+	// as the baseline.
+	namespace BitTreeDecoder
+	{
+		struct BitVector
+		{
+			std::array<bool, 9> bits;
+			int bitsUsed;
+
+			BitVector()
+			{
+				std::fill(this->bits.begin(), this->bits.end(), false);
+				this->bitsUsed = 0;
+			}
+		};
+
+		class BitTree
+		{
+		private:
+			struct Node
+			{
+				std::unique_ptr<int> value;
+				std::unique_ptr<Node> left;
+				std::unique_ptr<Node> right;
+			};
+
+			BitTree::Node root;
+		public:
+			void insert(const std::vector<bool> &bits, int value)
+			{
+				BitTree::Node *node = &this->root;
+				for (size_t i = 0; i < bits.size(); ++i)
+				{
+					std::unique_ptr<Node> &child = bits.at(i) ? node->right : node->left;
+					if (child.get() == nullptr)
+					{
+						child = std::unique_ptr<BitTree::Node>(new BitTree::Node());
+					}
+
+					node = child.get();
+
+					if (i == (bits.size() - 1))
+					{
+						node->value = std::unique_ptr<int>(new int(value));
+					}
+				}
+			}
+
+			const int *get(const BitVector &bitVector)
+			{
+				const int *value = nullptr;
+				const BitTree::Node *left = this->root.left.get();
+				const BitTree::Node *right = this->root.right.get();
+
+				for (int i = 0; i < bitVector.bitsUsed; i++)
+				{
+					const BitTree::Node *node = bitVector.bits.at(i) ? right : left;
+					assert(node != nullptr);
+
+					if ((node->left.get() == nullptr) && (node->right.get() == nullptr))
+					{
+						value = node->value.get();
+					}
+
+					left = node->left.get();
+					right = node->right.get();
+				}
+
+				return value;
+			}
+		};
+
+		std::vector<uint8_t> unpack(const std::vector<uint8_t> &srcData)
+		{
+			BitTree bitTree1, bitTree2;
+
+			for (int i = 0; i < 11; ++i)
+			{
+				bitTree1.insert(Duplication1.at(i), i + 2);
+			}
+
+			bitTree1.insert(Duplication1.at(11), 13);
+
+			for (int i = 12; i < static_cast<int>(Duplication1.size()); ++i)
+			{
+				bitTree1.insert(Duplication1.at(i), i + 1);
+			}
+
+			for (int i = 0; i < static_cast<int>(Duplication2.size()); ++i)
+			{
+				bitTree2.insert(Duplication2.at(i), i);
+			}
+
+			const uint8_t *compressedStart = srcData.data() + CompressedStart;
+			const uint8_t *compressedEnd = srcData.data() + (srcData.size() - 8);
+
+			const size_t decompLen = (Bytes::getLE16(compressedEnd) * 16) +
+				Bytes::getLE16(compressedEnd + 2);
+
+			std::vector<uint8_t> decomp(decompLen, 0);
+			size_t decompIndex = 0;
+			uint16_t bitArray = Bytes::getLE16(compressedStart);
+			int byteIndex = 2;
+			int bitsRead = 0;
+
+			auto getNextByte = [compressedStart, &byteIndex]()
+			{
+				const uint8_t byte = compressedStart[byteIndex];
+				byteIndex++;
+				return byte;
+			};
+
+			auto getNextBit = [&bitArray, &bitsRead, &getNextByte]()
+			{
+				const bool bit = (bitArray & (1 << bitsRead)) != 0;
+				bitsRead++;
+
+				if (bitsRead == 16)
+				{
+					bitsRead = 0;
+					const uint8_t byte1 = getNextByte();
+					const uint8_t byte2 = getNextByte();
+					bitArray = byte1 | (byte2 << 8);
+				}
+
+				return bit;
+			};
+
+			while (true)
+			{
+				if (getNextBit())
+				{
+					BitVector copyBits;
+					const int *copyPtr = nullptr;
+					while (copyPtr == nullptr)
+					{
+						copyBits.bits.at(copyBits.bitsUsed) = getNextBit();
+						copyBits.bitsUsed++;
+						copyPtr = bitTree1.get(copyBits);
+					}
+
+					const std::vector<bool> &specialCase = Duplication1.at(SpecialCaseIndex);
+					bool isSpecialCase = copyBits.bitsUsed == static_cast<int>(specialCase.size());
+					for (int i = 0; isSpecialCase && (i < copyBits.bitsUsed); i++)
+					{
+						isSpecialCase = copyBits.bits.at(i) == specialCase.at(i);
+					}
+
+					uint16_t copyCount = 0;
+					if (isSpecialCase)
+					{
+						const uint8_t encryptedByte = getNextByte();
+						if (encryptedByte == 0xFE)
+						{
+							continue;
+						}
+						else if (encryptedByte == 0xFF)
+						{
+							break;
+						}
+						else
+						{
+							copyCount = encryptedByte + 25;
+						}
+					}
+					else
+					{
+						copyCount = *copyPtr;
+					}
+
+					uint8_t mostSigByte = 0;
+					if (copyCount != 2)
+					{
+						BitVector offsetBits;
+						const int *offsetPtr = nullptr;
+						while (offsetPtr == nullptr)
+						{
+							offsetBits.bits.at(offsetBits.bitsUsed) = getNextBit();
+							offsetBits.bitsUsed++;
+							offsetPtr = bitTree2.get(offsetBits);
+						}
+
+						mostSigByte = *offsetPtr;
+					}
+
+					const uint8_t leastSigByte = getNextByte();
+					const uint16_t offset = leastSigByte | (mostSigByte << 8);
+
+					const size_t duplicateBegin = decompIndex - offset;
+					const size_t duplicateEnd = duplicateBegin + copyCount;
+					for (size_t i = duplicateBegin; i < duplicateEnd; ++i, ++decompIndex)
+					{
+						decomp.at(decompIndex) = decomp.at(i);
+					}
+				}
+				else
+				{
+					const uint8_t encryptedByte = getNextByte();
+					const uint8_t key = 16 - bitsRead;
+					decomp.at(decompIndex) = encryptedByte ^ key;
+					decompIndex++;
+				}
+			}
+
+			return decomp;
+		}
+	}
+
+	bool textEquals(const std::string &text, const std::vector<uint8_t> &data)
+	{
+		return (text.size() == data.size()) &&
+			std::equal(data.begin(), data.end(), reinterpret_cast<const uint8_t*>(text.data()));
+	}
+}
+
+int main()
+{
+	const std::vector<uint8_t> unpacked = makeUnpackedData();
+	const std::vector<uint8_t> exe = makeExecutable(unpacked);
+	std::cout << "Synthetic executable: " << exe.size() << " bytes, unpacks to " <<
+		unpacked.size() << " bytes.\n";
+
+	// Both decoders must give back the original data.
+	Check::that(BitTreeDecoder::unpack(exe) == unpacked, "Bit tree decoder output differs.");
+	Check::that(textEquals(ExeUnpacker(exe).getText(), unpacked),
+		"Lookup table decoder output differs.");
+
+	const double bitTreeMs = Check::timeMs(DecodeRuns, [&exe]()
+	{
+		BitTreeDecoder::unpack(exe);
+	});
+
+	const double bitTableMs = Check::timeMs(DecodeRuns, [&exe]()
+	{
+		ExeUnpacker unpacker(exe);
+	});
+
+	std::cout << "Bit tree decode: " << String::fixedPrecision(bitTreeMs, 3) << "ms\n";
+	std::cout << "Lookup table decode: " << String::fixedPrecision(bitTableMs, 3) << "ms (" <<
+		String::fixedPrecision(bitTreeMs / bitTableMs, 2) << "x)\n";
+
+	// Write the executable to disk, then unpack it once to make the cache and again
+	// to load from it. The first run has to replace a stale cache file.
+	const std::string exeFilename = "ExeUnpackerBenchmark.EXE";
+	const std::string cacheFilename = "ExeUnpackerBenchmark.cache";
+
+	std::ofstream ofs(exeFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+	ofs.write(reinterpret_cast<const char*>(exe.data()), exe.size());
+	ofs.close();
+
+	std::ofstream staleOfs(cacheFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+	staleOfs << "stale";
+	staleOfs.close();
+
+	VFS::Manager::get().addDataPath(".");
+
+	const ExeUnpacker firstRun(exeFilename, cacheFilename);
+	Check::that(textEquals(firstRun.getText(), unpacked), "First cached run output differs.");
+
+	const ExeUnpacker cachedRun(exeFilename, cacheFilename);
+	Check::that(textEquals(cachedRun.getText(), unpacked), "Cache file contents differ.");
+
+	const double cachedMs = Check::timeMs(CacheRuns, [&exeFilename, &cacheFilename]()
+	{
+		ExeUnpacker unpacker(exeFilename, cacheFilename);
+	});
+
+	std::cout << "Load from cache (including reading the executable): " <<
+		String::fixedPrecision(cachedMs, 3) << "ms\n";
+
+	std::remove(exeFilename.c_str());
+	std::remove(cacheFilename.c_str());
+
+	return Check::getExitCode();
+}
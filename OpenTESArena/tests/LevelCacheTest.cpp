@@ -0,0 +1,327 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+
+#include "OpenTESArena/src/Assets/INFFile.h"
+#include "OpenTESArena/src/Assets/MIFFile.h"
+#include "OpenTESArena/src/World/LevelCache.h"
+#include "OpenTESArena/src/World/VoxelData.h"
+#include "OpenTESArena/src/World/VoxelGrid.h"
+#include "OpenTESArena/src/World/WorldData.h"
+
+#include "components/vfs/manager.hpp"
+
+// Builds the levels of a small .MIF file written by the test and keeps them in a level
+// cache, checking that cached levels come back as they were stored, that the cache
+// stays within its byte budget, and that the least recently stored levels are evicted
+// first.
+
+namespace
+{
+	const std::string MIFFilename = "LevelCacheTest.MIF";
+	const std::string INFFilename = "LEVELCACHETEST.INF";
+	const int LevelCount = 4;
+	const int MapWidth = 64;
+	const int MapDepth = 64;
+
+	void appendLE16(std::vector<uint8_t> &data, int value)
+	{
+		data.push_back(static_cast<uint8_t>(value & 0xFF));
+		data.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+	}
+
+	void appendTag(std::vector<uint8_t> &data, const std::string &tag,
+		const std::vector<uint8_t> &tagData)
+	{
+		data.insert(data.end(), tag.begin(), tag.end());
+		appendLE16(data, static_cast<int>(tagData.size()));
+		data.insert(data.end(), tagData.begin(), tagData.end());
+	}
+
+	// Encodes bytes as type 8 data (what .MIF voxel data is compressed with), using only
+	// literals. It walks the same adaptive tree as Compression::decodeType08(), so every
+	// byte is written as the path from the root to that byte's leaf.
+	std::vector<uint8_t> encodeType08(const std::vector<uint8_t> &src)
+	{
+		std::array<uint16_t, 941> NodeIdxMap;
+		std::iota(NodeIdxMap.begin(), NodeIdxMap.begin() + 626, 0);
+		std::for_each(NodeIdxMap.begin(), NodeIdxMap.begin() + 626,
+			[](uint16_t &val) { val = (val >> 1) + 314; });
+
+		NodeIdxMap[626] = 0;
+		std::iota(NodeIdxMap.begin() + 627, NodeIdxMap.end(), 0);
+
+		std::array<uint16_t, 627> NodeTree;
+		std::iota(NodeTree.begin(), NodeTree.begin() + 314, 627);
+		std::iota(NodeTree.begin() + 314, NodeTree.end(), 0);
+		std::for_each(NodeTree.begin() + 314, NodeTree.end(),
+			[](uint16_t &val) { val *= 2; });
+
+		std::array<uint16_t, 627> NodeFreq;
+		std::fill(NodeFreq.begin(), NodeFreq.begin() + 314, 1);
+		{
+			auto iter = NodeFreq.begin();
+			std::for_each(NodeFreq.begin() + 314, NodeFreq.begin() + 627,
+				[&iter](uint16_t &val)
+			{
+				val = *(iter++);
+				val += *(iter++);
+			});
+		}
+
+		std::vector<uint8_t> dst;
+		int bitCount = 0;
+		auto writeBit = [&dst, &bitCount](int bit)
+		{
+			if ((bitCount % 8) == 0)
+			{
+				dst.push_back(0);
+			}
+
+			dst.back() |= bit << (7 - (bitCount % 8));
+			bitCount++;
+		};
+
+		for (const uint8_t value : src)
+		{
+			// Each position's parent is in the index map, and a node's children are at
+			// its tree value and the one after it. The root is always last.
+			const uint16_t node = 627 + value;
+			std::vector<int> bits;
+			uint16_t position = NodeIdxMap.at(node);
+			while (position != 626)
+			{
+				const uint16_t parent = NodeIdxMap.at(position);
+				bits.push_back(position - NodeTree.at(parent));
+				position = parent;
+			}
+
+			for (auto iter = bits.rbegin(); iter != bits.rend(); ++iter)
+			{
+				writeBit(*iter);
+			}
+
+			// Update the tree the same way the decoder does.
+			uint16_t freqidx = NodeIdxMap.at(node);
+			do {
+				NodeFreq.at(freqidx) += 1;
+				uint16_t freq = NodeFreq[freqidx];
+				uint16_t nextidx = freqidx + 1;
+				if (nextidx < NodeFreq.size() && NodeFreq[nextidx] < freq)
+				{
+					do {
+						++nextidx;
+					} while (nextidx < NodeFreq.size() && NodeFreq[nextidx] < freq);
+					--nextidx;
+
+					NodeFreq[freqidx] = NodeFreq[nextidx];
+					NodeFreq[nextidx] = freq;
+
+					std::iter_swap(NodeTree.begin() + freqidx, NodeTree.begin() + nextidx);
+
+					uint16_t mapidx = NodeTree[nextidx];
+					NodeIdxMap.at(mapidx) = nextidx;
+					if (mapidx < 627)
+					{
+						NodeIdxMap[mapidx + 1] = nextidx;
+					}
+
+					mapidx = NodeTree[freqidx];
+					NodeIdxMap.at(mapidx) = freqidx;
+					if (mapidx < 627)
+					{
+						NodeIdxMap[mapidx + 1] = freqidx;
+					}
+
+					freqidx = nextidx;
+				}
+
+				freqidx = NodeIdxMap[freqidx];
+			} while (freqidx != 0);
+		}
+
+		return dst;
+	}
+
+	// Voxel data tags start with their uncompressed size.
+	std::vector<uint8_t> makeVoxelTag(const std::vector<uint8_t> &voxels)
+	{
+		std::vector<uint8_t> tagData;
+		appendLE16(tagData, static_cast<int>(voxels.size()));
+
+		const std::vector<uint8_t> encoded = encodeType08(voxels);
+		tagData.insert(tagData.end(), encoded.begin(), encoded.end());
+		return tagData;
+	}
+
+	// Every level has a different floor texture (its index plus one) so it can be told
+	// apart, and a few walls.
+	std::vector<uint8_t> makeLevel(int levelIndex)
+	{
+		std::vector<uint8_t> flor, map1;
+		for (int i = 0; i < (MapWidth * MapDepth); i++)
+		{
+			appendLE16(flor, (levelIndex + 1) << 8);
+			appendLE16(map1, ((i % 7) == 0) ? 0x0202 : 0);
+		}
+
+		const std::string name = "Level " + std::to_string(levelIndex);
+		std::vector<uint8_t> levelTags;
+		appendTag(levelTags, "NAME", std::vector<uint8_t>(name.begin(), name.end() + 1));
+		appendTag(levelTags, "INFO", std::vector<uint8_t>(INFFilename.begin(),
+			INFFilename.end() + 1));
+		appendTag(levelTags, "NUMF", std::vector<uint8_t>(1, 2));
+		appendTag(levelTags, "FLOR", makeVoxelTag(flor));
+		appendTag(levelTags, "MAP1", makeVoxelTag(map1));
+
+		std::vector<uint8_t> level;
+		appendTag(level, "LEVL", levelTags);
+		return level;
+	}
+
+	std::vector<uint8_t> makeMIF()
+	{
+		// The header is 61 bytes after "MHDR" and its size, with one start point.
+		std::vector<uint8_t> header(61, 0);
+		header[1] = 1;
+		header[2] = 64;
+		header[10] = 64;
+		header[19] = LevelCount;
+		header[21] = MapWidth;
+		header[23] = MapDepth;
+
+		std::vector<uint8_t> data;
+		appendTag(data, "MHDR", header);
+		for (int i = 0; i < LevelCount; i++)
+		{
+			const std::vector<uint8_t> level = makeLevel(i);
+			data.insert(data.end(), level.begin(), level.end());
+		}
+
+		return data;
+	}
+
+	std::unique_ptr<WorldData> makeWorld(const MIFFile &mif, int levelIndex,
+		const INFFile &inf)
+	{
+		return std::unique_ptr<WorldData>(new WorldData(mif, levelIndex, inf));
+	}
+
+	// Gets which level a world was built from, using its floor texture.
+	int getLevelIndex(const WorldData &worldData)
+	{
+		const VoxelGrid &voxelGrid = worldData.getVoxelGrid();
+		return voxelGrid.getVoxelData(voxelGrid.getVoxels().get(0, 0, 0)).sideID - 1;
+	}
+}
+
+int main()
+{
+	const std::vector<uint8_t> mifData = makeMIF();
+	std::ofstream mifOfs(MIFFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+	mifOfs.write(reinterpret_cast<const char*>(mifData.data()), mifData.size());
+	mifOfs.close();
+
+	// An empty .INF file is enough for floors and walls.
+	std::ofstream infOfs(INFFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+	infOfs.close();
+
+	VFS::Manager::get().addDataPath(".");
+
+	const MIFFile mif(MIFFilename);
+	const INFFile inf(INFFilename);
+	Check::that(static_cast<int>(mif.getLevels().size()) == LevelCount,
+		"Wrong level count in the .MIF file.");
+
+	std::vector<size_t> levelBytes;
+	for (int i = 0; i < LevelCount; i++)
+	{
+		const std::unique_ptr<WorldData> worldData = makeWorld(mif, i, inf);
+		Check::that(getLevelIndex(*worldData) == i,
+			"Level " + std::to_string(i) + " has the wrong floor.");
+		Check::that(worldData->getVoxelGrid().getVoxels().get(0, 1, 0) != 0,
+			"Level " + std::to_string(i) + " is missing a wall.");
+		levelBytes.push_back(worldData->getByteCount());
+	}
+
+	// The levels are the same size, and the cache has room for two and a half of them.
+	const size_t bytesPerLevel = levelBytes.front();
+	Check::that(std::all_of(levelBytes.begin(), levelBytes.end(),
+		[bytesPerLevel](size_t bytes) { return bytes == bytesPerLevel; }),
+		"Level byte counts differ.");
+
+	LevelCache levelCache((bytesPerLevel * 5) / 2);
+	levelCache.put(mif.getName(), 0, makeWorld(mif, 0, inf));
+	levelCache.put(mif.getName(), 1, makeWorld(mif, 1, inf));
+	Check::that(levelCache.getCount() == 2, "Wrong count after storing two levels.");
+	Check::that(levelCache.getByteCount() == (bytesPerLevel * 2),
+		"Wrong byte count after storing two levels.");
+
+	// Storing a level again replaces the cached copy.
+	levelCache.put(mif.getName(), 1, makeWorld(mif, 1, inf));
+	Check::that(levelCache.getCount() == 2, "A level is cached twice.");
+
+	// A hit gives back the stored level and removes it from the cache.
+	std::unique_ptr<WorldData> level0 = levelCache.take(mif.getName(), 0);
+	Check::that((level0.get() != nullptr) && (getLevelIndex(*level0) == 0),
+		"Level 0 wasn't a hit.");
+	Check::that(!levelCache.contains(mif.getName(), 0), "Level 0 is still cached.");
+	Check::that(levelCache.getByteCount() == bytesPerLevel,
+		"Wrong byte count after taking a level.");
+	Check::that(levelCache.take(mif.getName(), 2).get() == nullptr, "Level 2 was a hit.");
+	Check::that(levelCache.take("OTHER.MIF", 1).get() == nullptr,
+		"A level of another .MIF file was a hit.");
+
+	// Level 0 is now more recent than level 1, so level 1 is evicted first.
+	levelCache.put(mif.getName(), 0, std::move(level0));
+	levelCache.put(mif.getName(), 2, makeWorld(mif, 2, inf));
+	Check::that(levelCache.getCount() == 2, "Wrong count after going over the budget.");
+	Check::that(levelCache.getByteCount() <= ((bytesPerLevel * 5) / 2),
+		"The cache is over its budget.");
+	Check::that(!levelCache.contains(mif.getName(), 1),
+		"Level 1 wasn't evicted.");
+	Check::that(levelCache.contains(mif.getName(), 0) &&
+		levelCache.contains(mif.getName(), 2), "The wrong level was evicted.");
+
+	levelCache.put(mif.getName(), 3, makeWorld(mif, 3, inf));
+	Check::that(!levelCache.contains(mif.getName(), 0) &&
+		levelCache.contains(mif.getName(), 2) && levelCache.contains(mif.getName(), 3),
+		"Level 0 wasn't evicted after level 2.");
+
+	// Lowering the budget evicts the oldest levels right away.
+	levelCache.setMaxBytes(bytesPerLevel);
+	Check::that((levelCache.getCount() == 1) && levelCache.contains(mif.getName(), 3),
+		"Lowering the budget didn't evict the oldest level.");
+
+	std::unique_ptr<WorldData> level3 = levelCache.take(mif.getName(), 3);
+	Check::that((level3.get() != nullptr) && (getLevelIndex(*level3) == 3),
+		"Level 3 wasn't a hit.");
+
+	// A level bigger than the whole budget isn't kept.
+	levelCache.setMaxBytes(bytesPerLevel - 1);
+	levelCache.put(mif.getName(), 3, std::move(level3));
+	Check::that((levelCache.getCount() == 0) && (levelCache.getByteCount() == 0),
+		"A level over the budget was kept.");
+
+	levelCache.setMaxBytes(LevelCache::DEFAULT_MAX_BYTES);
+	levelCache.put(mif.getName(), 1, makeWorld(mif, 1, inf));
+	levelCache.clear();
+	Check::that((levelCache.getCount() == 0) && (levelCache.getByteCount() == 0),
+		"Levels left after clearing.");
+
+	std::cout << LevelCount << " levels of " << bytesPerLevel << " bytes each\n";
+
+	std::remove(MIFFilename.c_str());
+	std::remove(INFFilename.c_str());
+
+	return Check::getExitCode();
+}
@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "Check.h"
+
+#include "OpenTESArena/src/Math/Constants.h"
+#include "OpenTESArena/src/Math/Random.h"
+#include "OpenTESArena/src/Math/Vector2.h"
+#include "OpenTESArena/src/Math/Vector3.h"
+#include "OpenTESArena/src/Rendering/SoftwareRenderer.h"
+#include "OpenTESArena/src/Utilities/String.h"
+#include "OpenTESArena/src/World/VoxelData.h"
+#include "OpenTESArena/src/World/VoxelDistanceField.h"
+#include "OpenTESArena/src/World/VoxelGrid.h"
+
+// Times ray casting on open maps at several fog distances. The first part walks rays
+// through the grid the way SoftwareRenderer::rayCast2D() does, once one voxel at a time
+// and once jumping with the distance field, and checks that both find the same columns.
+// The second part times whole frames from the software renderer.
+
+namespace
+{
+	const int GridWidth = 256;
+	const int GridHeight = 3;
+	const int GridDepth = 256;
+
+	// Fraction of columns with a wall in them. The rest are open.
+	const double WallDensity = 0.01;
+
+	const std::vector<double> FogDistances = { 16.0, 32.0, 64.0, 128.0 };
+
+	const int EyeCount = 64;
+	const int RaysPerEye = 320;
+	const int TraversalRuns = 5;
+
+	const int FrameWidth = 320;
+	const int FrameHeight = 200;
+	const int FrameRuns = 10;
+
+	// A column found by a ray, and the distance to where the ray entered it.
+	struct ColumnHit
+	{
+		int x, z;
+		double distance;
+	};
+
+	// Makes a grid with walls scattered over open ground, and optionally a floor
+	// under every column (as in most real levels).
+	void fillGrid(VoxelGrid &voxelGrid, bool withFloor)
+	{
+		const int airID = voxelGrid.addVoxelData(VoxelData(0));
+		const int wallID = voxelGrid.addVoxelData(VoxelData(1));
+		static_cast<void>(airID);
+
+		Random random(12345);
+		for (int z = 0; z < GridDepth; z++)
+		{
+			for (int x = 0; x < GridWidth; x++)
+			{
+				if (withFloor)
+				{
+					voxelGrid.setVoxel(x, 0, z, wallID);
+				}
+
+				if (random.nextReal() < WallDensity)
+				{
+					voxelGrid.setVoxel(x, 1, z, wallID);
+				}
+			}
+		}
+	}
+
+	// Eye positions in open columns, and directions spread around each one.
+	void makeRays(const VoxelGrid &voxelGrid, std::vector<Double3> &eyes,
+		std::vector<Double2> &directions)
+	{
+		Random random(54321);
+		while (static_cast<int>(eyes.size()) < EyeCount)
+		{
+			const Double3 eye(
+				8.0 + (random.nextReal() * static_cast<double>(GridWidth - 16)),
+				1.5,
+				8.0 + (random.nextReal() * static_cast<double>(GridDepth - 16)));
+
+			const VoxelGrid::ColumnSummary &summary = voxelGrid.getColumnSummary(
+				static_cast<int>(eye.x), static_cast<int>(eye.z));
+			if (!summary.isOccupied(1))
+			{
+				eyes.push_back(eye);
+			}
+		}
+
+		for (int i = 0; i < RaysPerEye; i++)
+		{
+			const double angle = (static_cast<double>(i) + 0.50) *
+				((2.0 * PI) / static_cast<double>(RaysPerEye));
+			directions.push_back(Double2(std::cos(angle), std::sin(angle)));
+		}
+	}
+
+	// Walks a ray through the grid's columns until it leaves the grid or reaches the
+	// fog distance, adding the columns that aren't all air. The distance field is
+	// null to step one voxel at a time.
+	void castRay(const Double3 &eye, const Double2 &direction, double fogDistance,
+		const VoxelGrid &voxelGrid, const VoxelDistanceField *distanceField,
+		std::vector<ColumnHit> &hits)
+	{
+		const double dirX = direction.x;
+		const double dirZ = direction.y;
+		const double deltaDistX = std::sqrt(1.0 + ((dirZ * dirZ) / (dirX * dirX)));
+		const double deltaDistZ = std::sqrt(1.0 + ((dirX * dirX) / (dirZ * dirZ)));
+		const bool nonNegativeDirX = dirX >= 0.0;
+		const bool nonNegativeDirZ = dirZ >= 0.0;
+		const int stepX = nonNegativeDirX ? 1 : -1;
+		const int stepZ = nonNegativeDirZ ? 1 : -1;
+
+		int cellX = static_cast<int>(std::floor(eye.x));
+		int cellZ = static_cast<int>(std::floor(eye.z));
+		double sideDistX = nonNegativeDirX ?
+			((static_cast<double>(cellX) + 1.0 - eye.x) * deltaDistX) :
+			((eye.x - static_cast<double>(cellX)) * deltaDistX);
+		double sideDistZ = nonNegativeDirZ ?
+			((static_cast<double>(cellZ) + 1.0 - eye.z) * deltaDistZ) :
+			((eye.z - static_cast<double>(cellZ)) * deltaDistZ);
+		double zDistance = 0.0;
+
+		auto isValid = [&voxelGrid](int x, int z)
+		{
+			return (x >= 0) && (x < voxelGrid.getWidth()) &&
+				(z >= 0) && (z < voxelGrid.getDepth());
+		};
+
+		auto doDDAStep = [&]()
+		{
+			if (sideDistX < sideDistZ)
+			{
+				sideDistX += deltaDistX;
+				cellX += stepX;
+				zDistance = (static_cast<double>(cellX) - eye.x +
+					static_cast<double>((1 - stepX) / 2)) / dirX;
+			}
+			else
+			{
+				sideDistZ += deltaDistZ;
+				cellZ += stepZ;
+				zDistance = (static_cast<double>(cellZ) - eye.z +
+					static_cast<double>((1 - stepZ) / 2)) / dirZ;
+			}
+		};
+
+		// Same as the jump in SoftwareRenderer::rayCast2D().
+		auto skipEmptySpace = [&](int radius)
+		{
+			const double exitDistX = nonNegativeDirX ?
+				((static_cast<double>(cellX + radius + 1) - eye.x) * deltaDistX) :
+				((eye.x - static_cast<double>(cellX - radius)) * deltaDistX);
+			const double exitDistZ = nonNegativeDirZ ?
+				((static_cast<double>(cellZ + radius + 1) - eye.z) * deltaDistZ) :
+				((eye.z - static_cast<double>(cellZ - radius)) * deltaDistZ);
+
+			auto getExitCell = [radius](double position, int center)
+			{
+				return std::min(std::max(static_cast<int>(std::floor(position)),
+					center - radius), center + radius);
+			};
+
+			if (exitDistX < exitDistZ)
+			{
+				cellZ = getExitCell(eye.z + (dirZ * exitDistX), cellZ);
+				cellX += nonNegativeDirX ? (radius + 1) : -(radius + 1);
+				zDistance = exitDistX;
+			}
+			else
+			{
+				cellX = getExitCell(eye.x + (dirX * exitDistZ), cellX);
+				cellZ += nonNegativeDirZ ? (radius + 1) : -(radius + 1);
+				zDistance = exitDistZ;
+			}
+
+			sideDistX = nonNegativeDirX ?
+				((static_cast<double>(cellX) + 1.0 - eye.x) * deltaDistX) :
+				((eye.x - static_cast<double>(cellX)) * deltaDistX);
+			sideDistZ = nonNegativeDirZ ?
+				((static_cast<double>(cellZ) + 1.0 - eye.z) * deltaDistZ) :
+				((eye.z - static_cast<double>(cellZ)) * deltaDistZ);
+		};
+
+		doDDAStep();
+
+		while (isValid(cellX, cellZ) && (zDistance < fogDistance))
+		{
+			if (distanceField != nullptr)
+			{
+				const int emptyRadius = distanceField->getDistance(cellX, cellZ) - 1;
+				if (emptyRadius > 0)
+				{
+					skipEmptySpace(emptyRadius);
+					continue;
+				}
+			}
+
+			if (!voxelGrid.getColumnSummary(cellX, cellZ).isEmpty())
+			{
+				ColumnHit hit;
+				hit.x = cellX;
+				hit.z = cellZ;
+				hit.distance = zDistance;
+				hits.push_back(hit);
+			}
+
+			doDDAStep();
+		}
+	}
+
+	// Casts every ray and returns the number of columns found, to keep the work from
+	// being optimized away.
+	size_t castAllRays(const std::vector<Double3> &eyes, const std::vector<Double2> &directions,
+		double fogDistance, const VoxelGrid &voxelGrid, const VoxelDistanceField *distanceField)
+	{
+		std::vector<ColumnHit> hits;
+		size_t hitCount = 0;
+		for (const Double3 &eye : eyes)
+		{
+			for (const Double2 &direction : directions)
+			{
+				hits.clear();
+				castRay(eye, direction, fogDistance, voxelGrid, distanceField, hits);
+				hitCount += hits.size();
+			}
+		}
+
+		return hitCount;
+	}
+
+	// Checks that jumping finds the same columns at the same distances as stepping.
+	void checkTraversal(const std::vector<Double3> &eyes, const std::vector<Double2> &directions,
+		double fogDistance, const VoxelGrid &voxelGrid, const VoxelDistanceField &distanceField)
+	{
+		std::vector<ColumnHit> steppedHits, skippedHits;
+		for (const Double3 &eye : eyes)
+		{
+			for (const Double2 &direction : directions)
+			{
+				steppedHits.clear();
+				skippedHits.clear();
+				castRay(eye, direction, fogDistance, voxelGrid, nullptr, steppedHits);
+				castRay(eye, direction, fogDistance, voxelGrid, &distanceField, skippedHits);
+
+				bool same = steppedHits.size() == skippedHits.size();
+				for (size_t i = 0; same && (i < steppedHits.size()); i++)
+				{
+					same = (steppedHits[i].x == skippedHits[i].x) &&
+						(steppedHits[i].z == skippedHits[i].z) &&
+						(std::abs(steppedHits[i].distance - skippedHits[i].distance) < 1e-9);
+				}
+
+				if (!same)
+				{
+					Check::that(false, "Skipping found different columns than stepping (fog " +
+						String::fixedPrecision(fogDistance, 0) + ").");
+					return;
+				}
+			}
+		}
+	}
+
+	void runMap(const std::string &name, bool withFloor)
+	{
+		VoxelGrid voxelGrid(GridWidth, GridHeight, GridDepth);
+		fillGrid(voxelGrid, withFloor);
+
+		VoxelDistanceField distanceField;
+		const double buildMs = Check::timeMs(TraversalRuns, [&voxelGrid, &distanceField]()
+		{
+			distanceField.build(voxelGrid);
+		});
+
+		std::vector<Double3> eyes;
+		std::vector<Double2> directions;
+		makeRays(voxelGrid, eyes, directions);
+
+		std::cout << name << " (" << GridWidth << "x" << GridDepth << ", distance field built in " <<
+			String::fixedPrecision(buildMs, 3) << "ms):\n";
+
+		// The renderer with a checkerboard texture for walls and floors.
+		std::vector<uint32_t> texture(64 * 64);
+		for (int i = 0; i < static_cast<int>(texture.size()); i++)
+		{
+			texture[i] = (((i / 64) + (i % 64)) % 2) == 0 ? 0xFF808080 : 0xFF404040;
+		}
+
+		const std::vector<uint32_t> skyColors = { 0xFF6080C0, 0xFF203040 };
+		SoftwareRenderer renderer(FrameWidth, FrameHeight);
+		renderer.addTexture(texture.data(), 64, 64);
+		renderer.setSkyPalette(skyColors.data(), static_cast<int>(skyColors.size()));
+
+		std::vector<uint32_t> frame(FrameWidth * FrameHeight);
+		std::vector<uint32_t> firstFrame;
+		const Double3 eye = eyes.front();
+		const Double3 direction = Double3(1.0, 0.0, 0.5).normalized();
+
+		for (const double fogDistance : FogDistances)
+		{
+			checkTraversal(eyes, directions, fogDistance, voxelGrid, distanceField);
+
+			size_t steppedHitCount = 0;
+			const double steppedMs = Check::timeMs(TraversalRuns, [&]()
+			{
+				steppedHitCount = castAllRays(eyes, directions, fogDistance, voxelGrid, nullptr);
+			});
+
+			size_t skippedHitCount = 0;
+			const double skippedMs = Check::timeMs(TraversalRuns, [&]()
+			{
+				skippedHitCount = castAllRays(eyes, directions, fogDistance, voxelGrid,
+					&distanceField);
+			});
+
+			Check::that(steppedHitCount == skippedHitCount, "Column counts differ.");
+
+			renderer.setFogDistance(fogDistance);
+			renderer.render(eye, direction, 90.0, 1.0, 0.25, voxelGrid, frame.data());
+			firstFrame = frame;
+
+			const double frameMs = Check::timeMs(FrameRuns, [&]()
+			{
+				renderer.render(eye, direction, 90.0, 1.0, 0.25, voxelGrid, frame.data());
+			});
+
+			Check::that(frame == firstFrame, "Frames of the same view differ.");
+
+			std::cout << "  Fog " << String::fixedPrecision(fogDistance, 0) << ": " <<
+				(eyes.size() * directions.size()) << " rays stepped in " <<
+				String::fixedPrecision(steppedMs, 3) << "ms, skipped in " <<
+				String::fixedPrecision(skippedMs, 3) << "ms (" <<
+				String::fixedPrecision(steppedMs / skippedMs, 2) << "x); " <<
+				FrameWidth << "x" << FrameHeight << " frame in " <<
+				String::fixedPrecision(frameMs, 3) << "ms\n";
+		}
+	}
+}
+
+int main()
+{
+	runMap("Open map", false);
+
+	// Every column has a floor here, so nothing can be skipped. This shows the cost
+	// of checking the distance field when it doesn't help.
+	runMap("Open map with floor", true);
+
+	return Check::getExitCode();
+}
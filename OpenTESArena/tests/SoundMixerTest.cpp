@@ -0,0 +1,191 @@
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+
+#include "OpenTESArena/src/Media/SoundMixer.h"
+
+// Checks the sound mixer's resampling and mixing: the length and interpolation of
+// resampled sounds, stereo gains when two sounds play at once, clamping of loud
+// output to 16 bits, removal of finished sounds, and the voice limit. Frame counts
+// are picked so both the vectorized loops and their leftovers are covered.
+
+namespace
+{
+	const int SampleRate = 22050;
+
+	SoundMixer::SamplesPtr makeSamples(const std::vector<int16_t> &samples)
+	{
+		return std::make_shared<const std::vector<int16_t>>(samples);
+	}
+
+	// Resampled values can be off by one from rounding toward zero.
+	bool near(int16_t value, int expected)
+	{
+		return std::abs(static_cast<int>(value) - expected) <= 1;
+	}
+
+	void checkResample()
+	{
+		// Unsigned 8-bit samples are centered on 128 and scaled up to 16 bits.
+		const std::vector<uint8_t> src = { 128, 192, 64, 255 };
+		const std::vector<int16_t> same = SoundMixer::resample(src, 11025, 11025);
+		Check::that(same.size() == src.size(),
+			"Resampling at the same rate changed the length.");
+		Check::that((same.size() == 4) && (same[0] == 0) && (same[1] == 16384) &&
+			(same[2] == -16384) && (same[3] == 32512), "Wrong 8-bit to 16-bit conversion.");
+
+		// Doubling the rate puts a halfway sample between each pair, and the last one
+		// is held.
+		const std::vector<int16_t> doubled = SoundMixer::resample(src, 11025, 22050);
+		Check::that(doubled.size() == 8, "Doubling the rate gave " +
+			std::to_string(doubled.size()) + " samples instead of 8.");
+		if (doubled.size() == 8)
+		{
+			const int expected[] = { 0, 8192, 16384, 0, -16384, 8064, 32512, 32512 };
+			bool matches = true;
+			for (size_t i = 0; i < doubled.size(); i++)
+			{
+				matches &= near(doubled[i], expected[i]);
+			}
+
+			Check::that(matches, "Wrong interpolation when doubling the rate.");
+		}
+
+		// Rates that don't divide evenly round the length up.
+		const std::vector<uint8_t> longSrc(11025, 128);
+		Check::that(SoundMixer::resample(longSrc, 11025, 22050).size() == 22050,
+			"Wrong length for one second at double the rate.");
+		const std::vector<uint8_t> shortSrc(10, 128);
+		Check::that(SoundMixer::resample(shortSrc, 22050, 8000).size() == 4,
+			"Wrong length when lowering the rate.");
+		Check::that(SoundMixer::resample(std::vector<uint8_t>(), 11025, 22050).size() == 0,
+			"Resampling nothing gave samples.");
+	}
+
+	void checkStereoMix()
+	{
+		// Seven frames, so some go through the four-at-a-time loop and some don't.
+		SoundMixer mixer(SampleRate);
+		const int frameCount = 7;
+		std::vector<int16_t> first, second;
+		for (int i = 0; i < frameCount; i++)
+		{
+			first.push_back(static_cast<int16_t>(1000 * (i + 1)));
+			second.push_back(static_cast<int16_t>(-200 * (i + 1)));
+		}
+
+		Check::that(mixer.play(makeSamples(first), 1.0f, 0.50f), "Couldn't play a sound.");
+		Check::that(mixer.play(makeSamples(second), 0.0f, 2.0f), "Couldn't play a sound.");
+
+		std::vector<int16_t> output(frameCount * 2);
+		mixer.mix(output.data(), frameCount);
+
+		bool matches = true;
+		for (int i = 0; i < frameCount; i++)
+		{
+			const int left = 1000 * (i + 1);
+			const int right = (500 * (i + 1)) - (400 * (i + 1));
+			matches &= (output[i * 2] == left) && (output[(i * 2) + 1] == right);
+		}
+
+		Check::that(matches, "Wrong stereo mix of two sounds.");
+	}
+
+	void checkSaturation()
+	{
+		// Eleven frames are 22 samples, so the conversion goes through both its eight-
+		// at-a-time loop and the leftovers.
+		SoundMixer mixer(SampleRate);
+		const int frameCount = 11;
+		const std::vector<int16_t> loud(frameCount, 30000);
+		const std::vector<int16_t> quiet(frameCount, -30000);
+		mixer.play(makeSamples(loud), 1.0f, 0.0f);
+		mixer.play(makeSamples(loud), 1.0f, 0.0f);
+		mixer.play(makeSamples(quiet), 0.0f, 1.0f);
+		mixer.play(makeSamples(quiet), 0.0f, 1.0f);
+
+		std::vector<int16_t> output(frameCount * 2);
+		mixer.mix(output.data(), frameCount);
+
+		bool clamped = true;
+		for (int i = 0; i < frameCount; i++)
+		{
+			clamped &= (output[i * 2] == 32767) && (output[(i * 2) + 1] == -32768);
+		}
+
+		Check::that(clamped, "Loud output wasn't clamped to 16 bits.");
+
+		// Volume is applied before clamping.
+		mixer.setVolume(0.25f);
+		mixer.play(makeSamples(loud), 1.0f, 0.0f);
+		mixer.play(makeSamples(loud), 1.0f, 0.0f);
+		mixer.mix(output.data(), frameCount);
+		Check::that((output[0] == 15000) && (output[(frameCount - 1) * 2] == 15000),
+			"Volume wasn't applied.");
+	}
+
+	void checkFinishedVoices()
+	{
+		SoundMixer mixer(SampleRate);
+		mixer.play(makeSamples(std::vector<int16_t>(5, 100)), 1.0f, 1.0f);
+		mixer.play(makeSamples(std::vector<int16_t>(12, 100)), 1.0f, 1.0f);
+		mixer.play(makeSamples(std::vector<int16_t>(8, 100)), 1.0f, 1.0f);
+
+		// The first sound ends partway through, and the rest of its frames are silent.
+		std::vector<int16_t> output(16);
+		mixer.mix(output.data(), 8);
+		Check::that(mixer.getVoiceCount() == 1, "Finished sounds weren't removed (" +
+			std::to_string(mixer.getVoiceCount()) + " left).");
+		Check::that((output[8] == 300) && (output[10] == 200),
+			"Wrong output while a sound finishes.");
+
+		mixer.mix(output.data(), 8);
+		Check::that(mixer.getVoiceCount() == 0, "The last sound wasn't removed.");
+		Check::that((output[6] == 100) && (output[8] == 0),
+			"Wrong output after the last sound ended.");
+
+		mixer.mix(output.data(), 8);
+		bool silent = true;
+		for (const int16_t sample : output)
+		{
+			silent &= sample == 0;
+		}
+
+		Check::that(silent, "Output isn't silent with no sounds.");
+	}
+
+	void checkVoiceLimit()
+	{
+		SoundMixer mixer(SampleRate);
+		const SoundMixer::SamplesPtr samples = makeSamples(std::vector<int16_t>(64, 1));
+		bool allPlayed = true;
+		for (int i = 0; i < SoundMixer::MAX_VOICES; i++)
+		{
+			allPlayed &= mixer.play(samples, 1.0f, 1.0f);
+		}
+
+		Check::that(allPlayed, "A sound under the voice limit didn't play.");
+		Check::that(!mixer.play(samples, 1.0f, 1.0f), "A sound over the voice limit played.");
+		Check::that(mixer.getVoiceCount() == SoundMixer::MAX_VOICES,
+			"Wrong voice count at the limit.");
+
+		mixer.stop();
+		Check::that((mixer.getVoiceCount() == 0) && mixer.play(samples, 1.0f, 1.0f),
+			"Sounds didn't play after stopping.");
+	}
+}
+
+int main()
+{
+	checkResample();
+	checkStereoMix();
+	checkSaturation();
+	checkFinishedVoices();
+	checkVoiceLimit();
+
+	return Check::getExitCode();
+}
@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+
+#include "OpenTESArena/src/Math/Vector2.h"
+#include "OpenTESArena/src/Math/Vector3.h"
+#include "OpenTESArena/src/World/VoxelCollision.h"
+#include "OpenTESArena/src/World/VoxelData.h"
+#include "OpenTESArena/src/World/VoxelGrid.h"
+
+// Replays movement traces of the player's collision box through small voxel maps with
+// VoxelCollision, the way Player::updatePhysics() moves the player. Each trace runs at
+// 60 FPS and at the lowest frame rate the game allows, and checks that the box never
+// overlaps solid geometry or gets past a wall, and that it ends up where it should.
+
+namespace
+{
+	// The player's box and movement values, from Player.cpp.
+	const double HalfWidth = 0.20;
+	const double Height = 0.70;
+	const double StepHeight = 0.25;
+	const double JumpVelocity = 3.0;
+	const double Gravity = 9.81;
+
+	// 60 FPS and Options::MIN_FPS, which is the longest frame the game ticks with.
+	const std::vector<double> FrameRates = { 60.0, 15.0 };
+
+	const int GridWidth = 16;
+	const int GridHeight = 5;
+	const int GridDepth = 16;
+
+	// Ground is solid up to here, so there is room for pits below it.
+	const double GroundY = 2.0;
+
+	// How close positions must be to where the box should stop.
+	const double Tolerance = 1.0e-6;
+
+	// Part of a trace: walking with a velocity in XZ for some time, and optionally
+	// jumping at the start.
+	struct Segment
+	{
+		double seconds;
+		Double2 walkVelocity;
+		bool jump;
+	};
+
+	struct State
+	{
+		Double3 feetPosition, velocity;
+		bool onGround, hitWall, hitCeiling;
+	};
+
+	struct Trace
+	{
+		std::string name;
+		std::function<void(VoxelGrid&)> build;
+		Double3 start;
+		std::vector<Segment> segments;
+
+		// Checked after every frame. Returns false if the box is somewhere it can't be.
+		std::function<bool(const State&)> isAllowed;
+
+		// Checked at the end.
+		std::function<bool(const State&)> isDone;
+	};
+
+	// Makes a grid with solid ground under every column.
+	VoxelGrid makeGrid()
+	{
+		VoxelGrid voxelGrid(GridWidth, GridHeight, GridDepth);
+		voxelGrid.addVoxelData(VoxelData(0));
+		const int groundID = voxelGrid.addVoxelData(VoxelData(1));
+
+		for (int z = 0; z < GridDepth; z++)
+		{
+			for (int x = 0; x < GridWidth; x++)
+			{
+				voxelGrid.setVoxel(x, 0, z, groundID);
+				voxelGrid.setVoxel(x, 1, z, groundID);
+			}
+		}
+
+		return voxelGrid;
+	}
+
+	// A voxel that's solid from the bottom up to some height, like a stair or bridge.
+	int addPartial(VoxelGrid &voxelGrid, double yOffset, double ySize)
+	{
+		return voxelGrid.addVoxelData(VoxelData(1, 1, 1, yOffset, ySize, 0.0, 1.0));
+	}
+
+	void addWall(VoxelGrid &voxelGrid, int x, int z)
+	{
+		const int wallID = voxelGrid.addVoxelData(VoxelData(1));
+		voxelGrid.setVoxel(x, 2, z, wallID);
+		voxelGrid.setVoxel(x, 3, z, wallID);
+	}
+
+	// One frame of the player's physics: walking sets the horizontal velocity, jumping
+	// only works on the ground, and gravity always pulls down.
+	State tick(const VoxelGrid &voxelGrid, const State &state, const Double2 &walkVelocity,
+		bool jump, double dt)
+	{
+		Double3 velocity(walkVelocity.x, state.velocity.y, walkVelocity.y);
+		if (jump && state.onGround)
+		{
+			velocity.y += JumpVelocity;
+		}
+
+		velocity.y -= Gravity * dt;
+
+		const VoxelCollision::Result result = VoxelCollision::move(voxelGrid,
+			state.feetPosition, HalfWidth, Height, StepHeight, velocity, dt);
+
+		State newState;
+		newState.feetPosition = result.position;
+		newState.velocity = result.velocity;
+		newState.onGround = (result.velocity.y <= 0.0) &&
+			VoxelCollision::isOnGround(voxelGrid, result.position, HalfWidth, Height);
+		newState.hitWall = state.hitWall || result.hitWall;
+		newState.hitCeiling = state.hitCeiling || result.hitCeiling;
+		return newState;
+	}
+
+	// Replays a trace at a frame rate, returning the end state.
+	State replay(const Trace &trace, double frameRate)
+	{
+		VoxelGrid voxelGrid = makeGrid();
+		trace.build(voxelGrid);
+
+		State state;
+		state.feetPosition = trace.start;
+		state.velocity = Double3(0.0, 0.0, 0.0);
+		state.onGround = VoxelCollision::isOnGround(voxelGrid, trace.start, HalfWidth, Height);
+		state.hitWall = false;
+		state.hitCeiling = false;
+
+		const std::string prefix = trace.name + " at " +
+			std::to_string(static_cast<int>(frameRate)) + " FPS: ";
+		Check::that(!VoxelCollision::overlaps(voxelGrid, trace.start, HalfWidth, Height),
+			prefix + "starts inside something.");
+
+		const double dt = 1.0 / frameRate;
+		for (const Segment &segment : trace.segments)
+		{
+			const int frameCount = static_cast<int>(std::ceil(segment.seconds * frameRate));
+			for (int frame = 0; frame < frameCount; frame++)
+			{
+				state = tick(voxelGrid, state, segment.walkVelocity,
+					segment.jump && (frame == 0), dt);
+
+				const Double3 &position = state.feetPosition;
+				if (VoxelCollision::overlaps(voxelGrid, position, HalfWidth, Height) ||
+					!trace.isAllowed(state))
+				{
+					Check::that(false, prefix + "box got to (" + std::to_string(position.x) +
+						", " + std::to_string(position.y) + ", " +
+						std::to_string(position.z) + ").");
+					return state;
+				}
+			}
+		}
+
+		Check::that(trace.isDone(state), prefix + "ended at (" +
+			std::to_string(state.feetPosition.x) + ", " +
+			std::to_string(state.feetPosition.y) + ", " +
+			std::to_string(state.feetPosition.z) + ").");
+		return state;
+	}
+
+	bool near(double a, double b)
+	{
+		return std::abs(a - b) <= Tolerance;
+	}
+
+	bool nearPosition(const Double3 &a, const Double3 &b)
+	{
+		return near(a.x, b.x) && near(a.y, b.y) && near(a.z, b.z);
+	}
+
+	std::vector<Trace> makeTraces()
+	{
+		std::vector<Trace> traces;
+
+		// Walking into a wall stops the box against it.
+		Trace wall;
+		wall.name = "Wall";
+		wall.build = [](VoxelGrid &voxelGrid) { addWall(voxelGrid, 8, 4); };
+		wall.start = Double3(4.50, GroundY, 4.50);
+		wall.segments = { { 2.0, Double2(3.0, 0.0), false } };
+		wall.isAllowed = [](const State &state)
+		{
+			return state.feetPosition.x <= (8.0 - HalfWidth + Tolerance);
+		};
+		wall.isDone = [](const State &state)
+		{
+			return state.hitWall && state.onGround &&
+				nearPosition(state.feetPosition, Double3(8.0 - HalfWidth, GroundY, 4.50));
+		};
+		traces.push_back(wall);
+
+		// Running diagonally into a corner stops the box in it.
+		Trace corner;
+		corner.name = "Corner";
+		corner.build = [](VoxelGrid &voxelGrid)
+		{
+			for (int i = 0; i <= 8; i++)
+			{
+				addWall(voxelGrid, 8, i);
+				addWall(voxelGrid, i, 8);
+			}
+		};
+		corner.start = Double3(4.50, GroundY, 5.50);
+		corner.segments = { { 2.0, Double2(4.0, 4.0), false } };
+		corner.isAllowed = [](const State &state)
+		{
+			return (state.feetPosition.x <= (8.0 - HalfWidth + Tolerance)) &&
+				(state.feetPosition.z <= (8.0 - HalfWidth + Tolerance));
+		};
+		corner.isDone = [](const State &state)
+		{
+			return nearPosition(state.feetPosition,
+				Double3(8.0 - HalfWidth, GroundY, 8.0 - HalfWidth));
+		};
+		traces.push_back(corner);
+
+		// A fast box can't pass through a diagonal wall (which has no thickness), and
+		// slides along it instead. The wall is the line z = x.
+		Trace diagonal;
+		diagonal.name = "Diagonal";
+		diagonal.build = [](VoxelGrid &voxelGrid)
+		{
+			const int diagonalID = voxelGrid.addVoxelData(VoxelData(1, 0));
+			for (int i = 0; i < GridWidth; i++)
+			{
+				voxelGrid.setVoxel(i, 2, i, diagonalID);
+				voxelGrid.setVoxel(i, 3, i, diagonalID);
+			}
+		};
+		diagonal.start = Double3(4.50, GroundY, 2.50);
+		diagonal.segments = { { 0.20, Double2(0.0, 40.0), false } };
+		diagonal.isAllowed = [](const State &state)
+		{
+			return (state.feetPosition.z - state.feetPosition.x) <=
+				(-2.0 * HalfWidth) + Tolerance;
+		};
+		diagonal.isDone = [](const State &state)
+		{
+			// It moved along the wall, not just up to it.
+			return state.hitWall && (state.feetPosition.x > 6.0) &&
+				near(state.feetPosition.z - state.feetPosition.x, -2.0 * HalfWidth);
+		};
+		traces.push_back(diagonal);
+
+		// Stairs of 0.2 are stepped up, and the 0.4 rise after them is a wall.
+		Trace stairs;
+		stairs.name = "Stairs";
+		stairs.build = [](VoxelGrid &voxelGrid)
+		{
+			const int lowID = addPartial(voxelGrid, 0.0, 0.20);
+			const int highID = addPartial(voxelGrid, 0.0, 0.40);
+			const int tooHighID = addPartial(voxelGrid, 0.0, 0.80);
+			for (int z = 0; z < GridDepth; z++)
+			{
+				voxelGrid.setVoxel(6, 2, z, lowID);
+				voxelGrid.setVoxel(7, 2, z, highID);
+				voxelGrid.setVoxel(8, 2, z, highID);
+				voxelGrid.setVoxel(9, 2, z, tooHighID);
+			}
+		};
+		stairs.start = Double3(4.50, GroundY, 4.50);
+		stairs.segments = { { 3.0, Double2(3.0, 0.0), false } };
+		stairs.isAllowed = [](const State &state)
+		{
+			return state.feetPosition.x <= (9.0 - HalfWidth + Tolerance);
+		};
+		stairs.isDone = [](const State &state)
+		{
+			return state.onGround && nearPosition(state.feetPosition,
+				Double3(9.0 - HalfWidth, GroundY + 0.40, 4.50));
+		};
+		traces.push_back(stairs);
+
+		// A thin bridge over a pit holds the box up the whole way across.
+		Trace bridge;
+		bridge.name = "Bridge";
+		bridge.build = [](VoxelGrid &voxelGrid)
+		{
+			const int bridgeID = addPartial(voxelGrid, 0.0, 0.10);
+			for (int z = 0; z < GridDepth; z++)
+			{
+				for (int x = 6; x <= 9; x++)
+				{
+					voxelGrid.setVoxel(x, 1, z, 0);
+				}
+			}
+
+			for (int x = 6; x <= 9; x++)
+			{
+				voxelGrid.setVoxel(x, 2, 4, bridgeID);
+			}
+		};
+		bridge.start = Double3(4.50, GroundY, 4.50);
+		bridge.segments = {
+			{ 2.90, Double2(2.0, 0.0), false },
+			{ 0.50, Double2(0.0, 0.0), false } };
+		bridge.isAllowed = [](const State &state)
+		{
+			return state.feetPosition.y >= (GroundY - Tolerance);
+		};
+		bridge.isDone = [](const State &state)
+		{
+			return state.onGround && (state.feetPosition.x > 10.0) &&
+				near(state.feetPosition.y, GroundY);
+		};
+		traces.push_back(bridge);
+
+		// Walking off a ledge falls to the bottom of the pit, and its far side is too
+		// high to step up.
+		Trace pit;
+		pit.name = "Pit";
+		pit.build = [](VoxelGrid &voxelGrid)
+		{
+			for (int z = 0; z < GridDepth; z++)
+			{
+				for (int x = 7; x <= 11; x++)
+				{
+					voxelGrid.setVoxel(x, 1, z, 0);
+				}
+			}
+		};
+		pit.start = Double3(4.50, GroundY, 4.50);
+		pit.segments = { { 4.0, Double2(2.0, 0.0), false } };
+		pit.isAllowed = [](const State &state)
+		{
+			return (state.feetPosition.y >= (GroundY - 1.0 - Tolerance)) &&
+				(state.feetPosition.x <= (12.0 - HalfWidth + Tolerance));
+		};
+		pit.isDone = [](const State &state)
+		{
+			return state.onGround && state.hitWall && nearPosition(state.feetPosition,
+				Double3(12.0 - HalfWidth, GroundY - 1.0, 4.50));
+		};
+		traces.push_back(pit);
+
+		// Jumping under a low ceiling hits it, and the box comes back down.
+		Trace ceiling;
+		ceiling.name = "Ceiling";
+		ceiling.build = [](VoxelGrid &voxelGrid)
+		{
+			const int ceilingID = voxelGrid.addVoxelData(VoxelData(1));
+			for (int z = 0; z < GridDepth; z++)
+			{
+				for (int x = 0; x < GridWidth; x++)
+				{
+					voxelGrid.setVoxel(x, 3, z, ceilingID);
+				}
+			}
+		};
+		ceiling.start = Double3(4.50, GroundY, 4.50);
+		ceiling.segments = { { 1.0, Double2(0.0, 0.0), true } };
+		ceiling.isAllowed = [](const State &state)
+		{
+			return (state.feetPosition.y + Height) <= (3.0 + Tolerance);
+		};
+		ceiling.isDone = [](const State &state)
+		{
+			return state.hitCeiling && state.onGround &&
+				nearPosition(state.feetPosition, Double3(4.50, GroundY, 4.50));
+		};
+		traces.push_back(ceiling);
+
+		// Jumping onto a ledge too high to step up, then walking along it. Jumps are a
+		// little lower at low frame rates, so the ledge is low enough for both.
+		Trace ledge;
+		ledge.name = "Ledge";
+		ledge.build = [](VoxelGrid &voxelGrid)
+		{
+			const int ledgeID = addPartial(voxelGrid, 0.0, 0.30);
+			for (int z = 0; z < GridDepth; z++)
+			{
+				for (int x = 6; x < GridWidth; x++)
+				{
+					voxelGrid.setVoxel(x, 2, z, ledgeID);
+				}
+			}
+		};
+		ledge.start = Double3(4.50, GroundY, 4.50);
+		ledge.segments = {
+			{ 1.0, Double2(2.0, 0.0), false },
+			{ 1.0, Double2(2.0, 0.0), true },
+			{ 1.0, Double2(0.0, 2.0), false } };
+		ledge.isAllowed = [](const State &state)
+		{
+			return state.feetPosition.y >= (GroundY - Tolerance);
+		};
+		ledge.isDone = [](const State &state)
+		{
+			return state.onGround && near(state.feetPosition.y, GroundY + 0.30) &&
+				(state.feetPosition.x > 6.0) && (state.feetPosition.z > 6.0);
+		};
+		traces.push_back(ledge);
+
+		return traces;
+	}
+}
+
+int main()
+{
+	const std::vector<Trace> traces = makeTraces();
+	for (const Trace &trace : traces)
+	{
+		for (const double frameRate : FrameRates)
+		{
+			replay(trace, frameRate);
+		}
+	}
+
+	std::cout << traces.size() << " traces replayed at " << FrameRates.size() <<
+		" frame rates\n";
+
+	return Check::getExitCode();
+}